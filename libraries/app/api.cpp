@@ -112,50 +112,6 @@ namespace btcm { namespace app {
 
     void network_broadcast_api::on_api_startup()
     {
-       /// note cannot capture shared pointer here, because _applied_block_connection will never
-       /// be freed if the lambda holds a reference to it.
-       _applied_block_connection = connect_signal( _app.chain_database()->applied_block, *this, &network_broadcast_api::on_applied_block );
-    }
-
-    void network_broadcast_api::on_applied_block( const signed_block& b )
-    {
-       int32_t block_num = int32_t(b.block_num());
-       if( _callbacks.size() )
-       {
-          /// we need to ensure the database_api is not deleted for the life of the async operation
-          auto capture_this = shared_from_this();
-          for( size_t trx_num = 0; trx_num < b.transactions.size(); ++trx_num )
-          {
-             const auto& trx = b.transactions[trx_num];
-             auto id = trx.id();
-             auto itr = _callbacks.find(id);
-             if( itr != _callbacks.end() )
-             {
-                auto callback = _callbacks.find(id)->second;
-                fc::async( [capture_this,this,id,block_num,trx_num,callback](){ callback( fc::variant( transaction_confirmation{ id, block_num, int32_t(trx_num), false}, GRAPHENE_MAX_NESTED_OBJECTS ) ); } );
-                itr->second = []( const variant& ){};
-             }
-          }
-       }
-
-       /// clear all expirations
-       if( _callbacks_expirations.size() ) {
-          auto end = _callbacks_expirations.upper_bound( b.timestamp );
-          auto itr = _callbacks_expirations.begin();
-          while( itr != end ) {
-             for( const auto trx_id : itr->second ) {
-               auto cb_itr = _callbacks.find( trx_id );
-               if( cb_itr != _callbacks.end() ) {
-                   auto capture_this = shared_from_this();
-                   auto callback = _callbacks.find(trx_id)->second; 
-                   fc::async( [capture_this,block_num,trx_id,callback](){ callback( fc::variant( transaction_confirmation{ trx_id, block_num, -1, true}, GRAPHENE_MAX_NESTED_OBJECTS ) ); } );
-                   _callbacks.erase(cb_itr);
-               }
-             }
-             _callbacks_expirations.erase( itr );
-             itr = _callbacks_expirations.begin();
-          }
-       }
     }
 
     void network_broadcast_api::broadcast_transaction(const signed_transaction& trx)
@@ -173,6 +129,28 @@ namespace btcm { namespace app {
        return future<fc::variant>(prom).wait();
     }
 
+    vector<network_broadcast_api::broadcast_result> network_broadcast_api::broadcast_transaction_batch( const vector<signed_transaction>& trxs )
+    {
+       vector<broadcast_result> results;
+       results.reserve( trxs.size() );
+       for( const auto& trx : trxs )
+       {
+          broadcast_result result;
+          result.id = trx.id();
+          try
+          {
+             broadcast_transaction( trx );
+             result.accepted = true;
+          }
+          catch( const fc::exception& e )
+          {
+             result.error = e.to_string();
+          }
+          results.push_back( std::move( result ) );
+       }
+       return results;
+    }
+
     void network_broadcast_api::broadcast_block( const signed_block& b )
     {
        _app.chain_database()->push_block(b);
@@ -182,10 +160,15 @@ namespace btcm { namespace app {
     void network_broadcast_api::broadcast_transaction_with_callback(confirmation_callback cb, const signed_transaction& trx)
     {
        trx.validate();
-       _callbacks[trx.id()] = cb;
-       _callbacks_expirations[trx.expiration].push_back(trx.id());
-
        _app.chain_database()->push_transaction(trx);
+
+       /// the callback must not be invoked once the API session that requested it is gone
+       std::weak_ptr<network_broadcast_api> weak_this = shared_from_this();
+       _app.confirmation_tracker()->track( trx.id(), trx.expiration, [weak_this,cb]( const transaction_confirmation& c )
+       {
+          if( weak_this.lock() )
+             cb( fc::variant( c, GRAPHENE_MAX_NESTED_OBJECTS ) );
+       } );
        _app.p2p_node()->broadcast_transaction(trx);
     }
 
@@ -41,6 +41,7 @@
 #include <fc/io/fstream.hpp>
 #include <fc/rpc/api_connection.hpp>
 #include <fc/rpc/websocket_api.hpp>
+#include <fc/rpc/binary_api_connection.hpp>
 #include <fc/network/resolve.hpp>
 
 #include <boost/algorithm/string.hpp>
@@ -164,12 +165,17 @@ namespace detail {
          FC_CAPTURE_AND_RETHROW((endpoint_string))
       }
 
+      uint16_t rpc_io_threads()const
+      {
+         return _options->count("rpc-io-threads") ? _options->at("rpc-io-threads").as<uint16_t>() : 0;
+      }
+
       void reset_websocket_server()
       { try {
          if( !_options->count("rpc-endpoint") )
             return;
 
-         _websocket_server = std::make_shared<fc::http::websocket_server>();
+         _websocket_server = std::make_shared<fc::http::websocket_server>( rpc_io_threads() );
 
          _websocket_server->on_connection([&]( const fc::http::websocket_connection_ptr& c ){ on_connection(c); } );
          ilog("Configured websocket rpc to listen on ${ip}", ("ip",_options->at("rpc-endpoint").as<string>()));
@@ -189,7 +195,8 @@ namespace detail {
          }
 
          string password = _options->count("server-pem-password") ? _options->at("server-pem-password").as<string>() : "";
-         _websocket_tls_server = std::make_shared<fc::http::websocket_tls_server>( _options->at("server-pem").as<string>(), password );
+         _websocket_tls_server = std::make_shared<fc::http::websocket_tls_server>( _options->at("server-pem").as<string>(), password,
+                                                                                   rpc_io_threads() );
 
          _websocket_tls_server->on_connection([this]( const fc::http::websocket_connection_ptr& c ){ on_connection(c); } );
          ilog("Configured websocket TLS rpc to listen on ${ip}", ("ip",_options->at("rpc-tls-endpoint").as<string>()));
@@ -197,10 +204,31 @@ namespace detail {
          _websocket_tls_server->start_accept();
       } FC_CAPTURE_AND_RETHROW() }
 
+      void reset_binary_websocket_server()
+      { try {
+         if( !_options->count("rpc-binary-endpoint") )
+            return;
+
+         _binary_websocket_server = std::make_shared<fc::http::websocket_server>( rpc_io_threads() );
+
+         _binary_websocket_server->on_connection([this]( const fc::http::websocket_connection_ptr& c ){
+            on_connection( c, std::make_shared<fc::rpc::binary_api_connection>(*c, GRAPHENE_NET_MAX_NESTED_OBJECTS) );
+         } );
+         ilog("Configured binary websocket rpc to listen on ${ip}", ("ip",_options->at("rpc-binary-endpoint").as<string>()));
+         _binary_websocket_server->listen( fc::ip::endpoint::from_string(_options->at("rpc-binary-endpoint").as<string>()) );
+         _binary_websocket_server->start_accept();
+      } FC_CAPTURE_AND_RETHROW() }
+
       void on_connection( const fc::http::websocket_connection_ptr& c )
+      {
+         on_connection( c, std::make_shared<fc::rpc::websocket_api_connection>(*c, GRAPHENE_NET_MAX_NESTED_OBJECTS) );
+      }
+
+      /// registers the public APIs on @p con, login_api adds the others the user may access
+      void on_connection( const fc::http::websocket_connection_ptr& c, const std::shared_ptr<fc::api_connection>& con )
       {
          std::shared_ptr< api_session_data > session = std::make_shared<api_session_data>();
-         session->wsc = std::make_shared<fc::rpc::websocket_api_connection>(*c, GRAPHENE_NET_MAX_NESTED_OBJECTS);
+         session->wsc = con;
 
          for( const std::string& name : _public_apis )
          {
@@ -220,7 +248,8 @@ namespace detail {
       explicit application_impl(application* self)
          : _self(self),
            _pending_trx_db(std::make_shared<graphene::db::object_database>()),
-           _chain_db(std::make_shared<chain::database>())
+           _chain_db(std::make_shared<chain::database>()),
+           _confirmation_tracker(std::make_shared<transaction_confirmation_tracker>(*_chain_db))
       {
       }
 
@@ -285,6 +314,14 @@ namespace detail {
          if( _options->count("replay-blockchain") )
             _chain_db->wipe( _data_dir / "blockchain", false );
 
+         if( _options->count("content-vote-archive-days") )
+            _chain_db->set_content_vote_archive_age( _options->at("content-vote-archive-days").as<uint32_t>() * 60*60*24 );
+
+         chain::block_database::write_options block_log;
+         block_log.async = !( _options->count("block-log-synchronous") && _options->at("block-log-synchronous").as<bool>() );
+         block_log.fsync = _options->count("block-log-fsync") && _options->at("block-log-fsync").as<bool>();
+         _chain_db->set_block_log_write_options( block_log );
+
          try
          {
             _chain_db->open( _data_dir / "blockchain", initial_state(), GRAPHENE_CURRENT_DB_VERSION );
@@ -341,6 +378,7 @@ namespace detail {
          reset_p2p_node(_data_dir);
          reset_websocket_server();
          reset_websocket_tls_server();
+         reset_binary_websocket_server();
       } FC_LOG_AND_RETHROW() }
 
       optional< api_access_info > get_api_access_info(const string& username)const
@@ -435,6 +473,10 @@ namespace detail {
             }
 
             return result;
+         } catch ( const btcm::chain::block_buffered_exception& e ) {
+            // kept by the fork database until its ancestors arrive, tell the net code not to fetch it again
+            wlog("Block ${n} does not link yet, keeping it until its ancestors arrive", ("n", blk_msg.block.block_num()));
+            FC_THROW_EXCEPTION(graphene::net::block_buffered_exception, "Block does not link yet:\n${e}", ("e", e.to_detail_string()));
          } catch ( const btcm::chain::unlinkable_block_exception& e ) {
             // translate to a graphene::net exception
             elog("Error when pushing block:\n${e}", ("e", e.to_detail_string()));
@@ -788,9 +830,11 @@ namespace detail {
 
       std::shared_ptr<graphene::db::object_database>   _pending_trx_db;
       std::shared_ptr<btcm::chain::database>        _chain_db;
+      std::shared_ptr<transaction_confirmation_tracker> _confirmation_tracker;
       std::shared_ptr<graphene::net::node>             _p2p_network;
       std::shared_ptr<fc::http::websocket_server>      _websocket_server;
       std::shared_ptr<fc::http::websocket_tls_server>  _websocket_tls_server;
+      std::shared_ptr<fc::http::websocket_server>      _binary_websocket_server;
 
       std::map<string, std::shared_ptr<abstract_plugin> > _plugins_available;
       std::map<string, std::shared_ptr<abstract_plugin> > _plugins_enabled;
@@ -849,10 +893,15 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("checkpoint,c", checkpoint_option, "Pairs of [BLOCK_NUM,BLOCK_ID] that should be enforced as checkpoints.")
          ("rpc-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:1028"), "Endpoint for websocket RPC to listen on")
          ("rpc-tls-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:1029"), "Endpoint for TLS websocket RPC to listen on")
+         ("rpc-binary-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:1030"), "Endpoint for websocket RPC with fc::raw packed calls to listen on, see fc::rpc::binary_api_connection")
          ("server-pem,p", bpo::value<string>()->implicit_value("server.pem"), "The TLS certificate file for this server")
+         ("rpc-io-threads", bpo::value<uint16_t>(), "Number of threads each RPC endpoint handles socket I/O, TLS and request parsing on (default: share fc's I/O threads)")
          ("server-pem-password,P", bpo::value<string>()->implicit_value(""), "Password for this certificate")
          ("dbg-init-key", bpo::value<string>(), "Block signing key to use for init witnesses, overrides genesis file")
          ("genesis-json", bpo::value<boost::filesystem::path>(), "File to read Genesis State from")
+         ("content-vote-archive-days", bpo::value<uint32_t>(), "Move content votes that have not changed for this many days to an on-disk archive")
+         ("block-log-fsync", bpo::bool_switch(), "Sync the block log to stable storage after every batch of appended blocks")
+         ("block-log-synchronous", bpo::bool_switch(), "Append blocks to the block log on the thread that applies them instead of a writer thread")
          ("api-user", bpo::value< vector<string> >()->composing(), "API user specification, may be specified multiple times")
          ("public-api", bpo::value< vector<string> >()->composing()->default_value(default_apis, str_default_apis), "Set an API to be publicly available, may be specified multiple times")
          ("enable-plugin", bpo::value< vector<string> >()->composing()->default_value(default_plugins, str_default_plugins), "Plugin(s) to enable, may be specified multiple times")
@@ -905,6 +954,11 @@ std::shared_ptr<graphene::db::object_database> application::pending_trx_database
    return my->_pending_trx_db;
 }
 
+std::shared_ptr<transaction_confirmation_tracker> application::confirmation_tracker() const
+{
+   return my->_confirmation_tracker;
+}
+
 void application::set_block_production(bool producing_blocks)
 {
    my->_is_block_producer = producing_blocks;
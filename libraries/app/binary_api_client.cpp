@@ -0,0 +1,34 @@
+#include <btcm/app/binary_api_client.hpp>
+
+#include <fc/smart_ref_impl.hpp>
+
+namespace btcm { namespace app {
+
+   binary_api_client::binary_api_client( fc::api_id_type login_api_id, uint32_t max_depth )
+      : _login_api_id( login_api_id ), _max_depth( max_depth )
+   {
+   }
+
+   binary_api_client::~binary_api_client()
+   {
+   }
+
+   void binary_api_client::connect( const std::string& uri )
+   { try {
+      FC_ASSERT( !_connection, "already connected" );
+      _socket = _client.connect( uri );
+      _connection = std::make_shared< fc::rpc::binary_api_connection >( *_socket, _max_depth );
+   } FC_CAPTURE_AND_RETHROW( (uri) ) }
+
+   bool binary_api_client::login( const std::string& user, const std::string& password )
+   {
+      return get_login_api()->login( user, password );
+   }
+
+   fc::api< login_api > binary_api_client::get_login_api()const
+   {
+      FC_ASSERT( _connection, "not connected" );
+      return _connection->get_remote_api< login_api >( _login_api_id );
+   }
+
+} } // btcm::app
@@ -0,0 +1,63 @@
+#include <btcm/app/confirmation_tracker.hpp>
+
+#include <fc/thread/thread.hpp>
+
+namespace btcm { namespace app {
+
+   using namespace btcm::chain;
+
+   transaction_confirmation_tracker::transaction_confirmation_tracker( chain::database& db )
+   {
+      _applied_block_connection = db.applied_block.connect( [this]( const signed_block& b ){ on_applied_block( b ); } );
+   }
+
+   void transaction_confirmation_tracker::track( const transaction_id_type& trx_id, time_point_sec expiration, confirmation_callback cb )
+   {
+      _tracked.insert( tracked_transaction{ trx_id, expiration, std::move( cb ) } );
+   }
+
+   void transaction_confirmation_tracker::on_applied_block( const signed_block& b )
+   {
+      if( _tracked.empty() )
+         return;
+
+      int32_t block_num = int32_t( b.block_num() );
+      vector< std::pair< confirmation_callback, transaction_confirmation > > confirmations;
+
+      auto& by_id_idx = _tracked.get< by_trx_id >();
+      for( size_t trx_num = 0; trx_num < b.transactions.size(); ++trx_num )
+      {
+         // the transaction ids are cached while the block is being applied
+         auto trx_id = b.transactions[ trx_num ].id();
+         auto range = by_id_idx.equal_range( trx_id );
+         for( auto itr = range.first; itr != range.second; ++itr )
+            confirmations.emplace_back( itr->callback, transaction_confirmation{ trx_id, block_num, int32_t( trx_num ), false } );
+         by_id_idx.erase( range.first, range.second );
+      }
+
+      auto& by_exp_idx = _tracked.get< by_expiration >();
+      auto end = by_exp_idx.upper_bound( b.timestamp );
+      for( auto itr = by_exp_idx.begin(); itr != end; ++itr )
+         confirmations.emplace_back( itr->callback, transaction_confirmation{ itr->trx_id, block_num, -1, true } );
+      by_exp_idx.erase( by_exp_idx.begin(), end );
+
+      if( confirmations.empty() )
+         return;
+
+      fc::async( [confirmations]()
+      {
+         for( const auto& c : confirmations )
+         {
+            try
+            {
+               c.first( c.second );
+            }
+            catch( const fc::exception& e )
+            {
+               wlog( "Error delivering confirmation of transaction ${id}: ${e}", ("id",c.second.id)("e",e.to_detail_string()) );
+            }
+         }
+      } );
+   }
+
+} } // btcm::app
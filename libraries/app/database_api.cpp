@@ -17,6 +17,8 @@
 #include <cfenv>
 #include <iostream>
 #include <locale>
+#include <mutex>
+#include <tuple>
 
 #define GET_REQUIRED_FEES_MAX_RECURSION 4
 
@@ -26,6 +28,15 @@ namespace btcm { namespace app {
 
 extended_balance::extended_balance(const account_balance_object& balance) : account_balance_object(balance) {}
 
+extended_content::extended_content( const content_object& content, const content_stats_object& stats )
+   : content_object( content ),
+     accumulated_balance_master( stats.accumulated_balance_master ),
+     accumulated_balance_comp( stats.accumulated_balance_comp ),
+     last_played( stats.last_played ),
+     times_played( stats.times_played ),
+     times_played_24( stats.times_played_24 ),
+     vote_totals( stats.vote_totals ) {}
+
 class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 {
    public:
@@ -73,17 +84,19 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       bool is_streaming_platform(string straming_platform)const;
       //content
       vector<report_object> get_reports_for_account(string consumer)const;
-      vector<content_object> get_content_by_uploader(string author)const;
-      optional<content_object>    get_content_by_url(string url)const;
-      vector<content_object> lookup_content(const string& start, uint32_t limit )const;
-      vector<content_object> list_content_by_latest( const content_id_type start, uint16_t limit )const;
-      vector<content_object> list_content_by_genre( uint32_t genre, const content_id_type start, uint16_t limit )const;
-      vector<content_object> list_content_by_category( const string& category, const content_id_type bound, uint16_t limit )const;
-      vector<content_object> list_content_by_uploader( const string& uploader, const object_id_type bound, uint16_t limit )const;
+      vector<extended_content> get_content_by_uploader(string author)const;
+      optional<extended_content>    get_content_by_url(string url)const;
+      vector<extended_content> lookup_content(const string& start, uint32_t limit )const;
+      vector<extended_content> list_content_by_latest( const content_id_type start, uint16_t limit )const;
+      vector<extended_content> list_content_by_genre( uint32_t genre, const content_id_type start, uint16_t limit )const;
+      vector<extended_content> list_content_by_category( const string& category, const content_id_type bound, uint16_t limit )const;
+      vector<extended_content> list_content_by_uploader( const string& uploader, const object_id_type bound, uint16_t limit )const;
+      extended_content extend_content( const content_object& content )const;
 
       //scoring
       uint64_t get_account_scoring( string account );
       uint64_t get_content_scoring( string content );
+      optional<content_vote_totals> get_content_vote_totals( string content )const;
       // Market
       vector< liquidity_balance > get_liquidity_queue( string start_account, uint32_t limit )const;
 
@@ -623,6 +636,20 @@ uint64_t database_api_impl::get_content_scoring( string content )
    return _db.get_scoring( *itr );
 }
 
+optional<content_vote_totals> database_api::get_content_vote_totals( string content )const
+{
+   return my->get_content_vote_totals( content );
+}
+
+optional<content_vote_totals> database_api_impl::get_content_vote_totals( string content )const
+{
+   const auto& idx = _db.get_index_type< content_index >().indices().get< by_url >();
+   auto itr = idx.find( content );
+   if( itr == idx.end() )
+      return optional<content_vote_totals>();
+   return _db.get_content_stats( *itr ).vote_totals;
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Witnesses and streaming platforms                                //
@@ -777,35 +804,40 @@ vector<report_object> database_api_impl::get_reports_for_account(string consumer
    return result;
 }
 
-vector<content_object> database_api::get_content_by_uploader(string author)const
+extended_content database_api_impl::extend_content( const content_object& content )const
+{
+   return extended_content( content, _db.get_content_stats( content ) );
+}
+
+vector<extended_content> database_api::get_content_by_uploader(string author)const
 {
    return my->get_content_by_uploader(author);
 }
 
-vector<content_object> database_api_impl::get_content_by_uploader(string uploader)const
+vector<extended_content> database_api_impl::get_content_by_uploader(string uploader)const
 {
    const auto& idx= _db.get_index_type<content_index>().indices().get< by_uploader >();
-   vector <content_object> result;
+   vector <extended_content> result;
     
    auto itr = idx.lower_bound( std::make_tuple( uploader, content_id_type((1ULL<<48)-1) ) );
    while( itr != idx.end() && itr->uploader == uploader && result.size() < 1000 )
    {
-      result.push_back (*itr);
+      result.push_back( extend_content( *itr ) );
       ++itr;
    }
    return result;
 }
 
-optional<content_object> database_api::get_content_by_url(string url)const
+optional<extended_content> database_api::get_content_by_url(string url)const
 {
    return my->get_content_by_url(url);
 }
 
-optional<content_object> database_api_impl::get_content_by_url(string url)const
+optional<extended_content> database_api_impl::get_content_by_url(string url)const
 {
    try{
-      optional<content_object> result;
-      result = _db.get_content(url);
+      optional<extended_content> result;
+      result = extend_content( _db.get_content(url) );
       return result;
    }
    catch(const fc::exception& e)
@@ -815,36 +847,36 @@ optional<content_object> database_api_impl::get_content_by_url(string url)const
 }
 
 
-vector<content_object>  database_api::lookup_content(const string& start, uint32_t limit )const
+vector<extended_content>  database_api::lookup_content(const string& start, uint32_t limit )const
 {
    return my->lookup_content(start, limit);
 }
 
-vector<content_object>  database_api_impl::lookup_content(const string& start, uint32_t limit )const
+vector<extended_content>  database_api_impl::lookup_content(const string& start, uint32_t limit )const
 {
-   vector <content_object> result;
+   vector <extended_content> result;
    const auto& idx = _db.get_index_type<content_index>().indices().get<by_title>();
    auto itr = idx.lower_bound( start );
    while( itr!=idx.end() && result.size() < limit && itr->track_title.compare( 0, start.size(), start ) == 0 )
    {
-      result.push_back( *itr );
+      result.push_back( extend_content( *itr ) );
       ++itr;
    }
    return result;
 }
 
-vector<content_object> database_api::list_content_by_latest( const string& start, uint16_t limit )const
+vector<extended_content> database_api::list_content_by_latest( const string& start, uint16_t limit )const
 {
    if( start.empty() )
       return my->list_content_by_latest( content_id_type(), limit );
    return my->list_content_by_latest( fc::variant(start, 1).as<content_id_type>(1), limit );
 }
 
-vector<content_object> database_api_impl::list_content_by_latest( const content_id_type start, uint16_t limit )const
+vector<extended_content> database_api_impl::list_content_by_latest( const content_id_type start, uint16_t limit )const
 {
    FC_ASSERT( limit <= 100 );
 
-   vector<content_object> result;
+   vector<extended_content> result;
    result.reserve( limit );
    const auto& idx = _db.get_index_type<content_index>().indices().get<by_id>();
    auto itr = (start.instance.value > 0 ? idx.upper_bound( start ) : idx.end());
@@ -855,23 +887,23 @@ vector<content_object> database_api_impl::list_content_by_latest( const content_
       if( itr->id != start ) itr++;
    }
    while( itr != idx.begin() && result.size() < limit )
-      result.push_back( *--itr );
+      result.push_back( extend_content( *--itr ) );
 
    return result;
 }
 
-vector<content_object> database_api::list_content_by_genre( uint32_t genre, const string& bound, uint16_t limit )const
+vector<extended_content> database_api::list_content_by_genre( uint32_t genre, const string& bound, uint16_t limit )const
 {
    if( bound.empty() )
       return my->list_content_by_genre( genre, content_id_type(), limit );
    return my->list_content_by_genre( genre, fc::variant(bound, 1).as<content_id_type>(1), limit );
 }
 
-vector<content_object> database_api_impl::list_content_by_genre( uint32_t genre, const content_id_type bound, uint16_t limit )const
+vector<extended_content> database_api_impl::list_content_by_genre( uint32_t genre, const content_id_type bound, uint16_t limit )const
 {
    FC_ASSERT( limit <= 100 );
 
-   vector<content_object> result;
+   vector<extended_content> result;
    result.reserve( limit );
    const auto& idx = _db.get_index_type< primary_index< content_index > >();
    const content_by_genre_index& by_genre = idx.get_secondary_index<btcm::chain::content_by_genre_index>();
@@ -884,23 +916,23 @@ vector<content_object> database_api_impl::list_content_by_genre( uint32_t genre,
       if( *itr != bound ) itr++;
    }
    while( itr != ids.begin() && result.size() < limit )
-      result.push_back( (*--itr)(_db) );
+      result.push_back( extend_content( (*--itr)(_db) ) );
 
    return result;
 }
 
-vector<content_object> database_api::list_content_by_category( const string& category, const string& bound, uint16_t limit )const
+vector<extended_content> database_api::list_content_by_category( const string& category, const string& bound, uint16_t limit )const
 {
    if( bound.empty() )
       return my->list_content_by_category( category, content_id_type(), limit );
    return my->list_content_by_category( category, fc::variant(bound, 1).as<content_id_type>(1), limit );
 }
 
-vector<content_object> database_api_impl::list_content_by_category( const string& category, const content_id_type bound, uint16_t limit )const
+vector<extended_content> database_api_impl::list_content_by_category( const string& category, const content_id_type bound, uint16_t limit )const
 {
    FC_ASSERT( limit <= 100 );
 
-   vector<content_object> result;
+   vector<extended_content> result;
    result.reserve( limit );
    const auto& idx = _db.get_index_type< primary_index< content_index > >();
    const content_by_category_index& by_category = idx.get_secondary_index<btcm::chain::content_by_category_index>();
@@ -913,23 +945,23 @@ vector<content_object> database_api_impl::list_content_by_category( const string
       if( *itr != bound ) itr++;
    }
    while( itr != ids.begin() && result.size() < limit )
-      result.push_back( (*--itr)(_db) );
+      result.push_back( extend_content( (*--itr)(_db) ) );
 
    return result;
 }
 
-vector<content_object> database_api::list_content_by_uploader( const string& uploader, const string& bound, uint16_t limit )const
+vector<extended_content> database_api::list_content_by_uploader( const string& uploader, const string& bound, uint16_t limit )const
 {
    if( bound.empty() )
       return my->list_content_by_uploader( uploader, content_id_type(), limit );
    return my->list_content_by_uploader( uploader, fc::variant(bound, 1).as<content_id_type>(1), limit );
 }
 
-vector<content_object> database_api_impl::list_content_by_uploader( const string& uploader, const object_id_type bound, uint16_t limit )const
+vector<extended_content> database_api_impl::list_content_by_uploader( const string& uploader, const object_id_type bound, uint16_t limit )const
 {
    FC_ASSERT( limit <= 100 );
 
-   vector<content_object> result;
+   vector<extended_content> result;
    result.reserve( limit );
    const auto& idx = _db.get_index_type<content_index>().indices().get<by_uploader>();
    auto itr = idx.lower_bound( boost::make_tuple( uploader, bound.instance() > 0 ? bound : object_id_type(content_id_type((1ULL<<48)-1)) ) );
@@ -939,7 +971,7 @@ vector<content_object> database_api_impl::list_content_by_uploader( const string
       if( itr->id == bound ) itr++;
    }
    while( itr != idx.end() && itr->uploader == uploader && result.size() < limit )
-      result.push_back( *itr++ );
+      result.push_back( extend_content( *itr++ ) );
 
    return result;
 }
@@ -1015,6 +1047,120 @@ order_book database_api::get_order_book_for_assets( asset_id_type base_id, asset
    return result;
 }
 
+namespace {
+
+   /**
+    *  Depth results shared by all API connections.  An entry is valid as long as the revision of its market in
+    *  the limit_order_depth_index has not changed.
+    */
+   struct order_book_depth_cache
+   {
+      struct entry
+      {
+         uint64_t                          revision = 0;
+         cached_json< order_book_depth >   depth;
+      };
+
+      static const size_t max_entries = 256;
+
+      std::mutex                                                            mutex;
+      std::map< std::tuple< asset_id_type, asset_id_type, uint32_t >, entry > entries;
+   };
+
+   order_book_depth_cache& get_order_book_depth_cache()
+   {
+      static order_book_depth_cache cache;
+      return cache;
+   }
+
+   /// levels of orders selling base for quote
+   price_level make_ask( const price& sell_price, const limit_order_depth_index::price_level& level )
+   {
+      price_level result;
+      result.order_price = ~sell_price;
+      result.real_price  = result.order_price.to_real();
+      result.base        = level.for_sale;
+      result.quote       = level.to_receive;
+      result.orders      = level.orders;
+      return result;
+   }
+
+   /// levels of orders selling quote for base
+   price_level make_bid( const price& sell_price, const limit_order_depth_index::price_level& level )
+   {
+      price_level result;
+      result.order_price = sell_price;
+      result.real_price  = result.order_price.to_real();
+      result.base        = level.to_receive;
+      result.quote       = level.for_sale;
+      result.orders      = level.orders;
+      return result;
+   }
+
+}
+
+cached_json< order_book_depth > database_api::get_order_book_depth( asset_id_type base_id, asset_id_type quote_id, uint32_t limit )const
+{
+   FC_ASSERT( limit <= 1000 );
+   const auto& idx = dynamic_cast< const primary_index< limit_order_index >& >( my->_db.get_index_type< limit_order_index >() );
+   const auto& depth_idx = idx.get_secondary_index< limit_order_depth_index >();
+   const uint64_t revision = depth_idx.get_revision( base_id, quote_id );
+   const auto key = std::make_tuple( base_id, quote_id, limit );
+
+   auto& cache = get_order_book_depth_cache();
+   if( revision != 0 )
+   {
+      std::lock_guard< std::mutex > lock( cache.mutex );
+      auto itr = cache.entries.find( key );
+      if( itr != cache.entries.end() && itr->second.revision == revision )
+         return itr->second.depth;
+   }
+
+   order_book_depth result;
+   result.base = base_id(my->_db).symbol_string;
+   result.quote = quote_id(my->_db).symbol_string;
+
+   for( const auto& level : depth_idx.get_side( base_id, quote_id ) )
+   {
+      if( result.asks.size() >= limit ) break;
+      result.asks.push_back( make_ask( level.first, level.second ) );
+   }
+   for( const auto& level : depth_idx.get_side( quote_id, base_id ) )
+   {
+      if( result.bids.size() >= limit ) break;
+      result.bids.push_back( make_bid( level.first, level.second ) );
+   }
+
+   cached_json< order_book_depth > depth( std::move( result ) );
+   if( revision != 0 )
+   {
+      std::lock_guard< std::mutex > lock( cache.mutex );
+      if( cache.entries.size() >= order_book_depth_cache::max_entries )
+         cache.entries.clear();
+      auto& entry = cache.entries[ key ];
+      entry.revision = revision;
+      entry.depth    = depth;
+   }
+   return depth;
+}
+
+top_of_book database_api::get_top_of_book( asset_id_type base_id, asset_id_type quote_id )const
+{
+   const auto& idx = dynamic_cast< const primary_index< limit_order_index >& >( my->_db.get_index_type< limit_order_index >() );
+   const auto& depth_idx = idx.get_secondary_index< limit_order_depth_index >();
+   top_of_book result;
+   result.base = base_id(my->_db).symbol_string;
+   result.quote = quote_id(my->_db).symbol_string;
+
+   const auto& asks = depth_idx.get_side( base_id, quote_id );
+   if( !asks.empty() )
+      result.ask = make_ask( asks.begin()->first, asks.begin()->second );
+   const auto& bids = depth_idx.get_side( quote_id, base_id );
+   if( !bids.empty() )
+      result.bid = make_bid( bids.begin()->first, bids.begin()->second );
+   return result;
+}
+
 vector< liquidity_balance > database_api::get_liquidity_queue( string start_account, uint32_t limit )const
 {
    return my->get_liquidity_queue( start_account, limit );
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <btcm/app/api_context.hpp>
+#include <btcm/app/confirmation_tracker.hpp>
 #include <btcm/app/database_api.hpp>
 #include <btcm/chain/protocol/types.hpp>
 
@@ -57,12 +58,13 @@ namespace btcm { namespace app {
       public:
          network_broadcast_api(const api_context& a);
 
-         struct transaction_confirmation
+         typedef btcm::app::transaction_confirmation transaction_confirmation;
+
+         struct broadcast_result
          {
             transaction_id_type   id;
-            int32_t               block_num;
-            int32_t               trx_num;
-            bool                  expired;
+            bool                  accepted = false;
+            string                error;
          };
 
          typedef std::function<void(variant/*transaction_confirmation*/)> confirmation_callback;
@@ -87,26 +89,21 @@ namespace btcm { namespace app {
           */
          fc::variant broadcast_transaction_synchronous( const signed_transaction& trx);
 
-         void broadcast_block( const signed_block& block );
-
          /**
-          * @brief Not reflected, thus not accessible to API clients.
+          * @brief Broadcast a batch of transactions to the network in a single call
+          * @param trxs The transactions to broadcast
+          * @return One result per transaction, in the same order
           *
-          * This function is registered to receive the applied_block
-          * signal from the chain database when a block is received.
-          * It then dispatches callbacks to clients who have requested
-          * to be notified when a particular txid is included in a block.
+          * Every transaction is checked against the local database and broadcast independently of the others,
+          * a transaction that fails to apply is reported in its result and does not affect the rest of the batch.
           */
-         void on_applied_block( const signed_block& b );
+         vector<broadcast_result> broadcast_transaction_batch( const vector<signed_transaction>& trxs );
+
+         void broadcast_block( const signed_block& block );
 
          /// internal method, not exposed via JSON RPC
          void on_api_startup();
       private:
-         boost::signals2::scoped_connection             _applied_block_connection;
-
-         map<transaction_id_type,confirmation_callback>     _callbacks;
-         map<time_point_sec, vector<transaction_id_type> >  _callbacks_expirations;
-
          application&                                   _app;
    };
 
@@ -192,8 +189,8 @@ namespace btcm { namespace app {
 
 }}  // btcm::app
 
-FC_REFLECT( btcm::app::network_broadcast_api::transaction_confirmation,
-        (id)(block_num)(trx_num)(expired) )
+FC_REFLECT( btcm::app::network_broadcast_api::broadcast_result,
+        (id)(accepted)(error) )
 //FC_REFLECT_TYPENAME( fc::ecc::compact_signature );
 //FC_REFLECT_TYPENAME( fc::ecc::commitment_type );
 
@@ -201,6 +198,7 @@ FC_API(btcm::app::network_broadcast_api,
        (broadcast_transaction)
        (broadcast_transaction_with_callback)
        (broadcast_transaction_synchronous)
+       (broadcast_transaction_batch)
        (broadcast_block)
      )
 FC_API(btcm::app::network_node_api,
@@ -8,11 +8,11 @@
 
 #include <fc/api.hpp>
 
-namespace fc { namespace rpc {
+namespace fc {
 
-class websocket_api_connection;
+class api_connection;
 
-} }
+}
 
 namespace btcm { namespace app {
 
@@ -25,7 +25,8 @@ class application;
 
 struct api_session_data
 {
-   std::shared_ptr< fc::rpc::websocket_api_connection >        wsc;
+   /// a fc::rpc::websocket_api_connection, or a fc::rpc::binary_api_connection on the binary endpoint
+   std::shared_ptr< fc::api_connection >                       wsc;
    std::map< std::string, fc::api_ptr >                        api_map;
 };
 
@@ -25,6 +25,7 @@
 
 #include <btcm/app/api_access.hpp>
 #include <btcm/app/api_context.hpp>
+#include <btcm/app/confirmation_tracker.hpp>
 #include <btcm/chain/database.hpp>
 
 #include <graphene/net/node.hpp>
@@ -80,6 +81,7 @@ namespace btcm { namespace app {
          graphene::net::node_ptr                    p2p_node();
          std::shared_ptr<chain::database> chain_database()const;
          std::shared_ptr<graphene::db::object_database> pending_trx_database() const;
+         std::shared_ptr<transaction_confirmation_tracker> confirmation_tracker() const;
 
          void set_block_production(bool producing_blocks);
          fc::optional< api_access_info > get_api_access_info( const string& username )const;
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <btcm/app/api.hpp>
+
+#include <fc/network/http/websocket.hpp>
+#include <fc/rpc/binary_api_connection.hpp>
+
+#include <memory>
+#include <string>
+
+namespace btcm { namespace app {
+
+   /**
+    * @brief Calls the APIs of a node on its rpc-binary-endpoint, with arguments and results packed by fc::raw
+    *
+    * The node registers its public APIs on the connection as on its JSON endpoints and logging in grants the
+    * same APIs, so a client that did
+    *
+    *    auto db = websocket_api_connection->get_remote_api< login_api >( 1 )->get_api_by_name( "database_api" )->as< database_api >();
+    *
+    * does
+    *
+    *    binary_api_client client;
+    *    client.connect( "ws://127.0.0.1:1030" );
+    *    client.login( user, password );
+    *    auto db = client.get_api< database_api >( "database_api" );
+    *
+    * The APIs are called like any other fc::api and block the calling fc task until the result arrives;
+    * callbacks are not supported by the binary protocol.
+    */
+   class binary_api_client
+   {
+      public:
+         /// @param login_api_id the id login_api has on the node's connections, its place in the public-api option
+         explicit binary_api_client( fc::api_id_type login_api_id = 1,
+                                     uint32_t max_depth = GRAPHENE_NET_MAX_NESTED_OBJECTS );
+         ~binary_api_client();
+
+         void connect( const std::string& uri );
+
+         /// @return false if the user is unknown or the password is wrong
+         bool login( const std::string& user, const std::string& password );
+
+         fc::api< login_api > get_login_api()const;
+
+         /// An API the session may call, by the name it was registered with, e.g. "database_api"
+         template< typename Api >
+         fc::api< Api > get_api( const std::string& api_name )const
+         {
+            return _connection->get_remote_api< Api >( get_login_api()->get_api_by_name( api_name ) );
+         }
+
+         const std::shared_ptr< fc::rpc::binary_api_connection >& connection()const { return _connection; }
+
+      private:
+         fc::api_id_type                                     _login_api_id;
+         uint32_t                                            _max_depth;
+         // the client closes the socket when it is destroyed, which the connection is told about
+         std::shared_ptr< fc::rpc::binary_api_connection >   _connection;
+         fc::http::websocket_client                          _client;
+         fc::http::websocket_connection_ptr                  _socket;
+   };
+
+} } // btcm::app
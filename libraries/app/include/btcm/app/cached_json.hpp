@@ -0,0 +1,84 @@
+#pragma once
+#include <fc/io/json_writer.hpp>
+#include <fc/io/raw_fwd.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace btcm { namespace app {
+
+   /**
+    *  An API result that keeps the JSON it is written as, so that a result returned again and again is
+    *  only serialized once.  API connections that write JSON directly (see fc::json_writer) copy the
+    *  stored text; everything else sees the value.
+    */
+   template< typename T >
+   class cached_json
+   {
+      public:
+         cached_json() : cached_json( T() ) {}
+         explicit cached_json( T v )
+         {
+            auto e = std::make_shared< entry >();
+            e->value = std::move( v );
+            e->json  = fc::to_json_string( e->value, format );
+            _entry = std::move( e );
+         }
+
+         const T&           value()const { return _entry->value; }
+         const std::string& json()const  { return _entry->json; }
+
+         /// the format of api connections writing JSON directly
+         static const fc::json::output_formatting format = fc::json::stringify_large_ints_and_doubles;
+
+      private:
+         struct entry
+         {
+            T           value;
+            std::string json;
+         };
+         std::shared_ptr< const entry > _entry;
+   };
+
+   template< typename T >
+   void to_json( const cached_json< T >& v, fc::json_writer& w, uint32_t max_depth )
+   {
+      if( w.format() == cached_json< T >::format )
+         w.buffer().append( v.json() );
+      else
+         fc::to_json( v.value(), w, max_depth );
+   }
+
+   /// the binary protocol packs the value, see fc::to_binary
+   template< typename T >
+   void to_binary( const cached_json< T >& v, std::vector< char >& result, uint32_t max_depth )
+   {
+      result = fc::raw::pack_to_vector( v.value(), max_depth );
+   }
+
+   template< typename T >
+   void from_binary( const std::vector< char >& packed, cached_json< T >& v, uint32_t max_depth )
+   {
+      v = cached_json< T >( fc::raw::unpack_from_vector< T >( packed, max_depth ) );
+   }
+
+} } // btcm::app
+
+namespace fc {
+
+   template< typename T >
+   void to_variant( const btcm::app::cached_json< T >& v, fc::variant& var, uint32_t max_depth )
+   {
+      to_variant( v.value(), var, max_depth );
+   }
+
+   template< typename T >
+   void from_variant( const fc::variant& var, btcm::app::cached_json< T >& v, uint32_t max_depth )
+   {
+      T value;
+      from_variant( var, value, max_depth );
+      v = btcm::app::cached_json< T >( std::move( value ) );
+   }
+
+} // fc
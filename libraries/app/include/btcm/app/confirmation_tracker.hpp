@@ -0,0 +1,75 @@
+#pragma once
+
+#include <btcm/chain/database.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+
+#include <functional>
+
+namespace btcm { namespace app {
+
+   struct transaction_confirmation
+   {
+      chain::transaction_id_type   id;
+      int32_t                      block_num;
+      int32_t                      trx_num;
+      bool                         expired;
+   };
+
+   /**
+    * @brief Tracks the transactions API clients are waiting for, on behalf of all API sessions
+    *
+    * The tracker is fed once per applied block from the ids of the transactions in the block, and drops
+    * expired entries in order of expiration.  Callbacks are never invoked from within the applied_block
+    * signal; all confirmations of a block are delivered together by a single asynchronous task.
+    */
+   class transaction_confirmation_tracker
+   {
+      public:
+         typedef std::function< void( const transaction_confirmation& ) > confirmation_callback;
+
+         explicit transaction_confirmation_tracker( chain::database& db );
+
+         /**
+          * Registers cb to be called when the transaction is included in a block, or with expired set once
+          * a block past the expiration of the transaction has been applied.  Several callbacks may be
+          * registered for the same transaction.
+          */
+         void track( const chain::transaction_id_type& trx_id, chain::time_point_sec expiration, confirmation_callback cb );
+
+         size_t size()const { return _tracked.size(); }
+
+      private:
+         void on_applied_block( const chain::signed_block& b );
+
+         struct tracked_transaction
+         {
+            chain::transaction_id_type   trx_id;
+            chain::time_point_sec        expiration;
+            confirmation_callback        callback;
+         };
+
+         struct by_trx_id;
+         struct by_expiration;
+         typedef boost::multi_index::multi_index_container<
+            tracked_transaction,
+            boost::multi_index::indexed_by<
+               boost::multi_index::hashed_non_unique< boost::multi_index::tag< by_trx_id >,
+                  boost::multi_index::member< tracked_transaction, chain::transaction_id_type, &tracked_transaction::trx_id >,
+                  std::hash< chain::transaction_id_type > >,
+               boost::multi_index::ordered_non_unique< boost::multi_index::tag< by_expiration >,
+                  boost::multi_index::member< tracked_transaction, chain::time_point_sec, &tracked_transaction::expiration > >
+            >
+         > tracked_transaction_index;
+
+         tracked_transaction_index            _tracked;
+         boost::signals2::scoped_connection   _applied_block_connection;
+   };
+
+} } // btcm::app
+
+FC_REFLECT( btcm::app::transaction_confirmation,
+        (id)(block_num)(trx_num)(expired) )
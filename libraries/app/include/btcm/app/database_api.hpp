@@ -1,5 +1,6 @@
 #pragma once
 #include <btcm/app/state.hpp>
+#include <btcm/app/cached_json.hpp>
 #include <btcm/chain/protocol/ext.hpp>
 #include <btcm/chain/protocol/types.hpp>
 
@@ -42,6 +43,32 @@ struct order_book
    vector< order >      bids;
 };
 
+/// All orders of one side of a market at the same price, see get_order_book_depth
+struct price_level
+{
+   price                order_price;
+   double               real_price; // dollars per btcm
+   share_type           base;
+   share_type           quote;
+   uint32_t             orders = 0;
+};
+
+struct order_book_depth
+{
+   string                  base = BTCM_SYMBOL_STRING;
+   string                  quote = XUSD_SYMBOL_STRING;
+   vector< price_level >   asks;
+   vector< price_level >   bids;
+};
+
+struct top_of_book
+{
+   string                  base = BTCM_SYMBOL_STRING;
+   string                  quote = XUSD_SYMBOL_STRING;
+   optional< price_level > ask;
+   optional< price_level > bid;
+};
+
 struct api_context;
 
 struct scheduled_hardfork
@@ -69,6 +96,22 @@ struct extended_balance : account_balance_object
    extended_balance(const account_balance_object& balance);
 };
 
+/**
+ *  A content_object together with the balances and counters kept in its content_stats_object
+ */
+struct extended_content : content_object
+{
+   asset               accumulated_balance_master;
+   asset               accumulated_balance_comp;
+   time_point_sec      last_played;
+   uint64_t            times_played = 0;
+   uint32_t            times_played_24 = 0;
+   content_vote_totals vote_totals;
+
+   extended_content() = default;
+   extended_content( const content_object& content, const content_stats_object& stats );
+};
+
 class database_api_impl;
 
 /**
@@ -119,7 +162,7 @@ class database_api
        * @return List of content, not more than 1000 entries
        * @ingroup db_api
        */
-      vector<content_object> get_content_by_uploader(string author)const;
+      vector<extended_content> get_content_by_uploader(string author)const;
       
       /****************
        * Get piece of content by its url
@@ -127,7 +170,7 @@ class database_api
        * @return Content object if content with given url has been found, empty otherwise
        * @ingroup db_api
        */
-      optional<content_object>    get_content_by_url(string url)const;
+      optional<extended_content>    get_content_by_url(string url)const;
 
       /****************
        * Lookup songs by title
@@ -136,7 +179,7 @@ class database_api
        * @return List of content, sorted by title
        * @ingroup db_api
        */
-      vector<content_object>  lookup_content(const string& start, uint32_t limit )const;
+      vector<extended_content>  lookup_content(const string& start, uint32_t limit )const;
 
       /****************
        * Lookup songs by descending publication (in BTCM!) time
@@ -145,7 +188,7 @@ class database_api
        * @return List of content, sorted by descending publication time
        * @ingroup db_api
        */
-      vector<content_object> list_content_by_latest( const string& bound, uint16_t limit )const;
+      vector<extended_content> list_content_by_latest( const string& bound, uint16_t limit )const;
 
       /****************
        * Lookup songs matching the given genre by descending publication (in BTCM!) time
@@ -155,7 +198,7 @@ class database_api
        * @return List of content, sorted by descending publication time
        * @ingroup db_api
        */
-      vector<content_object> list_content_by_genre( uint32_t genre, const string& bound, uint16_t limit )const;
+      vector<extended_content> list_content_by_genre( uint32_t genre, const string& bound, uint16_t limit )const;
 
       /****************
        * Lookup songs matching the given category (aka album_meta.album_type) by
@@ -166,7 +209,7 @@ class database_api
        * @return List of content, sorted by descending publication time
        * @ingroup db_api
        */
-      vector<content_object> list_content_by_category( const string& category, const string& bound, uint16_t limit )const;
+      vector<extended_content> list_content_by_category( const string& category, const string& bound, uint16_t limit )const;
 
       /****************
        * Lookup songs that were uploaded by the given account by descending
@@ -177,7 +220,7 @@ class database_api
        * @return List of content, sorted by descending publication time
        * @ingroup db_api
        */
-      vector<content_object> list_content_by_uploader( const string& uploader, const string& bound, uint16_t limit )const;
+      vector<extended_content> list_content_by_uploader( const string& uploader, const string& bound, uint16_t limit )const;
 
       /****************
        * Lookup User Issued Assets
@@ -235,6 +278,13 @@ class database_api
        */
 
       uint64_t get_content_scoring( string content );
+      /**
+       * Get the totals of the votes cast on the given content
+       * @param content Content to look for
+       * @return Vote count and weight sums, maintained as votes are cast, so votes that have been archived count
+       * @ingroup db_api
+       */
+      optional<content_vote_totals> get_content_vote_totals( string content )const;
 
       ///////////////////
       // Subscriptions //
@@ -464,6 +514,21 @@ class database_api
        * @return Order book
        */
       order_book get_order_book_for_assets( asset_id_type base_id, asset_id_type quote_id, uint32_t limit = 1000 )const;
+      /**
+       * Gets the current order book for the given market pair with the orders at the same price aggregated.
+       * The result is kept until an order of the market changes, so repeated calls are cheap.
+       * @param base_id first Asset ID to look for
+       * @param quote_id second asset ID to look for
+       * @param limit Maximum number of price levels for each side of the spread to return -- Must not exceed 1000
+       * @return Order book depth
+       */
+      cached_json< order_book_depth > get_order_book_depth( asset_id_type base_id, asset_id_type quote_id, uint32_t limit = 1000 )const;
+      /**
+       * Gets the best ask and bid of the given market pair, at a cost independent of the size of the order book
+       * @param base_id first Asset ID to look for
+       * @param quote_id second asset ID to look for
+       */
+      top_of_book get_top_of_book( asset_id_type base_id, asset_id_type quote_id )const;
       /**
        * Get open orders by the given account
        * @param owner Account opening the orders
@@ -560,11 +625,17 @@ class database_api
 
 FC_REFLECT( btcm::app::order, (order_price)(real_price)(base)(quote)(created) );
 FC_REFLECT( btcm::app::order_book, (base)(quote)(asks)(bids) );
+FC_REFLECT( btcm::app::price_level, (order_price)(real_price)(base)(quote)(orders) );
+FC_REFLECT( btcm::app::order_book_depth, (base)(quote)(asks)(bids) );
+FC_REFLECT( btcm::app::top_of_book, (base)(quote)(ask)(bid) );
 FC_REFLECT( btcm::app::scheduled_hardfork, (hf_version)(live_time) );
 FC_REFLECT( btcm::app::liquidity_balance, (account)(weight) );
 FC_REFLECT_DERIVED( btcm::app::extended_balance, (btcm::chain::account_balance_object),
                     (issuer)(symbol)(description)(precision)(current_supply)(max_supply) );
 
+FC_REFLECT_DERIVED( btcm::app::extended_content, (btcm::chain::content_object),
+                    (accumulated_balance_master)(accumulated_balance_comp)
+                    (last_played)(times_played)(times_played_24)(vote_totals) );
 FC_REFLECT( btcm::app::discussion_query, (tag)(filter_tags)(start_author)(start_permlink)(parent_author)(parent_permlink)(limit) );
 
 FC_API(btcm::app::database_api,
@@ -611,6 +682,8 @@ FC_API(btcm::app::database_api,
    (get_order_book)
    (get_order_book_for_asset)
    (get_order_book_for_assets)
+   (get_order_book_depth)
+   (get_top_of_book)
    (get_open_orders)
    (get_liquidity_queue)
 
@@ -646,6 +719,7 @@ FC_API(btcm::app::database_api,
    //score
    (get_account_scoring)
    (get_content_scoring)
+   (get_content_vote_totals)
    (get_balance_objects)
    (get_balance_objects_by_key)
 )
@@ -4,6 +4,8 @@
 
 #include <fc/uint128.hpp>
 
+#include <atomic>
+
 namespace btcm { namespace chain {
 
 
@@ -125,4 +127,72 @@ void account_member_index::object_modified( const object& after )
 
 
 
+void limit_order_depth_index::add_order( const limit_order_object& o )
+{
+   price_level& level = _sides[ std::make_pair( o.sell_price.base.asset_id, o.sell_price.quote.asset_id ) ][ o.sell_price ];
+   level.for_sale   += o.for_sale;
+   level.to_receive += o.amount_to_receive().amount;
+   ++level.orders;
+   changed( o );
+}
+
+void limit_order_depth_index::remove_order( const limit_order_object& o )
+{
+   auto side = _sides.find( std::make_pair( o.sell_price.base.asset_id, o.sell_price.quote.asset_id ) );
+   if( side == _sides.end() ) return;
+   auto level = side->second.find( o.sell_price );
+   if( level == side->second.end() ) return;
+
+   level->second.for_sale   -= o.for_sale;
+   level->second.to_receive -= o.amount_to_receive().amount;
+   if( --level->second.orders == 0 )
+      side->second.erase( level );
+   if( side->second.empty() )
+      _sides.erase( side );
+   changed( o );
+}
+
+void limit_order_depth_index::changed( const limit_order_object& o )
+{
+   static std::atomic< uint64_t > next_revision( 1 );
+   _revisions[ o.get_market() ] = next_revision++;
+}
+
+void limit_order_depth_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast< const limit_order_object* >( &obj ) ); // for debug only
+   add_order( static_cast< const limit_order_object& >( obj ) );
+}
+
+void limit_order_depth_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast< const limit_order_object* >( &obj ) ); // for debug only
+   remove_order( static_cast< const limit_order_object& >( obj ) );
+}
+
+void limit_order_depth_index::about_to_modify( const object& before )
+{
+   assert( dynamic_cast< const limit_order_object* >( &before ) ); // for debug only
+   remove_order( static_cast< const limit_order_object& >( before ) );
+}
+
+void limit_order_depth_index::object_modified( const object& after )
+{
+   assert( dynamic_cast< const limit_order_object* >( &after ) ); // for debug only
+   add_order( static_cast< const limit_order_object& >( after ) );
+}
+
+const limit_order_depth_index::side_type& limit_order_depth_index::get_side( asset_id_type sell, asset_id_type receive )const
+{
+   static const side_type empty;
+   auto side = _sides.find( std::make_pair( sell, receive ) );
+   return side == _sides.end() ? empty : side->second;
+}
+
+uint64_t limit_order_depth_index::get_revision( asset_id_type a, asset_id_type b )const
+{
+   auto itr = _revisions.find( a < b ? std::make_pair( a, b ) : std::make_pair( b, a ) );
+   return itr == _revisions.end() ? 0 : itr->second;
+}
+
 } } // btcm::chain
@@ -1,6 +1,11 @@
 #include <btcm/chain/block_database.hpp>
 #include <fc/io/raw.hpp>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace btcm { namespace chain {
 
 struct index_entry
@@ -14,23 +19,54 @@ FC_REFLECT( btcm::chain::index_entry, (block_pos)(block_size)(block_id) );
 
 namespace btcm { namespace chain {
 
+block_database::block_database() {}
+
+block_database::~block_database()
+{
+   try
+   {
+      close();
+   }
+   catch( const fc::exception& e )
+   {
+      elog( "Error while closing block database: ${e}", ("e", e.to_detail_string()) );
+   }
+   catch( const std::exception& e )
+   {
+      elog( "Error while closing block database: ${e}", ("e", e.what()) );
+   }
+}
+
+void block_database::set_write_options( const write_options& o )
+{
+   FC_ASSERT( o.max_batch > 0 && o.max_queued > 0 );
+   _options = o;
+}
+
 void block_database::open( const fc::path& dbdir )
 { try {
+   close();
    fc::create_directories(dbdir);
    _block_num_to_pos.exceptions(std::ios_base::failbit | std::ios_base::badbit);
    _blocks.exceptions(std::ios_base::failbit | std::ios_base::badbit);
 
    _index_filename = dbdir / "index";
+   _blocks_filename = dbdir / "blocks";
    if( !fc::exists( _index_filename ) )
    {
      _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
-     _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
+     _blocks.open( _blocks_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
    }
    else
    {
      _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
-     _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+     _blocks.open( _blocks_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
    }
+
+   _stopping = false;
+   _write_error = std::exception_ptr();
+   if( _options.async )
+      _writer = std::thread( [this]() { write_loop(); } );
 } FC_CAPTURE_AND_RETHROW( (dbdir) ) }
 
 bool block_database::is_open()const
@@ -40,16 +76,56 @@ bool block_database::is_open()const
 
 void block_database::close()
 {
-  _blocks.close();
-  _block_num_to_pos.close();
+  if( _writer.joinable() )
+  {
+     {
+        std::lock_guard< std::mutex > lock( _queue_mutex );
+        _stopping = true;
+     }
+     _queue_changed.notify_all();
+     _writer.join();
+  }
+
+  std::exception_ptr error;
+  {
+     std::lock_guard< std::mutex > lock( _queue_mutex );
+     error = _write_error;
+     _write_error = std::exception_ptr();
+     _queue.clear();
+     _pending.clear();
+     _in_flight = 0;
+  }
+
+  if( _blocks.is_open() )
+  {
+     _blocks.close();
+     _block_num_to_pos.close();
+  }
+  if( error )
+     std::rethrow_exception( error );
 }
 
 void block_database::flush()
 {
+  if( _writer.joinable() )
+  {
+     std::unique_lock< std::mutex > lock( _queue_mutex );
+     _queue_changed.wait( lock, [this]() { return ( _queue.empty() && _in_flight == 0 ) || _write_error; } );
+  }
+  check_write_error();
+
+  std::lock_guard< std::mutex > lock( _file_mutex );
   _blocks.flush();
   _block_num_to_pos.flush();
 }
 
+void block_database::check_write_error()
+{
+  std::lock_guard< std::mutex > lock( _queue_mutex );
+  if( _write_error )
+     std::rethrow_exception( _write_error );
+}
+
 void block_database::store( const block_id_type& _id, const signed_block& b )
 {
    block_id_type id = _id;
@@ -58,20 +134,138 @@ void block_database::store( const block_id_type& _id, const signed_block& b )
       id = b.id();
       elog( "id argument of block_database::store() was not initialized for block ${id}", ("id", id) );
    }
-   auto num = block_header::num_from_id(id);
+
+   pending_block p;
+   p.id   = id;
+   p.data = std::make_shared< const std::vector<char> >( fc::raw::pack_to_vector( b ) );
+
+   if( !_writer.joinable() )
+   {
+      std::lock_guard< std::mutex > lock( _file_mutex );
+      write_block( p );
+      if( _options.fsync )
+      {
+         _blocks.flush();
+         _block_num_to_pos.flush();
+         sync_files();
+      }
+      return;
+   }
+
+   {
+      std::unique_lock< std::mutex > lock( _queue_mutex );
+      _queue_changed.wait( lock, [this]() { return _queue.size() < _options.max_queued || _write_error; } );
+      if( _write_error )
+         std::rethrow_exception( _write_error );
+      p.sequence = _next_sequence++;
+      _pending[ block_header::num_from_id( id ) ] = p;
+      _queue.push_back( std::move( p ) );
+   }
+   _queue_changed.notify_all();
+}
+
+/// Appends the block and points its index entry at it, requires _file_mutex
+void block_database::write_block( const pending_block& b )
+{
+   auto num = block_header::num_from_id(b.id);
    _block_num_to_pos.seekp( sizeof( index_entry ) * num );
    index_entry e;
    _blocks.seekp( 0, _blocks.end );
-   auto vec = fc::raw::pack_to_vector( b );
    e.block_pos  = _blocks.tellp();
-   e.block_size = vec.size();
-   e.block_id   = id;
-   _blocks.write( vec.data(), vec.size() );
+   e.block_size = b.data->size();
+   e.block_id   = b.id;
+   _blocks.write( b.data->data(), b.data->size() );
    _block_num_to_pos.write( (char*)&e, sizeof(e) );
 }
 
+/**
+ *  Takes up to max_batch blocks off the queue at a time and appends them with a single flush (and sync, if
+ *  enabled) of both files.  A block stays visible in _pending until it has been written, unless it has
+ *  been superseded by a block with the same number stored after it.
+ */
+void block_database::write_loop()
+{
+   std::unique_lock< std::mutex > lock( _queue_mutex );
+   while( true )
+   {
+      _queue_changed.wait( lock, [this]() { return _stopping || !_queue.empty(); } );
+      if( _queue.empty() )
+         break;
+
+      std::vector< pending_block > batch;
+      while( !_queue.empty() && batch.size() < _options.max_batch )
+      {
+         batch.push_back( std::move( _queue.front() ) );
+         _queue.pop_front();
+      }
+      _in_flight = batch.size();
+      lock.unlock();
+      _queue_changed.notify_all();
+
+      std::exception_ptr error;
+      try
+      {
+         {
+            std::lock_guard< std::mutex > files( _file_mutex );
+            for( const pending_block& b : batch )
+               write_block( b );
+            _blocks.flush();
+            _block_num_to_pos.flush();
+         }
+         if( _options.fsync )
+            sync_files();
+      }
+      catch( ... )
+      {
+         error = std::current_exception();
+      }
+
+      lock.lock();
+      _in_flight = 0;
+      if( error )
+      {
+         // blocks that were not written stay in _pending; nothing else is written after a failed batch
+         _write_error = error;
+         _queue_changed.notify_all();
+         break;
+      }
+      for( const pending_block& b : batch )
+      {
+         auto itr = _pending.find( block_header::num_from_id( b.id ) );
+         if( itr != _pending.end() && itr->second.sequence == b.sequence )
+            _pending.erase( itr );
+      }
+      _queue_changed.notify_all();
+   }
+}
+
+void block_database::sync_files()
+{
+#ifndef _WIN32
+   for( const fc::path& file : { _blocks_filename, _index_filename } )
+   {
+      int fd = ::open( file.generic_string().c_str(), O_RDONLY );
+      FC_ASSERT( fd >= 0, "Unable to open ${f} for syncing", ("f", file) );
+      int result = ::fsync( fd );
+      ::close( fd );
+      FC_ASSERT( result == 0, "Unable to sync ${f}", ("f", file) );
+   }
+#endif
+}
+
+optional<block_database::pending_block> block_database::find_pending( uint32_t block_num )const
+{
+   std::lock_guard< std::mutex > lock( _queue_mutex );
+   auto itr = _pending.find( block_num );
+   if( itr == _pending.end() ) return optional<pending_block>();
+   return itr->second;
+}
+
 void block_database::remove( const block_id_type& id )
 { try {
+   flush();
+
+   std::lock_guard< std::mutex > lock( _file_mutex );
    index_entry e;
    auto index_pos = sizeof(e)*block_header::num_from_id(id);
    _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
@@ -94,6 +288,11 @@ bool block_database::contains( const block_id_type& id )const
    if( id == block_id_type() )
       return false;
 
+   optional<pending_block> p = find_pending( block_header::num_from_id(id) );
+   if( p.valid() )
+      return p->id == id;
+
+   std::lock_guard< std::mutex > lock( _file_mutex );
    index_entry e;
    auto index_pos = sizeof(e)*block_header::num_from_id(id);
    _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
@@ -108,6 +307,11 @@ bool block_database::contains( const block_id_type& id )const
 block_id_type block_database::fetch_block_id( uint32_t block_num )const
 {
    assert( block_num != 0 );
+   optional<pending_block> p = find_pending( block_num );
+   if( p.valid() )
+      return p->id;
+
+   std::lock_guard< std::mutex > lock( _file_mutex );
    index_entry e;
    auto index_pos = sizeof(e)*block_num;
    _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
@@ -125,6 +329,14 @@ optional<signed_block> block_database::fetch_optional( const block_id_type& id )
 {
    try
    {
+      optional<pending_block> p = find_pending( block_header::num_from_id(id) );
+      if( p.valid() )
+      {
+         if( p->id != id ) return optional<signed_block>();
+         return fc::raw::unpack_from_vector<signed_block>( *p->data );
+      }
+
+      std::lock_guard< std::mutex > lock( _file_mutex );
       index_entry e;
       auto index_pos = sizeof(e)*block_header::num_from_id(id);
       _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
@@ -157,6 +369,11 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
 {
    try
    {
+      optional<pending_block> p = find_pending( block_num );
+      if( p.valid() )
+         return fc::raw::unpack_from_vector<signed_block>( *p->data );
+
+      std::lock_guard< std::mutex > lock( _file_mutex );
       index_entry e;
       auto index_pos = sizeof(e)*block_num;
       _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
@@ -182,6 +399,7 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
    return optional<signed_block>();
 }
 
+/// Requires _file_mutex
 optional<index_entry> block_database::last_index_entry()const {
    try
    {
@@ -235,14 +453,38 @@ optional<index_entry> block_database::last_index_entry()const {
 
 optional<signed_block> block_database::last()const
 {
-   optional<index_entry> entry = last_index_entry();
+   optional<pending_block> p;
+   {
+      std::lock_guard< std::mutex > lock( _queue_mutex );
+      if( !_pending.empty() ) p = _pending.rbegin()->second;
+   }
+
+   optional<index_entry> entry;
+   {
+      std::lock_guard< std::mutex > lock( _file_mutex );
+      entry = last_index_entry();
+   }
+   if( p.valid() && ( !entry.valid() || block_header::num_from_id(p->id) >= block_header::num_from_id(entry->block_id) ) )
+      return fc::raw::unpack_from_vector<signed_block>( *p->data );
    if( entry.valid() ) return fetch_by_number( block_header::num_from_id(entry->block_id) );
    return optional<signed_block>();
 }
 
 optional<block_id_type> block_database::last_id()const
 {
-   optional<index_entry> entry = last_index_entry();
+   optional<pending_block> p;
+   {
+      std::lock_guard< std::mutex > lock( _queue_mutex );
+      if( !_pending.empty() ) p = _pending.rbegin()->second;
+   }
+
+   optional<index_entry> entry;
+   {
+      std::lock_guard< std::mutex > lock( _file_mutex );
+      entry = last_index_entry();
+   }
+   if( p.valid() && ( !entry.valid() || block_header::num_from_id(p->id) >= block_header::num_from_id(entry->block_id) ) )
+      return p->id;
    if( entry.valid() ) return entry->block_id;
    return optional<block_id_type>();
 }
@@ -278,7 +278,7 @@ void streaming_platform_report_evaluator::do_apply ( const streaming_platform_re
       sp.total_listening_time += o.play_time;
    });
 
-   db().modify< content_object >(content, [] (content_object &c){
+   db().modify( db().get_content_stats( content ), [] (content_stats_object &c){
         ++c.times_played;
         ++c.times_played_24;
    });
@@ -330,34 +330,10 @@ void friendship_evaluator::do_apply( const friendship_operation& o )
       return;
    if( a1.waiting.find( a2.id ) != a1.waiting.end() ) // approve friendship case
    {
-
-      for( auto a3id : a2.friends ) {
-         const auto &a3 = db().get<account_object>(a3id);
-         db().modify<account_object>(a3, [&](account_object &a) {
-              a.second_level.insert(a1.id);
-         });
-         db().recalculate_score(a3);
-      }
-      for( auto a3id : a1.friends ) {
-         const auto &a3 = db().get<account_object>(a3id);
-         db().modify<account_object>(a3, [&](account_object &a) {
-              a.second_level.insert(a2.id);
-         });
-         db().recalculate_score(a3);
-      }
       db().modify<account_object>( a1, [&]( account_object& a ){
            a.waiting.erase( a2.id );
-           a.friends.insert( a2.id );
-           a.second_level.insert( a2.friends.begin(), a2.friends.end() );
-           a.second_level.erase( a.id );
       });
-      db().recalculate_score(a1);
-      db().modify<account_object>( a2, [&]( account_object& a ){
-           a.friends.insert( a1.id );
-           a.second_level.insert( a1.friends.begin(), a1.friends.end() ); //TODO_BTCM: potentially replace with set_union
-           a.second_level.erase( a.id );
-      });
-      db().recalculate_score(a2);
+      db().add_friendship( a1, a2 );
       return;
    }
 
@@ -382,83 +358,8 @@ void unfriend_evaluator::do_apply( const unfriend_operation& o )
       });
       return;
    }
-   /*for( auto aid : a1.friends ){
-
-   }
-   db().modify<account_object>( a1, [&]( account_object& a ){
-        a.second_level.clear();
-        for(auto aid : a.friends)
-           a.second_level.insert( a2.friends.begin(), a2.friends.end() );
-        a.second_level.erase( a.id );
-   });*/
    if( a2.friends.find( a1.id ) != a2.friends.end() )
-   {
-      db().modify<account_object>( a2, [&]( account_object& a ) {
-           a.friends.erase( a1.id );
-           a.second_level.clear();
-      });
-      db().modify<account_object>( a1, [&]( account_object& a ) {
-           a.friends.erase( a2.id );
-           a.second_level.clear();
-      });
-      //rebuild second level lists
-      set<account_id_type> new_sl_list;
-      for( auto fid : a1.friends )
-      {
-         const auto& f = db().get<account_object>( fid );
-         new_sl_list.insert( f.friends.begin(), f.friends.end() );
-      }
-      new_sl_list.erase( a1.id );
-      db().modify<account_object>( a1, [&]( account_object& a ) {
-           a.second_level = new_sl_list;
-      });
-      new_sl_list.clear();
-      for( auto fid : a2.friends )
-      {
-         const auto& f = db().get<account_object>( fid );
-         new_sl_list.insert( f.friends.begin(), f.friends.end() );
-      }
-      new_sl_list.erase( a2.id );
-      db().modify<account_object>( a2, [&]( account_object& a ) {
-           a.second_level = new_sl_list;
-      });
-      db().recalculate_score(a1);
-      db().recalculate_score(a2);
-
-      //rebuild second level lists of all friends. this is expensive
-      for( auto aid : a1.friends )
-      {
-         const auto& f = db().get<account_object>( aid );
-         set<account_id_type> new_sl_list;
-         for( auto slid : f.friends )
-         {
-            const auto& sl = db().get<account_object>( slid );
-            new_sl_list.insert( sl.friends.begin(), sl.friends.end() );
-         }
-         new_sl_list.erase( aid );
-         db().modify<account_object>(f, [&](account_object& a) {
-              a.second_level.clear();
-              a.second_level = new_sl_list;
-         });
-         db().recalculate_score(f);
-      }
-      for( auto aid : a2.friends )
-      {
-         const auto& f = db().get<account_object>( aid );
-         set<account_id_type> new_sl_list;
-         for( auto slid : f.friends )
-         {
-            const auto& sl = db().get<account_object>( slid );
-            new_sl_list.insert( sl.friends.begin(), sl.friends.end() );
-         }
-         new_sl_list.erase( aid );
-         db().modify<account_object>(f, [&](account_object& a) {
-              a.second_level.clear();
-              a.second_level = new_sl_list;
-         });
-         db().recalculate_score(f);
-      }
-   }
+      db().remove_friendship( a1, a2 );
 }
 
 void content_evaluator::do_apply( const content_operation& o )
@@ -489,7 +390,7 @@ void content_evaluator::do_apply( const content_operation& o )
             db().get_account(m.voter); // ensure it exists
       }
 
-      db().create< content_object >( [&o,this]( content_object& con ) {
+      const auto& content = db().create< content_object >( [&o,this]( content_object& con ) {
            //validate_url
            con.uploader = o.uploader;
            con.url = o.url;
@@ -521,14 +422,18 @@ void content_evaluator::do_apply( const content_operation& o )
            }
            else
                con.publishers_share = 0;
-           con.accumulated_balance_master = asset(0);
-           con.accumulated_balance_comp = asset(0);
            con.created = db().head_block_time();
            con.last_update = con.created;
-           con.last_played = time_point_sec(0);
-           con.times_played = 0;
            con.playing_reward = o.playing_reward;
       });
+      const auto& stats = db().create< content_stats_object >( [&content]( content_stats_object& cs ) {
+           cs.content = content.id;
+           cs.accumulated_balance_master = asset(0);
+           cs.accumulated_balance_comp = asset(0);
+           cs.last_played = time_point_sec(0);
+           cs.times_played = 0;
+      });
+      FC_ASSERT( stats.id.instance() == content.id.instance(), "content stats out of step with content" );
    } FC_CAPTURE_AND_RETHROW( (o) ) }
 
 void content_update_evaluator::do_apply( const content_update_operation& o )
@@ -546,7 +451,8 @@ void content_update_evaluator::do_apply( const content_update_operation& o )
       for( const management_vote& m : o.new_management )
          db().get_account(m.voter); // just to ensure that m.voter account exists
 
-      asset accumulated_balances = (o.side==content_update_operation::side_t::master)?itr->accumulated_balance_master : itr->accumulated_balance_comp;
+      const auto& stats = db().get_content_stats( content );
+      asset accumulated_balances = (o.side==content_update_operation::side_t::master)?stats.accumulated_balance_master : stats.accumulated_balance_comp;
       db().modify< content_object >( *itr, [&o,this]( content_object& con ) {
            //the third_party_publishers flag cannot be changed. EVER.
            bool third_party_flag = con.comp_meta.third_party_publishers;
@@ -593,9 +499,9 @@ void content_update_evaluator::do_apply( const content_update_operation& o )
       });
       if( o.new_distributions.size() > 0 && accumulated_balances.amount > 0 ) {
          if( o.side == o.master )
-            db().pay_to_content_master( *itr, asset( 0, BTCM_SYMBOL ) );
+            db().pay_to_content_master( *itr, stats, asset( 0, BTCM_SYMBOL ) );
          else
-            db().pay_to_content_comp( *itr, asset( 0, BTCM_SYMBOL ) );
+            db().pay_to_content_comp( *itr, stats, asset( 0, BTCM_SYMBOL ) );
       }
    } FC_CAPTURE_AND_RETHROW( (o) ) }
 
@@ -676,21 +582,26 @@ void vote_evaluator::do_apply( const vote_operation& o )
          FC_ASSERT( !content.disabled );
          const auto weight = o.weight;
          if( weight > 0 ) FC_ASSERT( content.allow_votes );
-         const auto& content_vote_idx = db().get_index_type< content_vote_index >().indices().get< by_content_voter >();
-         auto itr = content_vote_idx.find( std::make_tuple( content.id, voter.id ) );
+         const content_vote_object* existing = db().find_content_vote( content.id, voter.id );
 
-         if( itr!=content_vote_idx.end() ) //vote already exists...
+         if( existing ) //vote already exists...
          {
-            FC_ASSERT( itr->num_changes < BTCM_MAX_VOTE_CHANGES, "Cannot change vote again" );
+            FC_ASSERT( existing->num_changes < BTCM_MAX_VOTE_CHANGES, "Cannot change vote again" );
 
-            FC_ASSERT( itr->weight != o.weight, "Changing your vote requires actually changing you vote." );
+            FC_ASSERT( existing->weight != o.weight, "Changing your vote requires actually changing you vote." );
 
-            db().modify( *itr, [weight,now]( content_vote_object& cv )
+            const auto old_weight = existing->weight;
+            db().modify( *existing, [weight,now]( content_vote_object& cv )
             {
                  cv.weight = weight;
                  cv.last_update = std::move(now);
                  cv.num_changes += 1;
             });
+            db().modify( db().get_content_stats( content ), [old_weight,weight]( content_stats_object& c )
+            {
+                 c.vote_totals.remove( old_weight );
+                 c.vote_totals.add( weight );
+            });
          }else{ //new vote...
             FC_ASSERT( weight != 0, "Weight cannot be 0");
             db().create<content_vote_object>( [&voter,&content,weight,now]( content_vote_object& cv ){
@@ -700,6 +611,10 @@ void vote_evaluator::do_apply( const vote_operation& o )
                  cv.last_update = std::move(now);
                  cv.num_changes = 0;
             });
+            db().modify( db().get_content_stats( content ), [weight]( content_stats_object& c )
+            {
+                 c.vote_totals.add( weight );
+            });
          }
       }
    } FC_CAPTURE_AND_RETHROW( (o)) }
@@ -0,0 +1,336 @@
+#include <btcm/chain/content_vote_archive.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/interprocess/file_mapping.hpp>
+#include <fc/log/logger.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace btcm { namespace chain {
+
+namespace detail {
+
+   /**
+    *  A segment file starts with a header followed by header.count records sorted by (content, voter).
+    *  A segment that was produced by merging lists the first sequence number it replaces; all segments
+    *  from first_sequence up to its own sequence number are superseded by it once it is known to be
+    *  consistent with the object database.
+    */
+   struct content_vote_segment_header
+   {
+      char     magic[8];
+      uint32_t version;
+      uint32_t block_num;
+      uint64_t first_sequence;
+      uint64_t count;
+   };
+   static_assert( sizeof(content_vote_segment_header) == 32, "segment header is stored as is" );
+
+   struct content_vote_segment_record
+   {
+      uint64_t content;
+      uint64_t voter;
+      uint32_t last_update;
+      int16_t  weight;
+      int8_t   num_changes;
+      int8_t   reserved;
+   };
+   static_assert( sizeof(content_vote_segment_record) == 24, "segment record is stored as is" );
+
+   bool operator < ( const content_vote_segment_record& a, const content_vote_segment_record& b )
+   {
+      return a.content < b.content || ( a.content == b.content && a.voter < b.voter );
+   }
+
+} // detail
+
+namespace {
+
+   using detail::content_vote_segment_header;
+   using detail::content_vote_segment_record;
+   typedef content_vote_segment_header segment_header;
+   typedef content_vote_segment_record segment_record;
+
+   const char     segment_magic[8] = { 'B', 'T', 'C', 'M', 'C', 'V', 'A', '\0' };
+   const uint32_t segment_version = 1;
+
+   segment_record to_record( const archived_content_vote& v )
+   {
+      segment_record r;
+      std::memset( &r, 0, sizeof(r) );
+      r.content     = v.content.instance.value;
+      r.voter       = v.voter.instance.value;
+      r.last_update = v.last_update.sec_since_epoch();
+      r.weight      = v.weight;
+      r.num_changes = v.num_changes;
+      return r;
+   }
+
+   archived_content_vote from_record( const segment_record& r )
+   {
+      archived_content_vote v;
+      v.content     = content_id_type( r.content );
+      v.voter       = account_id_type( r.voter );
+      v.last_update = time_point_sec( r.last_update );
+      v.weight      = r.weight;
+      v.num_changes = r.num_changes;
+      return v;
+   }
+
+   fc::path segment_file( const fc::path& dir, uint64_t sequence )
+   {
+      char name[32];
+      snprintf( name, sizeof(name), "%016llx.seg", (unsigned long long)sequence );
+      return dir / name;
+   }
+
+   bool parse_segment_file( const fc::path& file, uint64_t& sequence )
+   {
+      const std::string name = file.filename().generic_string();
+      if( name.size() != 20 || name.compare( 16, 4, ".seg" ) != 0 ) return false;
+      char* end = nullptr;
+      sequence = std::strtoull( name.substr( 0, 16 ).c_str(), &end, 16 );
+      return end && *end == '\0';
+   }
+
+   void write_segment_file( const fc::path& file, const segment_header& header, const segment_record* records )
+   {
+      const fc::path tmp = file.generic_string() + ".tmp";
+      {
+         std::ofstream out( tmp.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+         out.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+         out.write( (const char*)&header, sizeof(header) );
+         out.write( (const char*)records, header.count * sizeof(segment_record) );
+         out.flush();
+      }
+#ifndef _WIN32
+      // the segments a merged segment replaces are removed once it is written, it must not get lost in a crash
+      int fd = ::open( tmp.generic_string().c_str(), O_RDONLY );
+      FC_ASSERT( fd >= 0, "Unable to open ${f} for syncing", ("f", tmp) );
+      int result = ::fsync( fd );
+      ::close( fd );
+      FC_ASSERT( result == 0, "Unable to sync ${f}", ("f", tmp) );
+#endif
+      fc::rename( tmp, file );
+   }
+
+} // anonymous
+
+struct content_vote_archive::segment
+{
+   fc::path                          file;
+   uint64_t                          sequence = 0;
+   segment_header                    header;
+   std::unique_ptr<fc::file_mapping>  mapping;
+   std::unique_ptr<fc::mapped_region> region;
+
+   segment( const fc::path& f, uint64_t seq ) : file( f ), sequence( seq )
+   {
+      std::memset( &header, 0, sizeof(header) );
+   }
+
+   bool read_header()
+   {
+      if( fc::file_size( file ) < sizeof(header) ) return false;
+      std::ifstream in( file.generic_string().c_str(), std::ios::in | std::ios::binary );
+      in.read( (char*)&header, sizeof(header) );
+      return in && std::memcmp( header.magic, segment_magic, sizeof(segment_magic) ) == 0
+                && header.version == segment_version
+                && fc::file_size( file ) == sizeof(header) + header.count * sizeof(segment_record);
+   }
+
+   void map()
+   {
+      mapping.reset( new fc::file_mapping( file.generic_string().c_str(), fc::read_only ) );
+      region.reset( new fc::mapped_region( *mapping, fc::read_only, 0, fc::file_size( file ) ) );
+   }
+
+   const segment_record* begin()const
+   {
+      return (const segment_record*)( (const char*)region->get_address() + sizeof(segment_header) );
+   }
+
+   const segment_record* end()const { return begin() + header.count; }
+};
+
+content_vote_archive::content_vote_archive() {}
+
+content_vote_archive::~content_vote_archive() {}
+
+void content_vote_archive::open( const fc::path& dir, uint32_t head_block_num )
+{ try {
+   close();
+   _dir = dir;
+   fc::create_directories( _dir );
+
+   std::map< uint64_t, std::unique_ptr< segment > > found;
+   for( fc::directory_iterator itr( _dir ), end; itr != end; ++itr )
+   {
+      const fc::path file = *itr;
+      uint64_t sequence;
+      if( !parse_segment_file( file, sequence ) )
+      {
+         if( file.extension() == ".tmp" ) fc::remove( file );
+         continue;
+      }
+      _next_sequence = std::max( _next_sequence, sequence + 1 );
+      std::unique_ptr< segment > s( new segment( file, sequence ) );
+      if( !s->read_header() )
+      {
+         wlog( "Removing damaged content vote archive segment ${f}", ("f",file) );
+         fc::remove( file );
+      }
+      else if( s->header.block_num > head_block_num )
+      {
+         // written after the object database was last saved; its votes are still in the object database
+         fc::remove( file );
+      }
+      else
+         found[sequence] = std::move( s );
+   }
+
+   // a surviving merged segment supersedes the segments it was merged from
+   for( auto itr = found.rbegin(); itr != found.rend(); ++itr )
+   {
+      const segment& merged = *itr->second;
+      if( merged.header.first_sequence == merged.sequence ) continue;
+      auto superseded = found.lower_bound( merged.header.first_sequence );
+      while( superseded != found.end() && superseded->first < merged.sequence )
+      {
+         fc::remove( superseded->second->file );
+         superseded = found.erase( superseded );
+      }
+   }
+
+   for( auto& s : found )
+   {
+      s.second->map();
+      _segments.push_back( std::move( s.second ) );
+   }
+} FC_CAPTURE_AND_RETHROW( (dir)(head_block_num) ) }
+
+void content_vote_archive::close()
+{
+   // open() removes what is left of them
+   _superseded.clear();
+   _segments.clear();
+}
+
+void content_vote_archive::wipe( const fc::path& dir )
+{
+   close();
+   _next_sequence = 0;
+   fc::remove_all( dir );
+}
+
+uint64_t content_vote_archive::size()const
+{
+   uint64_t result = 0;
+   for( const auto& s : _segments )
+      result += s->header.count;
+   return result;
+}
+
+fc::optional< archived_content_vote > content_vote_archive::find( content_id_type content, account_id_type voter )const
+{
+   segment_record key;
+   key.content = content.instance.value;
+   key.voter   = voter.instance.value;
+   for( auto s = _segments.rbegin(); s != _segments.rend(); ++s )
+   {
+      const segment_record* itr = std::lower_bound( (*s)->begin(), (*s)->end(), key );
+      if( itr != (*s)->end() && itr->content == key.content && itr->voter == key.voter )
+         return from_record( *itr );
+   }
+   return fc::optional< archived_content_vote >();
+}
+
+void content_vote_archive::add( const std::vector< archived_content_vote >& votes, uint32_t head_block_num )
+{ try {
+   FC_ASSERT( !_dir.generic_string().empty(), "content vote archive is not open" );
+   if( votes.empty() ) return;
+
+   std::vector< segment_record > records;
+   records.reserve( votes.size() );
+   for( const auto& v : votes )
+   {
+      records.push_back( to_record( v ) );
+      FC_ASSERT( records.size() == 1 || records[records.size() - 2] < records.back(),
+                 "archived votes must be sorted by content and voter" );
+   }
+
+   segment_header header;
+   std::memcpy( header.magic, segment_magic, sizeof(segment_magic) );
+   header.version        = segment_version;
+   header.block_num      = head_block_num;
+   header.first_sequence = _next_sequence;
+   header.count          = records.size();
+   write_segment( header, records );
+
+   if( _segments.size() > max_segments )
+      merge_segments();
+} FC_CAPTURE_AND_RETHROW( (votes.size())(head_block_num) ) }
+
+void content_vote_archive::write_segment( const segment_header& header, const std::vector< segment_record >& records )
+{
+   const uint64_t sequence = _next_sequence++;
+   std::unique_ptr< segment > s( new segment( segment_file( _dir, sequence ), sequence ) );
+   s->header = header;
+   write_segment_file( s->file, header, records.data() );
+   s->map();
+   _segments.push_back( std::move( s ) );
+}
+
+/**
+ *  Merges all segments into one, keeping only the newest record of every vote.  The merged segments stay on
+ *  disk until remove_superseded() learns that the object database has been saved past the merged segment, or
+ *  until the next open(), which removes them unless the merged segment itself has to be discarded.
+ */
+void content_vote_archive::merge_segments()
+{
+   std::vector< segment_record > records;
+   records.reserve( size() );
+   for( auto s = _segments.rbegin(); s != _segments.rend(); ++s )
+      records.insert( records.end(), (*s)->begin(), (*s)->end() );
+   // stable, so the newest record of every vote comes first and survives unique()
+   std::stable_sort( records.begin(), records.end() );
+   records.erase( std::unique( records.begin(), records.end(),
+                               []( const segment_record& a, const segment_record& b ) {
+                                  return a.content == b.content && a.voter == b.voter;
+                               } ),
+                  records.end() );
+
+   segment_header header = _segments.back()->header;
+   header.first_sequence = _segments.front()->sequence;
+   header.count          = records.size();
+
+   std::vector< std::unique_ptr< segment > > merged;
+   merged.swap( _segments );
+   write_segment( header, records );
+   for( const auto& s : merged )
+      _superseded.emplace_back( header.block_num, s->file );
+}
+
+void content_vote_archive::remove_superseded( uint32_t flushed_block_num )
+{ try {
+   auto itr = _superseded.begin();
+   while( itr != _superseded.end() )
+   {
+      if( itr->first > flushed_block_num )
+      {
+         ++itr;
+         continue;
+      }
+      fc::remove( itr->second );
+      itr = _superseded.erase( itr );
+   }
+} FC_CAPTURE_AND_RETHROW( (flushed_block_num) ) }
+
+} } // btcm::chain
@@ -17,6 +17,7 @@
 
 #include <graphene/db/flat_index.hpp>
 
+#include <fc/scoped_exit.hpp>
 #include <fc/smart_ref_impl.hpp>
 #include <fc/uint128.hpp>
 
@@ -103,6 +104,7 @@ void database::open( const fc::path& data_dir, const genesis_state_type& initial
       if( wipe_object_db ) {
          ilog("Wiping object_database due to missing or wrong version");
          object_database::wipe( data_dir );
+         _content_vote_archive.wipe( data_dir / "content_vote_archive" );
          std::ofstream version_file( (data_dir / "db_version").generic_string().c_str(),
                                      std::ios::out | std::ios::binary | std::ios::trunc );
          version_file.write( db_version.c_str(), db_version.size() );
@@ -119,6 +121,8 @@ void database::open( const fc::path& data_dir, const genesis_state_type& initial
       if( !find(dynamic_global_property_id_type()) )
          init_genesis( initial_allocation );
 
+      _content_vote_archive.open( data_dir / "content_vote_archive", head_block_num() );
+
       init_hardforks();
 
       fc::optional<block_id_type> last_block = _block_id_to_block.last_id();
@@ -256,6 +260,7 @@ void database::wipe(const fc::path& data_dir, bool include_blocks)
      close();
    }
    object_database::wipe(data_dir);
+   _content_vote_archive.wipe( data_dir / "content_vote_archive" );
    if( include_blocks )
       fc::remove_all( data_dir / "database" );
 }
@@ -294,9 +299,11 @@ void database::close(bool rewind)
       // DB state (issue #336).
       clear_pending();
 
-      object_database::flush();
+      flush();
       object_database::close();
 
+      _content_vote_archive.close();
+
       if( _block_id_to_block.is_open() )
          _block_id_to_block.close();
 
@@ -307,6 +314,12 @@ void database::close(bool rewind)
    FC_CAPTURE_AND_RETHROW()
 }
 
+void database::flush()
+{ try {
+   object_database::flush();
+   _content_vote_archive.remove_superseded( head_block_num() );
+} FC_CAPTURE_AND_RETHROW() }
+
 bool database::is_known_block( const block_id_type& id )const
 {
    return _fork_db.is_known_block(id) || _block_id_to_block.contains(id);
@@ -319,6 +332,8 @@ bool database::is_known_block( const block_id_type& id )const
  */
 bool database::is_known_transaction( const transaction_id_type& id )const
 {
+   if( !_transaction_filter->may_contain( id ) )
+      return false;
    const auto& trx_idx = get_index_type<transaction_index>().indices().get<by_trx_id>();
    return trx_idx.find( id ) != trx_idx.end();
 }
@@ -350,12 +365,40 @@ optional<signed_block> database::fetch_block_by_number( uint32_t num )const
    return optional<signed_block>();
 }
 
-const signed_transaction& database::get_recent_transaction(const transaction_id_type& trx_id) const
+signed_transaction database::get_recent_transaction(const transaction_id_type& trx_id) const
 {
    auto& index = get_index_type<transaction_index>().indices().get<by_trx_id>();
    auto itr = index.find(trx_id);
    FC_ASSERT(itr != index.end());
-   return itr->trx;
+
+   for( const auto& trx : _pending_tx )
+      if( trx.id() == trx_id )
+         return trx;
+
+   const uint32_t block_num = _transaction_blocks->block_num( trx_id );
+   if( block_num != 0 )
+   {
+      const auto block = fetch_block_by_number( block_num );
+      if( block.valid() )
+         for( const auto& trx : block->transactions )
+            if( trx.id() == trx_id )
+               return trx;
+   }
+
+   // not applied by this process, a transaction can only have been included in a block at most BTCM_MAX_TIME_UNTIL_EXPIRATION before it expires
+   const time_point_sec earliest = itr->expiration - BTCM_MAX_TIME_UNTIL_EXPIRATION;
+   block_id_type id = head_block_id();
+   while( id != block_id_type() )
+   {
+      const auto block = fetch_block_by_id( id );
+      if( !block.valid() || block->timestamp < earliest )
+         break;
+      for( const auto& trx : block->transactions )
+         if( trx.id() == trx_id )
+            return trx;
+      id = block->previous;
+   }
+   FC_THROW( "Transaction ${trx_id} is neither pending nor in a block of its expiration window", ("trx_id",trx_id) );
 }
 
 std::vector<block_id_type> database::get_block_ids_on_fork(block_id_type head_of_fork) const
@@ -424,7 +467,7 @@ const limit_order_object& database::get_limit_order( const string& name, uint32_
 const witness_object& database::get_witness( const string& name ) const
 {
    const auto& witnesses_by_name = get_index_type< witness_index >().indices().get< by_name >();
-   auto itr = witnesses_by_name.find( name );
+   auto itr = witnesses_by_name.find( account_name_type( name ) );
    FC_ASSERT( itr != witnesses_by_name.end(),
               "Unable to find witness account '${wit}'. Did you forget to add a record for it?",
               ( "wit", name ) );
@@ -434,7 +477,7 @@ const witness_object& database::get_witness( const string& name ) const
 const witness_object* database::find_witness( const string& name ) const
 {
    const auto& witnesses_by_name = get_index_type< witness_index >().indices().get< by_name >();
-   auto itr = witnesses_by_name.find( name );
+   auto itr = witnesses_by_name.find( account_name_type( name ) );
    if( itr == witnesses_by_name.end() ) return nullptr;
    return &*itr;
 }
@@ -442,7 +485,7 @@ const witness_object* database::find_witness( const string& name ) const
 const streaming_platform_object& database::get_streaming_platform( const string& name ) const
 {
    const auto& streaming_platform_by_name = get_index_type< streaming_platform_index >().indices().get< by_name >();
-   auto itr = streaming_platform_by_name.find( name );
+   auto itr = streaming_platform_by_name.find( account_name_type( name ) );
    FC_ASSERT( itr != streaming_platform_by_name.end(),
               "Unable to find streaming_platform account '${wit}'. Did you forget to add a record for it?",
               ( "wit", name ) );
@@ -452,7 +495,7 @@ const streaming_platform_object& database::get_streaming_platform( const string&
 const streaming_platform_object* database::find_streaming_platform( const string& name ) const
 {
    const auto& streaming_platform_by_name = get_index_type< streaming_platform_index >().indices().get< by_name >();
-   auto itr = streaming_platform_by_name.find( name );
+   auto itr = streaming_platform_by_name.find( account_name_type( name ) );
    if( itr == streaming_platform_by_name.end() ) return nullptr;
    return &*itr;
 }
@@ -468,6 +511,75 @@ const content_object& database::get_content( const string& url )const
    FC_CAPTURE_AND_RETHROW((url))
 }
 
+const content_stats_object& database::get_content_stats( const content_object& content )const
+{
+   return get< content_stats_object >( content_stats_id_type( content.id.instance() ) );
+}
+
+const content_vote_object* database::find_content_vote( content_id_type content, account_id_type voter )
+{
+   const auto& content_vote_idx = get_index_type< content_vote_index >().indices().get< by_content_voter >();
+   auto itr = content_vote_idx.find( std::make_tuple( content, voter ) );
+   if( itr != content_vote_idx.end() )
+      return &*itr;
+
+   const auto archived = _content_vote_archive.find( content, voter );
+   if( !archived.valid() )
+      return nullptr;
+   return &create< content_vote_object >( [&archived]( content_vote_object& cv ) {
+      cv.voter       = archived->voter;
+      cv.content     = archived->content;
+      cv.weight      = archived->weight;
+      cv.num_changes = archived->num_changes;
+      cv.last_update = archived->last_update;
+   });
+}
+
+/**
+ *  A vote is settled when it has not changed for _content_vote_archive_age and its last change is in an
+ *  irreversible block.  Settled votes are written to a new archive segment in (content, voter) order and
+ *  removed from the content_vote_index; find_content_vote() brings them back when they are changed.
+ *
+ *  The archive is local to this node.  A restored vote gets a new object id, which is why nothing should
+ *  refer to content_vote_object ids.
+ */
+uint32_t database::archive_settled_content_votes()
+{ try {
+   const auto& dgp = get_dynamic_global_properties();
+   if( dgp.last_irreversible_block_num == 0 ) return 0;
+   const auto lib = fetch_block_by_number( dgp.last_irreversible_block_num );
+   if( !lib.valid() ) return 0;
+   const time_point_sec cutoff = std::min( head_block_time() - _content_vote_archive_age, lib->timestamp );
+
+   const auto& by_update = get_index_type< content_vote_index >().indices().get< by_reward_flag_update >();
+   auto end = by_update.upper_bound( std::make_tuple( false, cutoff ) );
+   vector< const content_vote_object* > settled;
+   for( auto itr = by_update.lower_bound( std::make_tuple( false ) ); itr != end; ++itr )
+      settled.push_back( &*itr );
+   if( settled.empty() ) return 0;
+
+   std::sort( settled.begin(), settled.end(), []( const content_vote_object* a, const content_vote_object* b ) {
+      return std::tie( a->content, a->voter ) < std::tie( b->content, b->voter );
+   });
+   vector< archived_content_vote > votes;
+   votes.reserve( settled.size() );
+   for( const auto* cv : settled )
+   {
+      archived_content_vote v;
+      v.content     = cv->content;
+      v.voter       = cv->voter;
+      v.weight      = cv->weight;
+      v.num_changes = cv->num_changes;
+      v.last_update = cv->last_update;
+      votes.push_back( v );
+   }
+   _content_vote_archive.add( votes, head_block_num() );
+
+   for( const auto* cv : settled )
+      remove( *cv );
+   return settled.size();
+} FC_CAPTURE_AND_RETHROW() }
+
 void database::pay_fee( const account_object& account, asset fee )
 {
    FC_ASSERT( fee.amount >= 0 ); /// NOTE if this fails then validate() on some operation is probably wrong
@@ -610,6 +722,7 @@ bool database::push_block(const signed_block& new_block, uint32_t skip)
 
 bool database::_push_block(const signed_block& new_block)
 {
+   scoped_serialization_cache< signed_block > cached_block( new_block );
    uint32_t skip = get_node_properties().skip_flags;
    if( !(skip&skip_fork_db) )
    {
@@ -621,9 +734,43 @@ bool database::_push_block(const signed_block& new_block)
          //Only switch forks if new_head is actually higher than head
          if( new_head->data.block_num() > head_block_num() )
          {
-            wlog( "Switching to fork: ${id}", ("id",new_head->data.id()) );
             auto branches = _fork_db.fetch_branch_from(new_head->data.id(), head_block_id());
 
+            // the blocks cached by the fork database until this one arrived may simply extend the current chain
+            if( branches.second.size() == 1 && branches.second.front()->id == head_block_id() )
+            {
+               branches.first.pop_back();
+               ilog( "Pushing ${n} blocks linked to the chain by block ${id}", ("n",branches.first.size())("id",new_block.id()) );
+               for( auto ritr = branches.first.rbegin(); ritr != branches.first.rend(); ++ritr )
+               {
+                  try
+                  {
+                     auto session = _undo_db.start_undo_session();
+                     apply_block( (*ritr)->data, skip );
+                     _block_id_to_block.store( (*ritr)->id, (*ritr)->data );
+                     session.commit();
+                  }
+                  catch( const fc::exception& e )
+                  {
+                     // the cached blocks built on top of an invalid block are invalid as well
+                     for( auto bad = ritr; bad != branches.first.rend(); ++bad )
+                        _fork_db.remove( (*bad)->id );
+                     _fork_db.set_head( ritr == branches.first.rbegin() ? branches.second.front() : *std::prev( ritr ) );
+                     if( (*ritr)->id == new_block.id() )
+                     {
+                        elog( "Failed to push new block:\n${e}", ("e", e.to_detail_string()) );
+                        throw;
+                     }
+                     wlog( "Dropping cached block #${n} ${id} that failed to apply: ${e}",
+                           ("n",(*ritr)->num)("id",(*ritr)->id)("e",e.to_detail_string()) );
+                     break;
+                  }
+               }
+               return false;
+            }
+
+            wlog( "Switching to fork: ${id}", ("id",new_head->data.id()) );
+
             // pop blocks until we hit the forked block
             while( head_block_id() != branches.second.back()->data.previous )
             {
@@ -716,7 +863,8 @@ void database::push_transaction( const signed_transaction& trx, uint32_t skip )
    {
       try
       {
-         FC_ASSERT( fc::raw::pack_size(trx) <= (get_dynamic_global_properties().maximum_block_size - 256) );
+         scoped_serialization_cache< signed_transaction > cached_trx( trx );
+         FC_ASSERT( trx.packed_size() <= (get_dynamic_global_properties().maximum_block_size - 256) );
          set_producing( true );
          detail::with_skip_flags( *this, skip, [&]() { _push_transaction( trx ); } );
          set_producing(false);
@@ -842,7 +990,8 @@ signed_block database::_generate_block(
       if( tx.expiration < when )
          continue;
 
-      uint64_t new_total_size = total_block_size + fc::raw::pack_size( tx );
+      scoped_serialization_cache< signed_transaction > cached_tx( tx );
+      uint64_t new_total_size = total_block_size + tx.packed_size();
 
       // postpone transaction if it would make block too big
       if( new_total_size >= maximum_block_size )
@@ -857,7 +1006,7 @@ signed_block database::_generate_block(
          _apply_transaction( tx );
          temp_session.merge();
 
-         total_block_size += fc::raw::pack_size( tx );
+         total_block_size += tx.packed_size();
          pending_block.transactions.push_back( tx );
       }
       catch ( const fc::exception& e )
@@ -888,7 +1037,7 @@ signed_block database::_generate_block(
    // TODO:  Move this to _push_block() so session is restored.
    if( !(skip & skip_block_size_check) )
    {
-      FC_ASSERT( fc::raw::pack_size(pending_block) <= BTCM_MAX_BLOCK_SIZE );
+      FC_ASSERT( pending_block.packed_size() <= BTCM_MAX_BLOCK_SIZE );
    }
 
    push_block( pending_block, skip );
@@ -1079,12 +1228,13 @@ bool database::is_voted_streaming_platform(string streaming_platform)const
    //this is simple version to check if given account has been voted in as streaming_platform AT THE MOMENT of check...
    //not sute yet if this can cause any issues, e.g. race condition. Test carefully. 
    int count =0;
+   const account_name_type owner( streaming_platform );
    const auto& spidx = get_index_type<streaming_platform_index>().indices().get<by_vote_name>();
    for ( auto itr = spidx.begin(); 
          itr != spidx.end() && count < BTCM_MAX_VOTED_STREAMING_PLATFORMS;
          ++itr, ++count )
    {
-      if (itr->owner.compare(streaming_platform) == 0)
+      if (itr->owner == owner)
          return true;
    }
    return false;
@@ -1093,12 +1243,13 @@ bool database::is_voted_streaming_platform(string streaming_platform)const
 bool database::is_streaming_platform(string streaming_platform)const
 {
    int count =0;
+   const account_name_type owner( streaming_platform );
    const auto& spidx = get_index_type<streaming_platform_index>().indices().get<by_vote_name>();
    for ( auto&& itr = spidx.begin();
          itr != spidx.end() && count < BTCM_MAX_VOTED_STREAMING_PLATFORMS;
          ++itr )
    {
-      if (itr->owner.compare(streaming_platform) == 0)
+      if (itr->owner == owner)
          return true;
       count++;
    }
@@ -1510,122 +1661,172 @@ void database::update_owner_authority( const account_object& account, const auth
 
 void database::process_vesting_withdrawals()
 {
-   const auto& widx = get_index_type< account_index >().indices().get< by_next_vesting_withdrawal >();
+   const auto& widx = get_index_type< vesting_withdrawal_index >().indices().get< by_next_vesting_withdrawal >();
    const auto& didx = get_index_type< withdraw_vesting_route_index >().indices().get< by_withdraw_route >();
-   auto current = widx.begin();
+   const auto now = head_block_time();
+
+   if( widx.empty() || widx.begin()->next_vesting_withdrawal > now )
+      return;
 
    const auto& cprops = get_dynamic_global_properties();
 
-   while( current != widx.end() && current->next_vesting_withdrawal <= head_block_time() )
+   /// the vesting fund is only read through the share price while paying out, so the totals are kept here and
+   /// written once; every payout is still converted at the price left by the ones before it
+   dynamic_global_property_object totals = cprops;
+
+   vector< account_id_type > due;
+   vector< pair< const withdraw_vesting_route_object*, const account_object* > > routes;
+
+   while( !widx.empty() && widx.begin()->next_vesting_withdrawal <= now )
    {
-      const auto& from_account = *current; ++current;
+      /// a batch of the accounts due at the same time, in the order of their ids; paying one out moves it one
+      /// interval later, past this batch
+      const auto due_time = widx.begin()->next_vesting_withdrawal;
+      due.clear();
+      for( auto itr = widx.begin(); itr != widx.end() && itr->next_vesting_withdrawal == due_time; ++itr )
+         due.push_back( itr->account );
+
+      for( const auto& from_id : due )
+      {
+         const auto& from_account = get( from_id );
 
-      /**
-      *  Let T = total tokens in vesting fund
-      *  Let V = total vesting shares
-      *  Let v = total vesting shares being cashed out
-      *
-      *  The user may withdraw  vT / V tokens
-      */
-      share_type to_withdraw;
-      if ( from_account.to_withdraw - from_account.withdrawn < from_account.vesting_withdraw_rate.amount )
-         to_withdraw = std::min( from_account.vesting_shares.amount, from_account.to_withdraw % from_account.vesting_withdraw_rate.amount ).value;
-      else
-         to_withdraw = std::min( from_account.vesting_shares.amount, from_account.vesting_withdraw_rate.amount ).value;
+         /**
+         *  Let T = total tokens in vesting fund
+         *  Let V = total vesting shares
+         *  Let v = total vesting shares being cashed out
+         *
+         *  The user may withdraw  vT / V tokens
+         */
+         share_type to_withdraw;
+         if ( from_account.to_withdraw - from_account.withdrawn < from_account.vesting_withdraw_rate.amount )
+            to_withdraw = std::min( from_account.vesting_shares.amount, from_account.to_withdraw % from_account.vesting_withdraw_rate.amount ).value;
+         else
+            to_withdraw = std::min( from_account.vesting_shares.amount, from_account.vesting_withdraw_rate.amount ).value;
 
-      share_type vests_deposited_as_btcm = 0;
-      share_type vests_deposited_as_vests = 0;
+         share_type vests_deposited_as_btcm = 0;
+         share_type vests_deposited_as_vests = 0;
 
-      // Do two passes, the first for vests, the second for btcm. Try to maintain as much accuracy for vests as possible.
-      for( auto itr = didx.upper_bound( boost::make_tuple( from_account.id, account_id_type() ) );
-           itr != didx.end() && itr->from_account == from_account.id;
-           ++itr )
-      {
-         if( itr->auto_vest )
-         {
-            share_type to_deposit = ( ( fc::uint128_t ( to_withdraw.value ) * itr->percent ) / BTCM_100_PERCENT ).to_uint64();
-            vests_deposited_as_vests += to_deposit;
+         routes.clear();
+         for( auto itr = didx.upper_bound( boost::make_tuple( from_account.id, account_id_type() ) );
+              itr != didx.end() && itr->from_account == from_account.id;
+              ++itr )
+            routes.emplace_back( &*itr, &itr->to_account( *this ) );
 
-            if( to_deposit > 0 )
+         // Do two passes, the first for vests, the second for btcm. Try to maintain as much accuracy for vests as possible.
+         for( const auto& r : routes )
+         {
+            if( r.first->auto_vest )
             {
-               const auto& to_account = itr->to_account( *this );
+               share_type to_deposit = ( ( fc::uint128_t ( to_withdraw.value ) * r.first->percent ) / BTCM_100_PERCENT ).to_uint64();
+               vests_deposited_as_vests += to_deposit;
 
-               modify( to_account, [&]( account_object& a )
+               if( to_deposit > 0 )
                {
-                  a.vesting_shares.amount += to_deposit;
-               });
+                  const auto& to_account = *r.second;
 
-               adjust_proxied_witness_votes( to_account, to_deposit );
-               recursive_recalculate_score( to_account, to_deposit);
-               push_applied_operation( fill_vesting_withdraw_operation( from_account.name, to_account.name, asset( to_deposit, VESTS_SYMBOL ), asset( to_deposit, VESTS_SYMBOL ) ) );
+                  modify( to_account, [&]( account_object& a )
+                  {
+                     a.vesting_shares.amount += to_deposit;
+                  });
+
+                  adjust_proxied_witness_votes( to_account, to_deposit );
+                  recursive_recalculate_score( to_account, to_deposit);
+                  push_applied_operation( fill_vesting_withdraw_operation( from_account.name, to_account.name, asset( to_deposit, VESTS_SYMBOL ), asset( to_deposit, VESTS_SYMBOL ) ) );
+               }
             }
          }
-      }
 
-      for( auto itr = didx.upper_bound( boost::make_tuple( from_account.id, account_id_type() ) );
-           itr != didx.end() && itr->from_account == from_account.id;
-           ++itr )
-      {
-         if( !itr->auto_vest )
+         for( const auto& r : routes )
          {
-            const auto& to_account = itr->to_account( *this );
+            if( !r.first->auto_vest )
+            {
+               const auto& to_account = *r.second;
 
-            share_type to_deposit = ( ( fc::uint128_t ( to_withdraw.value ) * itr->percent ) / BTCM_100_PERCENT ).to_uint64();
-            vests_deposited_as_btcm += to_deposit;
-            auto converted_btcm = asset( to_deposit, VESTS_SYMBOL ) * cprops.get_vesting_share_price();
+               share_type to_deposit = ( ( fc::uint128_t ( to_withdraw.value ) * r.first->percent ) / BTCM_100_PERCENT ).to_uint64();
+               vests_deposited_as_btcm += to_deposit;
+               auto converted_btcm = asset( to_deposit, VESTS_SYMBOL ) * totals.get_vesting_share_price();
 
-            if( to_deposit > 0 )
-            {
-               modify( to_account, [&]( account_object& a )
+               if( to_deposit > 0 )
                {
-                  a.balance += converted_btcm;
-               });
+                  modify( to_account, [&]( account_object& a )
+                  {
+                     a.balance += converted_btcm;
+                  });
 
-               modify( cprops, [&]( dynamic_global_property_object& o )
-               {
-                  o.total_vesting_fund_btcm -= converted_btcm;
-                  o.total_vesting_shares.amount -= to_deposit;
-               });
+                  totals.total_vesting_fund_btcm -= converted_btcm;
+                  totals.total_vesting_shares.amount -= to_deposit;
 
-               push_applied_operation( fill_vesting_withdraw_operation( from_account.name, to_account.name, asset( to_deposit, VESTS_SYMBOL), converted_btcm ) );
+                  push_applied_operation( fill_vesting_withdraw_operation( from_account.name, to_account.name, asset( to_deposit, VESTS_SYMBOL), converted_btcm ) );
+               }
             }
          }
-      }
 
-      share_type to_convert = to_withdraw - vests_deposited_as_btcm - vests_deposited_as_vests;
-      FC_ASSERT( to_convert >= 0, "Deposited more vests than were supposed to be withdrawn" );
+         share_type to_convert = to_withdraw - vests_deposited_as_btcm - vests_deposited_as_vests;
+         FC_ASSERT( to_convert >= 0, "Deposited more vests than were supposed to be withdrawn" );
 
-      auto converted_btcm = asset( to_convert, VESTS_SYMBOL ) * cprops.get_vesting_share_price();
+         auto converted_btcm = asset( to_convert, VESTS_SYMBOL ) * totals.get_vesting_share_price();
 
-      modify( from_account, [&]( account_object& a )
-      {
-         a.vesting_shares.amount -= to_withdraw;
-         a.balance += converted_btcm;
-         a.withdrawn += to_withdraw;
-
-         if( a.withdrawn >= a.to_withdraw || a.vesting_shares.amount == 0 )
-         {
-            a.vesting_withdraw_rate.amount = 0;
-            a.next_vesting_withdrawal = fc::time_point_sec::maximum();
-         }
-         else
+         modify( from_account, [&]( account_object& a )
          {
-            a.next_vesting_withdrawal += fc::seconds( BTCM_VESTING_WITHDRAW_INTERVAL_SECONDS );
-         }
-      });
+            a.vesting_shares.amount -= to_withdraw;
+            a.balance += converted_btcm;
+            a.withdrawn += to_withdraw;
 
-      modify( cprops, [&]( dynamic_global_property_object& o )
-      {
-         o.total_vesting_fund_btcm -= converted_btcm;
-         o.total_vesting_shares.amount -= to_convert;
-      });
+            if( a.withdrawn >= a.to_withdraw || a.vesting_shares.amount == 0 )
+            {
+               a.vesting_withdraw_rate.amount = 0;
+               a.next_vesting_withdrawal = fc::time_point_sec::maximum();
+            }
+            else
+            {
+               a.next_vesting_withdrawal += fc::seconds( BTCM_VESTING_WITHDRAW_INTERVAL_SECONDS );
+            }
+         });
+         update_vesting_withdrawal_schedule( from_account );
+
+         totals.total_vesting_fund_btcm -= converted_btcm;
+         totals.total_vesting_shares.amount -= to_convert;
 
-      if( to_withdraw > 0 ) {
-         adjust_proxied_witness_votes(from_account, -to_withdraw);
-         recursive_recalculate_score(from_account, -to_withdraw);
+         if( to_withdraw > 0 ) {
+            adjust_proxied_witness_votes(from_account, -to_withdraw);
+            recursive_recalculate_score(from_account, -to_withdraw);
+         }
+
+         push_applied_operation( fill_vesting_withdraw_operation( from_account.name, from_account.name, asset( to_convert, VESTS_SYMBOL ), converted_btcm ) );
       }
+   }
 
-      push_applied_operation( fill_vesting_withdraw_operation( from_account.name, from_account.name, asset( to_convert, VESTS_SYMBOL ), converted_btcm ) );
+   modify( cprops, [&]( dynamic_global_property_object& o )
+   {
+      o.total_vesting_fund_btcm = totals.total_vesting_fund_btcm;
+      o.total_vesting_shares = totals.total_vesting_shares;
+   });
+}
+
+void database::update_vesting_withdrawal_schedule( const account_object& a )
+{
+   const auto& idx = get_index_type< vesting_withdrawal_index >().indices().get< by_account >();
+   auto itr = idx.find( a.id );
+
+   if( a.next_vesting_withdrawal == fc::time_point_sec::maximum() )
+   {
+      if( itr != idx.end() )
+         remove( *itr );
+   }
+   else if( itr == idx.end() )
+   {
+      create< vesting_withdrawal_object >( [&]( vesting_withdrawal_object& w )
+      {
+         w.account = a.id;
+         w.next_vesting_withdrawal = a.next_vesting_withdrawal;
+      });
+   }
+   else if( itr->next_vesting_withdrawal != a.next_vesting_withdrawal )
+   {
+      modify( *itr, [&]( vesting_withdrawal_object& w )
+      {
+         w.next_vesting_withdrawal = a.next_vesting_withdrawal;
+      });
    }
 }
 
@@ -1878,18 +2079,18 @@ asset database::process_content_cashout( const asset& content_reward )
    return paid;
 } FC_LOG_AND_RETHROW() }
 
-void database::pay_to_content_master(const content_object &co, const asset& payout)
+void database::pay_to_content_master(const content_object &co, const content_stats_object& stats, const asset& payout)
 {try{
    if ( co.distributions_master.size() == 0)
    {
-      modify(co, [&payout]( content_object& c ){
+      modify(stats, [&payout]( content_stats_object& c ){
          c.accumulated_balance_master += payout;
       });
    }
    else
    {
       asset to_pay = payout;
-      to_pay += co.accumulated_balance_master;
+      to_pay += stats.accumulated_balance_master;
       asset total_paid = asset( 0, to_pay.asset_id );
       for ( const auto& di : co.distributions_master )
       {
@@ -1910,25 +2111,25 @@ void database::pay_to_content_master(const content_object &co, const asset& payo
          elog( "Paid out too much for content master ${co}: ${paid} > ${to_pay}",
                ("co",co)("paid",total_paid)("to_pay",to_pay) );
       to_pay -= total_paid;
-      if( co.accumulated_balance_master != to_pay )
-         modify(co, [&to_pay]( content_object& c ){
+      if( stats.accumulated_balance_master != to_pay )
+         modify(stats, [&to_pay]( content_stats_object& c ){
             c.accumulated_balance_master = to_pay;
          });
    }
 }FC_LOG_AND_RETHROW() }
 
-void database::pay_to_content_comp(const content_object &co, const asset& payout)
+void database::pay_to_content_comp(const content_object &co, const content_stats_object& stats, const asset& payout)
 {try{
    if ( co.distributions_comp.size() == 0)
    {
-      modify(co, [&payout]( content_object& c ){
+      modify(stats, [&payout]( content_stats_object& c ){
          c.accumulated_balance_comp += payout;
       });
    }
    else
    {
       asset to_pay = payout;
-      to_pay += co.accumulated_balance_comp;
+      to_pay += stats.accumulated_balance_comp;
       asset total_paid = asset( 0, to_pay.asset_id );
       for ( const auto& di : co.distributions_comp )
       {
@@ -1949,8 +2150,8 @@ void database::pay_to_content_comp(const content_object &co, const asset& payout
          elog( "Paid out too much for content composer ${co}: ${paid} > ${to_pay}",
                ("co",co)("paid",total_paid)("to_pay",to_pay) );
       to_pay -= total_paid;
-      if( co.accumulated_balance_comp != to_pay )
-         modify(co, [&to_pay]( content_object& c ){
+      if( stats.accumulated_balance_comp != to_pay )
+         modify(stats, [&to_pay]( content_stats_object& c ){
             c.accumulated_balance_comp = to_pay;
          });
    }
@@ -1978,12 +2179,13 @@ asset database::pay_to_content(const content_object& content, asset payout, stre
    comp_reward.amount = comp_reward.amount * content.publishers_share / BTCM_100_PERCENT;
    asset master_reward = payout - comp_reward;
 
-   pay_to_content_master(content, master_reward);
+   const content_stats_object& stats = get_content_stats( content );
+   pay_to_content_master(content, stats, master_reward);
    paid += master_reward;
-   pay_to_content_comp(content, comp_reward);
+   pay_to_content_comp(content, stats, comp_reward);
    paid += comp_reward;
 
-   modify<content_object>( content, []( content_object& c ) {
+   modify( stats, []( content_stats_object& c ) {
       --c.times_played_24;
    });
 
@@ -2180,6 +2382,18 @@ const dynamic_global_property_object&database::get_dynamic_global_properties() c
    return get( dynamic_global_property_id_type() );
 }
 
+void database::begin_global_property_buffering()
+{
+   _dgp_buffer.begin();
+   _feed_history_buffer.begin();
+}
+
+void database::end_global_property_buffering( bool notify )
+{
+   _dgp_buffer.end( *this, notify );
+   _feed_history_buffer.end( *this, notify );
+}
+
 const node_property_object& database::get_node_properties() const
 {
    return _node_property_object;
@@ -2276,8 +2490,9 @@ void database::initialize_indexes()
    //Protocol object indexes
    auto acnt_index = add_index< primary_index<account_index> >();
    acnt_index->add_secondary_index<account_member_index>();
+   acnt_index->enable_dense_lookup();
 
-   add_index< primary_index< streaming_platform_index > >();
+   add_index< primary_index< streaming_platform_index > >()->enable_dense_lookup();
    add_index< primary_index< stream_report_request_index > >();
    add_index< primary_index< report_index > >();
    add_index< primary_index< witness_index > >();
@@ -2286,16 +2501,20 @@ void database::initialize_indexes()
    add_index< primary_index< witness_vote_index > >();
    add_index< primary_index< convert_index > >();
    add_index< primary_index< liquidity_reward_index > >();
-   add_index< primary_index< limit_order_index > >();
+   add_index< primary_index< limit_order_index > >()->add_secondary_index<limit_order_depth_index>();
    add_index< primary_index< escrow_index > >();
    auto cti = add_index< primary_index< content_index > >();
    cti->add_secondary_index<content_by_genre_index>();
    cti->add_secondary_index<content_by_category_index>();
+   cti->enable_dense_lookup();
+   add_index< primary_index< content_stats_index > >()->enable_dense_lookup();
 
    add_index< primary_index< content_approve_index> >();
 
    //Implementation object indexes
-   add_index< primary_index< transaction_index                             > >();
+   auto trx_index = add_index< primary_index< transaction_index > >();
+   _transaction_filter = trx_index->add_secondary_index< transaction_id_filter >();
+   _transaction_blocks = trx_index->add_secondary_index< transaction_block_index >();
    add_index< primary_index< simple_index< dynamic_global_property_object  > > >();
    add_index< primary_index< simple_index< feed_history_object             > > >();
    add_index< primary_index< flat_index<   block_summary_object            > > >();
@@ -2315,6 +2534,24 @@ void database::initialize_indexes()
    add_index< primary_index< balance_index > >();
    add_index< primary_index< vesting_delegation_index > >();
    add_index< primary_index< vesting_delegation_expiration_index > >();
+   add_index< primary_index< friend_path_index > >();
+   add_index< primary_index< vesting_withdrawal_index > >();
+
+   initialize_expiration_queues();
+}
+
+void database::initialize_expiration_queues()
+{
+   // the queues are processed in the order they are added here
+   _expiration_queues.clear();
+   add_expiration_queue< transaction_expiration_index, transaction_index >( false,
+      [this]( const transaction_object& trx ) { remove( trx ); } );
+   add_expiration_queue< proposal_expiration_index, proposal_index >( true,
+      [this]( const proposal_object& proposal ) { expire_proposal( proposal ); } );
+   add_expiration_queue< limit_order_expiration_index, limit_order_index >( false,
+      [this]( const limit_order_object& order ) { cancel_order( order ); } );
+   add_expiration_queue< delegation_expiration_index, vesting_delegation_expiration_index >( false,
+      [this]( const vesting_delegation_expiration_object& delegation ) { return_expired_delegation( delegation ); } );
 }
 
 void database::init_genesis( const genesis_state_type& initial_allocation )
@@ -2560,6 +2797,7 @@ void database::notify_changed_objects()
 
 void database::apply_block( const signed_block& next_block, uint32_t skip )
 {
+   scoped_serialization_cache< signed_block > cached_block( next_block );
    auto block_num = next_block.block_num();
    if( _checkpoints.size() && _checkpoints.rbegin()->second != block_id_type() )
    {
@@ -2592,6 +2830,9 @@ void database::apply_block( const signed_block& next_block, uint32_t skip )
 void database::_apply_block( const signed_block& next_block )
 { try {
    uint32_t next_block_num = next_block.block_num();
+   _block_timings.reset( next_block_num );
+   block_phase_timer phase_timer( _block_timings, header_phase );
+
    uint32_t skip = get_node_properties().skip_flags;
 
    FC_ASSERT( (skip & skip_merkle_check) || next_block.transaction_merkle_root == next_block.calculate_merkle_root(), "mysterious place...", ("next_block.transaction_merkle_root",next_block.transaction_merkle_root)("calc",next_block.calculate_merkle_root())("next_block",next_block)("id",next_block.id()) );
@@ -2601,11 +2842,17 @@ void database::_apply_block( const signed_block& next_block )
    _current_block_num    = next_block_num;
    _current_trx_in_block = 0;
 
+   _applying_block = true;
+   auto applying_block = fc::make_scoped_exit( [this]() { _applying_block = false; } );
+   pre_apply_block( next_block );
+
    const auto& gprops = get_dynamic_global_properties();
-   auto block_size = fc::raw::pack_size( next_block );
+   auto block_size = next_block.packed_size();
    FC_ASSERT( block_size <= gprops.maximum_block_size, "Block Size is too Big", ("next_block_num",next_block_num)("block_size", block_size)("max",gprops.maximum_block_size) );
 
 
+   detail::global_property_buffer_scope buffered_properties( *this );
+
    /// modify current witness so transaction evaluators can know who included the transaction,
    /// this is mostly for POW operations which must pay the current_witness
    modify( gprops, [&]( dynamic_global_property_object& dgp ){
@@ -2618,6 +2865,7 @@ void database::_apply_block( const signed_block& next_block )
    FC_ASSERT( get_witness( next_block.witness ).running_version >= hardfork_property_id_type()( *this ).current_hardfork_version,
          "Block produced by witness that is not running current hardfork" );
 
+   phase_timer.next( transactions_phase );
    for( const auto& trx : next_block.transactions )
    {
       /* We do not need to push the undo state for each transaction
@@ -2630,18 +2878,21 @@ void database::_apply_block( const signed_block& next_block )
       ++_current_trx_in_block;
    }
 
+   phase_timer.next( dynamic_data_phase );
    update_global_dynamic_data(next_block);
    update_signing_witness(signing_witness, next_block);
 
    update_last_irreversible_block();
 
    create_block_summary(next_block);
-   clear_expired_transactions();
-   clear_expired_proposals();
-   clear_expired_orders();
-   clear_expired_delegations();
+
+   phase_timer.next( expiration_phase );
+   process_expirations();
+
+   phase_timer.next( witness_schedule_phase );
    update_witness_schedule();
 
+   phase_timer.next( supply_phase );
    update_median_feed();
    update_virtual_supply();
 
@@ -2649,21 +2900,36 @@ void database::_apply_block( const signed_block& next_block )
    const auto witness_pay = get_producer_reward();
    const auto vesting_reward = asset( 0, BTCM_SYMBOL );
 
+   phase_timer.next( funds_phase );
    process_funds( content_reward, witness_pay, vesting_reward );
    process_conversions();
+
+   phase_timer.next( cashout_phase );
    asset paid_for_content = process_content_cashout( content_reward );
    adjust_funds( content_reward, paid_for_content );
+
+   phase_timer.next( vesting_phase );
    process_vesting_withdrawals();
    update_virtual_supply();
 
+   phase_timer.next( maintenance_phase );
    account_recovery_processing();
 
+   if( _content_vote_archive_age > 0 && next_block_num % BTCM_BLOCKS_PER_HOUR == 0 )
+      archive_settled_content_votes();
+
    process_hardforks();
 
+   phase_timer.next( notify_phase );
+   buffered_properties.flush();
+
    // notify observers that the block has been applied
    applied_block( next_block ); //emit
 
    notify_changed_objects();
+
+   phase_timer.finish();
+   applied_block_timings( _block_timings ); //emit
 }
 FC_LOG_AND_RETHROW() }
 
@@ -2782,17 +3048,18 @@ void database::apply_transaction(const signed_transaction& trx, uint32_t skip)
 
 void database::_apply_transaction(const signed_transaction& trx)
 { try {
+   scoped_serialization_cache< signed_transaction > cached_trx( trx );
    _current_trx_id = trx.id();
    uint32_t skip = get_node_properties().skip_flags;
 
    if( !(skip&skip_validate) )   /* issue #505 explains why this skip_flag is disabled */
       trx.validate();
 
-   auto& trx_idx = get_mutable_index_type<transaction_index>();
+   detail::global_property_buffer_scope buffered_properties( *this );
+
    const chain_id_type& chain_id = BTCM_CHAIN_ID;
    auto trx_id = trx.id();
-   FC_ASSERT( (skip & skip_transaction_dupe_check) ||
-              trx_idx.indices().get<by_trx_id>().find(trx_id) == trx_idx.indices().get<by_trx_id>().end() );
+   FC_ASSERT( (skip & skip_transaction_dupe_check) || !is_known_transaction( trx_id ) );
    transaction_evaluation_state eval_state(this);
    eval_state._trx = &trx;
 
@@ -2809,7 +3076,7 @@ void database::_apply_transaction(const signed_transaction& trx)
    flat_set<string> required; vector<authority> other;
    flat_set<string> required_content;
    trx.get_required_authorities( required, required, required, required_content, required_content, other );
-   auto trx_size = fc::raw::pack_size(trx);
+   auto trx_size = trx.packed_size();
 
    for( const auto& auth : required ) {
       const auto& acnt = get_account(auth);
@@ -2850,8 +3117,12 @@ void database::_apply_transaction(const signed_transaction& trx)
    {
       create<transaction_object>([&](transaction_object& transaction) {
          transaction.trx_id = trx_id;
-         transaction.trx = trx;
+         transaction.expiration = trx.expiration;
       });
+      if( _transaction_filter->is_stale() )
+         _transaction_filter->rebuild( get_index_type< transaction_index >() );
+      if( is_applying_block() )
+         _transaction_blocks->set_block_num( trx_id, _current_block_num );
    }
 
    //Finally process the operations
@@ -2862,6 +3133,7 @@ void database::_apply_transaction(const signed_transaction& trx)
       ++_current_op_in_trx;
      } FC_CAPTURE_AND_RETHROW( (op) );
    }
+   buffered_properties.flush();
    _current_trx_id = transaction_id_type();
 
 } FC_CAPTURE_AND_RETHROW( (trx) ) }
@@ -2875,7 +3147,9 @@ void database::apply_operation(transaction_evaluation_state& eval_state, const o
    unique_ptr<op_evaluator>& eval = _operation_evaluators[ u_which ];
    FC_ASSERT( eval, "No registered evaluator for operation ${op}", ("op",op) );
    push_applied_operation( op );
+   const fc::time_point start = fc::time_point::now();
    eval->evaluate( eval_state, op, true );
+   _block_timings.add_operation( i_which, fc::time_point::now() - start );
    notify_post_apply_operation( op );
 } FC_CAPTURE_AND_RETHROW(  ) }
 
@@ -2912,7 +3186,7 @@ void database::create_block_summary(const signed_block& next_block)
 
 void database::update_global_dynamic_data( const signed_block& b )
 {
-   auto block_size = fc::raw::pack_size(b);
+   auto block_size = b.packed_size();
    const dynamic_global_property_object& _dgp =
       dynamic_global_property_id_type(0)(*this);
 
@@ -3120,26 +3394,148 @@ void database::update_last_irreversible_block()
 }
 
 
+/**
+ *  Matches the new order against the resting orders of the other side of its market, best price first.
+ *
+ *  The whole sweep is computed before the database is changed.  It is then applied with one modify or
+ *  remove per order and one balance adjustment per seller and asset, instead of a modify of the new order
+ *  and of a seller's balance for every resting order that is hit.  The fills and balance adjustments are
+ *  issued in the same order as matching the resting orders one at a time with match() would issue them,
+ *  so the resulting state, object ids and virtual operations are identical.
+ */
 bool database::apply_order( const limit_order_object& new_order_object )
 {
-   auto order_id = new_order_object.id;
-  
    const auto& limit_price_idx = get_index_type<limit_order_index>().indices().get<by_price>();
 
    auto max_price = ~new_order_object.sell_price;
    auto limit_itr = limit_price_idx.lower_bound(max_price.max());
    auto limit_end = limit_price_idx.upper_bound(max_price);
 
-   bool finished = false;
-   while( !finished && limit_itr != limit_end )
+   struct order_credit
    {
-      auto old_limit_itr = limit_itr;
+      const string* seller;
+      asset         amount;
+   };
+
+   vector< fill_order_operation >  fills;
+   vector< size_t >                fill_credits_end; ///< end of the credits of every fill
+   vector< order_credit >          credits;
+   vector< const limit_order_object* > removed;
+   const limit_order_object*       partial = nullptr;
+   share_type                      partial_for_sale;
+
+   const asset_id_type sell_asset = new_order_object.sell_price.base.asset_id;
+   share_type new_for_sale = new_order_object.for_sale;
+   bool new_order_removed = false;
+
+   while( !new_order_removed && limit_itr != limit_end )
+   {
+      const limit_order_object& old_order = *limit_itr;
       ++limit_itr;
-      // match returns 2 when only the old order was fully filled. In this case, we keep matching; otherwise, we stop.
-      finished = ( match(new_order_object, *old_limit_itr, old_limit_itr->sell_price) & 0x1 );
+      const price& match_price = old_order.sell_price;
+      assert( new_for_sale > 0 && old_order.for_sale > 0 );
+
+      // see match()
+      const asset new_order_for_sale( new_for_sale, sell_asset );
+      const asset old_order_for_sale = old_order.amount_for_sale();
+      asset new_order_receives, old_order_receives;
+      if( new_order_for_sale <= old_order_for_sale * match_price )
+      {
+         old_order_receives = new_order_for_sale;
+         new_order_receives = new_order_for_sale * match_price;
+      }
+      else
+      {
+         new_order_receives = old_order_for_sale;
+         old_order_receives = old_order_for_sale * match_price;
+      }
+      const asset old_order_pays = new_order_receives;
+      const asset new_order_pays = old_order_receives;
+      assert( new_order_pays == new_order_for_sale || old_order_pays == old_order_for_sale );
+
+      fills.emplace_back( new_order_object.seller, new_order_object.orderid, new_order_pays,
+                          old_order.seller, old_order.orderid, old_order_pays );
+
+      // see fill_order() and cancel_order()
+      credits.push_back( { &new_order_object.seller, new_order_receives } );
+      new_for_sale -= new_order_pays.amount;
+      if( new_for_sale == 0 )
+         new_order_removed = true;
+      else if( ( asset( new_for_sale, sell_asset ) * new_order_object.sell_price ).amount == 0 )
+      {
+         credits.push_back( { &new_order_object.seller, asset( new_for_sale, sell_asset ) } );
+         new_order_removed = true;
+      }
+
+      credits.push_back( { &old_order.seller, old_order_receives } );
+      if( old_order_pays == old_order_for_sale )
+         removed.push_back( &old_order );
+      else
+      {
+         const share_type old_for_sale = old_order.for_sale - old_order_pays.amount;
+         if( ( asset( old_for_sale, old_order_pays.asset_id ) * match_price ).amount == 0 )
+         {
+            credits.push_back( { &old_order.seller, asset( old_for_sale, old_order_pays.asset_id ) } );
+            removed.push_back( &old_order );
+         }
+         else
+         {
+            partial = &old_order;
+            partial_for_sale = old_for_sale;
+         }
+      }
+      fill_credits_end.push_back( credits.size() );
    }
-   
-   return find_object(order_id) == nullptr;
+
+   if( fills.empty() )
+      return false;
+
+   // every seller gets the total of its credits in an asset with the first credit that would have changed
+   // its balance: any credit of BTCM or XUSD, which may pay XUSD interest, and the first non zero one otherwise
+   flat_map< std::pair< string, asset_id_type >, share_type > totals;
+   for( const auto& c : credits )
+      totals[ std::make_pair( *c.seller, c.amount.asset_id ) ] += c.amount.amount;
+
+   flat_map< string, const account_object* > sellers;
+   size_t next_credit = 0;
+   for( size_t i = 0; i < fills.size(); ++i )
+   {
+      push_applied_operation( fills[i] );
+      for( ; next_credit < fill_credits_end[i]; ++next_credit )
+      {
+         const order_credit& c = credits[ next_credit ];
+         if( c.amount.amount == 0 && c.amount.asset_id != BTCM_SYMBOL && c.amount.asset_id != XUSD_SYMBOL )
+            continue;
+         auto total = totals.find( std::make_pair( *c.seller, c.amount.asset_id ) );
+         if( total == totals.end() )
+            continue; // credited already
+
+         auto seller = sellers.find( *c.seller );
+         if( seller == sellers.end() )
+            seller = sellers.emplace( *c.seller, &get_account( *c.seller ) ).first;
+         adjust_balance( *seller->second, asset( total->second, c.amount.asset_id ) );
+         totals.erase( total );
+      }
+   }
+
+   for( const limit_order_object* o : removed )
+      remove( *o );
+   if( partial != nullptr )
+      modify( *partial, [&]( limit_order_object& b )
+      {
+         b.for_sale = partial_for_sale;
+      } );
+
+   if( new_order_removed )
+   {
+      remove( new_order_object );
+      return true;
+   }
+   modify( new_order_object, [&]( limit_order_object& b )
+   {
+      b.for_sale = new_for_sale;
+   } );
+   return false;
 }
 
 int database::match( const limit_order_object& new_order, const limit_order_object& old_order, const price& match_price )
@@ -3232,71 +3628,58 @@ void database::cancel_order( const limit_order_object& order )
 }
 
 
-void database::clear_expired_transactions()
-{
-   //Look for expired transactions in the deduplication list, and remove them.
-   //Transactions must have expired by at least two forking windows in order to be removed.
-   auto& transaction_idx = static_cast<transaction_index&>(get_mutable_index(implementation_ids, impl_transaction_object_type));
-   const auto& dedupe_index = transaction_idx.indices().get<by_expiration>();
-   while( (!dedupe_index.empty()) && (head_block_time() > dedupe_index.begin()->trx.expiration) )
-      transaction_idx.remove(*dedupe_index.begin());
-}
-
-void database::clear_expired_orders()
+void database::process_expirations()
 {
-   auto now = head_block_time();
-   const auto& orders_by_exp = get_index_type<limit_order_index>().indices().get<by_expiration>();
-   auto itr = orders_by_exp.begin();
-   while( itr != orders_by_exp.end() && itr->expiration < now )
+   const auto now = head_block_time();
+   vector< object_id_type > due;
+   for( const auto& queue : _expiration_queues )
    {
-      cancel_order( *itr );
-      itr = orders_by_exp.begin();
+      const time_point_sec end = queue.at_expiration ? now + 1 : now;
+      while( queue.expirations->get_due( end, due ) )
+      {
+         for( const auto& id : due )
+         {
+            // expiring an object may remove others of the same second
+            const object* obj = queue.primary->find( id );
+            if( obj == nullptr )
+               continue;
+            queue.expire( *obj );
+            FC_ASSERT( queue.primary->find( id ) == nullptr, "Expired object was not removed", ("id",id) );
+         }
+      }
    }
 }
 
-void database::clear_expired_delegations()
+void database::return_expired_delegation( const vesting_delegation_expiration_object& delegation )
 {
-   const auto dgpo = get_dynamic_global_properties();
-   auto now = dgpo.time;
-   const auto& delegations_by_exp = get_index_type< vesting_delegation_expiration_index >().indices().get< by_expiration >();
-   auto itr = delegations_by_exp.begin();
-   while( itr != delegations_by_exp.end() && itr->expiration < now )
-   {
-      if( find_streaming_platform( itr->delegator ) )
-         modify( dgpo, [&itr]( dynamic_global_property_object& dgpo ) {
-            dgpo.total_vested_by_platforms += itr->vesting_shares.amount;
-         });
-
-      modify( get_account( itr->delegator ), [&]( account_object& a )
-      {
-         a.delegated_vesting_shares -= itr->vesting_shares;
+   if( find_streaming_platform( delegation.delegator ) )
+      modify( get_dynamic_global_properties(), [&]( dynamic_global_property_object& dgpo ) {
+         dgpo.total_vested_by_platforms += delegation.vesting_shares.amount;
       });
 
-      push_applied_operation( return_vesting_delegation_operation( itr->delegator, itr->vesting_shares ) );
+   modify( get_account( delegation.delegator ), [&]( account_object& a )
+   {
+      a.delegated_vesting_shares -= delegation.vesting_shares;
+   });
 
-      remove( *itr );
-      itr = delegations_by_exp.begin();
-   }
+   push_applied_operation( return_vesting_delegation_operation( delegation.delegator, delegation.vesting_shares ) );
+
+   remove( delegation );
 }
 
-void database::clear_expired_proposals()
+void database::expire_proposal( const proposal_object& proposal )
 {
-   const auto& proposal_expiration_index = get_index_type<proposal_index>().indices().get<by_expiration>();
-   while( !proposal_expiration_index.empty() && proposal_expiration_index.begin()->expiration_time <= head_block_time() )
-   {
-      const proposal_object& proposal = *proposal_expiration_index.begin();
-      try {
-         if( proposal.is_authorized_to_execute(*this) )
-         {
-            push_proposal(proposal);
-            continue;
-         }
-      } catch( const fc::exception& e ) {
-         ilog("Failed to apply proposed transaction on its expiration. Deleting it.\n${proposal}\n${error}",
-              ("proposal", proposal)("error", e.to_detail_string()));
+   try {
+      if( proposal.is_authorized_to_execute(*this) )
+      {
+         push_proposal(proposal);
+         return;
       }
-      remove(proposal);
+   } catch( const fc::exception& e ) {
+      ilog("Failed to apply proposed transaction on its expiration. Deleting it.\n${proposal}\n${error}",
+           ("proposal", proposal)("error", e.to_detail_string()));
    }
+   remove(proposal);
 }
 
 string database::to_pretty_string( const asset& a )const
@@ -3550,6 +3933,23 @@ void database::validate_invariants()const
                                   + itr->received_vesting_shares.amount;
       }
 
+      size_t total_second_level = 0;
+      for( const auto& a : account_idx )
+         total_second_level += a.second_level.size();
+      const auto& friend_path_idx = get_index_type< friend_path_index >().indices();
+      for( const auto& p : friend_path_idx )
+         FC_ASSERT( p.paths > 0 && get( p.account ).second_level.count( p.second ), "", ("path",p) );
+      FC_ASSERT( friend_path_idx.size() == total_second_level );
+
+      size_t powering_down = 0;
+      for( const auto& a : account_idx )
+         if( a.next_vesting_withdrawal != fc::time_point_sec::maximum() )
+            ++powering_down;
+      const auto& withdrawal_idx = get_index_type< vesting_withdrawal_index >().indices();
+      for( const auto& w : withdrawal_idx )
+         FC_ASSERT( get( w.account ).next_vesting_withdrawal == w.next_vesting_withdrawal, "", ("withdrawal",w) );
+      FC_ASSERT( withdrawal_idx.size() == powering_down );
+
       const auto& convert_request_idx = get_index_type< convert_index >().indices();
 
       for( auto itr = convert_request_idx.begin(); itr != convert_request_idx.end(); ++itr )
@@ -3580,8 +3980,8 @@ void database::validate_invariants()const
       for( auto itr = balances.begin(); itr != balances.end(); itr++ )
          total_supply += itr->balance;
 
-      const auto& content_idx = get_index_type< content_index >().indices();
-      for( auto itr = content_idx.begin(); itr != content_idx.end(); itr++ )
+      const auto& content_stats_idx = get_index_type< content_stats_index >().indices();
+      for( auto itr = content_stats_idx.begin(); itr != content_stats_idx.end(); itr++ )
       {
          total_supply += itr->accumulated_balance_master;
          total_supply += itr->accumulated_balance_comp;
@@ -3744,6 +4144,93 @@ void database::recalculate_score(const account_object& a) {
    });
 };
 
+void database::add_friendship( const account_object& a1, const account_object& a2 )
+{ try {
+   FC_ASSERT( a1.id != a2.id );
+   FC_ASSERT( a1.friends.find( a2.id ) == a1.friends.end(), "Accounts are already friends" );
+
+   adjust_friend_paths( a1, a2, true );
+   adjust_friend_paths( a2, a1, true );
+
+   modify( a1, [&]( account_object& a ) { a.friends.insert( a2.id ); } );
+   modify( a2, [&]( account_object& a ) { a.friends.insert( a1.id ); } );
+
+   recalculate_friendship_scores( a1, a2 );
+} FC_CAPTURE_AND_RETHROW( (a1.name)(a2.name) ) }
+
+void database::remove_friendship( const account_object& a1, const account_object& a2 )
+{ try {
+   FC_ASSERT( a1.friends.find( a2.id ) != a1.friends.end(), "Accounts are not friends" );
+
+   modify( a1, [&]( account_object& a ) { a.friends.erase( a2.id ); } );
+   modify( a2, [&]( account_object& a ) { a.friends.erase( a1.id ); } );
+
+   adjust_friend_paths( a1, a2, false );
+   adjust_friend_paths( a2, a1, false );
+
+   recalculate_friendship_scores( a1, a2 );
+} FC_CAPTURE_AND_RETHROW( (a1.name)(a2.name) ) }
+
+/**
+ * Recalculates the scores of a1, a2 and of all of their friends.  This is the set the friendship and unfriend
+ * evaluators recalculated before second levels were maintained incrementally; it includes every account whose
+ * second level can have changed.
+ */
+void database::recalculate_friendship_scores( const account_object& a1, const account_object& a2 )
+{
+   flat_set< account_id_type > accounts{ a1.id, a2.id };
+   accounts.insert( a1.friends.begin(), a1.friends.end() );
+   accounts.insert( a2.friends.begin(), a2.friends.end() );
+   for( const auto& id : accounts )
+      recalculate_score( get( id ) );
+}
+
+/**
+ * Adjusts the paths that run over the edge a -> b, i.e. a -> b -> f and f -> b -> a for every other friend f
+ * of b.  Must be called while a and b are not friends of each other.
+ */
+void database::adjust_friend_paths( const account_object& a, const account_object& b, bool add )
+{
+   for( const auto& f : b.friends )
+   {
+      adjust_friend_path( a.id, f, add );
+      adjust_friend_path( f, a.id, add );
+   }
+}
+
+void database::adjust_friend_path( account_id_type account, account_id_type second, bool add )
+{
+   const auto& path_idx = get_index_type< friend_path_index >().indices().get< by_account_second >();
+   auto itr = path_idx.find( boost::make_tuple( account, second ) );
+
+   if( add )
+   {
+      if( itr != path_idx.end() )
+      {
+         modify( *itr, []( friend_path_object& p ) { ++p.paths; } );
+         return;
+      }
+      create< friend_path_object >( [&]( friend_path_object& p )
+      {
+         p.account = account;
+         p.second = second;
+         p.paths = 1;
+      });
+      modify( get( account ), [&]( account_object& a ) { a.second_level.insert( second ); } );
+   }
+   else
+   {
+      FC_ASSERT( itr != path_idx.end(), "Missing friend path", ("account",account)("second",second) );
+      if( itr->paths > 1 )
+      {
+         modify( *itr, []( friend_path_object& p ) { --p.paths; } );
+         return;
+      }
+      remove( *itr );
+      modify( get( account ), [&]( account_object& a ) { a.second_level.erase( second ); } );
+   }
+}
+
 namespace detail {
 uint32_t isqrt(uint64_t a) {
    uint64_t rem = 0;
@@ -9,6 +9,7 @@ void fork_database::reset()
 {
    _head.reset();
    _index.clear();
+   _unlinked_index.clear();
 }
 
 void fork_database::pop_block()
@@ -27,8 +28,12 @@ void     fork_database::start_block(signed_block b)
 }
 
 /**
- * Pushes the block into the fork database and caches it if it doesn't link
+ * Pushes the block into the fork database and caches it if it doesn't link.  A cached block, and
+ * everything cached on top of it, is linked as soon as its parent is pushed.
  *
+ * @throws block_buffered_exception if the block was cached
+ * @throws unlinkable_block_exception if the block does not link and is too far ahead of the head
+ *         block to be cached
  */
 shared_ptr<fork_item>  fork_database::push_block(const signed_block& b)
 {
@@ -38,11 +43,23 @@ shared_ptr<fork_item>  fork_database::push_block(const signed_block& b)
    }
    catch ( const unlinkable_block_exception& e )
    {
-      wlog( "Pushing block to fork database that failed to link: ${id}, ${num}", ("id",b.id())("num",b.block_num()) );
-      wlog( "Head: ${num}, ${id}", ("num",_head->data.block_num())("id",_head->data.id()) );
-      throw;
+      BTCM_ASSERT( item->num <= _head->num + MAX_BLOCK_REORDERING, unlinkable_block_exception,
+                   "block is too far ahead of the head block to be cached",
+                   ("num",item->num)("head",_head->num) );
+
       _unlinked_index.insert( item );
+      // when the cache is full, drop the blocks that are the furthest from linking
+      auto& by_num_idx = _unlinked_index.get<block_num>();
+      while( by_num_idx.size() > MAX_BLOCK_REORDERING )
+         by_num_idx.erase( std::prev( by_num_idx.end() ) );
+      BTCM_ASSERT( is_known_block( item->id ), unlinkable_block_exception,
+                   "unlinked block cache is full", ("num",item->num)("head",_head->num) );
+
+      dlog( "Caching block ${num} ${id} until its ancestors arrive", ("id",item->id)("num",item->num) );
+      FC_THROW_EXCEPTION( block_buffered_exception, "block ${num} does not link to known chain yet",
+                          ("num",item->num)("id",item->id)("head",_head->num) );
    }
+   _push_next( item );
    return _head;
 }
 
@@ -80,22 +97,38 @@ void  fork_database::_push_block(const item_ptr& item)
 
 /**
  *  Iterate through the unlinked cache and insert anything that
- *  links to the newly inserted item.  This will start a recursive
- *  set of calls performing a depth-first insertion of pending blocks as
- *  _push_next(..) calls _push_block(...) which will in turn call _push_next
+ *  links to the newly inserted item, and then anything that links to those,
+ *  depth first.  Cached blocks that fail to insert are dropped.
  */
 void fork_database::_push_next( const item_ptr& new_item )
 {
     auto& prev_idx = _unlinked_index.get<by_previous>();
+    if( prev_idx.empty() )
+       return;
 
-    auto itr = prev_idx.find( new_item->id );
-    while( itr != prev_idx.end() )
+    vector<item_ptr> linked{ new_item };
+    while( !linked.empty() )
     {
-       auto tmp = *itr;
-       prev_idx.erase( itr );
-       _push_block( tmp );
+       const item_ptr parent = linked.back();
+       linked.pop_back();
+
+       auto itr = prev_idx.find( parent->id );
+       while( itr != prev_idx.end() )
+       {
+          auto tmp = *itr;
+          prev_idx.erase( itr );
+          try
+          {
+             _push_block( tmp );
+             linked.push_back( tmp );
+          }
+          catch( const fc::exception& e )
+          {
+             wlog( "Dropping cached block ${num} ${id}: ${e}", ("num",tmp->num)("id",tmp->id)("e",e.to_detail_string()) );
+          }
 
-       itr = prev_idx.find( new_item->id );
+          itr = prev_idx.find( parent->id );
+       }
     }
 }
 
@@ -221,6 +254,7 @@ void fork_database::set_head(shared_ptr<fork_item> h)
 void fork_database::remove(block_id_type id)
 {
    _index.get<block_id>().erase(id);
+   _unlinked_index.get<block_id>().erase(id);
 }
 
 } } // btcm::chain
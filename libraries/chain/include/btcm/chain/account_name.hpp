@@ -0,0 +1,42 @@
+#pragma once
+#include <btcm/chain/config.hpp>
+
+#include <fc/fixed_string.hpp>
+
+#include <cstring>
+#include <ostream>
+
+namespace btcm { namespace chain {
+
+   /**
+    * Storage of an account_name_type: the name zero padded to BTCM_MAX_ACCOUNT_NAME_LENGTH characters.
+    * Comparing the padded bytes orders names exactly like std::string does.
+    */
+   struct account_name_storage
+   {
+      char bytes[BTCM_MAX_ACCOUNT_NAME_LENGTH] = {};
+
+      friend bool operator <  ( const account_name_storage& a, const account_name_storage& b ) { return std::memcmp( a.bytes, b.bytes, sizeof(a.bytes) ) <  0; }
+      friend bool operator <= ( const account_name_storage& a, const account_name_storage& b ) { return std::memcmp( a.bytes, b.bytes, sizeof(a.bytes) ) <= 0; }
+      friend bool operator >  ( const account_name_storage& a, const account_name_storage& b ) { return std::memcmp( a.bytes, b.bytes, sizeof(a.bytes) ) >  0; }
+      friend bool operator >= ( const account_name_storage& a, const account_name_storage& b ) { return std::memcmp( a.bytes, b.bytes, sizeof(a.bytes) ) >= 0; }
+      friend bool operator == ( const account_name_storage& a, const account_name_storage& b ) { return std::memcmp( a.bytes, b.bytes, sizeof(a.bytes) ) == 0; }
+      friend bool operator != ( const account_name_storage& a, const account_name_storage& b ) { return std::memcmp( a.bytes, b.bytes, sizeof(a.bytes) ) != 0; }
+   };
+
+   /**
+    * Fixed width in-memory representation of an account name.
+    *
+    * Chain and plugin objects that refer to accounts by name hold them in this type instead of a heap
+    * allocated std::string, so copying an object never allocates for its names and the ordered indexes
+    * keyed on them compare a fixed number of bytes.  The raw and variant serializations are identical
+    * to those of std::string, so the protocol, the API and the object database formats are unchanged.
+    */
+   typedef fc::fixed_string< account_name_storage > account_name_type;
+
+   inline std::ostream& operator << ( std::ostream& out, const account_name_type& name )
+   {
+      return out << std::string( name );
+   }
+
+} } // btcm::chain
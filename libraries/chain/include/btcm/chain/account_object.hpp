@@ -7,6 +7,7 @@
 #include <btcm/chain/streaming_platform_objects.hpp>
   
 #include <graphene/db/generic_index.hpp>
+#include <graphene/db/expiration_index.hpp>
 
 #include <boost/multi_index/composite_key.hpp>
 
@@ -196,8 +197,8 @@ namespace btcm { namespace chain {
          static const uint8_t space_id = implementation_ids;
          static const uint8_t type_id  = impl_vesting_delegation_object_type;
 
-         string            delegator;
-         string            delegatee;
+         account_name_type delegator;
+         account_name_type delegatee;
          asset             vesting_shares;
          time_point_sec    min_delegation_time;
    };
@@ -208,7 +209,7 @@ namespace btcm { namespace chain {
          static const uint8_t space_id = implementation_ids;
          static const uint8_t type_id  = impl_vesting_delegation_expiration_object_type;
 
-         string            delegator;
+         account_name_type delegator;
          asset             vesting_shares;
          time_point_sec    expiration;
    };
@@ -252,6 +253,46 @@ namespace btcm { namespace chain {
          change_recovery_account_request_id_type get_id()const { return id; }
    };
 
+   /**
+    *  @brief Counts the paths account -> friend -> second
+    *
+    *  There is one object for every pair of accounts connected through at least one common friend, and
+    *  second is a member of account.second_level for exactly as long as the object exists.  Adding or
+    *  removing a friendship only adjusts the counts of the pairs that run through the two parties,
+    *  instead of rebuilding the second level of every friend.
+    */
+   class friend_path_object : public abstract_object< friend_path_object >
+   {
+      public:
+         static const uint8_t space_id = implementation_ids;
+         static const uint8_t type_id  = impl_friend_path_object_type;
+
+         account_id_type   account;
+         account_id_type   second;
+         uint32_t          paths = 0;
+
+         friend_path_id_type get_id()const { return id; }
+   };
+
+   /**
+    *  @brief Schedules the next payout of an account that is powering down
+    *
+    *  There is one object for every account whose next_vesting_withdrawal is not time_point_sec::maximum(),
+    *  with the same time.  Payouts are found through this small index, so that the account_index doesn't
+    *  have to re-sort every account it pays out.
+    */
+   class vesting_withdrawal_object : public abstract_object< vesting_withdrawal_object >
+   {
+      public:
+         static const uint8_t space_id = implementation_ids;
+         static const uint8_t type_id  = impl_vesting_withdrawal_object_type;
+
+         account_id_type   account;
+         time_point_sec    next_vesting_withdrawal;
+
+         vesting_withdrawal_id_type get_id()const { return id; }
+   };
+
    struct by_name;
    struct by_proxy;
    struct by_next_vesting_withdrawal;
@@ -277,12 +318,6 @@ namespace btcm { namespace chain {
                member<object, object_id_type, &object::id >
             > /// composite key by proxy
          >,
-         ordered_unique< tag< by_next_vesting_withdrawal >,
-            composite_key< account_object,
-               member<account_object, time_point_sec, &account_object::next_vesting_withdrawal >,
-               member<object, object_id_type, &object::id >
-            > /// composite key by_next_vesting_withdrawal
-         >,
          ordered_unique< tag< by_btcm_balance >,
             composite_key< account_object,
                member<account_object, asset, &account_object::balance >,
@@ -330,10 +365,10 @@ namespace btcm { namespace chain {
             member< object, object_id_type, &object::id > >,
          ordered_unique< tag< by_delegation >,
             composite_key< vesting_delegation_object,
-               member< vesting_delegation_object, string, &vesting_delegation_object::delegator >,
-               member< vesting_delegation_object, string, &vesting_delegation_object::delegatee >
+               member< vesting_delegation_object, account_name_type, &vesting_delegation_object::delegator >,
+               member< vesting_delegation_object, account_name_type, &vesting_delegation_object::delegatee >
             >,
-            composite_key_compare< std::less< string >, std::less< string > >
+            composite_key_compare< std::less< account_name_type >, std::less< account_name_type > >
          >
       >
    > vesting_delegation_multi_index_type;
@@ -346,20 +381,13 @@ namespace btcm { namespace chain {
       indexed_by <
          ordered_unique< tag< by_id >,
             member< object, object_id_type, &object::id > >,
-         ordered_unique< tag< by_expiration >,
-            composite_key< vesting_delegation_expiration_object,
-               member< vesting_delegation_expiration_object, time_point_sec, &vesting_delegation_expiration_object::expiration >,
-               member<object, object_id_type, &object::id >
-            >,
-            composite_key_compare< std::less< time_point_sec >, std::less< object_id_type > >
-         >,
          ordered_unique< tag< by_account_expiration >,
             composite_key< vesting_delegation_expiration_object,
-               member< vesting_delegation_expiration_object, string, &vesting_delegation_expiration_object::delegator >,
+               member< vesting_delegation_expiration_object, account_name_type, &vesting_delegation_expiration_object::delegator >,
                member< vesting_delegation_expiration_object, time_point_sec, &vesting_delegation_expiration_object::expiration >,
                member<object, object_id_type, &object::id >
             >,
-            composite_key_compare< std::less< string >, std::less< time_point_sec >, std::less< object_id_type > >
+            composite_key_compare< std::less< account_name_type >, std::less< time_point_sec >, std::less< object_id_type > >
          >
       >
    > vesting_delegation_expiration_multi_index_type;
@@ -429,12 +457,52 @@ namespace btcm { namespace chain {
       >
    > change_recovery_account_request_multi_index_type;
 
+   struct by_account_second;
+
+   typedef multi_index_container <
+      friend_path_object,
+      indexed_by <
+         ordered_unique< tag< by_id >,
+            member< object, object_id_type, &object::id > >,
+         ordered_unique< tag< by_account_second >,
+            composite_key< friend_path_object,
+               member< friend_path_object, account_id_type, &friend_path_object::account >,
+               member< friend_path_object, account_id_type, &friend_path_object::second >
+            >,
+            composite_key_compare< std::less< account_id_type >, std::less< account_id_type > >
+         >
+      >
+   > friend_path_multi_index_type;
+
+   typedef multi_index_container <
+      vesting_withdrawal_object,
+      indexed_by <
+         ordered_unique< tag< by_id >,
+            member< object, object_id_type, &object::id > >,
+         ordered_unique< tag< by_next_vesting_withdrawal >,
+            composite_key< vesting_withdrawal_object,
+               member< vesting_withdrawal_object, time_point_sec, &vesting_withdrawal_object::next_vesting_withdrawal >,
+               member< vesting_withdrawal_object, account_id_type, &vesting_withdrawal_object::account >
+            >,
+            composite_key_compare< std::less< time_point_sec >, std::less< account_id_type > >
+         >,
+         ordered_unique< tag< by_account >,
+            member< vesting_withdrawal_object, account_id_type, &vesting_withdrawal_object::account > >
+      >
+   > vesting_withdrawal_multi_index_type;
+
    typedef generic_index< account_object,                         account_multi_index_type >                         account_index;
    typedef generic_index< owner_authority_history_object,         owner_authority_history_multi_index_type >         owner_authority_history_index;
    typedef generic_index< account_recovery_request_object,        account_recovery_request_multi_index_type >        account_recovery_request_index;
    typedef generic_index< change_recovery_account_request_object, change_recovery_account_request_multi_index_type > change_recovery_account_request_index;
    typedef generic_index< vesting_delegation_object,              vesting_delegation_multi_index_type >              vesting_delegation_index;
    typedef generic_index< vesting_delegation_expiration_object,   vesting_delegation_expiration_multi_index_type >   vesting_delegation_expiration_index;
+   typedef generic_index< friend_path_object,                     friend_path_multi_index_type >                     friend_path_index;
+   typedef generic_index< vesting_withdrawal_object,              vesting_withdrawal_multi_index_type >              vesting_withdrawal_index;
+
+   /// the vesting_delegation_expiration_objects by the second their shares are returned in
+   typedef expiration_index< vesting_delegation_expiration_object,
+                             member< vesting_delegation_expiration_object, time_point_sec, &vesting_delegation_expiration_object::expiration > > delegation_expiration_index;
 
    struct by_account_asset;
    struct by_asset_balance;
@@ -511,6 +579,12 @@ FC_REFLECT_DERIVED( btcm::chain::account_recovery_request_object, (graphene::db:
 FC_REFLECT_DERIVED( btcm::chain::change_recovery_account_request_object, (graphene::db::object),
                      (account_to_recover)(recovery_account)(effective_on)
                   )
+FC_REFLECT_DERIVED( btcm::chain::friend_path_object, (graphene::db::object),
+                     (account)(second)(paths)
+                  )
+FC_REFLECT_DERIVED( btcm::chain::vesting_withdrawal_object, (graphene::db::object),
+                     (account)(next_vesting_withdrawal)
+                  )
 FC_REFLECT_DERIVED( btcm::chain::account_balance_object, (graphene::db::object), 
                     (owner)(asset_type)(balance) 
                   )
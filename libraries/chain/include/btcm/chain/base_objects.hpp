@@ -8,6 +8,7 @@
 #include <btcm/chain/streaming_platform_objects.hpp>
 #include <btcm/chain/asset_object.hpp>
 #include <graphene/db/generic_index.hpp>
+#include <graphene/db/expiration_index.hpp>
 
 #include <boost/multi_index/composite_key.hpp>
 #include <boost/multiprecision/cpp_int.hpp>
@@ -152,7 +153,6 @@ namespace btcm { namespace chain {
       limit_order_object,
       indexed_by<
          ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
-         ordered_non_unique< tag<by_expiration>, member< limit_order_object, time_point_sec, &limit_order_object::expiration> >,
          ordered_unique< tag<by_price>,
             composite_key< limit_order_object,
                member< limit_order_object, price, &limit_order_object::sell_price>,
@@ -260,6 +260,51 @@ namespace btcm { namespace chain {
    typedef generic_index< withdraw_vesting_route_object,       withdraw_vesting_route_index_type >       withdraw_vesting_route_index;
    typedef generic_index< escrow_object,                       escrow_object_index_type >                escrow_index;
 
+   typedef expiration_index< limit_order_object, member< limit_order_object, time_point_sec, &limit_order_object::expiration > > limit_order_expiration_index;
+
+   /**
+    *  @brief This secondary index aggregates the limit orders of every market into price levels.
+    *
+    *  The levels follow orders as they are created, filled, cancelled and restored by undo, so the depth
+    *  and the best prices of a market can be read without walking its orders.  Every market also has a
+    *  revision that changes whenever one of its orders does, for caching anything derived from its levels.
+    */
+   class limit_order_depth_index : public secondary_index
+   {
+      public:
+         struct price_level
+         {
+            share_type for_sale;   ///< sum of for_sale of the orders at this price
+            share_type to_receive; ///< sum of amount_to_receive() of the orders at this price
+            uint32_t   orders = 0;
+         };
+
+         /// levels of the orders selling one asset for another, best price first like by_price
+         typedef std::map< price, price_level, std::greater< price > > side_type;
+
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void about_to_modify( const object& before ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         /// @return the levels of the orders selling @p sell for @p receive
+         const side_type& get_side( asset_id_type sell, asset_id_type receive )const;
+
+         /**
+          *  @return the revision of the market of @p a and @p b in either order, 0 if it never had orders.
+          *  Revisions are unique within the process, even across instances of this index.
+          */
+         uint64_t get_revision( asset_id_type a, asset_id_type b )const;
+
+      private:
+         void add_order( const limit_order_object& o );
+         void remove_order( const limit_order_object& o );
+         void changed( const limit_order_object& o );
+
+         map< pair< asset_id_type, asset_id_type >, side_type > _sides;
+         map< pair< asset_id_type, asset_id_type >, uint64_t >  _revisions;
+   };
+
 } } // btcm::chain
 
 #include <btcm/chain/account_object.hpp>
@@ -2,14 +2,48 @@
 #include <fstream>
 #include <btcm/chain/protocol/block.hpp>
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 namespace btcm { namespace chain {
    class index_entry;
 
+   /**
+    *  Stores blocks by number in an append only "blocks" file and an "index" file of fixed size entries.
+    *
+    *  Unless write_options::async is disabled, store() only packs the block and queues it; a writer thread
+    *  appends queued blocks in batches, so disk latency stays off the block applying thread.  Blocks that are
+    *  queued or being written are served from memory by all fetch methods, so callers cannot tell them apart
+    *  from blocks that are on disk.  Storing a block number again (e.g. while switching forks) supersedes
+    *  the earlier block in memory as well as on disk, since the writer appends in the order blocks were
+    *  stored.  Errors of the writer thread are rethrown by the next call to store(), flush() or close().
+    */
    class block_database
    {
       public:
+         struct write_options
+         {
+            bool     async = true;           ///< append blocks on a writer thread
+            bool     fsync = false;          ///< sync both files to stable storage after every batch
+            uint32_t max_batch = 256;        ///< most blocks appended by one batch
+            uint32_t max_queued = 4096;      ///< store() waits while this many blocks are waiting to be written
+         };
+
+         block_database();
+         ~block_database();
+
+         /// Takes effect on the next open()
+         void set_write_options( const write_options& o );
+         const write_options& get_write_options()const { return _options; }
+
          void open( const fc::path& dbdir );
          bool is_open()const;
+         /// Waits until all stored blocks have been written
          void flush();
          void close();
 
@@ -23,9 +57,38 @@ namespace btcm { namespace chain {
          optional<signed_block> last()const;
          optional<block_id_type> last_id()const;
       private:
+         struct pending_block
+         {
+            uint64_t                                  sequence = 0;
+            block_id_type                             id;
+            std::shared_ptr< const std::vector<char> > data;
+         };
+
          optional<index_entry> last_index_entry()const;
+         optional<pending_block> find_pending( uint32_t block_num )const;
+         void write_block( const pending_block& b );
+         void write_loop();
+         void sync_files();
+         void check_write_error();
+
          fc::path _index_filename;
+         fc::path _blocks_filename;
          mutable std::fstream _blocks;
          mutable std::fstream _block_num_to_pos;
+         write_options _options;
+
+         /// guards the files, which are shared by readers and the writer thread
+         mutable std::mutex                 _file_mutex;
+
+         /// guards everything below
+         mutable std::mutex                 _queue_mutex;
+         std::condition_variable            _queue_changed;
+         std::deque< pending_block >        _queue;
+         std::map< uint32_t, pending_block > _pending;        ///< latest queued or in flight block by number
+         uint64_t                           _next_sequence = 0;
+         uint32_t                           _in_flight = 0;   ///< blocks taken off the queue but not yet written
+         bool                               _stopping = false;
+         std::exception_ptr                 _write_error;
+         std::thread                        _writer;
    };
 } }
@@ -0,0 +1,134 @@
+#pragma once
+#include <fc/time.hpp>
+
+#include <array>
+#include <vector>
+
+namespace btcm { namespace chain {
+
+   /**
+    * The steps of database::_apply_block, in the order they are executed.
+    */
+   enum block_phase
+   {
+      header_phase,           ///< header validation, pre_apply_block observers and header extensions
+      transactions_phase,     ///< evaluation of the transactions in the block
+      dynamic_data_phase,     ///< global dynamic data, signing witness, irreversibility and block summary
+      expiration_phase,       ///< expired transactions, proposals, orders and delegations
+      witness_schedule_phase, ///< witness schedule
+      supply_phase,           ///< median feed and virtual supply
+      funds_phase,            ///< process_funds and process_conversions
+      cashout_phase,          ///< process_content_cashout
+      vesting_phase,          ///< process_vesting_withdrawals
+      maintenance_phase,      ///< account recovery and hardforks
+      notify_phase,           ///< applied_block observers and changed object notifications
+      BLOCK_PHASE_COUNT
+   };
+
+   inline const char* block_phase_name( block_phase phase )
+   {
+      static const char* const names[] = {
+         "header", "transactions", "dynamic_data", "expiration", "witness_schedule", "supply",
+         "funds", "cashout", "vesting", "maintenance", "notify"
+      };
+      static_assert( sizeof(names) / sizeof(names[0]) == BLOCK_PHASE_COUNT, "block_phase_name out of date" );
+      return names[ phase ];
+   }
+
+   /**
+    * Number, total and longest evaluation time of the operations of one type
+    */
+   struct operation_timing
+   {
+      uint32_t         count = 0;
+      fc::microseconds elapsed;
+      fc::microseconds max;
+
+      void add( const fc::microseconds& d )
+      {
+         ++count;
+         elapsed += d;
+         if( d > max )
+            max = d;
+      }
+   };
+
+   /**
+    * Time spent applying one block, by phase of database::_apply_block and by type of the operations
+    * evaluated in the transactions phase.
+    */
+   struct block_phase_timings
+   {
+      uint32_t                                          block_num = 0;
+      std::array< fc::microseconds, BLOCK_PHASE_COUNT > elapsed;
+      /// indexed by operation tag, only holds the operation types applied since the database was opened
+      std::vector< operation_timing >                   operations;
+
+      fc::microseconds total()const
+      {
+         fc::microseconds result;
+         for( const auto& e : elapsed )
+            result += e;
+         return result;
+      }
+
+      void reset( uint32_t num )
+      {
+         block_num = num;
+         elapsed.fill( fc::microseconds() );
+         for( auto& op : operations )
+            op = operation_timing();
+      }
+
+      void add_operation( int tag, const fc::microseconds& d )
+      {
+         if( operations.size() <= size_t( tag ) )
+            operations.resize( tag + 1 );
+         operations[ tag ].add( d );
+      }
+   };
+
+   /**
+    * Attributes the time spent between construction, each call to next() and finish() to the current
+    * phase of the given timings.
+    */
+   class block_phase_timer
+   {
+      public:
+         block_phase_timer( block_phase_timings& timings, block_phase first )
+            : _timings( &timings ), _phase( first ), _start( fc::time_point::now() ) {}
+
+         ~block_phase_timer() { finish(); }
+
+         void next( block_phase phase )
+         {
+            stop();
+            _phase = phase;
+         }
+
+         /// Records the current phase and stops timing
+         void finish()
+         {
+            stop();
+            _timings = nullptr;
+         }
+
+         block_phase_timer( const block_phase_timer& ) = delete;
+         block_phase_timer& operator=( const block_phase_timer& ) = delete;
+
+      private:
+         void stop()
+         {
+            if( _timings == nullptr )
+               return;
+            const fc::time_point now = fc::time_point::now();
+            _timings->elapsed[ _phase ] += now - _start;
+            _start = now;
+         }
+
+         block_phase_timings* _timings;
+         block_phase          _phase;
+         fc::time_point       _start;
+   };
+
+} } // btcm::chain
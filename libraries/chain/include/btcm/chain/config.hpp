@@ -177,7 +177,7 @@
 #define BTCM_MAX_ASSET_WHITELIST_AUTHORITIES 10
 #define BTCM_MAX_URL_LENGTH                  127
 
-#define GRAPHENE_CURRENT_DB_VERSION          "BTCM_0_1_0"
+#define GRAPHENE_CURRENT_DB_VERSION          "BTCM_0_1_6"
 
 #define BTCM_IRREVERSIBLE_THRESHOLD          (51 * BTCM_1_PERCENT)
 
@@ -15,6 +15,47 @@ namespace btcm { namespace chain {
 
    using namespace graphene::db;
 
+   /**
+    *  Running totals of the votes cast on a content, maintained by the vote evaluator as votes are
+    *  cast or changed so they stay available after the votes themselves have been archived.
+    */
+   struct content_vote_totals
+   {
+      uint32_t votes = 0;                 ///< votes with a non-zero weight
+      uint32_t positive_votes = 0;
+      int64_t  vote_weight = 0;           ///< sum of the weights of all votes
+      int64_t  positive_vote_weight = 0;  ///< sum of the weights of positive votes
+
+      void add( int16_t weight )
+      {
+         if( weight == 0 ) return;
+         ++votes;
+         vote_weight += weight;
+         if( weight > 0 )
+         {
+            ++positive_votes;
+            positive_vote_weight += weight;
+         }
+      }
+
+      void remove( int16_t weight )
+      {
+         if( weight == 0 ) return;
+         --votes;
+         vote_weight -= weight;
+         if( weight > 0 )
+         {
+            --positive_votes;
+            positive_vote_weight -= weight;
+         }
+      }
+   };
+
+   /**
+    *  The rarely changing part of a content: metadata, distributions and management.  The balances and
+    *  counters that change with every play or vote are kept in a content_stats_object, so modifying them
+    *  does not copy the metadata into the undo state.
+    */
    class content_object : public abstract_object<content_object>
    {
       public:
@@ -24,8 +65,6 @@ namespace btcm { namespace chain {
          string uploader;
          
          string            url;
-         asset             accumulated_balance_master;
-         asset             accumulated_balance_comp;
 
          content_metadata_album_master album_meta;
          content_metadata_track_master track_meta;
@@ -35,7 +74,6 @@ namespace btcm { namespace chain {
 
          time_point_sec    last_update;
          time_point_sec    created;
-         time_point_sec    last_played;
          
          vector <distribution> distributions_master;
          vector <distribution> distributions_comp;
@@ -46,9 +84,6 @@ namespace btcm { namespace chain {
          authority manage_master;
          authority manage_comp;
 
-         uint64_t times_played=0;
-         uint32_t times_played_24=0;
-
          bool           curation_rewards=true;
          time_point_sec curation_reward_expiration;
 
@@ -61,6 +96,27 @@ namespace btcm { namespace chain {
          }
    };
 
+   /**
+    *  Balances and counters of a content, see content_object
+    */
+   class content_stats_object : public abstract_object<content_stats_object>
+   {
+      public:
+         static const uint8_t space_id = implementation_ids;
+         static const uint8_t type_id  = impl_content_stats_object_type;
+
+         content_id_type     content;
+
+         asset               accumulated_balance_master;
+         asset               accumulated_balance_comp;
+
+         time_point_sec      last_played;
+         uint64_t            times_played=0;
+         uint32_t            times_played_24=0;
+
+         content_vote_totals vote_totals;
+   };
+
    class content_approve_object : public abstract_object<content_approve_object>
    {
       public:
@@ -142,10 +198,19 @@ namespace btcm { namespace chain {
       >
    > content_vote_multi_index_type;
 
+   struct by_popularity;
+   typedef multi_index_container<
+      content_stats_object,
+      indexed_by<
+         ordered_unique< tag< by_id >, member< object, object_id_type, &object::id > >,
+         ordered_unique< tag< by_content >, member< content_stats_object, content_id_type, &content_stats_object::content > >,
+         ordered_non_unique< tag< by_popularity >, member< content_stats_object, uint32_t, &content_stats_object::times_played_24 > >
+      >
+   > content_stats_multi_index_type;
+
    struct by_url; 
    struct by_title;
    struct by_uploader;
-   struct by_popularity;
    /**
     * @ingroup object_index
     */
@@ -161,12 +226,12 @@ namespace btcm { namespace chain {
                member< object, object_id_type, &object::id >
             >,
            composite_key_compare< std::less< string >, std::greater< object_id_type > >
-         >,
-         ordered_non_unique< tag< by_popularity >, member< content_object, uint32_t, &content_object::times_played_24 > >
+         >
       >
    > content_multi_index_type;
 
    typedef generic_index< content_object,      content_multi_index_type >       content_index;
+   typedef generic_index< content_stats_object, content_stats_multi_index_type > content_stats_index;
    typedef generic_index< content_vote_object, content_vote_multi_index_type >  content_vote_index;
    typedef generic_index< content_approve_object, content_approve_multi_index_type > content_approve_index;
 
@@ -213,16 +278,22 @@ namespace btcm { namespace chain {
 
 } } // btcm::chain
 
+FC_REFLECT( btcm::chain::content_vote_totals, (votes)(positive_votes)(vote_weight)(positive_vote_weight) )
+
 FC_REFLECT_DERIVED( btcm::chain::content_object, (graphene::db::object),
                     (album_meta)(track_meta)(comp_meta)(track_title)
-                    (uploader)(url)(accumulated_balance_master)(accumulated_balance_comp)
-                    (last_update)(created)(last_played)(times_played)(times_played_24)
+                    (uploader)(url)
+                    (last_update)(created)
                     (allow_votes)(playing_reward) (publishers_share)
                     (manage_master)(manage_comp)(distributions_master)(distributions_comp)
                     (curation_rewards)(curation_reward_expiration)
                     (disabled)
                     )
 
+FC_REFLECT_DERIVED( btcm::chain::content_stats_object, (graphene::db::object),
+                    (content)(accumulated_balance_master)(accumulated_balance_comp)
+                    (last_played)(times_played)(times_played_24)(vote_totals) )
+
 FC_REFLECT_DERIVED( btcm::chain::content_approve_object, (graphene::db::object),
                     (approver)(content) )
 
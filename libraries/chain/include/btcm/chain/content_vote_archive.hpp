@@ -0,0 +1,88 @@
+#pragma once
+#include <btcm/chain/protocol/types.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/optional.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace btcm { namespace chain {
+
+   namespace detail {
+      struct content_vote_segment_header;
+      struct content_vote_segment_record;
+   }
+
+   /**
+    *  The state of a content_vote_object that has been moved to the content_vote_archive
+    */
+   struct archived_content_vote
+   {
+      content_id_type content;
+      account_id_type voter;
+      int16_t         weight = 0;
+      int8_t          num_changes = 0;
+      time_point_sec  last_update;
+   };
+
+   /**
+    *  On-disk store of the content votes that have not changed for a long time, see
+    *  database::archive_settled_content_votes().
+    *
+    *  Votes are written in segments, files of fixed size records sorted by (content, voter) that are
+    *  binary searched through a read only mapping.  The same vote may be archived again after it has
+    *  been changed; the most recent segment holding it has its current state.
+    *
+    *  Every segment records the head block number it was written at.  Segments written at a block above
+    *  the head of the object database are discarded by open(), so a node that restarts from an older
+    *  object database never finds votes that do not exist yet at its head block.
+    */
+   class content_vote_archive
+   {
+      public:
+         content_vote_archive();
+         ~content_vote_archive();
+
+         void open( const fc::path& dir, uint32_t head_block_num );
+         void close();
+         void wipe( const fc::path& dir );
+
+         /// Number of archived records, including older states of votes that were archived more than once
+         uint64_t size()const;
+
+         fc::optional< archived_content_vote > find( content_id_type content, account_id_type voter )const;
+
+         /**
+          *  Writes @p votes as a new segment; when there are more than max_segments, all segments are merged
+          *  into one.
+          *  @param votes must be sorted by (content, voter) without duplicates
+          */
+         void add( const std::vector< archived_content_vote >& votes, uint32_t head_block_num );
+
+         /**
+          *  Removes the segments superseded by a merged segment written at or below @p flushed_block_num, the
+          *  head block the object database has just been saved at.  Until then a restart may still discard
+          *  the merged segment and fall back on the segments it was merged from.
+          */
+         void remove_superseded( uint32_t flushed_block_num );
+
+         static const uint32_t max_segments = 16;
+
+      private:
+         struct segment;
+
+         void write_segment( const detail::content_vote_segment_header& header,
+                             const std::vector< detail::content_vote_segment_record >& records );
+         void merge_segments();
+
+         fc::path                                  _dir;
+         std::vector< std::unique_ptr< segment > > _segments; ///< oldest first
+         /// files of merged segments and the block number of the segment they were merged into
+         std::vector< std::pair< uint32_t, fc::path > > _superseded;
+         uint64_t                                  _next_sequence = 0;
+   };
+
+} } // btcm::chain
+
+FC_REFLECT( btcm::chain::archived_content_vote, (content)(voter)(weight)(num_changes)(last_update) )
@@ -13,7 +13,11 @@
 #include <btcm/chain/protocol/protocol.hpp>
 #include <btcm/chain/global_property_object.hpp>
 #include <btcm/chain/genesis_state.hpp>
+#include <btcm/chain/singleton_write_buffer.hpp>
+#include <btcm/chain/block_phase_timer.hpp>
+#include <btcm/chain/content_vote_archive.hpp>
 
+#include <graphene/db/expiration_index.hpp>
 #include <graphene/db/object_database.hpp>
 #include <graphene/db/object.hpp>
 #include <graphene/db/simple_index.hpp>
@@ -27,6 +31,9 @@ namespace btcm { namespace chain {
    using graphene::db::abstract_object;
    using graphene::db::object;
 
+   class transaction_id_filter;
+   class transaction_block_index;
+
    namespace detail{ uint32_t isqrt(uint64_t a); }
    /**
     *   @class database
@@ -42,6 +49,9 @@ namespace btcm { namespace chain {
          void set_producing( bool p ) { _is_producing = p;  }
          bool _is_producing = false;
 
+         /// @return true from pre_apply_block until the block has been applied or has failed to apply
+         bool is_applying_block()const { return _applying_block; }
+
          enum validation_steps
          {
             skip_nothing                = 0,
@@ -90,6 +100,11 @@ namespace btcm { namespace chain {
          void wipe(const fc::path& data_dir, bool include_blocks);
          void close(bool rewind = true);
 
+         /**
+          * @brief Save the object graph to disk, then drop the archived content vote segments it no longer needs
+          */
+         void flush();
+
          //////////////////// db_block.cpp ////////////////////
 
          /**
@@ -102,7 +117,7 @@ namespace btcm { namespace chain {
          block_id_type              get_block_id_for_num( uint32_t block_num )const;
          optional<signed_block>     fetch_block_by_id( const block_id_type& id )const;
          optional<signed_block>     fetch_block_by_number( uint32_t num )const;
-         const signed_transaction&  get_recent_transaction( const transaction_id_type& trx_id )const;
+         signed_transaction         get_recent_transaction( const transaction_id_type& trx_id )const;
          std::vector<block_id_type> get_block_ids_on_fork(block_id_type head_of_fork) const;
 
          chain_id_type              get_chain_id()const;
@@ -114,6 +129,29 @@ namespace btcm { namespace chain {
          const streaming_platform_object & get_streaming_platform( const string& name) const;
          const account_object&  get_account( const string& name )const;
          const content_object&  get_content( const string& url )const;
+         /// The content_stats_object is created along with its content_object and shares its instance number
+         const content_stats_object& get_content_stats( const content_object& content )const;
+
+         /**
+          *  Finds the vote of @p voter on @p content.  A vote that has been moved to the content vote archive
+          *  is restored into the content_vote_index, so the result can be modified like any other vote.
+          *  @return nullptr if the voter has never voted on the content
+          */
+         const content_vote_object* find_content_vote( content_id_type content, account_id_type voter );
+
+         /**
+          *  Votes that have not changed for @p seconds and whose last change is irreversible are moved from
+          *  the content_vote_index to the content vote archive once per hour.  0 (the default) disables archival.
+          */
+         void set_content_vote_archive_age( uint32_t seconds ) { _content_vote_archive_age = seconds; }
+
+         /// Set before open(), see block_database
+         void set_block_log_write_options( const block_database::write_options& o ) { _block_id_to_block.set_write_options( o ); }
+
+         /// Moves the settled votes to the content vote archive, @return the number of votes archived
+         uint32_t archive_settled_content_votes();
+
+         const content_vote_archive& get_content_vote_archive()const { return _content_vote_archive; }
          
          const escrow_object&   get_escrow( const string& name, uint32_t escrowid )const;
          const limit_order_object& get_limit_order( const string& owner, uint32_t id )const;
@@ -189,6 +227,20 @@ namespace btcm { namespace chain {
           */
          fc::signal<void(const signed_block&)>           applied_block;
 
+         /**
+          *  This signal is emitted when a block has passed header validation, before any of its
+          *  transactions are applied.  Together with applied_block it lets plugins tell the operations
+          *  of a block apart from those of pending transactions.
+          */
+         fc::signal<void(const signed_block&)>           pre_apply_block;
+
+         /**
+          *  This signal is emitted at the very end of block application with the time spent in each
+          *  phase of it and in the evaluators of each operation type.  The timings are only valid
+          *  during the callback, which should execute quickly.
+          */
+         fc::signal<void(const block_phase_timings&)>    applied_block_timings;
+
          /**
           * This signal is emitted any time a new transaction is added to the pending
           * block state.
@@ -280,6 +332,16 @@ namespace btcm { namespace chain {
          void recalculate_score(const account_object& ao );
          void recursive_recalculate_score(const account_object& ao, share_type delta );
 
+         /**
+          * Makes a1 and a2 friends.  The second level of every account whose set of paths through a1 or a2
+          * changes is updated incrementally.  The scores of a1, a2 and all of their friends are recalculated,
+          * as the friendship evaluator always did, since a full recalculation drops the rounding that
+          * recursive_recalculate_score() accumulates and so changes scores that must match on replay.
+          */
+         void add_friendship( const account_object& a1, const account_object& a2 );
+         /** Reverts add_friendship() */
+         void remove_friendship( const account_object& a1, const account_object& a2 );
+
          const asset_object& get_asset( const string& symbol )const;
          /** this updates the votes for witnesses and streaming_platforms as a result of account voting proxy changing */
          void adjust_proxied_witness_votes( const account_object& a,
@@ -310,10 +372,12 @@ namespace btcm { namespace chain {
         
          vector<string> get_voted_streaming_platforms();
          void process_vesting_withdrawals();
+         /** Moves, creates or removes the vesting_withdrawal_object of @p a to match a.next_vesting_withdrawal */
+         void update_vesting_withdrawal_schedule( const account_object& a );
 
          asset pay_to_content(const content_object & content, asset payout, streaming_platform_id_type platform);
-         void pay_to_content_master(const content_object &content, const asset& payout);
-         void pay_to_content_comp(const content_object &content, const asset& payout);
+         void pay_to_content_master(const content_object &content, const content_stats_object& stats, const asset& payout);
+         void pay_to_content_comp(const content_object &content, const content_stats_object& stats, const asset& payout);
 
          asset process_content_cashout(const asset& content_reward);
          void process_funds(const asset& content_reward, const asset& witness_pay, const asset& vesting_reward);
@@ -334,6 +398,22 @@ namespace btcm { namespace chain {
          const feed_history_object&             get_feed_history()const;
          const witness_schedule_object&         get_witness_schedule_object()const;
 
+         /**
+          *  Modifications of the dynamic global properties and of the feed history are coalesced while
+          *  a detail::global_property_buffer_scope is open, see singleton_write_buffer.  All other
+          *  objects are modified through object_database::modify().
+          */
+         using object_database::modify;
+         template<typename Lambda>
+         void modify( const dynamic_global_property_object& obj, const Lambda& m )
+         { _dgp_buffer.modify( *this, obj, m ); }
+         template<typename Lambda>
+         void modify( const feed_history_object& obj, const Lambda& m )
+         { _feed_history_buffer.modify( *this, obj, m ); }
+
+         void begin_global_property_buffering();
+         void end_global_property_buffering( bool notify );
+
          /**
           * Helper method to return the current mbd value of a given amount of
           * BTCM.  Return 0 SBD if there isn't a current_median_history
@@ -390,6 +470,9 @@ namespace btcm { namespace chain {
          void set_hardfork( uint32_t hardfork, bool process_now = true );
 
          void validate_invariants()const;
+
+         /// Time spent applying the last block, see applied_block_timings
+         const block_phase_timings& get_last_block_timings()const { return _block_timings; }
          /**
           * @}
           */
@@ -424,10 +507,30 @@ namespace btcm { namespace chain {
          void update_virtual_supply();
          void update_signing_witness(const witness_object& signing_witness, const signed_block& new_block);
          void update_last_irreversible_block();
-         void clear_expired_transactions();
-         void clear_expired_proposals();
-         void clear_expired_orders();
-         void clear_expired_delegations();
+         void initialize_expiration_queues();
+         /// Expires the objects due in the queues added by add_expiration_queue(), in the order they were added
+         void process_expirations();
+         void expire_proposal( const proposal_object& proposal );
+         void return_expired_delegation( const vesting_delegation_expiration_object& delegation );
+
+         /**
+          *  Adds an ExpirationIndex to the primary index of IndexType, whose objects are passed to @p expire
+          *  once the head block time is past the second they expire in, or has reached it if @p at_expiration.
+          *  @p expire must remove the object.
+          */
+         template< typename ExpirationIndex, typename IndexType >
+         void add_expiration_queue( bool at_expiration,
+                                    std::function< void( const typename IndexType::object_type& ) > expire )
+         {
+            typedef typename IndexType::object_type object_type;
+            auto& idx = dynamic_cast< primary_index< IndexType >& >( get_mutable_index_type< IndexType >() );
+            expiration_queue queue;
+            queue.primary = &idx;
+            queue.expirations = idx.template add_secondary_index< ExpirationIndex >();
+            queue.at_expiration = at_expiration;
+            queue.expire = [expire]( const object& obj ){ expire( static_cast< const object_type& >( obj ) ); };
+            _expiration_queues.push_back( std::move( queue ) );
+         }
          void process_header_extensions( const signed_block& next_block );
 
          void reset_virtual_schedule_time();
@@ -442,6 +545,21 @@ namespace btcm { namespace chain {
          void pay_to_platform( streaming_platform_id_type platform, const asset& payout, const string& url );
          ///@}
 
+         void adjust_friend_paths( const account_object& a, const account_object& b, bool add );
+         void adjust_friend_path( account_id_type account, account_id_type second, bool add );
+         void recalculate_friendship_scores( const account_object& a1, const account_object& a2 );
+
+         struct expiration_queue
+         {
+            const graphene::db::index*              primary       = nullptr;
+            base_expiration_index*                  expirations   = nullptr;
+            bool                                    at_expiration = false;
+            std::function< void( const object& ) >  expire;
+         };
+         vector< expiration_queue >    _expiration_queues;
+         transaction_id_filter*        _transaction_filter = nullptr;
+         transaction_block_index*      _transaction_blocks = nullptr;
+
          vector< signed_transaction >  _pending_tx;
          fork_database                 _fork_db;
          fc::time_point_sec            _hardfork_times[ BTCM_NUM_HARDFORKS + 1 ];
@@ -458,16 +576,25 @@ namespace btcm { namespace chain {
           */
          block_database   _block_id_to_block;
 
+         content_vote_archive _content_vote_archive;
+         uint32_t             _content_vote_archive_age = 0;
+
          transaction_id_type               _current_trx_id;
          uint32_t                          _current_block_num    = 0;
          uint16_t                          _current_trx_in_block = 0;
          uint16_t                          _current_op_in_trx    = 0;
          uint16_t                          _current_virtual_op   = 0;
+         bool                              _applying_block       = false;
 
          flat_map<uint32_t,block_id_type>  _checkpoints;
 
          node_property_object              _node_property_object;
 
+         singleton_write_buffer< dynamic_global_property_object > _dgp_buffer;
+         singleton_write_buffer< feed_history_object >            _feed_history_buffer;
+
+         block_phase_timings               _block_timings;
+
          fc::sha256                        genesis_json_hash;
 
          /**
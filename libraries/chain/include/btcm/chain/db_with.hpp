@@ -89,6 +89,35 @@ struct pending_transactions_restorer
    std::vector< signed_transaction > _pending_transactions;
 };
 
+/**
+ * Coalesces modifications of the global property singletons until flush()
+ * is called.  If the scope is left without flush(), e.g. by an exception,
+ * the buffered changes are left to the enclosing undo session.
+ */
+struct global_property_buffer_scope
+{
+   global_property_buffer_scope( database& db )
+      : _db( db )
+   {
+      _db.begin_global_property_buffering();
+   }
+
+   ~global_property_buffer_scope()
+   {
+      if( !_flushed )
+         _db.end_global_property_buffering( false );
+   }
+
+   void flush()
+   {
+      _flushed = true;
+      _db.end_global_property_buffering( true );
+   }
+
+   database& _db;
+   bool _flushed = false;
+};
+
 /**
  * Set the skip_flags to the given value, call callback,
  * then reset skip_flags to their previous value after
@@ -64,6 +64,8 @@ namespace btcm { namespace chain {
    FC_DECLARE_DERIVED_EXCEPTION( insufficient_fee,                  btcm::chain::transaction_exception, 3030007, "insufficient fee" )
    FC_DECLARE_DERIVED_EXCEPTION( tx_missing_basic_auth,           btcm::chain::transaction_exception, 3030008, "missing required basic authority" )
 
+   FC_DECLARE_DERIVED_EXCEPTION( block_buffered_exception,          btcm::chain::unlinkable_block_exception, 3080001, "unlinkable block buffered until its ancestors arrive" )
+
    FC_DECLARE_DERIVED_EXCEPTION( pop_empty_chain,                   btcm::chain::undo_database_exception, 3070001, "there are no blocks to pop" )
 
    BTCM_DECLARE_OP_BASE_EXCEPTIONS( transfer );
@@ -41,13 +41,17 @@ namespace btcm { namespace chain {
     *
     *  Every time a block is pushed into the fork DB the
     *  block with the highest block_num will be returned.
+    *
+    *  Blocks that arrive before their parent are cached, up to
+    *  MAX_BLOCK_REORDERING of them, and linked into the tree
+    *  when the parent is pushed.
     */
    class fork_database
    {
       public:
          typedef vector<item_ptr> branch_type;
-         /// The maximum number of blocks that may be skipped in an out-of-order push
-         const static int MAX_BLOCK_REORDERING = 1024;
+         /// The maximum number of blocks that may be skipped in an out-of-order push, and of blocks cached until they link
+         const static uint32_t MAX_BLOCK_REORDERING = 1024;
 
          fork_database();
          void reset();
@@ -27,6 +27,7 @@
 #include <btcm/chain/transaction_evaluation_state.hpp>
 
 #include <graphene/db/generic_index.hpp>
+#include <graphene/db/expiration_index.hpp>
 
 #include <boost/multi_index/composite_key.hpp>
 
@@ -92,16 +93,11 @@ struct by_expiration{};
 typedef boost::multi_index_container<
    proposal_object,
    indexed_by<
-      ordered_unique< tag< by_id >, member< object, object_id_type, &object::id > >,
-      ordered_unique< tag< by_expiration >,
-         composite_key<proposal_object,
-            member<proposal_object, time_point_sec, &proposal_object::expiration_time>,
-            member< object, object_id_type, &object::id >
-         >
-      >
+      ordered_unique< tag< by_id >, member< object, object_id_type, &object::id > >
    >
 > proposal_multi_index_container;
 typedef generic_index<proposal_object, proposal_multi_index_container> proposal_index;
+typedef expiration_index< proposal_object, member< proposal_object, time_point_sec, &proposal_object::expiration_time > > proposal_expiration_index;
 
 } } // btcm::chain
 
@@ -8,6 +8,22 @@ namespace btcm { namespace chain {
    {
       checksum_type calculate_merkle_root()const;
       vector<signed_transaction> transactions;
+
+      /**
+       * Same as signed_block_header::id(), memoized while a scoped_serialization_cache is alive for
+       * this block.
+       */
+      block_id_type id()const;
+
+      /** @return the packed size of the block, memoized like id() */
+      size_t packed_size()const;
+
+      /** Also enables the cache of every transaction in the block */
+      void enable_serialization_cache()const;
+      void disable_serialization_cache()const;
+
+   private:
+      serialization_cache< block_id_type > _serialization_cache;
    };
 
 } } // btcm::chain
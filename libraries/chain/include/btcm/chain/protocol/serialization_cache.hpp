@@ -0,0 +1,80 @@
+#pragma once
+#include <btcm/chain/protocol/types.hpp>
+
+namespace btcm { namespace chain {
+
+   /**
+    * @class serialization_cache
+    * @brief Memoizes the packed size, digest and id of a transaction or block
+    *
+    * Each of these values requires a full walk of the reflected structure.  The cache is only active
+    * while at least one scoped_serialization_cache is alive for the owning object; outside of such a
+    * scope every accessor recomputes its value.  The cached values are discarded when the outermost
+    * scope is closed, so modifying the object after the scope has ended can never observe a stale
+    * value.  The owner must not be modified while a scope is open.
+    *
+    * Copying the owner never copies cached values or the scope depth.
+    */
+   template< typename IdType >
+   class serialization_cache
+   {
+      public:
+         serialization_cache(){}
+         serialization_cache( const serialization_cache& ){}
+         serialization_cache& operator=( const serialization_cache& ){ return *this; }
+
+         void enable()const { ++_depth; }
+         void disable()const
+         {
+            if( _depth > 0 && --_depth == 0 )
+            {
+               _packed_size.reset();
+               _digest.reset();
+               _id.reset();
+            }
+         }
+
+         template< typename Lambda >
+         size_t packed_size( const Lambda& compute )const { return get( _packed_size, compute ); }
+
+         template< typename Lambda >
+         digest_type digest( const Lambda& compute )const { return get( _digest, compute ); }
+
+         template< typename Lambda >
+         IdType id( const Lambda& compute )const { return get( _id, compute ); }
+
+      private:
+         template< typename T, typename Lambda >
+         T get( fc::optional< T >& value, const Lambda& compute )const
+         {
+            if( _depth == 0 )
+               return compute();
+            if( !value.valid() )
+               value = compute();
+            return *value;
+         }
+
+         mutable fc::optional< size_t >      _packed_size;
+         mutable fc::optional< digest_type > _digest;
+         mutable fc::optional< IdType >      _id;
+         mutable uint32_t                    _depth = 0;
+   };
+
+   /**
+    * Enables the serialization cache of a transaction or block for the lifetime of this object.
+    */
+   template< typename T >
+   class scoped_serialization_cache
+   {
+      public:
+         explicit scoped_serialization_cache( const T& obj ) : _obj( obj ) { _obj.enable_serialization_cache(); }
+         ~scoped_serialization_cache() { _obj.disable_serialization_cache(); }
+
+         scoped_serialization_cache( const scoped_serialization_cache& ) = delete;
+         scoped_serialization_cache& operator=( const scoped_serialization_cache& ) = delete;
+
+      private:
+         const T& _obj;
+   };
+
+} } // btcm::chain
@@ -1,5 +1,6 @@
 #pragma once
 #include <btcm/chain/protocol/operations.hpp>
+#include <btcm/chain/protocol/serialization_cache.hpp>
 #include <btcm/chain/protocol/sign_state.hpp>
 #include <btcm/chain/protocol/types.hpp>
 
@@ -96,7 +97,22 @@ namespace btcm { namespace chain {
 
       digest_type merkle_digest()const;
 
+      /**
+       * Same as transaction::id(), memoized while a scoped_serialization_cache is alive for this
+       * transaction.
+       */
+      transaction_id_type id()const;
+
+      /** @return the packed size of the signed transaction, memoized like id() */
+      size_t packed_size()const;
+
+      void enable_serialization_cache()const  { _serialization_cache.enable(); }
+      void disable_serialization_cache()const { _serialization_cache.disable(); }
+
       void clear() { operations.clear(); signatures.clear(); }
+
+   private:
+      serialization_cache< transaction_id_type > _serialization_cache;
    };
 
    void verify_authority( const vector<operation>& ops, const flat_set<public_key_type>& sigs,
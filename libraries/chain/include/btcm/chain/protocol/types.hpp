@@ -133,13 +133,16 @@ namespace btcm { namespace chain {
       impl_vesting_delegation_object_type,
       impl_vesting_delegation_expiration_object_type,
       impl_stream_report_request_object_type,
-      impl_streaming_platform_user_object_type
+      impl_streaming_platform_user_object_type,
+      impl_friend_path_object_type,
+      impl_vesting_withdrawal_object_type
    };
 
    class operation_object;
    class account_history_object;
    class content_object;
    class content_approve_object;
+   class content_vote_object;
    class vote_object;
    class witness_vote_object;
    class streaming_platform_object;
@@ -170,6 +173,8 @@ namespace btcm { namespace chain {
    class balance_object;
    class vesting_delegation_object;
    class vesting_delegation_expiration_object;
+   class friend_path_object;
+   class vesting_withdrawal_object;
 
    typedef object_id< implementation_ids, impl_operation_object_type,                        operation_object >                        operation_id_type;
    typedef object_id< implementation_ids, impl_account_history_object_type,                  account_history_object >                  account_history_id_type;
@@ -205,6 +210,8 @@ namespace btcm { namespace chain {
    typedef object_id< implementation_ids, impl_vesting_delegation_expiration_object_type,    vesting_delegation_expiration_object>     vesting_delegation_expiration_object_id_type;
    typedef object_id< implementation_ids, impl_stream_report_request_object_type,            stream_report_request_object>             stream_report_request_object_id_type;
    typedef object_id< implementation_ids, impl_streaming_platform_user_object_type,          streaming_platform_user_object >          streaming_platform_user_id_type;
+   typedef object_id< implementation_ids, impl_friend_path_object_type,                      friend_path_object >                      friend_path_id_type;
+   typedef object_id< implementation_ids, impl_vesting_withdrawal_object_type,               vesting_withdrawal_object >               vesting_withdrawal_id_type;
 
 
    typedef fc::ripemd160                                        block_id_type;
@@ -348,6 +355,8 @@ FC_REFLECT_ENUM( btcm::chain::impl_object_type,
                  (impl_vesting_delegation_expiration_object_type)
                  (impl_stream_report_request_object_type)
                  (impl_streaming_platform_user_object_type)
+                 (impl_friend_path_object_type)
+                 (impl_vesting_withdrawal_object_type)
                )
 
 FC_REFLECT_TYPENAME( btcm::chain::share_type )
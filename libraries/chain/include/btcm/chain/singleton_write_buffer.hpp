@@ -0,0 +1,92 @@
+#pragma once
+#include <graphene/db/object_database.hpp>
+
+namespace btcm { namespace chain {
+
+   /**
+    * @class singleton_write_buffer
+    * @brief Coalesces repeated modifications of a singleton object
+    *
+    * The dynamic global properties and the feed history are modified many times per block, and every
+    * call to object_database::modify() pays for the index lookup, the type erasure of the modifier and
+    * the undo / observer bookkeeping.
+    *
+    * Outside of a buffering scope modify() is simply forwarded to object_database::modify().  Inside a
+    * scope the modifier is applied to the object in place; undo state is saved only when the undo
+    * database revision has changed since the last buffered modification, and index observers are
+    * notified once when the outermost scope is flushed.  Since the object itself is modified, all
+    * references to it observe exactly the same values as with unbuffered modification, and a failed
+    * scope is rolled back by the enclosing undo session like any other change.
+    *
+    * This is only valid for objects in an index whose keys do not depend on the object contents and
+    * that has no secondary indexes, such as the simple_index used for the global property objects.
+    */
+   template<typename ObjectType>
+   class singleton_write_buffer
+   {
+      public:
+         template<typename Lambda>
+         void modify( graphene::db::object_database& db, const ObjectType& obj, const Lambda& m )
+         {
+            if( _depth == 0 )
+            {
+               db.modify( obj, m );
+               return;
+            }
+
+            const ObjectType* target = &obj;
+            if( target != _modified )
+            {
+               // obj may be a copy, always modify the object held by the index
+               target = &db.get<ObjectType>( obj.id );
+               if( target != _modified )
+               {
+                  flush( db );
+                  _modified = target;
+                  _undo_revision = db._undo_db.revision() - 1;
+               }
+            }
+            if( _undo_revision != db._undo_db.revision() )
+            {
+               db._undo_db.on_modify( *target );
+               _undo_revision = db._undo_db.revision();
+            }
+            m( const_cast<ObjectType&>( *target ) );
+         }
+
+         void begin() { ++_depth; }
+
+         /**
+          * Closes a buffering scope.  When the outermost scope is closed the observers of the modified
+          * object are notified, unless the scope was left by an exception, in which case the changes
+          * are left to the undo session that is about to be rolled back.
+          */
+         void end( graphene::db::object_database& db, bool notify )
+         {
+            FC_ASSERT( _depth > 0 );
+            if( --_depth > 0 )
+               return;
+            if( notify )
+               flush( db );
+            else
+               _modified = nullptr;
+         }
+
+         bool is_buffering()const { return _depth > 0; }
+
+      private:
+         void flush( graphene::db::object_database& db )
+         {
+            if( _modified == nullptr )
+               return;
+            const ObjectType* modified = _modified;
+            _modified = nullptr;
+            db.modify( *modified, []( ObjectType& ){} );
+         }
+
+         const ObjectType* _modified      = nullptr;
+         uint64_t          _undo_revision = 0;
+         uint32_t          _depth         = 0;
+   };
+
+} } // btcm::chain
@@ -2,6 +2,7 @@
 
 #include <btcm/chain/protocol/authority.hpp>
 #include <btcm/chain/protocol/types.hpp>
+#include <btcm/chain/account_name.hpp>
 #include <btcm/chain/protocol/base_operations.hpp>
 
 #include <graphene/db/generic_index.hpp>
@@ -19,7 +20,7 @@ namespace btcm { namespace chain {
          static const uint8_t type_id  = impl_streaming_platform_object_type;
 
          /** the account that has authority over this straming platform */
-         string          owner;
+         account_name_type owner;
          time_point_sec  created;
          string          url;
 
@@ -113,13 +114,13 @@ namespace btcm { namespace chain {
       streaming_platform_object,
       indexed_by<
          ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
-         ordered_unique< tag<by_name>, member<streaming_platform_object, string, &streaming_platform_object::owner> >,
+         ordered_unique< tag<by_name>, member<streaming_platform_object, account_name_type, &streaming_platform_object::owner> >,
          ordered_unique< tag<by_vote_name>,
             composite_key< streaming_platform_object,
                member<streaming_platform_object, share_type, &streaming_platform_object::votes >,
-               member<streaming_platform_object, string, &streaming_platform_object::owner >
+               member<streaming_platform_object, account_name_type, &streaming_platform_object::owner >
             >,
-            composite_key_compare< std::greater< share_type >, std::less< string > >
+            composite_key_compare< std::greater< share_type >, std::less< account_name_type > >
          >
       >
    > streaming_platform_multi_index_type;
@@ -4,13 +4,15 @@
 #include <btcm/chain/protocol/transaction.hpp>
 #include <graphene/db/index.hpp>
 #include <graphene/db/generic_index.hpp>
+#include <graphene/db/expiration_index.hpp>
 #include <fc/uint128.hpp>
+#include <fc/bloom_filter.hpp>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/member.hpp>
-#include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/mem_fun.hpp>
+
+#include <unordered_map>
 
 namespace btcm { namespace chain {
    using namespace graphene::db;
@@ -19,7 +21,10 @@ namespace btcm { namespace chain {
    /**
     * The purpose of this object is to enable the detection of duplicate transactions. When a transaction is included
     * in a block a transaction_object is added. At the end of block processing all transaction_objects that have
-    * expired can be removed from the index.
+    * expired are removed, see transaction_expiration_index.
+    *
+    * Only the id and the expiration are kept; database::get_recent_transaction() finds the transaction itself among
+    * the pending transactions or in the blocks of its expiration window.
     */
    class transaction_object : public abstract_object<transaction_object>
    {
@@ -27,25 +32,74 @@ namespace btcm { namespace chain {
          static const uint8_t space_id = implementation_ids;
          static const uint8_t type_id  = impl_transaction_object_type;
 
-         signed_transaction  trx;
          transaction_id_type trx_id;
-
-         time_point_sec get_expiration()const { return trx.expiration; }
+         time_point_sec      expiration;
    };
 
-   struct by_expiration;
-   struct by_id;
    struct by_trx_id;
    typedef multi_index_container<
       transaction_object,
       indexed_by<
-         ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
-         hashed_unique< tag<by_trx_id>, BOOST_MULTI_INDEX_MEMBER(transaction_object, transaction_id_type, trx_id), std::hash<transaction_id_type> >,
-         ordered_non_unique< tag<by_expiration>, const_mem_fun<transaction_object, time_point_sec, &transaction_object::get_expiration > >
+         hashed_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
+         hashed_unique< tag<by_trx_id>, BOOST_MULTI_INDEX_MEMBER(transaction_object, transaction_id_type, trx_id), std::hash<transaction_id_type> >
       >
    > transaction_multi_index_type;
 
    typedef generic_index<transaction_object, transaction_multi_index_type> transaction_index;
+   typedef expiration_index< transaction_object, member< transaction_object, time_point_sec, &transaction_object::expiration > > transaction_expiration_index;
+
+   /**
+    * A bloom filter of the trx_ids in the transaction_index, so that checking a new transaction for being a
+    * duplicate, which it almost never is, does not have to look it up in the index.
+    *
+    * Ids can't be taken out of a bloom filter, so the ids of removed transaction_objects stay in it until
+    * rebuild() refills it from the index.  That is due once more ids have been inserted than it was sized for.
+    *
+    * This is a secondary index on the transaction_index
+    */
+   class transaction_id_filter : public secondary_index
+   {
+      public:
+         transaction_id_filter();
+
+         virtual void object_inserted( const object& obj ) override;
+
+         /// @return false if there is no transaction_object of @p trx_id, true if there may be one
+         bool may_contain( const transaction_id_type& trx_id )const;
+
+         bool is_stale()const { return _inserted > _capacity; }
+         void rebuild( const transaction_index& idx );
+
+      private:
+         void reset( size_t capacity );
+
+         fc::bloom_filter  _filter;
+         size_t            _capacity = 0;
+         size_t            _inserted = 0;
+   };
+
+   /**
+    * The number of the block each transaction_object's transaction was applied in, so that
+    * database::get_recent_transaction() fetches a single block instead of searching the expiration window.
+    *
+    * This is not consensus state: the database records the block of a transaction once it applied it in one, and
+    * the entry goes away with the transaction_object when it expires or is undone.  Transactions restored by the
+    * undo database or loaded from disk have no entry.
+    *
+    * This is a secondary index on the transaction_index
+    */
+   class transaction_block_index : public secondary_index
+   {
+      public:
+         virtual void object_removed( const object& obj ) override;
+
+         void set_block_num( const transaction_id_type& trx_id, uint32_t block_num );
+         /// @return the number of the block @p trx_id was applied in, 0 if it is not known
+         uint32_t block_num( const transaction_id_type& trx_id )const;
+
+      private:
+         std::unordered_map< transaction_id_type, uint32_t > _block_nums;
+   };
 } }
 
-FC_REFLECT_DERIVED( btcm::chain::transaction_object, (graphene::db::object), (trx)(trx_id) )
+FC_REFLECT_DERIVED( btcm::chain::transaction_object, (graphene::db::object), (trx_id)(expiration) )
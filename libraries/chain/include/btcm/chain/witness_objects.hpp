@@ -2,6 +2,7 @@
  
 #include <btcm/chain/protocol/authority.hpp>
 #include <btcm/chain/protocol/types.hpp>
+#include <btcm/chain/account_name.hpp>
 #include <btcm/chain/protocol/base_operations.hpp>
 
 #include <graphene/db/generic_index.hpp>
@@ -25,7 +26,7 @@ namespace btcm { namespace chain {
          static const uint8_t type_id  = impl_witness_object_type;
 
          /** the account that has authority over this witness */
-         string          owner;
+         account_name_type owner;
          time_point_sec  created;
          string          url;
          uint32_t        total_missed = 0;
@@ -127,13 +128,13 @@ namespace btcm { namespace chain {
       indexed_by<
          ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
          ordered_non_unique< tag<by_work>, member<witness_object, digest_type, &witness_object::last_work> >,
-         ordered_unique< tag<by_name>, member<witness_object, string, &witness_object::owner> >,
+         ordered_unique< tag<by_name>, member<witness_object, account_name_type, &witness_object::owner> >,
          ordered_unique< tag<by_vote_name>,
             composite_key< witness_object,
                member<witness_object, share_type, &witness_object::votes >,
-               member<witness_object, string, &witness_object::owner >
+               member<witness_object, account_name_type, &witness_object::owner >
             >,
-            composite_key_compare< std::greater< share_type >, std::less< string > >
+            composite_key_compare< std::greater< share_type >, std::less< account_name_type > >
          >,
          ordered_unique< tag<by_schedule_time>,
             composite_key< witness_object,
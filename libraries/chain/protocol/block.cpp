@@ -39,6 +39,30 @@ namespace btcm { namespace chain {
       return signee() == expected_signee;
    }
 
+   block_id_type signed_block::id()const
+   {
+      return _serialization_cache.id( [this]() { return signed_block_header::id(); } );
+   }
+
+   size_t signed_block::packed_size()const
+   {
+      return _serialization_cache.packed_size( [this]() { return fc::raw::pack_size( *this ); } );
+   }
+
+   void signed_block::enable_serialization_cache()const
+   {
+      _serialization_cache.enable();
+      for( const auto& trx : transactions )
+         trx.enable_serialization_cache();
+   }
+
+   void signed_block::disable_serialization_cache()const
+   {
+      for( const auto& trx : transactions )
+         trx.disable_serialization_cache();
+      _serialization_cache.disable();
+   }
+
    checksum_type signed_block::calculate_merkle_root()const
    {
       if( transactions.size() == 0 )
@@ -16,9 +16,22 @@ using namespace graphene::db;
 
 digest_type signed_transaction::merkle_digest()const
 {
-   digest_type::encoder enc;
-   fc::raw::pack( enc, *this );
-   return enc.result();
+   return _serialization_cache.digest( [this]()
+   {
+      digest_type::encoder enc;
+      fc::raw::pack( enc, *this );
+      return enc.result();
+   } );
+}
+
+transaction_id_type signed_transaction::id()const
+{
+   return _serialization_cache.id( [this]() { return transaction::id(); } );
+}
+
+size_t signed_transaction::packed_size()const
+{
+   return _serialization_cache.packed_size( [this]() { return fc::raw::pack_size( *this ); } );
 }
 
 digest_type transaction::digest()const
@@ -0,0 +1,62 @@
+#include <btcm/chain/transaction_object.hpp>
+
+namespace btcm { namespace chain {
+
+/// the least number of ids the filter is sized for, and the chance of a false positive at that many
+static const size_t filter_min_capacity                = 10000;
+static const double filter_false_positive_probability  = 1.0 / 1000;
+
+transaction_id_filter::transaction_id_filter()
+{
+   reset( filter_min_capacity );
+}
+
+void transaction_id_filter::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const transaction_object*>(&obj) );
+   const transaction_id_type& trx_id = static_cast<const transaction_object&>(obj).trx_id;
+   _filter.insert( trx_id.data(), trx_id.data_size() );
+   ++_inserted;
+}
+
+bool transaction_id_filter::may_contain( const transaction_id_type& trx_id )const
+{
+   return _filter.contains( trx_id.data(), trx_id.data_size() );
+}
+
+void transaction_id_filter::rebuild( const transaction_index& idx )
+{
+   reset( std::max( filter_min_capacity, 2 * idx.indices().size() ) );
+   for( const auto& trx : idx.indices() )
+      object_inserted( trx );
+}
+
+void transaction_id_filter::reset( size_t capacity )
+{
+   fc::bloom_parameters param;
+   param.projected_element_count    = capacity;
+   param.false_positive_probability = filter_false_positive_probability;
+   param.compute_optimal_parameters();
+   _filter   = fc::bloom_filter( param );
+   _capacity = capacity;
+   _inserted = 0;
+}
+
+void transaction_block_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const transaction_object*>(&obj) );
+   _block_nums.erase( static_cast<const transaction_object&>(obj).trx_id );
+}
+
+void transaction_block_index::set_block_num( const transaction_id_type& trx_id, uint32_t block_num )
+{
+   _block_nums[ trx_id ] = block_num;
+}
+
+uint32_t transaction_block_index::block_num( const transaction_id_type& trx_id )const
+{
+   auto itr = _block_nums.find( trx_id );
+   return itr == _block_nums.end() ? 0 : itr->second;
+}
+
+} } // btcm::chain
@@ -0,0 +1,78 @@
+#include <graphene/db/expiration_index.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+namespace graphene { namespace db {
+
+   fc::time_point_sec base_expiration_index::next_expiration()const
+   {
+      return _buckets.empty() ? fc::time_point_sec::maximum() : _buckets.begin()->first;
+   }
+
+   bool base_expiration_index::get_due( fc::time_point_sec end, std::vector< object_id_type >& ids )
+   {
+      while( !_buckets.empty() && _buckets.begin()->first < end )
+      {
+         bucket& b = _buckets.begin()->second;
+         apply_removals( b );
+         if( !b.ids.empty() )
+         {
+            ids = b.ids;
+            return true;
+         }
+         _buckets.erase( _buckets.begin() );
+      }
+      return false;
+   }
+
+   size_t base_expiration_index::size()
+   {
+      size_t result = 0;
+      for( auto& item : _buckets )
+      {
+         apply_removals( item.second );
+         result += item.second.ids.size();
+      }
+      return result;
+   }
+
+   void base_expiration_index::add( object_id_type id, fc::time_point_sec expiration )
+   {
+      _buckets[ expiration ].ids.push_back( id );
+   }
+
+   void base_expiration_index::remove( object_id_type id, fc::time_point_sec expiration )
+   {
+      auto itr = _buckets.find( expiration );
+      if( itr == _buckets.end() )
+         return;
+
+      bucket& b = itr->second;
+      b.removed.push_back( id );
+      if( b.removed.size() * 2 >= b.ids.size() )
+      {
+         apply_removals( b );
+         if( b.ids.empty() )
+            _buckets.erase( itr );
+      }
+   }
+
+   void base_expiration_index::apply_removals( bucket& b )
+   {
+      std::sort( b.ids.begin(), b.ids.end() );
+      if( b.removed.empty() )
+         return;
+
+      // an id may be in both lists more than once if its object was restored by the undo database, so
+      // the lists are subtracted as multisets
+      std::sort( b.removed.begin(), b.removed.end() );
+      std::vector< object_id_type > remaining;
+      remaining.reserve( b.ids.size() );
+      std::set_difference( b.ids.begin(), b.ids.end(), b.removed.begin(), b.removed.end(),
+                           std::back_inserter( remaining ) );
+      b.ids.swap( remaining );
+      b.removed.clear();
+   }
+
+} } // graphene::db
@@ -0,0 +1,100 @@
+#pragma once
+#include <graphene/db/index.hpp>
+#include <fc/time.hpp>
+
+#include <map>
+#include <vector>
+
+namespace graphene { namespace db {
+
+   /**
+    * @class base_expiration_index
+    * @brief Buckets the objects of a primary index by the second they expire in
+    *
+    * An object is appended to the bucket of its second when it is inserted.  When it is removed before
+    * the bucket is due, its id is only noted in the bucket, and the removals are applied to the bucket
+    * in one pass once there are half as many of them as entries, or when the bucket is due.  This keeps
+    * inserting and removing objects constant time, and the expired objects of a second are found in
+    * bulk without searching an ordered index of the primary index.
+    *
+    * Buckets stay in place until all of their objects have been removed, so that the undo database can
+    * restore objects removed while expiring them like any other change.
+    */
+   class base_expiration_index : public secondary_index
+   {
+      public:
+         /// @return the first second any object expires in, time_point_sec::maximum() if none does
+         fc::time_point_sec next_expiration()const;
+
+         /**
+          * Finds the first bucket of a second before @p end that still has objects
+          * @param ids set to the ids of the objects of that bucket in ascending order
+          * @return false if there is no such bucket
+          */
+         bool get_due( fc::time_point_sec end, std::vector< object_id_type >& ids );
+
+         /// @return the number of objects in the buckets, which applies all pending removals
+         size_t size();
+
+      protected:
+         void add( object_id_type id, fc::time_point_sec expiration );
+         void remove( object_id_type id, fc::time_point_sec expiration );
+
+      private:
+         struct bucket
+         {
+            std::vector< object_id_type > ids;
+            std::vector< object_id_type > removed;
+         };
+
+         static void apply_removals( bucket& b );
+
+         std::map< fc::time_point_sec, bucket > _buckets;
+   };
+
+   /**
+    * @class expiration_index
+    * @brief A base_expiration_index of the objects of type Object
+    *
+    * GetExpiration is a key extractor returning the fc::time_point_sec an Object expires in, e.g.
+    * boost::multi_index::member< Object, fc::time_point_sec, &Object::expiration >.
+    */
+   template< typename Object, typename GetExpiration >
+   class expiration_index : public base_expiration_index
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override
+         {
+            add( obj.id, expiration_of( obj ) );
+         }
+
+         virtual void object_removed( const object& obj ) override
+         {
+            remove( obj.id, expiration_of( obj ) );
+         }
+
+         virtual void about_to_modify( const object& before ) override
+         {
+            _before = expiration_of( before );
+         }
+
+         virtual void object_modified( const object& after ) override
+         {
+            const fc::time_point_sec expiration = expiration_of( after );
+            if( expiration == _before )
+               return;
+            remove( after.id, _before );
+            add( after.id, expiration );
+         }
+
+      private:
+         static fc::time_point_sec expiration_of( const object& obj )
+         {
+            assert( dynamic_cast< const Object* >( &obj ) ); // for debug only
+            return GetExpiration()( static_cast< const Object& >( obj ) );
+         }
+
+         fc::time_point_sec _before;
+   };
+
+} } // graphene::db
@@ -93,6 +93,11 @@ namespace graphene { namespace db {
          virtual void open( const fc::path& db ) = 0;
          virtual void save( const fc::path& db ) = 0;
 
+         /**
+          *  Notifies secondary indexes of all objects loaded by open()
+          */
+         virtual void rebuild_secondary_indexes() {}
+
 
 
          /** @return the object with id or nullptr if not found */
@@ -162,9 +167,11 @@ namespace graphene { namespace db {
          void on_modify( const object& obj );
 
          template<typename T>
-         void add_secondary_index()
+         T* add_secondary_index()
          {
-            _sindex.emplace_back( new T() );
+            T* result = new T();
+            _sindex.emplace_back( result );
+            return result;
          }
 
          template<typename T>
@@ -178,9 +185,34 @@ namespace graphene { namespace db {
             FC_THROW_EXCEPTION( fc::assert_exception, "invalid index type" );
          }
 
+         /** @return true if the dense lookup table has been enabled, see primary_index::enable_dense_lookup() */
+         bool          has_dense_lookup()const { return _dense_lookup; }
+
+         /** @return the object with the given instance or nullptr, requires the dense lookup table */
+         const object* find_dense( uint64_t instance )const
+         {
+            return instance < _dense_objects.size() ? _dense_objects[instance] : nullptr;
+         }
+
       protected:
+         void dense_insert( const object& obj )
+         {
+            if( !_dense_lookup ) return;
+            const auto instance = obj.id.instance();
+            if( instance >= _dense_objects.size() ) _dense_objects.resize( instance + 1, nullptr );
+            _dense_objects[instance] = &obj;
+         }
+
+         void dense_remove( object_id_type id )
+         {
+            if( _dense_lookup && id.instance() < _dense_objects.size() )
+               _dense_objects[id.instance()] = nullptr;
+         }
+
          vector< shared_ptr<index_observer> >   _observers;
          vector< unique_ptr<secondary_index> >  _sindex;
+         vector< const object* >                _dense_objects;
+         bool                                   _dense_lookup = false;
 
       private:
          object_database& _db;
@@ -215,10 +247,15 @@ namespace graphene { namespace db {
 
          fc::sha256 get_object_version()const
          {
-            std::string desc = "1.0";//get_type_description<object_type>();
+            std::string desc = "1.1";//get_type_description<object_type>();
             return fc::sha256::hash(desc);
          }
 
+         /**
+          *  Decodes the objects directly from the mapped file.  Secondary indexes are not updated, so
+          *  that independent indexes can be opened concurrently; rebuild_secondary_indexes() must be
+          *  called once all indexes have been opened.
+          */
          virtual void open( const fc::path& db )override
          { 
             if( !fc::exists( db ) ) return;
@@ -226,18 +263,28 @@ namespace graphene { namespace db {
             fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size(db) );
             fc::datastream<const char*> ds( (const char*)mr.get_address(), mr.get_size() );
             fc::sha256 open_ver;
+            uint64_t   count = 0;
 
             fc::raw::unpack(ds, _next_id);
             fc::raw::unpack(ds, open_ver);
             FC_ASSERT( open_ver == get_object_version(), "Incompatible Version, the serialization of objects in this index has changed" );
-            try {
-               vector<char> tmp;
-               while( true ) 
-               {
-                  fc::raw::unpack( ds, tmp );
-                  load( tmp );
-               }
-            } catch ( const fc::exception&  ){}
+            fc::raw::unpack(ds, count);
+            for( uint64_t i = 0; i < count; ++i )
+            {
+               object_type obj;
+               fc::raw::unpack( ds, obj );
+               dense_insert( DerivedIndex::insert( std::move( obj ) ) );
+            }
+            FC_ASSERT( ds.remaining() == 0, "Unexpected data at the end of the index file", ("file",db) );
+         }
+
+         virtual void rebuild_secondary_indexes()override
+         {
+            if( _sindex.empty() ) return;
+            this->inspect_all_objects( [this]( const object& o ) {
+               for( const auto& item : _sindex )
+                  item->object_inserted( o );
+            });
          }
 
          virtual void save( const fc::path& db ) override 
@@ -246,12 +293,18 @@ namespace graphene { namespace db {
                                std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
             FC_ASSERT( out );
             auto ver  = get_object_version();
+            uint64_t count = 0;
+            this->inspect_all_objects( [&count]( const object& ) { ++count; } );
             fc::raw::pack( out, _next_id );
             fc::raw::pack( out, ver );
-            this->inspect_all_objects( [&out]( const object& o ) {
-                auto vec = fc::raw::pack_to_vector( static_cast<const object_type&>(o) );
-                auto packed_vec = fc::raw::pack_to_vector( vec );
-                out.write( packed_vec.data(), packed_vec.size() );
+            fc::raw::pack( out, count );
+            vector<char> buffer;
+            this->inspect_all_objects( [&out,&buffer]( const object& o ) {
+                const auto& obj = static_cast<const object_type&>(o);
+                buffer.resize( fc::raw::pack_size( obj ) );
+                fc::datastream<char*> ds( buffer.data(), buffer.size() );
+                fc::raw::pack( ds, obj );
+                out.write( buffer.data(), buffer.size() );
             });
          }
 
@@ -260,15 +313,25 @@ namespace graphene { namespace db {
             const auto& result = DerivedIndex::insert( fc::raw::unpack_from_vector<object_type>( data ) );
             for( const auto& item : _sindex )
                item->object_inserted( result );
+            dense_insert( result );
             return result;
          }
 
+         virtual const object&  insert( object&& obj )override
+         {
+            const auto& result = DerivedIndex::insert( std::move( obj ) );
+            for( const auto& item : _sindex )
+               item->object_inserted( result );
+            dense_insert( result );
+            return result;
+         }
 
          virtual const object&  create(const std::function<void(object&)>& constructor )override
          {
             const auto& result = DerivedIndex::create( constructor );
             for( const auto& item : _sindex )
                item->object_inserted( result );
+            dense_insert( result );
             on_add( result );
             return result;
          }
@@ -278,6 +341,7 @@ namespace graphene { namespace db {
             for( const auto& item : _sindex )
                item->object_removed( obj );
             on_remove(obj);
+            dense_remove( obj.id );
             DerivedIndex::remove(obj);
          }
 
@@ -286,12 +350,33 @@ namespace graphene { namespace db {
             save_undo( obj );
             for( const auto& item : _sindex )
                item->about_to_modify( obj );
-            DerivedIndex::modify( obj, m );
+            const object_id_type id = obj.id;
+            try {
+               DerivedIndex::modify( obj, m );
+            } catch( ... ) {
+               // a modification that violates an index constraint erases the object
+               if( DerivedIndex::find( id ) == nullptr )
+                  dense_remove( id );
+               throw;
+            }
             for( const auto& item : _sindex )
                item->object_modified( obj );
             on_modify( obj );
          }
 
+         /**
+          *  Maintains a table from instance number to object, so that object_database::get() and find()
+          *  can resolve ids of this index with an array access instead of a search of the derived index.
+          *  Since instances are allocated sequentially the table stays dense as long as few objects are
+          *  removed.  The derived index must never move its objects in memory, so this is not valid for
+          *  flat_index.
+          */
+         void enable_dense_lookup()
+         {
+            _dense_lookup = true;
+            this->inspect_all_objects( [this]( const object& o ) { dense_insert( o ); } );
+         }
+
          virtual void add_observer( const shared_ptr<index_observer>& o ) override
          {
             _observers.emplace_back( o );
@@ -42,7 +42,7 @@ namespace graphene { namespace db {
          object_database();
          ~object_database();
 
-         void reset_indexes() { _index.clear(); _index.resize(255); }
+         void reset_indexes() { _index.clear(); _index.resize(255); _primary_index.clear(); _primary_index.resize(255); }
 
          void open(const fc::path& data_dir );
 
@@ -109,14 +109,22 @@ namespace graphene { namespace db {
          template<typename T>
          const T& get( object_id_type id )const
          {
-            const object& obj = get_object( id );
-            assert( nullptr != dynamic_cast<const T*>(&obj) );
-            return static_cast<const T&>(obj);
+            const object* obj;
+            if( const base_primary_index* dense = get_dense_index( id ) )
+            {
+               obj = dense->find_dense( id.instance() );
+               FC_ASSERT( obj != nullptr, "Unable to find Object", ("id",id) );
+            }
+            else
+               obj = &get_object( id );
+            assert( nullptr != dynamic_cast<const T*>(obj) );
+            return static_cast<const T&>(*obj);
          }
          template<typename T>
          const T* find( object_id_type id )const
          {
-            const object* obj = find_object( id );
+            const base_primary_index* dense = get_dense_index( id );
+            const object* obj = dense ? dense->find_dense( id.instance() ) : find_object( id );
             assert(  !obj || nullptr != dynamic_cast<const T*>(obj) );
             return static_cast<const T*>(obj);
          }
@@ -135,9 +143,12 @@ namespace graphene { namespace db {
                 _index[ObjectType::space_id].resize( 255 );
             assert(!_index[ObjectType::space_id][ObjectType::type_id]);
             FC_ASSERT(!_index[ObjectType::space_id][ObjectType::type_id], "duplicate index id detected");
-            unique_ptr<index> indexptr( new IndexType(*this) );
-            _index[ObjectType::space_id][ObjectType::type_id] = std::move(indexptr);
-            return static_cast<IndexType*>(_index[ObjectType::space_id][ObjectType::type_id].get());
+            IndexType* result = new IndexType(*this);
+            _index[ObjectType::space_id][ObjectType::type_id] = unique_ptr<index>( result );
+            if( _primary_index[ObjectType::space_id].size() <= ObjectType::type_id )
+                _primary_index[ObjectType::space_id].resize( 255, nullptr );
+            _primary_index[ObjectType::space_id][ObjectType::type_id] = as_primary_index( result );
+            return result;
          }
 
          void pop_undo();
@@ -158,6 +169,17 @@ namespace graphene { namespace db {
          index& get_mutable_index(uint8_t space_id, uint8_t type_id);
 
      private:
+         /** @return the primary index holding id if it has a dense lookup table, nullptr otherwise */
+         const base_primary_index* get_dense_index( object_id_type id )const
+         {
+            if( id.space() >= _primary_index.size() || id.type() >= _primary_index[id.space()].size() )
+               return nullptr;
+            const base_primary_index* result = _primary_index[id.space()][id.type()];
+            return result != nullptr && result->has_dense_lookup() ? result : nullptr;
+         }
+
+         static const base_primary_index* as_primary_index( const base_primary_index* idx ) { return idx; }
+         static const base_primary_index* as_primary_index( const void* )                  { return nullptr; }
 
          friend class base_primary_index;
          friend class undo_database;
@@ -167,6 +189,8 @@ namespace graphene { namespace db {
 
          fc::path                                                  _data_dir;
          vector< vector< unique_ptr<index> > >                     _index;
+         /** non-owning, the base_primary_index of each entry of _index or nullptr */
+         vector< vector< const base_primary_index* > >             _primary_index;
    };
 
 } } // graphene::db
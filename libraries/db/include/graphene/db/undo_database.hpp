@@ -132,6 +132,13 @@ namespace graphene { namespace db {
 
          const undo_state& head()const;
 
+         /**
+          *  Changes whenever the undo state that receives new changes may have changed, i.e. when a
+          *  session is started, undone, merged or committed, or undo is enabled or disabled.  Callers
+          *  that modify an object repeatedly can skip on_modify() as long as the revision is unchanged.
+          */
+         uint64_t revision()const { return _revision; }
+
       private:
          void undo();
          void merge();
@@ -143,6 +150,7 @@ namespace graphene { namespace db {
          std::deque<undo_state>  _stack;
          object_database&        _db;
          size_t                  _max_size = 256;
+         uint64_t                _revision = 0;
    };
 
 } } // graphene::db
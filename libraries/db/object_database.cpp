@@ -25,6 +25,7 @@
 
 #include <fc/io/raw.hpp>
 #include <fc/container/flat.hpp>
+#include <fc/thread/parallel.hpp>
 #include <fc/uint128.hpp>
 
 namespace graphene { namespace db {
@@ -33,6 +34,7 @@ object_database::object_database()
 :_undo_db(*this)
 {
    _index.resize(255);
+   _primary_index.resize(255);
    _undo_db.enable();
 }
 
@@ -104,10 +106,36 @@ void object_database::open(const fc::path& data_dir)
        return;
    }
    ilog("Opening object database from ${d} ...", ("d", data_dir));
+
+   // indexes are independent of each other, load them on the worker pool
+   vector< fc::future<void> > loading;
+   for( uint32_t space = 0; space < _index.size(); ++space )
+      for( uint32_t type = 0; type  < _index[space].size(); ++type )
+         if( _index[space][type] )
+         {
+            index* idx = _index[space][type].get();
+            fc::path file = _data_dir / "object_database" / fc::to_string(space)/fc::to_string(type);
+            loading.push_back( fc::do_parallel( [idx,file]() { idx->open( file ); } ) );
+         }
+
+   // wait for all tasks before rethrowing, they reference the indexes
+   fc::exception_ptr failure;
+   for( auto& f : loading )
+   {
+      try {
+         f.wait();
+      } catch( const fc::exception& e ) {
+         if( !failure ) failure = e.dynamic_copy_exception();
+      }
+   }
+   if( failure )
+      failure->dynamic_rethrow_exception();
+
    for( uint32_t space = 0; space < _index.size(); ++space )
       for( uint32_t type = 0; type  < _index[space].size(); ++type )
          if( _index[space][type] )
-            _index[space][type]->open( _data_dir / "object_database" / fc::to_string(space)/fc::to_string(type) );
+            _index[space][type]->rebuild_secondary_indexes();
+   ilog("Done opening object database.");
 } FC_CAPTURE_AND_RETHROW( (data_dir) ) }
 
 
@@ -27,8 +27,8 @@
 
 namespace graphene { namespace db {
 
-void undo_database::enable()  { _disabled = false; }
-void undo_database::disable() { _disabled = true; }
+void undo_database::enable()  { _disabled = false; ++_revision; }
+void undo_database::disable() { _disabled = true; ++_revision; }
 
 undo_database::session undo_database::start_undo_session( bool force_enable )
 {
@@ -42,6 +42,7 @@ undo_database::session undo_database::start_undo_session( bool force_enable )
 
    _stack.emplace_back();
    ++_active_sessions;
+   ++_revision;
    return session(*this, disable_on_exit );
 }
 void undo_database::on_create( const object& obj )
@@ -49,7 +50,10 @@ void undo_database::on_create( const object& obj )
    if( _disabled ) return;
 
    if( _stack.empty() )
+   {
       _stack.emplace_back();
+      ++_revision;
+   }
    auto& state = _stack.back();
    auto index_id = object_id_type( obj.id.space(), obj.id.type(), 0 );
    auto itr = state.old_index_next_ids.find( index_id );
@@ -62,7 +66,10 @@ void undo_database::on_modify( const object& obj )
    if( _disabled ) return;
 
    if( _stack.empty() )
+   {
       _stack.emplace_back();
+      ++_revision;
+   }
    auto& state = _stack.back();
    if( state.new_ids.find(obj.id) != state.new_ids.end() )
       return;
@@ -75,7 +82,10 @@ void undo_database::on_remove( const object& obj )
    if( _disabled ) return;
 
    if( _stack.empty() )
+   {
       _stack.emplace_back();
+      ++_revision;
+   }
    undo_state& state = _stack.back();
    if( state.new_ids.count(obj.id) )
    {
@@ -114,6 +124,7 @@ void undo_database::rollback_state()
       _db.insert( std::move(*item.second) );
 
    _stack.pop_back();
+   ++_revision;
 } FC_CAPTURE_AND_RETHROW() }
 
 void undo_database::undo()
@@ -129,6 +140,7 @@ void undo_database::undo()
 void undo_database::merge()
 {
    FC_ASSERT( _active_sessions > 0 );
+   ++_revision;
    if( _active_sessions == 1 && _stack.size() == 1 )
    {
       _stack.pop_back();
@@ -244,6 +256,7 @@ void undo_database::commit()
 {
    FC_ASSERT( _active_sessions > 0 );
    --_active_sessions;
+   ++_revision;
 }
 
 void undo_database::pop_commit()
@@ -1,5 +1,6 @@
 #pragma once
 #include <fc/io/raw_fwd.hpp>
+#include <fc/exception/exception.hpp>
 
 
 namespace fc {
@@ -12,6 +13,9 @@ namespace fc {
     *  The string will serialize the same way as std::string for variant and raw formats
     *  The string will sort according to the comparison operators defined for Storage, this enables effecient
     *  sorting.
+    *
+    *  Strings longer than sizeof(Storage) are rejected rather than truncated, so that two different strings
+    *  never compare equal.
     */
    template<typename Storage = std::pair<uint64_t,uint64_t> >
    class fixed_string {
@@ -20,19 +24,13 @@ namespace fc {
          fixed_string( const fixed_string& c ):data(c.data){}
 
          fixed_string( const std::string& str ) {
-            if( str.size() <= sizeof(data) )
-               memcpy( (char*)&data, str.c_str(), str.size() );
-            else {
-               memcpy( (char*)&data, str.c_str(), sizeof(data) );
-            }
+            FC_ASSERT( str.size() <= sizeof(data), "String is too long", ("str",str)("max_size",sizeof(data)) );
+            memcpy( (char*)&data, str.c_str(), str.size() );
          }
          fixed_string( const char* str ) {
             auto l = strlen(str);
-            if( l <= sizeof(data) )
-               memcpy( (char*)&data, str, l );
-            else {
-               memcpy( (char*)&data, str, sizeof(data) );
-            }
+            FC_ASSERT( l <= sizeof(data), "String is too long", ("str",str)("max_size",sizeof(data)) );
+            memcpy( (char*)&data, str, l );
          }
 
          operator std::string()const {
@@ -56,14 +54,7 @@ namespace fc {
          }
 
          fixed_string& operator=( const std::string& str ) {
-            if( str.size() <= sizeof(data) ) {
-               data = Storage();
-               memcpy( (char*)&data, str.c_str(), str.size() );
-            }
-            else {
-               memcpy( (char*)&data, str.c_str(), sizeof(data) );
-            }
-            return *this;
+            return *this = fixed_string(str);
          }
 
          friend std::string operator + ( const fixed_string& a, const std::string& b ) {
@@ -98,7 +89,7 @@ namespace fc {
   namespace raw
   {
     template<typename Stream, typename Storage>
-    inline void pack( Stream& s, const fc::fixed_string<Storage>& u, uint32_t _max_depth=FC_PACK_MAX_DEPTH ) {
+    inline void pack( Stream& s, const fc::fixed_string<Storage>& u, uint32_t _max_depth ) {
        FC_ASSERT( _max_depth > 0 );
        unsigned_int size = u.size();
        pack( s, size, _max_depth - 1 );
@@ -106,25 +97,14 @@ namespace fc {
     }
 
     template<typename Stream, typename Storage>
-    inline void unpack( Stream& s, fc::fixed_string<Storage>& u, uint32_t _max_depth=FC_PACK_MAX_DEPTH ) {
+    inline void unpack( Stream& s, fc::fixed_string<Storage>& u, uint32_t _max_depth ) {
        FC_ASSERT( _max_depth > 0 );
+       u.data = Storage();
        unsigned_int size;
        fc::raw::unpack( s, size, _max_depth - 1 );
-       if( size.value > 0 ) {
-          if( size.value > sizeof(Storage) ) {
-             s.read( (char*)&u.data, sizeof(Storage) );
-             char buf[1024];
-             size_t left = size.value - sizeof(Storage);
-             while( left >= 1024 )
-             {
-                s.read( buf, 1024 );
-                left -= 1024;
-             }
-             s.read( buf, left );
-          } else {
-             s.read( (char*)&u.data, size.value );
-          }
-       }
+       FC_ASSERT( size.value <= sizeof(Storage), "String is too long", ("size",size.value)("max_size",sizeof(Storage)) );
+       if( size.value > 0 )
+          s.read( (char*)&u.data, size.value );
     }
   }
 }
@@ -0,0 +1,305 @@
+#pragma once
+#include <fc/io/json.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/container/flat_fwd.hpp>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fc
+{
+   /**
+    *  Writes JSON straight into a string, producing the same text as fc::json::to_string does for
+    *  the fc::variant of a value.
+    *
+    *  Values are written with to_json(), which walks reflected types by their FC_REFLECT metadata
+    *  instead of building a variant tree first.  Types that define their own to_variant() are still
+    *  converted through a variant, but only that value is, not the objects containing it.
+    */
+   class json_writer
+   {
+      public:
+         explicit json_writer( std::string& out, json::output_formatting format = json::stringify_large_ints_and_doubles )
+            : _out( out ), _format( format ) {}
+
+         void write_null()            { _out.append( "null", 4 ); }
+         void write( bool b )         { b ? _out.append( "true", 4 ) : _out.append( "false", 5 ); }
+         void write( int64_t i );
+         void write( uint64_t u );
+         void write( double d );
+         void write( const char* str, size_t len );
+         void write( const std::string& str ) { write( str.data(), str.size() ); }
+         void write( const variant& v, uint32_t max_depth );
+         void write( const variant_object& o, uint32_t max_depth );
+         void write( const variants& a, uint32_t max_depth );
+
+         void begin_object() { _out.push_back( '{' ); }
+         void end_object()   { _out.push_back( '}' ); }
+         void begin_array()  { _out.push_back( '[' ); }
+         void end_array()    { _out.push_back( ']' ); }
+         void separator()    { _out.push_back( ',' ); }
+
+         /// Writes the key of an object member, which must not need escaping
+         void key( const char* name )
+         {
+            _out.push_back( '"' );
+            _out.append( name );
+            _out.append( "\":", 2 );
+         }
+         void key( const std::string& name )
+         {
+            write( name );
+            _out.push_back( ':' );
+         }
+
+         std::string& buffer() { return _out; }
+         json::output_formatting format()const { return _format; }
+
+      private:
+         std::string&                _out;
+         json::output_formatting     _format;
+   };
+
+   inline void to_json( const bool& b, json_writer& w, uint32_t max_depth = 1 )     { w.write( b ); }
+   inline void to_json( const int8_t& i, json_writer& w, uint32_t max_depth = 1 )   { w.write( int64_t( i ) ); }
+   inline void to_json( const int16_t& i, json_writer& w, uint32_t max_depth = 1 )  { w.write( int64_t( i ) ); }
+   inline void to_json( const int32_t& i, json_writer& w, uint32_t max_depth = 1 )  { w.write( int64_t( i ) ); }
+   inline void to_json( const int64_t& i, json_writer& w, uint32_t max_depth = 1 )  { w.write( i ); }
+   inline void to_json( const uint8_t& u, json_writer& w, uint32_t max_depth = 1 )  { w.write( uint64_t( u ) ); }
+   inline void to_json( const uint16_t& u, json_writer& w, uint32_t max_depth = 1 ) { w.write( uint64_t( u ) ); }
+   inline void to_json( const uint32_t& u, json_writer& w, uint32_t max_depth = 1 ) { w.write( uint64_t( u ) ); }
+   inline void to_json( const uint64_t& u, json_writer& w, uint32_t max_depth = 1 ) { w.write( u ); }
+   inline void to_json( const double& d, json_writer& w, uint32_t max_depth = 1 )   { w.write( d ); }
+   inline void to_json( const float& f, json_writer& w, uint32_t max_depth = 1 )    { w.write( double( f ) ); }
+   inline void to_json( const std::string& s, json_writer& w, uint32_t max_depth = 1 ) { w.write( s ); }
+   inline void to_json( const variant& v, json_writer& w, uint32_t max_depth )      { w.write( v, max_depth ); }
+   inline void to_json( const variant_object& o, json_writer& w, uint32_t max_depth )
+   {
+      _FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+      w.write( o, max_depth - 1 );
+   }
+   /// hex encoded like its variant
+   inline void to_json( const std::vector<char>& data, json_writer& w, uint32_t max_depth = 1 )
+   {
+      w.write( variant( data, max_depth ), max_depth );
+   }
+
+   template<typename T>
+   void to_json( const T& v, json_writer& w, uint32_t max_depth );
+
+   template<typename T>
+   void to_json( const optional<T>& v, json_writer& w, uint32_t max_depth )
+   {
+      _FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+      if( v.valid() )
+         to_json( *v, w, max_depth - 1 );
+      else
+         w.write_null();
+   }
+
+   template<typename T>
+   void to_json( const std::shared_ptr<T>& v, json_writer& w, uint32_t max_depth )
+   {
+      if( v )
+      {
+         _FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+         to_json( *v, w, max_depth - 1 );
+      }
+      else
+         w.write_null();
+   }
+
+   template<typename A, typename B>
+   void to_json( const std::pair<A,B>& p, json_writer& w, uint32_t max_depth )
+   {
+      _FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+      w.begin_array();
+      to_json( p.first, w, max_depth - 1 );
+      w.separator();
+      to_json( p.second, w, max_depth - 1 );
+      w.end_array();
+   }
+
+   namespace detail
+   {
+      template<typename Container>
+      void container_to_json( const Container& c, json_writer& w, uint32_t max_depth )
+      {
+         _FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+         w.begin_array();
+         bool first = true;
+         for( const auto& item : c )
+         {
+            if( !first )
+               w.separator();
+            first = false;
+            to_json( item, w, max_depth - 1 );
+         }
+         w.end_array();
+      }
+   }
+
+   template<typename T>
+   void to_json( const std::vector<T>& v, json_writer& w, uint32_t max_depth ) { detail::container_to_json( v, w, max_depth ); }
+   template<typename T>
+   void to_json( const std::deque<T>& v, json_writer& w, uint32_t max_depth )  { detail::container_to_json( v, w, max_depth ); }
+   template<typename T>
+   void to_json( const std::set<T>& v, json_writer& w, uint32_t max_depth )    { detail::container_to_json( v, w, max_depth ); }
+   template<typename T, typename... A>
+   void to_json( const flat_set<T, A...>& v, json_writer& w, uint32_t max_depth ) { detail::container_to_json( v, w, max_depth ); }
+   template<typename K, typename T>
+   void to_json( const std::map<K,T>& v, json_writer& w, uint32_t max_depth )  { detail::container_to_json( v, w, max_depth ); }
+   template<typename K, typename T>
+   void to_json( const std::multimap<K,T>& v, json_writer& w, uint32_t max_depth ) { detail::container_to_json( v, w, max_depth ); }
+   template<typename K, typename... T>
+   void to_json( const flat_map<K,T...>& v, json_writer& w, uint32_t max_depth ) { detail::container_to_json( v, w, max_depth ); }
+
+   /// maps keyed by strings are objects, like their variant_object
+   template<typename T>
+   void to_json( const std::map<string,T>& v, json_writer& w, uint32_t max_depth )
+   {
+      _FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+      w.begin_object();
+      bool first = true;
+      for( const auto& item : v )
+      {
+         if( !first )
+            w.separator();
+         first = false;
+         w.key( item.first );
+         to_json( item.second, w, max_depth - 1 );
+      }
+      w.end_object();
+   }
+
+   namespace detail
+   {
+      namespace to_variant_probe
+      {
+         struct probe_result {};
+
+         /**
+          * Exactly as specialized as the to_variant() template of fc/reflect/variant.hpp, so a call that
+          * would pick that template is ambiguous here.  A call that picks a to_variant() written for the
+          * type is not.  Never defined, only used in unevaluated context.
+          */
+         template<typename T>
+         probe_result to_variant( const T&, fc::variant&, uint32_t );
+
+         template<typename T>
+         struct uses_reflected_to_variant
+         {
+            template<typename U>
+            static std::false_type test( decltype( to_variant( std::declval<const U&>(), std::declval<fc::variant&>(), uint32_t() ) )* );
+            template<typename U>
+            static std::true_type test( ... );
+
+            static const bool value = decltype( test<T>( nullptr ) )::value;
+         };
+      }
+
+      /// True if T is reflected and converted to a variant by its FC_REFLECT metadata
+      template<typename T>
+      struct is_reflected_for_json
+      {
+         static const bool value = fc::reflector<T>::is_defined::value && to_variant_probe::uses_reflected_to_variant<T>::value;
+      };
+
+      template<typename T>
+      class to_json_visitor
+      {
+         public:
+            to_json_visitor( json_writer& w, const T& v, uint32_t max_depth )
+            : _writer( w ), _val( v ), _max_depth( max_depth - 1 ), _first( true ) {
+               _FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+            }
+
+            template<typename Member, class Class, Member (Class::*member)>
+            void operator()( const char* name )const
+            {
+               this->add( name, ( _val.*member ) );
+            }
+
+         private:
+            template<typename M>
+            void add( const char* name, const optional<M>& v )const
+            {
+               if( v.valid() )
+                  add( name, *v );
+            }
+            template<typename M>
+            void add( const char* name, const M& v )const
+            {
+               if( !_first )
+                  _writer.separator();
+               _first = false;
+               _writer.key( name );
+               to_json( v, _writer, _max_depth );
+            }
+
+            json_writer&   _writer;
+            const T&       _val;
+            const uint32_t _max_depth;
+            mutable bool   _first;
+      };
+
+      template<bool Reflected, typename IsEnum>
+      struct to_json_impl
+      {
+         template<typename T>
+         static void write( const T& v, json_writer& w, uint32_t max_depth )
+         {
+            w.write( variant( v, max_depth ), max_depth );
+         }
+      };
+
+      template<>
+      struct to_json_impl<true, fc::false_type>
+      {
+         template<typename T>
+         static void write( const T& v, json_writer& w, uint32_t max_depth )
+         {
+            w.begin_object();
+            fc::reflector<T>::visit( to_json_visitor<T>( w, v, max_depth ) );
+            w.end_object();
+         }
+      };
+
+      template<>
+      struct to_json_impl<true, fc::true_type>
+      {
+         template<typename T>
+         static void write( const T& v, json_writer& w, uint32_t max_depth )
+         {
+            w.write( fc::reflector<T>::to_fc_string( v ) );
+         }
+      };
+   } // namespace detail
+
+   /**
+    *  Reflected types without a to_variant() of their own are written member by member, reflected
+    *  enums by name; everything else is written through its variant.
+    */
+   template<typename T>
+   void to_json( const T& v, json_writer& w, uint32_t max_depth )
+   {
+      detail::to_json_impl< detail::is_reflected_for_json<T>::value, typename fc::reflector<T>::is_enum >::write( v, w, max_depth );
+   }
+
+   /// Returns the same string as fc::json::to_string( fc::variant( v, max_depth ), format, max_depth )
+   template<typename T>
+   std::string to_json_string( const T& v, json::output_formatting format = json::stringify_large_ints_and_doubles, uint32_t max_depth = 200 )
+   {
+      std::string result;
+      json_writer w( result, format );
+      to_json( v, w, max_depth );
+      return result;
+   }
+
+} // fc
@@ -2,7 +2,10 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include <fc/any.hpp>
+#include <fc/optional.hpp>
+#include <fc/variant.hpp>
 #include <fc/network/ip.hpp>
 #include <fc/signals.hpp>
 
@@ -19,12 +22,43 @@ namespace fc { namespace http {
       public:
          virtual ~websocket_connection(){}
          virtual void send_message( const std::string& message ) = 0;
+         /// sends a binary frame, which arrives at the other end's message handler like a text frame
+         virtual void send_binary_message( const std::vector<char>& message ) = 0;
          virtual void close( int64_t code, const std::string& reason  ){};
          void on_message( const std::string& message ) { _on_message(message); }
          string on_http( const std::string& message ) { return _on_http(message); }
 
+         /// @param parsed the result of parse_message(), the message is passed on unparsed if there is none
+         void on_message( const std::string& message, const fc::optional<fc::variant>& parsed )
+         {
+            if( parsed && _on_parsed_message ) _on_parsed_message( message, *parsed );
+            else _on_message( message );
+         }
+         string on_http( const std::string& message, const fc::optional<fc::variant>& parsed )
+         {
+            if( parsed && _on_parsed_http ) return _on_parsed_http( message, *parsed );
+            return _on_http( message );
+         }
+
+         /**
+          * Servers call this on the I/O thread that received a message, so that the thread the connection
+          * was accepted on only has to handle the parsed message.
+          * @return nothing if there is no parse handler or the message doesn't parse; the message handlers
+          *         then get the raw message and report the error
+          */
+         fc::optional<fc::variant> parse_message( const std::string& message )const
+         {
+            if( !_parse ) return fc::optional<fc::variant>();
+            try { return _parse( message ); }
+            catch( ... ) { return fc::optional<fc::variant>(); }
+         }
+
          void on_message_handler( const std::function<void(const std::string&)>& h ) { _on_message = h; }
          void on_http_handler( const std::function<std::string(const std::string&)>& h ) { _on_http = h; }
+         /// The parse handler must be safe to call from any thread, the other handlers are set before messages arrive
+         void on_parse_handler( const std::function<fc::variant(const std::string&)>& h ) { _parse = h; }
+         void on_parsed_message_handler( const std::function<void(const std::string&, const fc::variant&)>& h ) { _on_parsed_message = h; }
+         void on_parsed_http_handler( const std::function<std::string(const std::string&, const fc::variant&)>& h ) { _on_parsed_http = h; }
 
          void     set_session_data( fc::any d ){ _session_data = std::move(d); }
          fc::any& get_session_data() { return _session_data; }
@@ -36,15 +70,26 @@ namespace fc { namespace http {
          fc::any                                   _session_data;
          std::function<void(const std::string&)>   _on_message;
          std::function<string(const std::string&)> _on_http;
+         std::function<fc::variant(const std::string&)>                   _parse;
+         std::function<void(const std::string&, const fc::variant&)>     _on_parsed_message;
+         std::function<string(const std::string&, const fc::variant&)>   _on_parsed_http;
    };
    typedef std::shared_ptr<websocket_connection> websocket_connection_ptr;
 
    typedef std::function<void(const websocket_connection_ptr&)> on_connection_handler;
 
+   /**
+    * Socket I/O, the TLS handshake and parsing of incoming messages run on the server's I/O threads.  With
+    * io_threads > 0 the server runs its own io_service on that many threads, and websocketpp serializes the
+    * handlers of each connection, so connections are spread over the threads while every single one is
+    * handled by one thread at a time.  With io_threads == 0 the server shares fc::asio::default_io_service().
+    *
+    * Connection handlers and parsed messages are passed to the thread that constructed the server.
+    */
    class websocket_server
    {
       public:
-         websocket_server();
+         explicit websocket_server( uint16_t io_threads = 0 );
          ~websocket_server();
 
          void on_connection( const on_connection_handler& handler);
@@ -61,8 +106,10 @@ namespace fc { namespace http {
    class websocket_tls_server
    {
       public:
+         /// @param io_threads see websocket_server
          websocket_tls_server( const std::string& server_pem = std::string(),
-                           const std::string& ssl_password = std::string());
+                           const std::string& ssl_password = std::string(),
+                           uint16_t io_threads = 0 );
          ~websocket_tls_server();
 
          void on_connection( const on_connection_handler& handler);
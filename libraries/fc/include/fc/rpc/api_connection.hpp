@@ -3,6 +3,12 @@
 #include <fc/optional.hpp>
 #include <fc/api.hpp>
 #include <fc/any.hpp>
+#include <fc/io/json_writer.hpp>
+#include <fc/io/datastream.hpp>
+// fc/io/raw.hpp is left to the translation units that register APIs, overloads of fc::raw::pack for the
+// types of their methods have to be declared before it
+#include <fc/io/raw_fwd.hpp>
+#include <fc/io/raw_variant.hpp>
 #include <memory>
 #include <vector>
 #include <functional>
@@ -12,6 +18,22 @@
 namespace fc {
    class api_connection;
 
+   /**
+    * Packs the result of a method for the binary protocol, see fc::rpc::binary_api_connection.  Results are
+    * packed with fc::raw unless an overload next to their type, found by argument dependent lookup, says otherwise.
+    */
+   template<typename T>
+   void to_binary( const T& v, std::vector<char>& result, uint32_t max_depth )
+   {
+      result = fc::raw::pack_to_vector( v, max_depth );
+   }
+
+   template<typename T>
+   void from_binary( const std::vector<char>& packed, T& v, uint32_t max_depth )
+   {
+      fc::raw::unpack_from_vector( packed, v, max_depth );
+   }
+
    namespace detail {
       template<typename Signature>
       class callback_functor
@@ -100,6 +122,12 @@ namespace fc {
    class generic_api
    {
       public:
+         typedef std::function<variant(const variants&)>            method;
+         /// writes the result of the method as JSON, see fc::json_writer
+         typedef std::function<void(const variants&, json_writer&)> json_method;
+         /// unpacks the arguments and packs the result with fc::raw, only built for a binary api_connection, see fc::rpc::binary_api_connection
+         typedef std::function<void(fc::datastream<const char*>&, std::vector<char>&)> binary_method;
+
          template<typename Api>
          generic_api( const Api& a, const std::shared_ptr<fc::api_connection>& c );
 
@@ -118,6 +146,32 @@ namespace fc {
             return _methods[method_id](args);
          }
 
+         void call( const string& name, const variants& args, json_writer& result )
+         {
+            auto itr = _by_name.find(name);
+            FC_ASSERT( itr != _by_name.end(), "no method with name '${name}'", ("name",name)("api",_by_name) );
+            call( itr->second, args, result );
+         }
+
+         void call( uint32_t method_id, const variants& args, json_writer& result )
+         {
+            FC_ASSERT( method_id < _json_methods.size() );
+            _json_methods[method_id]( args, result );
+         }
+
+         void call( const string& name, fc::datastream<const char*>& args, std::vector<char>& result )
+         {
+            auto itr = _by_name.find(name);
+            FC_ASSERT( itr != _by_name.end(), "no method with name '${name}'", ("name",name)("api",_by_name) );
+            call( itr->second, args, result );
+         }
+
+         void call( uint32_t method_id, fc::datastream<const char*>& args, std::vector<char>& result )
+         {
+            FC_ASSERT( method_id < _binary_methods.size() );
+            _binary_methods[method_id]( args, result );
+         }
+
          std::weak_ptr< fc::api_connection > get_connection()
          {
             return _api_connection;
@@ -171,9 +225,35 @@ namespace fc {
             return  call_generic<R,Args...>( this->bind_first_arg<R,Arg0,Args...>( f, a0->as< typename std::decay<Arg0>::type >( max_depth - 1 ) ), a0+1, e, max_depth - 1 );
          }
 
+         template<typename R>
+         R call_binary( const std::function<R()>& f, fc::datastream<const char*>& args, uint32_t max_depth )const
+         {
+            return f();
+         }
+
+         template<typename R, typename Signature, typename ... Args>
+         R call_binary( const std::function<R(std::function<Signature>,Args...)>& f, fc::datastream<const char*>& args, uint32_t max_depth )const
+         {
+            FC_THROW( "callbacks are not supported by the binary protocol" );
+         }
+         template<typename R, typename Signature, typename ... Args>
+         R call_binary( const std::function<R(const std::function<Signature>&,Args...)>& f, fc::datastream<const char*>& args, uint32_t max_depth )const
+         {
+            FC_THROW( "callbacks are not supported by the binary protocol" );
+         }
+
+         template<typename R, typename Arg0, typename ... Args>
+         R call_binary( const std::function<R(Arg0,Args...)>& f, fc::datastream<const char*>& args, uint32_t max_depth )const
+         {
+            typename std::decay<Arg0>::type a0;
+            fc::raw::unpack( args, a0, max_depth );
+            return call_binary<R,Args...>( this->bind_first_arg<R,Arg0,Args...>( f, std::move(a0) ), args, max_depth );
+         }
+
          struct api_visitor
          {
-            api_visitor( generic_api& a, const std::weak_ptr<fc::api_connection>& s ):_api(a),_api_con(s){ }
+            api_visitor( generic_api& a, const std::weak_ptr<fc::api_connection>& s, bool binary )
+               :_api(a),_api_con(s),_binary(binary){ }
 
             template<typename Interface, typename Adaptor, typename ... Args>
             std::function<variant(const fc::variants&)> to_generic( const std::function<api<Interface,Adaptor>(Args...)>& f )const;
@@ -190,21 +270,63 @@ namespace fc {
             template<typename ... Args>
             std::function<variant(const fc::variants&)> to_generic( const std::function<void(Args...)>& f )const;
 
+            /// Results that are APIs or nothing are written from the variant returned by the generic method m
+            template<typename Interface, typename Adaptor, typename ... Args>
+            json_method to_json_generic( const std::function<api<Interface,Adaptor>(Args...)>& f, const method& m )const;
+
+            template<typename Interface, typename Adaptor, typename ... Args>
+            json_method to_json_generic( const std::function<fc::optional<api<Interface,Adaptor>>(Args...)>& f, const method& m )const;
+
+            template<typename ... Args>
+            json_method to_json_generic( const std::function<fc::api_ptr(Args...)>& f, const method& m )const;
+
+            template<typename ... Args>
+            json_method to_json_generic( const std::function<void(Args...)>& f, const method& m )const;
+
+            /// Other results are written straight from the returned value, without converting it to a variant
+            template<typename R, typename ... Args>
+            json_method to_json_generic( const std::function<R(Args...)>& f, const method& m )const;
+
+            json_method variant_to_json( const method& m )const;
+
+            /// APIs are returned as their id on the connection, see fc::rpc::binary_api_connection
+            template<typename Interface, typename Adaptor, typename ... Args>
+            binary_method to_binary_generic( const std::function<api<Interface,Adaptor>(Args...)>& f )const;
+
+            template<typename Interface, typename Adaptor, typename ... Args>
+            binary_method to_binary_generic( const std::function<fc::optional<api<Interface,Adaptor>>(Args...)>& f )const;
+
+            template<typename ... Args>
+            binary_method to_binary_generic( const std::function<fc::api_ptr(Args...)>& f )const;
+
+            template<typename R, typename ... Args>
+            binary_method to_binary_generic( const std::function<R(Args...)>& f )const;
+
+            template<typename ... Args>
+            binary_method to_binary_generic( const std::function<void(Args...)>& f )const;
+
             template<typename Result, typename... Args>
             void operator()( const char* name, std::function<Result(Args...)>& memb )const {
                _api._methods.emplace_back( to_generic( memb ) );
+               _api._json_methods.emplace_back( to_json_generic( memb, _api._methods.back() ) );
+               if( _binary )
+                  _api._binary_methods.emplace_back( to_binary_generic( memb ) );
                _api._by_name[name] = _api._methods.size() - 1;
             }
 
             generic_api& _api;
             const std::weak_ptr<fc::api_connection>& _api_con;
+            /// whether the connection calls the binary methods, which are only built then
+            const bool _binary;
          };
 
 
          std::weak_ptr<fc::api_connection>                       _api_connection;
          fc::any                                                 _api;
          std::map< std::string, uint32_t >                       _by_name;
-         std::vector< std::function<variant(const variants&)> >  _methods;
+         std::vector< method >                                   _methods;
+         std::vector< json_method >                              _json_methods;
+         std::vector< binary_method >                            _binary_methods;
    }; // class generic_api
 
 
@@ -238,6 +360,19 @@ namespace fc {
             FC_ASSERT( _local_apis.size() > api_id );
             return _local_apis[api_id]->call( method_name, args );
          }
+         /** writes the result of the call as JSON, identical to the JSON of the variant returned by the other overload */
+         void receive_call( api_id_type api_id, const string& method_name, const variants& args, json_writer& result )const
+         {
+            FC_ASSERT( _local_apis.size() > api_id );
+            _local_apis[api_id]->call( method_name, args, result );
+         }
+         /** unpacks the arguments from @p args and packs the result into @p result, both with fc::raw */
+         void receive_call( api_id_type api_id, const string& method_name, fc::datastream<const char*>& args,
+                            std::vector<char>& result )const
+         {
+            FC_ASSERT( _local_apis.size() > api_id );
+            _local_apis[api_id]->call( method_name, args, result );
+         }
          variant receive_callback( uint64_t callback_id,  const variants& args = variants() )const
          {
             FC_ASSERT( _local_callbacks.size() > callback_id );
@@ -270,6 +405,9 @@ namespace fc {
 
          std::vector<std::string> get_method_names( api_id_type local_api_id = 0 )const { return _local_apis[local_api_id]->get_method_names(); }
 
+         /** whether calls arrive packed with fc::raw, see fc::rpc::binary_api_connection */
+         virtual bool is_binary()const { return false; }
+
          fc::signal<void()> closed;
          const uint32_t     _max_conversion_depth; // for nested structures, json, variant etc.
       private:
@@ -409,7 +547,7 @@ namespace fc {
    generic_api::generic_api( const Api& a, const std::shared_ptr<fc::api_connection>& c )
    :_api_connection(c),_api(a)
    {
-      boost::any_cast<const Api&>(a)->visit( api_visitor( *this, c ) );
+      boost::any_cast<const Api&>(a)->visit( api_visitor( *this, c, c->is_binary() ) );
    }
 
    template<typename Interface, typename Adaptor, typename ... Args>
@@ -485,6 +623,129 @@ namespace fc {
       };
    }
 
+   template<typename Interface, typename Adaptor, typename ... Args>
+   generic_api::json_method generic_api::api_visitor::to_json_generic(
+                                               const std::function<fc::api<Interface,Adaptor>(Args...)>& f, const method& m )const
+   {
+      return variant_to_json( m );
+   }
+
+   template<typename Interface, typename Adaptor, typename ... Args>
+   generic_api::json_method generic_api::api_visitor::to_json_generic(
+                                               const std::function<fc::optional<fc::api<Interface,Adaptor>>(Args...)>& f, const method& m )const
+   {
+      return variant_to_json( m );
+   }
+
+   template<typename ... Args>
+   generic_api::json_method generic_api::api_visitor::to_json_generic( const std::function<fc::api_ptr(Args...)>& f, const method& m )const
+   {
+      return variant_to_json( m );
+   }
+
+   template<typename ... Args>
+   generic_api::json_method generic_api::api_visitor::to_json_generic( const std::function<void(Args...)>& f, const method& m )const
+   {
+      return variant_to_json( m );
+   }
+
+   template<typename R, typename ... Args>
+   generic_api::json_method generic_api::api_visitor::to_json_generic( const std::function<R(Args...)>& f, const method& m )const
+   {
+      auto con = _api_con.lock();
+      FC_ASSERT( con, "not connected" );
+      uint32_t max_depth = con->_max_conversion_depth;
+      generic_api* gapi = &_api;
+      return [f,gapi,max_depth]( const variants& args, json_writer& result ) {
+         to_json( gapi->call_generic( f, args.begin(), args.end(), max_depth ), result, max_depth );
+      };
+   }
+
+   inline generic_api::json_method generic_api::api_visitor::variant_to_json( const method& m )const
+   {
+      auto con = _api_con.lock();
+      FC_ASSERT( con, "not connected" );
+      uint32_t max_depth = con->_max_conversion_depth;
+      return [m,max_depth]( const variants& args, json_writer& result ) {
+         result.write( m( args ), max_depth );
+      };
+   }
+
+   template<typename Interface, typename Adaptor, typename ... Args>
+   generic_api::binary_method generic_api::api_visitor::to_binary_generic(
+                                               const std::function<fc::api<Interface,Adaptor>(Args...)>& f )const
+   {
+      auto api_con = _api_con;
+      auto gapi = &_api;
+      return [=]( fc::datastream<const char*>& args, std::vector<char>& result ) {
+         auto con = api_con.lock();
+         FC_ASSERT( con, "not connected" );
+
+         auto api_result = gapi->call_binary( f, args, con->_max_conversion_depth );
+         result = fc::raw::pack_to_vector( con->register_api( api_result ) );
+      };
+   }
+
+   template<typename Interface, typename Adaptor, typename ... Args>
+   generic_api::binary_method generic_api::api_visitor::to_binary_generic(
+                                               const std::function<fc::optional<fc::api<Interface,Adaptor>>(Args...)>& f )const
+   {
+      auto api_con = _api_con;
+      auto gapi = &_api;
+      return [=]( fc::datastream<const char*>& args, std::vector<char>& result ) {
+         auto con = api_con.lock();
+         FC_ASSERT( con, "not connected" );
+
+         auto api_result = gapi->call_binary( f, args, con->_max_conversion_depth );
+         fc::optional<api_id_type> id;
+         if( api_result )
+            id = con->register_api( *api_result );
+         result = fc::raw::pack_to_vector( id );
+      };
+   }
+
+   template<typename ... Args>
+   generic_api::binary_method generic_api::api_visitor::to_binary_generic( const std::function<fc::api_ptr(Args...)>& f )const
+   {
+      auto api_con = _api_con;
+      auto gapi = &_api;
+      return [=]( fc::datastream<const char*>& args, std::vector<char>& result ) {
+         auto con = api_con.lock();
+         FC_ASSERT( con, "not connected" );
+
+         auto api_result = gapi->call_binary( f, args, con->_max_conversion_depth );
+         fc::optional<api_id_type> id;
+         if( api_result )
+            id = api_result->register_api( *con );
+         result = fc::raw::pack_to_vector( id );
+      };
+   }
+
+   template<typename R, typename ... Args>
+   generic_api::binary_method generic_api::api_visitor::to_binary_generic( const std::function<R(Args...)>& f )const
+   {
+      auto con = _api_con.lock();
+      FC_ASSERT( con, "not connected" );
+      uint32_t max_depth = con->_max_conversion_depth;
+      generic_api* gapi = &_api;
+      return [f,gapi,max_depth]( fc::datastream<const char*>& args, std::vector<char>& result ) {
+         to_binary( gapi->call_binary( f, args, max_depth ), result, max_depth );
+      };
+   }
+
+   template<typename ... Args>
+   generic_api::binary_method generic_api::api_visitor::to_binary_generic( const std::function<void(Args...)>& f )const
+   {
+      auto con = _api_con.lock();
+      FC_ASSERT( con, "not connected" );
+      uint32_t max_depth = con->_max_conversion_depth;
+      generic_api* gapi = &_api;
+      return [f,gapi,max_depth]( fc::datastream<const char*>& args, std::vector<char>& result ) {
+         gapi->call_binary( f, args, max_depth );
+         result.clear();
+      };
+   }
+
    /**
     * It is slightly unclean tight coupling to have this method in the api class.
     * It breaks encapsulation by requiring an api class method to have a pointer
@@ -1,532 +1,159 @@
 #pragma once
-#include <fc/variant.hpp>
+#include <fc/rpc/api_connection.hpp>
+#include <fc/rpc/bstate.hpp>
+#include <fc/network/http/websocket.hpp>
 #include <fc/io/raw.hpp>
-#include <fc/optional.hpp>
-#include <fc/api.hpp>
-#include <fc/any.hpp>
-#include <memory>
-#include <vector>
-#include <functional>
-#include <utility>
-#include <fc/signals.hpp>
-//#include <fc/rpc/json_connection.hpp>
+#include <fc/reflect/variant.hpp>
 
-namespace fc {
-   class binary_api_connection;
+#include <initializer_list>
 
-   namespace detail {
-      template<typename Signature>
-      class callback_functor
-      {
-         public:
-            typedef typename std::function<Signature>::result_type result_type;
+namespace fc { namespace rpc {
 
-            callback_functor( std::weak_ptr< fc::binary_api_connection > con, uint64_t id )
-            :_callback_id(id),_binary_api_connection(con){}
-
-            template<typename... Args> 
-            result_type operator()( Args... args )const;
-
-         private:
-            uint64_t _callback_id;
-            std::weak_ptr< fc::binary_api_connection > _binary_api_connection;
-      };
-
-      template<typename R, typename Arg0, typename ... Args>
-      std::function<R(Args...)> bind_first_arg( const std::function<R(Arg0,Args...)>& f, Arg0 a0 )
-      {
-         return [=]( Args... args ) { return f( a0, args... ); };
-      }
-      template<typename R>
-      R call_generic( const std::function<R()>& f, variants::const_iterator a0, variants::const_iterator e )
-      {
-         return f();
-      }
-
-      template<typename R, typename Arg0, typename ... Args>
-      R call_generic( const std::function<R(Arg0,Args...)>& f, variants::const_iterator a0, variants::const_iterator e )
-      {
-         FC_ASSERT( a0 != e );
-         return  call_generic<R,Args...>( bind_first_arg<R,Arg0,Args...>( f, a0->as< typename std::decay<Arg0>::type >() ), a0+1, e );
-      }
-
-      template<typename R, typename ... Args>
-      std::function<variant(const fc::variants&)> to_generic( const std::function<R(Args...)>& f )
-      {
-         return [=]( const variants& args ) { 
-            return variant( call_generic( f, args.begin(), args.end() ) ); 
-         };
-      }
-
-      template<typename ... Args>
-      std::function<variant(const fc::variants&)> to_generic( const std::function<void(Args...)>& f )
-      {
-         return [=]( const variants& args ) { 
-            call_generic( f, args.begin(), args.end() ); 
-            return variant();
-         };
-      }
-
-      /**
-       * If api<T> is returned from a remote method, the API is eagerly bound to api<T> of
-       * the correct type in api_visitor::from_variant().  This binding [1] needs a reference
-       * to the binary_api_connection, which is made available to from_variant() as a parameter.
-       *
-       * However, in the case of a remote method which returns api_base which can subsequently
-       * be cast by the caller with as<T>, we need to keep track of the connection because
-       * the binding is done later (when the client code actually calls as<T>).
-       *
-       * [1] The binding actually happens in get_remote_api().
-       */
-      class any_api : public api_base
-      {
-         public:
-            any_api( api_id_type api_id, const std::shared_ptr<fc::binary_api_connection>& con )
-               : _api_id(api_id), _binary_api_connection(con) {}
-
-            virtual uint64_t get_handle()const override
-            {  return _api_id;    }
-
-            virtual api_id_type register_api( binary_api_connection& conn )const override
-            {  FC_ASSERT( false ); return api_id_type(); }
-
-            api_id_type                         _api_id;
-            std::weak_ptr<fc::binary_api_connection>   _binary_api_connection;
-      };
-
-   } // namespace detail
-
-   class generic_api
-   {
-      public:
-         template<typename Api>
-         generic_api( const Api& a, const std::shared_ptr<fc::binary_api_connection>& c );
-
-         generic_api( const generic_api& cpy ) = delete;
-
-         vector<char> call( const string& name, const vector<char>& args )
-         {
-            auto itr = _by_name.find(name);
-            FC_ASSERT( itr != _by_name.end(), "no method with name '${name}'", ("name",name)("api",_by_name) );
-            return call( itr->second, args );
-         }
-
-         vector<char> call( uint32_t method_id, const vector<char>& args )
-         {
-            FC_ASSERT( method_id < _methods.size() );
-            return _methods[method_id](args);
-         }
-
-         std::weak_ptr< fc::binary_api_connection > get_connection()
-         {
-            return _binary_api_connection;
-         }
-
-         std::vector<std::string> get_method_names()const
-         {
-            std::vector<std::string> result;
-            result.reserve( _by_name.size() );
-            for( auto& m : _by_name ) result.push_back(m.first);
-            return result;
-         }
-
-      private:
-         friend struct api_visitor;
-
-         template<typename R, typename Arg0, typename ... Args>
-         std::function<R(Args...)> bind_first_arg( const std::function<R(Arg0,Args...)>& f, Arg0 a0 )const
-         {
-            return [=]( Args... args ) { return f( a0, args... ); };
-         }
-
-         template<typename R>
-         R call_generic( const std::function<R()>& f, datastream<const char*>& ds )const
-         {
-            return f();
-         }
-
-         template<typename R, typename Signature, typename ... Args>
-         R call_generic( const std::function<R(std::function<Signature>,Args...)>& f, datastream<const char*>& ds )
-         {
-            uint64_t callback_id = 0;
-            fc::raw::unpack( ds, callback_id );
-            detail::callback_functor<Signature> arg0( get_connection(), callback_id );
-            return  call_generic<R,Args...>( this->bind_first_arg<R,std::function<Signature>,Args...>( f, std::function<Signature>(arg0) ), ds );
-         }
-         template<typename R, typename Signature, typename ... Args>
-         R call_generic( const std::function<R(const std::function<Signature>&,Args...)>& f, fc::datastream<const char*>& ds )
-         {
-            uint64_t callback_id = 0;
-            fc::raw::unpack( ds, callback_id );
-            detail::callback_functor<Signature> arg0( get_connection(), callback_id );
-            return  call_generic<R,Args...>( this->bind_first_arg<R,const std::function<Signature>&,Args...>( f, arg0 ), ds );
-         }
-
-         template<typename R, typename Arg0, typename ... Args>
-         R call_generic( const std::function<R(Arg0,Args...)>& f, fc::datastream<const char*>& ds )
-         {
-            std::decay<Arg0>::type a0;
-            fc::raw::unpack( ds, a0 );
-            return  call_generic<R,Args...>( this->bind_first_arg<R,Arg0,Args...>( f, a0 ), ds );
-         }
-
-         struct api_visitor
-         {
-            api_visitor( generic_api& a, const std::weak_ptr<fc::binary_api_connection>& s ):api(a),_api_con(s){ }
-
-            template<typename Interface, typename Adaptor, typename ... Args>
-            std::function<variant(const fc::variants&)> to_generic( const std::function<api<Interface,Adaptor>(Args...)>& f )const;
-
-            template<typename Interface, typename Adaptor, typename ... Args>
-            std::function<variant(const fc::variants&)> to_generic( const std::function<fc::optional<api<Interface,Adaptor>>(Args...)>& f )const;
-
-            template<typename ... Args>
-            std::function<variant(const fc::variants&)> to_generic( const std::function<fc::api_ptr(Args...)>& f )const;
-
-            template<typename R, typename ... Args>
-            std::function<variant(const fc::variants&)> to_generic( const std::function<R(Args...)>& f )const;
-
-            template<typename ... Args>
-            std::function<variant(const fc::variants&)> to_generic( const std::function<void(Args...)>& f )const;
-
-            template<typename Result, typename... Args>
-            void operator()( const char* name, std::function<Result(Args...)>& memb )const {
-               api._methods.emplace_back( to_generic( memb ) ); 
-               api._by_name[name] = api._methods.size() - 1;
-            }
-
-            generic_api&  api;
-            const std::weak_ptr<fc::binary_api_connection>& _api_con;
-         };
-
-
-         std::weak_ptr<fc::binary_api_connection>                         _binary_api_connection;
-         fc::any                                                          _api;
-         std::map< std::string, uint32_t >                                _by_name;
-         std::vector< std::function<vector<char>(const vector<char>&)> >  _methods;
-   }; // class generic_api
-
-
-
-   class binary_api_connection : public std::enable_shared_from_this<fc::binary_api_connection>
+   /**
+    * Serves and calls APIs with their arguments and results packed by fc::raw, in binary websocket frames.
+    * Every frame is a bmessage.  A call is the brequest "call", whose params are the api_id_type of the API,
+    * the name of the method and the arguments of the method, one after the other; the result of a method
+    * that returns an API is the api_id_type it was registered under, or an optional of it.
+    *
+    * APIs are registered as on a websocket_api_connection.  Callbacks are not supported, and calls by API
+    * name neither; log in and use login_api::get_api_by_name instead.
+    *
+    * Remote APIs must be bound with get_remote_api() of this class, which packs the arguments for the method
+    * that is called; api_base::as() binds to the variant calls, which this connection doesn't make.
+    */
+   class binary_api_connection : public api_connection
    {
       public:
-         typedef std::vector<char> params_type;
-         typedef std::vector<char> result_type;
-
-         binary_api_connection(){}
-         virtual ~binary_api_connection(){};
-
+         binary_api_connection( fc::http::websocket_connection& c, uint32_t max_conversion_depth );
+         ~binary_api_connection();
 
          template<typename T>
          api<T> get_remote_api( api_id_type api_id = 0 )
          {
             api<T> result;
-            result->visit( api_visitor(  api_id, this->shared_from_this() ) );
+            result->visit( binary_api_visitor( api_id, std::static_pointer_cast<binary_api_connection>( shared_from_this() ) ) );
             return result;
          }
-  
-         /** makes calls to the remote server */
-         virtual result_type send_call( api_id_type api_id, string method_name, params_type args = params_type() ) = 0;
-         virtual result_type send_callback( uint64_t callback_id, params_type args = params_type() ) = 0;
-         virtual void    send_notice( uint64_t callback_id, params_type args = params_type() ) = 0;
 
-         result_type receive_call( api_id_type api_id, const string& method_name, const params_type& args = params_type() )const
-         {
-            FC_ASSERT( _local_apis.size() > api_id );
-            return _local_apis[api_id]->call( method_name, args );
-         }
-         result_type receive_callback( uint64_t callback_id,  const params_type& args = params_type() )const
-         {
-            FC_ASSERT( _local_callbacks.size() > callback_id );
-            return _local_callbacks[callback_id]( args );
-         }
-         void receive_notice( uint64_t callback_id,  const params_type& args = params_type() )const
+         /// binds an API returned by a remote method, e.g. by login_api::get_api_by_name
+         template<typename T>
+         api<T> get_remote_api( const api_ptr& a )
          {
-            FC_ASSERT( _local_callbacks.size() > callback_id );
-            _local_callbacks[callback_id]( args );
+            FC_ASSERT( a, "no such API" );
+            return get_remote_api<T>( api_id_type( a->get_handle() ) );
          }
 
-         template<typename Interface>
-         api_id_type register_api( const Interface& a )
-         {
-            auto handle = a.get_handle();
-            auto itr = _handle_to_id.find(handle);
-            if( itr != _handle_to_id.end() ) return itr->second;
+         /**
+          * Calls @p method_name of the remote API @p api_id
+          * @param args the arguments of the method packed one after the other
+          * @return the packed result
+          */
+         std::vector<char> send_call( api_id_type api_id, const string& method_name, const std::vector<char>& args );
 
-            _local_apis.push_back( std::unique_ptr<generic_api>( new generic_api(a, shared_from_this() ) ) );
-            _handle_to_id[handle] = _local_apis.size() - 1;
-            return _local_apis.size() - 1;
-         }
+         virtual variant send_call( api_id_type api_id, string method_name, variants args = variants() ) override;
+         virtual variant send_call( string api_name, string method_name, variants args = variants() ) override;
+         virtual variant send_callback( uint64_t callback_id, variants args = variants() ) override;
+         virtual void    send_notice( uint64_t callback_id, variants args = variants() ) override;
 
-         template<typename Signature>
-         uint64_t register_callback( const std::function<Signature>& cb )
-         {
-            _local_callbacks.push_back( detail::to_generic( cb ) );
-            return _local_callbacks.size() - 1;
-         }
+         virtual bool is_binary()const override { return true; }
+
+      protected:
+         void on_message( const std::string& message );
 
-         std::vector<std::string> get_method_names( api_id_type local_api_id = 0 )const { return _local_apis[local_api_id]->get_method_names(); }
+         fc::http::websocket_connection&  _connection;
+         fc::rpc::bstate                  _rpc_state;
 
-         fc::signal<void()> closed;
       private:
-         std::vector< std::unique_ptr<generic_api> >             _local_apis;
-         std::map< uint64_t, api_id_type >                       _handle_to_id;
-         std::vector< std::function<variant(const variants&)>  > _local_callbacks;
+         struct binary_api_visitor
+         {
+            api_id_type                                  _api_id;
+            std::shared_ptr<binary_api_connection>       _connection;
 
+            binary_api_visitor( api_id_type api_id, std::shared_ptr<binary_api_connection> con )
+            :_api_id(api_id),_connection(std::move(con)) {}
 
-         struct api_visitor
-         {
-            uint32_t                            _api_id;
-            std::shared_ptr<fc::binary_api_connection> _connection;
+            template<typename T>
+            static void pack_arg( fc::datastream<size_t>& size, fc::datastream<char*>* out, const T& v, uint32_t max_depth )
+            {
+               if( out )
+                  fc::raw::pack( *out, v, max_depth );
+               else
+                  fc::raw::pack( size, v, max_depth );
+            }
 
-            api_visitor( uint32_t api_id, std::shared_ptr<fc::binary_api_connection> con )
-            :_api_id(api_id),_connection(std::move(con))
+            template<typename Signature>
+            static void pack_arg( fc::datastream<size_t>&, fc::datastream<char*>*, const std::function<Signature>&, uint32_t )
             {
+               FC_THROW( "callbacks are not supported by the binary protocol" );
             }
 
-            api_visitor() = delete;
+            template<typename... Args>
+            static std::vector<char> pack_args( uint32_t max_depth, const Args&... args )
+            {
+               fc::datastream<size_t> size;
+               (void)std::initializer_list<int>{ ( pack_arg( size, nullptr, args, max_depth ), 0 )... };
+               std::vector<char> result( size.tellp() );
+               fc::datastream<char*> out( result.data(), result.size() );
+               (void)std::initializer_list<int>{ ( pack_arg( size, &out, args, max_depth ), 0 )... };
+               return result;
+            }
 
             template<typename Result>
-            static Result from_vector( const vector<char>& v, Result*, const std::shared_ptr<fc::binary_api_connection>&  )
+            static Result unpack_result( const std::vector<char>& packed, Result*, const std::shared_ptr<binary_api_connection>& con )
             {
-               return fc::raw::unpack<Result>( v ); 
+               Result result;
+               from_binary( packed, result, con->_max_conversion_depth );
+               return result;
             }
 
             template<typename ResultInterface>
-            static fc::api<ResultInterface> from_vector( const vector<char>& v, 
-                                                          fc::api<ResultInterface>* /*used for template deduction*/,
-                                                          const std::shared_ptr<fc::binary_api_connection>&  con 
-                                                        )
+            static fc::api<ResultInterface> unpack_result( const std::vector<char>& packed, fc::api<ResultInterface>*,
+                                                           const std::shared_ptr<binary_api_connection>& con )
             {
-               return con->get_remote_api<ResultInterface>( fc::raw::unpack<uint64_t>( v ) );
+               return con->get_remote_api<ResultInterface>( fc::raw::unpack_from_vector<api_id_type>( packed ) );
             }
 
-            static fc::api_ptr from_vector(
-               const vector<char>& v,
-               fc::api_ptr* /* used for template deduction */,
-               const std::shared_ptr<fc::binary_api_connection>&  con
-            )
+            template<typename ResultInterface>
+            static fc::optional<fc::api<ResultInterface>> unpack_result( const std::vector<char>& packed,
+                                                                         fc::optional<fc::api<ResultInterface>>*,
+                                                                         const std::shared_ptr<binary_api_connection>& con )
             {
-               return fc::api_ptr( new detail::any_api( fc::raw::unpack<uint64_t>(v), con ) );
+               auto id = fc::raw::unpack_from_vector<fc::optional<api_id_type>>( packed );
+               if( !id )
+                  return fc::optional<fc::api<ResultInterface>>();
+               return con->get_remote_api<ResultInterface>( *id );
             }
 
-            template<typename T>
-            static result_type convert_callbacks( const std::shared_ptr<fc::binary_api_connection>&, const T& v ) 
-            { 
-               return fc::raw::pack(v); 
-            }
-
-            template<typename Signature>
-            static result_type convert_callbacks( const std::shared_ptr<fc::binary_api_connection>& con, const std::function<Signature>& v ) 
-            { 
-               return con->register_callback( v ); 
+            static fc::api_ptr unpack_result( const std::vector<char>& packed, fc::api_ptr*,
+                                              const std::shared_ptr<binary_api_connection>& con )
+            {
+               auto id = fc::raw::unpack_from_vector<fc::optional<api_id_type>>( packed );
+               if( !id )
+                  return fc::api_ptr();
+               return fc::api_ptr( new fc::detail::any_api( *id, con ) );
             }
 
             template<typename Result, typename... Args>
-            void operator()( const char* name, std::function<Result(Args...)>& memb )const 
+            void operator()( const char* name, std::function<Result(Args...)>& memb )const
             {
-                auto con   = _connection;
-                auto api_id = _api_id;
-                memb = [con,api_id,name]( Args... args ) {
-                    auto var_result = con->send_call( api_id, name, { convert_callbacks(con,args)...} );
-                    return from_vector( var_result, (Result*)nullptr, con );
-                };
+               auto con = _connection;
+               auto api_id = _api_id;
+               memb = [con,api_id,name]( Args... args ) {
+                  auto result = con->send_call( api_id, name, pack_args( con->_max_conversion_depth, args... ) );
+                  return unpack_result( result, (Result*)nullptr, con );
+               };
             }
+
             template<typename... Args>
-            void operator()( const char* name, std::function<void(Args...)>& memb )const 
+            void operator()( const char* name, std::function<void(Args...)>& memb )const
             {
-                auto con   = _connection;
-                auto api_id = _api_id;
-                memb = [con,api_id,name]( Args... args ) {
-                   con->send_call( api_id, name, { convert_callbacks(con,args)...} );
-                };
+               auto con = _connection;
+               auto api_id = _api_id;
+               memb = [con,api_id,name]( Args... args ) {
+                  con->send_call( api_id, name, pack_args( con->_max_conversion_depth, args... ) );
+               };
             }
          };
    };
 
-   class local_binary_api_connection : public binary_api_connection
-   {
-      public:
-         /** makes calls to the remote server */
-         virtual result_type send_call( api_id_type api_id, string method_name, params_type args = params_type() ) override
-         {
-            FC_ASSERT( _remote_connection );
-            return _remote_connection->receive_call( api_id, method_name, std::move(args) );
-         }
-         virtual result_type send_callback( uint64_t callback_id, params_type args = params_type() ) override
-         {
-            FC_ASSERT( _remote_connection );
-            return _remote_connection->receive_callback( callback_id, args );
-         }
-         virtual void send_notice( uint64_t callback_id, params_type args = params_type() ) override
-         {
-            FC_ASSERT( _remote_connection );
-            _remote_connection->receive_notice( callback_id, args );
-         }
-
-
-         void  set_remote_connection( const std::shared_ptr<fc::binary_api_connection>& rc )
-         {
-            FC_ASSERT( !_remote_connection );
-            FC_ASSERT( rc != this->shared_from_this() );
-            _remote_connection = rc;
-         }
-         const std::shared_ptr<fc::binary_api_connection>& remote_connection()const  { return _remote_connection; }
-
-         std::shared_ptr<fc::binary_api_connection>    _remote_connection;
-   };
-
-   template<typename Api>
-   generic_api::generic_api( const Api& a, const std::shared_ptr<fc::binary_api_connection>& c )
-   :_binary_api_connection(c),_api(a)
-   {
-      boost::any_cast<const Api&>(a)->visit( api_visitor( *this, c ) );
-   }
-
-   template<typename Interface, typename Adaptor, typename ... Args>
-   std::function<result_type(const params_type&)> generic_api::api_visitor::to_generic( 
-                                               const std::function<fc::api<Interface,Adaptor>(Args...)>& f )const
-   {
-      auto api_con = _api_con;
-      auto gapi = &api;
-      return [=]( const params_type& args ) { 
-         auto con = api_con.lock();
-         FC_ASSERT( con, "not connected" );
-
-         fc::raw::datastream<const char*> ds( args.data(), args.size() );
-         auto api_result = gapi->call_generic( f, args ); 
-         return con->register_api( api_result );
-      };
-   }
-   template<typename Interface, typename Adaptor, typename ... Args>
-   std::function<result_type(const params_type&)> generic_api::api_visitor::to_generic( 
-                                               const std::function<fc::optional<fc::api<Interface,Adaptor>>(Args...)>& f )const
-   {
-      auto api_con = _api_con;
-      auto gapi = &api;
-      return [=]( const params_type& args )-> fc::variant { 
-         auto con = api_con.lock();
-         FC_ASSERT( con, "not connected" );
-
-         fc::raw::datastream<const char*> ds( args.data(), args.size() );
-         auto api_result = gapi->call_generic( f, ds ); 
-         if( api_result )
-            return con->register_api( *api_result );
-         return result_type();
-      };
-   }
-
-   template<typename ... Args>
-   std::function<result_type(const params_type&)> generic_api::api_visitor::to_generic(
-                                               const std::function<fc::api_ptr(Args...)>& f )const
-   {
-      auto api_con = _api_con;
-      auto gapi = &api;
-      return [=]( const variants& args ) -> fc::variant {
-         auto con = api_con.lock();
-         FC_ASSERT( con, "not connected" );
-
-         fc::raw::datastream<const char*> ds( args.data(), args.size() );
-         auto api_result = gapi->call_generic( f, ds );
-         if( !api_result )
-            return result_type();
-         return api_result->register_api( *con );
-      };
-   }
-
-   template<typename R, typename ... Args>
-   std::function<result_type(const params_type&)> generic_api::api_visitor::to_generic( const std::function<R(Args...)>& f )const
-   {
-      generic_api* gapi = &api;
-      return [f,gapi]( const params_type& args ) { 
-         fc::raw::datastream<const char*> ds( args.data(), args.size() );
-         return  fc::raw::pack(gapi->call_generic( f, ds )); 
-      };
-   }
-
-   template<typename ... Args>
-   std::function<result_type(const params_type&)> generic_api::api_visitor::to_generic( const std::function<void(Args...)>& f )const
-   {
-      generic_api* gapi = &api;
-      return [f,gapi]( const params_type& args ) { 
-         fc::raw::datastream<const char*> ds( args.data(), args.size() );
-         gapi->call_generic( f, ds ); 
-         return result_type();
-      };
-   }
-
-   /**
-    * It is slightly unclean tight coupling to have this method in the api class.
-    * It breaks encapsulation by requiring an api class method to have a pointer
-    * to an binary_api_connection.  The reason this is necessary is we have a goal of being
-    * able to call register_api() on an api<T> through its base class api_base.  But
-    * register_api() must know the template parameters!
-    *
-    * The only reasonable way to achieve the goal is to implement register_api()
-    * as a method in api<T> (which obviously knows the template parameter T),
-    * then make the implementation accessible through the base class (by making
-    * it a pure virtual method in the base class which is overridden by the subclass's
-    * implementation).
-    */
-   template< typename Interface, typename Transform >
-   api_id_type api< Interface, Transform >::register_api( binary_api_connection& conn )const
-   {
-      return conn.register_api( *this );
-   }
-
-   template< typename T >
-   api<T> api_base::as()
-   {
-      // TODO:  this method should probably be const (if it is not too hard)
-      api<T>* maybe_requested_type = dynamic_cast< api<T>* >(this);
-      if( maybe_requested_type != nullptr )
-         return *maybe_requested_type;
-
-      detail::any_api* maybe_any = dynamic_cast< detail::any_api* >(this);
-      FC_ASSERT( maybe_any != nullptr );
-      std::shared_ptr< binary_api_connection > api_conn = maybe_any->_binary_api_connection.lock();
-      FC_ASSERT( api_conn );
-      return api_conn->get_remote_api<T>( maybe_any->_api_id );
-   }
-
-   namespace detail {
-      template<typename Signature>
-      template<typename... Args> 
-      typename callback_functor<Signature>::result_type callback_functor<Signature>::operator()( Args... args )const
-      {
-         std::shared_ptr< fc::binary_api_connection > locked = _binary_api_connection.lock();
-         // TODO:  make new exception type for this instead of recycling eof_exception
-         if( !locked )
-            throw fc::eof_exception();
-
-         /// TODO------------->>> pack args... 
-         locked->send_callback( _callback_id, fc::raw::pack( args... ) ).template as< result_type >();
-      }
-
-
-      template<typename... Args>
-      class callback_functor<void(Args...)>
-      {
-         public:
-          typedef void result_type;
-
-          callback_functor( std::weak_ptr< fc::binary_api_connection > con, uint64_t id )
-          :_callback_id(id),_binary_api_connection(con){}
-
-          void operator()( Args... args )const
-          {
-             std::shared_ptr< fc::binary_api_connection > locked = _binary_api_connection.lock();
-             // TODO:  make new exception type for this instead of recycling eof_exception
-             if( !locked )
-                throw fc::eof_exception();
-             locked->send_notice( _callback_id, fc::variants{ args... } );
-          }
-
-         private:
-          uint64_t _callback_id;
-          std::weak_ptr< fc::binary_api_connection > _binary_api_connection;
-      };
-   } // namespace detail
-
-} // fc
+} } // namespace fc::rpc
@@ -2,6 +2,7 @@
 #include <fc/variant.hpp>
 #include <functional>
 #include <fc/thread/future.hpp>
+#include <fc/static_variant.hpp>
 #include <fc/rpc/state.hpp>
 
 namespace fc { namespace rpc {
@@ -25,6 +26,9 @@ namespace fc { namespace rpc {
       optional<error_object> error;
    };
 
+   /** a frame of the binary protocol, see binary_api_connection */
+   typedef fc::static_variant< brequest, bresponse > bmessage;
+
    /** binary RPC state */
    class bstate
    {
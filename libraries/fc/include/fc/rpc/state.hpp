@@ -1,5 +1,6 @@
 #pragma once
 #include <fc/variant.hpp>
+#include <fc/io/json_writer.hpp>
 #include <functional>
 #include <fc/thread/future.hpp>
 
@@ -36,12 +37,17 @@ namespace fc { namespace rpc {
    {
       public:
          typedef std::function<variant(const variants&)>       method;
+         typedef std::function<void(const variants&, json_writer&)> json_method;
          ~state();
 
          void add_method( const fc::string& name, method m );
+         /** methods that write their result as JSON, called by the json_writer overload of local_call */
+         void add_json_method( const fc::string& name, json_method m );
          void remove_method( const fc::string& name );
 
          variant local_call( const string& method_name, const variants& args );
+         /** writes the result as JSON, methods added with add_method are written from their variant */
+         void    local_call( const string& method_name, const variants& args, json_writer& result, uint32_t max_depth );
          void    handle_reply( const response& response );
 
          request start_remote_call( const string& method_name, variants args );
@@ -50,12 +56,15 @@ namespace fc { namespace rpc {
          void close();
 
          void on_unhandled( const std::function<variant(const string&,const variants&)>& unhandled );
+         void on_unhandled_json( const std::function<void(const string&,const variants&,json_writer&)>& unhandled );
 
       private:
          uint64_t                                                   _next_id = 1;
          std::unordered_map<uint64_t, fc::promise<variant>::ptr>    _awaiting;
          std::unordered_map<std::string, method>                    _methods;
+         std::unordered_map<std::string, json_method>               _json_methods;
          std::function<variant(const string&,const variants&)>                    _unhandled;
+         std::function<void(const string&,const variants&,json_writer&)>          _unhandled_json;
    };
 } }  // namespace  fc::rpc
 
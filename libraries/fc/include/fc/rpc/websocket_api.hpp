@@ -32,6 +32,11 @@ namespace fc { namespace rpc {
          std::string on_message(
             const std::string& message,
             bool send_message = true );
+         /// @param var the message, already parsed
+         std::string on_message(
+            const std::string& message,
+            const variant& var,
+            bool send_message = true );
 
          fc::http::websocket_connection&  _connection;
          fc::rpc::state                   _rpc_state;
@@ -6,11 +6,16 @@
 #include <fc/io/sstream.hpp>
 #include <fc/log/logger.hpp>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <locale>
 #include <sstream>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include <boost/filesystem/fstream.hpp>
 
 namespace fc
@@ -21,12 +26,49 @@ namespace fc
     template<typename T> fc::string stringFromStream( T& in );
     template<typename T> bool skip_white_space( T& in );
     template<typename T> fc::string stringFromToken( T& in );
-    template<typename T> variant_object objectFromStreamBase( T& in, std::function<std::string(T&)>& get_key, std::function<variant(T&)>& get_value );
+    template<typename T, typename GetKey, typename GetValue> variant_object objectFromStreamBase( T& in, GetKey& get_key, GetValue& get_value );
     template<typename T, json::parse_type parser_type> variant_object objectFromStream( T& in, uint32_t max_depth );
-    template<typename T> variants arrayFromStreamBase( T& in, std::function<variant(T&)>& get_value );
+    template<typename T, typename GetValue> variants arrayFromStreamBase( T& in, GetValue& get_value );
     template<typename T, json::parse_type parser_type> variants arrayFromStream( T& in, uint32_t max_depth );
-    template<typename T, json::parse_type parser_type> variant number_from_stream( T& in );
+    template<json::parse_type parser_type, typename T> variant number_from_stream( T& in );
+    template<json::parse_type parser_type> variant number_from_token( const fc::string& str, bool dot, bool neg );
     template<typename T> variant token_from_stream( T& in );
+
+    namespace
+    {
+       /**
+        *  Reads the characters of a string in place, for json::from_string.  Like the streams, peek()
+        *  and get() throw eof_exception at the end of the input.
+        */
+       class string_input
+       {
+          public:
+             explicit string_input( const std::string& str ) : pos( str.data() ), end( str.data() + str.size() ) {}
+
+             char peek()const
+             {
+                if( pos == end )
+                   FC_THROW_EXCEPTION( eof_exception, "end of JSON input" );
+                return *pos;
+             }
+             char get()
+             {
+                if( pos == end )
+                   FC_THROW_EXCEPTION( eof_exception, "end of JSON input" );
+                return *pos++;
+             }
+
+             const char* pos;
+             const char* const end;
+       };
+    }
+
+    // string_input overloads of the stream readers above, which scan the buffer instead of reading
+    // it character by character
+    bool skip_white_space( string_input& in );
+    fc::string stringFromStream( string_input& in );
+    template<json::parse_type parser_type> variant number_from_stream( string_input& in );
+    variant token_from_stream( string_input& in );
     void escape_string( const string& str, ostream& os );
     template<typename T> void to_stream( T& os, const variants& a, json::output_formatting format, uint32_t max_depth );
     template<typename T> void to_stream( T& os, const variant_object& o, json::output_formatting format, uint32_t max_depth );
@@ -178,8 +220,8 @@ namespace fc
                                           ("token", token.str() ) );
    }
 
-   template<typename T>
-   variant_object objectFromStreamBase( T& in, std::function<std::string(T&)>& get_key, std::function<variant(T&)>& get_value )
+   template<typename T, typename GetKey, typename GetValue>
+   variant_object objectFromStreamBase( T& in, GetKey& get_key, GetValue& get_value )
    {
       mutable_variant_object obj;
       try
@@ -230,13 +272,13 @@ namespace fc
    template<typename T, json::parse_type parser_type>
    variant_object objectFromStream( T& in, uint32_t max_depth )
    {
-      std::function<std::string(T&)> get_key = []( T& in ){ return stringFromStream( in ); };
-      std::function<variant(T&)> get_value = [max_depth]( T& in ){ return variant_from_stream<T, parser_type>( in, max_depth ); };
+      auto get_key = []( T& in ){ return stringFromStream( in ); };
+      auto get_value = [max_depth]( T& in ){ return variant_from_stream<T, parser_type>( in, max_depth ); };
       return objectFromStreamBase<T>( in, get_key, get_value );
    }
 
-   template<typename T>
-   variants arrayFromStreamBase( T& in, std::function<variant(T&)>& get_value  )
+   template<typename T, typename GetValue>
+   variants arrayFromStreamBase( T& in, GetValue& get_value  )
    {
       variants ar;
       try
@@ -268,11 +310,11 @@ namespace fc
    template<typename T, json::parse_type parser_type>
    variants arrayFromStream( T& in, uint32_t max_depth )
    {
-      std::function<variant(T&)> get_value = [max_depth]( T& in ){ return variant_from_stream<T, parser_type>( in, max_depth ); };
+      auto get_value = [max_depth]( T& in ){ return variant_from_stream<T, parser_type>( in, max_depth ); };
       return arrayFromStreamBase<T>( in, get_value );
    }
 
-   template<typename T, json::parse_type parser_type>
+   template<json::parse_type parser_type, typename T>
    variant number_from_stream( T& in )
    {
       fc::stringstream ss;
@@ -327,7 +369,12 @@ namespace fc
       catch (const std::ios_base::failure&)
       { // read error ends the loop
       }
-      fc::string str = ss.str();
+      return number_from_token<parser_type>( ss.str(), dot, neg );
+   }
+
+   template<json::parse_type parser_type>
+   variant number_from_token( const fc::string& str, bool dot, bool neg )
+   {
       if (str == "-." || str == "." || str == "-") // check the obviously wrong things we could have encountered
         FC_THROW_EXCEPTION(parse_error_exception, "Can't parse token \"${token}\" as a JSON numeric constant", ("token", str));
       if( dot )
@@ -439,7 +486,7 @@ namespace fc
          case '7':
          case '8':
          case '9':
-            return number_from_stream<T, parser_type>( in );
+            return number_from_stream<parser_type>( in );
          // null, true, false, or 'warning' / string
          case 'n':
          case 't':
@@ -458,11 +505,200 @@ namespace fc
       }
   }
 
+   namespace
+   {
+      inline bool is_white_space( char c )
+      {
+         return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+      }
+
+#ifdef __SSE2__
+      /// Bit i of the result is set if p[i] is one of the characters, for the 16 characters at p
+      inline int match_mask( const char* p, char c1, char c2, char c3, char c4 )
+      {
+         const __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) );
+         const __m128i m = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( chunk, _mm_set1_epi8( c1 ) ),
+                                                       _mm_cmpeq_epi8( chunk, _mm_set1_epi8( c2 ) ) ),
+                                         _mm_or_si128( _mm_cmpeq_epi8( chunk, _mm_set1_epi8( c3 ) ),
+                                                       _mm_cmpeq_epi8( chunk, _mm_set1_epi8( c4 ) ) ) );
+         return _mm_movemask_epi8( m );
+      }
+#endif
+
+      /// Returns the first character in [p,end) that is not white space, or end
+      const char* find_non_white_space( const char* p, const char* end )
+      {
+         // most values are preceded by no or a single white space character
+         if( p == end || !is_white_space( *p ) )
+            return p;
+#ifdef __SSE2__
+         for( ; end - p >= 16; p += 16 )
+         {
+            const int mask = ~match_mask( p, ' ', '\t', '\n', '\r' ) & 0xffff;
+            if( mask != 0 )
+               return p + __builtin_ctz( mask );
+         }
+#endif
+         while( p != end && is_white_space( *p ) )
+            ++p;
+         return p;
+      }
+
+      /// Returns the first '"', '\\' or '\x04' in [p,end), or end.  These end a run of plain characters in a string.
+      const char* find_string_special( const char* p, const char* end )
+      {
+#ifdef __SSE2__
+         for( ; end - p >= 16; p += 16 )
+         {
+            const int mask = match_mask( p, '"', '\\', '\x04', '"' );
+            if( mask != 0 )
+               return p + __builtin_ctz( mask );
+         }
+#endif
+         while( p != end && *p != '"' && *p != '\\' && *p != '\x04' )
+            ++p;
+         return p;
+      }
+   }
+
+   bool skip_white_space( string_input& in )
+   {
+      const char* start = in.pos;
+      in.pos = find_non_white_space( in.pos, in.end );
+      in.peek(); // the stream readers see the end of the input while skipping
+      return in.pos != start;
+   }
+
+   fc::string stringFromStream( string_input& in )
+   {
+      fc::string token;
+      try
+      {
+         char c = in.peek();
+
+         if( c != '"' )
+            FC_THROW_EXCEPTION( parse_error_exception,
+                                            "Expected '\"' but read '${char}'",
+                                            ("char", string(&c, (&c) + 1) ) );
+         in.get();
+         while( true )
+         {
+            const char* special = find_string_special( in.pos, in.end );
+            token.append( in.pos, special );
+            in.pos = special;
+
+            switch( in.peek() )
+            {
+               case '\\':
+                  token.push_back( parseEscape( in ) );
+                  break;
+               case '"':
+                  in.get();
+                  return token;
+               default: // 0x04
+                  FC_THROW_EXCEPTION( parse_error_exception, "EOF before closing '\"' in string '${token}'",
+                                                   ("token", token ) );
+            }
+         }
+       } FC_RETHROW_EXCEPTIONS( warn, "while parsing token '${token}'",
+                                          ("token", token ) );
+   }
+
+   template<json::parse_type parser_type>
+   variant number_from_stream( string_input& in )
+   {
+      const char* start = in.pos;
+      const char* p = start;
+      bool dot = false;
+      bool neg = false;
+      if( p != in.end && *p == '-' )
+      {
+         neg = true;
+         ++p;
+      }
+      for( ; p != in.end && *p != 0; ++p )
+      {
+         const char c = *p;
+         if( c == '.' )
+         {
+            if( dot )
+               FC_THROW_EXCEPTION(parse_error_exception, "Can't parse a number with two decimal places");
+            dot = true;
+         }
+         else if( c < '0' || c > '9' )
+         {
+            if( isalnum( c, c_locale ) )
+            {
+               in.pos = p;
+               return fc::string( start, p ) + stringFromToken( in );
+            }
+            break;
+         }
+      }
+      in.pos = p;
+      return number_from_token<parser_type>( fc::string( start, p ), dot, neg );
+   }
+
+   variant token_from_stream( string_input& in )
+   {
+      const char* start = in.pos;
+      const char* p = start;
+      while( p != in.end )
+      {
+         const char c = *p;
+         if( c != 'n' && c != 'u' && c != 'l' && c != 't' && c != 'r' && c != 'e' && c != 'f' && c != 'a' && c != 's' )
+            break;
+         ++p;
+      }
+      in.pos = p;
+
+      const size_t len = p - start;
+      if( len == 4 && memcmp( start, "null", 4 ) == 0 )
+        return variant();
+      if( len == 4 && memcmp( start, "true", 4 ) == 0 )
+        return true;
+      if( len == 5 && memcmp( start, "false", 5 ) == 0 )
+        return false;
+
+      // as in the stream reader: a malformed token is an un-quoted string
+      fc::string str( start, p );
+      if( p == in.end )
+      {
+        if (str.empty())
+          FC_THROW_EXCEPTION( parse_error_exception, "Unexpected EOF" );
+        return str;
+      }
+      return str + stringFromToken(in);
+   }
+
+   namespace
+   {
+      variant variant_from_string_input( string_input& in, json::parse_type ptype, uint32_t max_depth )
+      {
+         switch( ptype )
+         {
+             case json::legacy_parser:
+                 return variant_from_stream<string_input, json::legacy_parser>( in, max_depth );
+#ifdef WITH_EXOTIC_JSON_PARSERS
+             case json::legacy_parser_with_string_doubles:
+                 return variant_from_stream<string_input, json::legacy_parser_with_string_doubles>( in, max_depth );
+             case json::strict_parser:
+                 return json_relaxed::variant_from_stream<string_input, true>( in, max_depth );
+             case json::relaxed_parser:
+                 return json_relaxed::variant_from_stream<string_input, false>( in, max_depth );
+#endif
+             case json::broken_nul_parser:
+                 return variant_from_stream<string_input, json::broken_nul_parser>( in, max_depth );
+             default:
+                 FC_ASSERT( false, "Unknown JSON parser type {ptype}", ("ptype", ptype) );
+         }
+      }
+   }
+
    variant json::from_string( const std::string& utf8_str, parse_type ptype, uint32_t max_depth )
    { try {
-      fc::istream_ptr in( new fc::stringstream( utf8_str ) );
-      fc::buffered_istream bin( in );
-      return from_stream( bin, ptype, max_depth );
+      string_input in( utf8_str );
+      return variant_from_string_input( in, ptype, max_depth );
    } FC_RETHROW_EXCEPTIONS( warn, "", ("str",utf8_str) ) }
 
    variants json::variants_from_string( const std::string& utf8_str, parse_type ptype, uint32_t max_depth )
@@ -801,11 +1037,9 @@ namespace fc
    bool json::is_valid( const std::string& utf8_str, parse_type ptype, uint32_t max_depth )
    {
       if( utf8_str.size() == 0 ) return false;
-      fc::istream_ptr in( new fc::stringstream( utf8_str ) );
-      fc::buffered_istream bin( in );
-      from_stream( bin, ptype, max_depth );
-      try { bin.peek(); } catch ( const eof_exception& e ) { return true; }
-      return false;
+      string_input in( utf8_str );
+      variant_from_string_input( in, ptype, max_depth );
+      return in.pos == in.end;
    }
 
 } // fc
@@ -0,0 +1,178 @@
+#include <fc/io/json_writer.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/string.hpp>
+
+namespace fc
+{
+   namespace
+   {
+      /**
+       *  Characters escaped by escape_string() in json.cpp: the control characters, '"' and '\\'.
+       *  0 for characters that are copied as they are, otherwise the character following the '\\'
+       *  ('u' for the \u00XX form).
+       */
+      struct escape_table
+      {
+         char escape[256];
+
+         escape_table()
+         {
+            for( int c = 0; c < 256; ++c )
+               escape[c] = c < 0x20 ? 'u' : 0;
+            escape[ uint8_t('\b') ] = 'b';
+            escape[ uint8_t('\f') ] = 'f';
+            escape[ uint8_t('\n') ] = 'n';
+            escape[ uint8_t('\r') ] = 'r';
+            escape[ uint8_t('\t') ] = 't';
+            escape[ uint8_t('\\') ] = '\\';
+            escape[ uint8_t('"') ]  = '"';
+         }
+      };
+
+      const escape_table escapes;
+
+      void append_uint( std::string& out, uint64_t u )
+      {
+         char digits[20];
+         char* end = digits + sizeof(digits);
+         char* p = end;
+         do
+         {
+            *--p = char( '0' + u % 10 );
+            u /= 10;
+         } while( u != 0 );
+         out.append( p, end - p );
+      }
+
+      void append_int( std::string& out, int64_t i )
+      {
+         if( i < 0 )
+         {
+            out.push_back( '-' );
+            append_uint( out, uint64_t( 0 ) - uint64_t( i ) );
+         }
+         else
+            append_uint( out, uint64_t( i ) );
+      }
+   }
+
+   void json_writer::write( int64_t i )
+   {
+      const bool quote = _format == json::stringify_large_ints_and_doubles && ( i > INT32_MAX || i < INT32_MIN );
+      if( quote )
+         _out.push_back( '"' );
+      append_int( _out, i );
+      if( quote )
+         _out.push_back( '"' );
+   }
+
+   void json_writer::write( uint64_t u )
+   {
+      const bool quote = _format == json::stringify_large_ints_and_doubles && u > 0xffffffff;
+      if( quote )
+         _out.push_back( '"' );
+      append_uint( _out, u );
+      if( quote )
+         _out.push_back( '"' );
+   }
+
+   void json_writer::write( double d )
+   {
+      const bool quote = _format == json::stringify_large_ints_and_doubles;
+      if( quote )
+         _out.push_back( '"' );
+      _out.append( fc::to_string( d ) );
+      if( quote )
+         _out.push_back( '"' );
+   }
+
+   void json_writer::write( const char* str, size_t len )
+   {
+      static const char hex[] = "0123456789abcdef";
+      _out.reserve( _out.size() + len + 2 );
+      _out.push_back( '"' );
+      const char* run = str;
+      const char* const end = str + len;
+      for( const char* p = str; p != end; ++p )
+      {
+         const char e = escapes.escape[ uint8_t( *p ) ];
+         if( e == 0 )
+            continue;
+         _out.append( run, p - run );
+         run = p + 1;
+         _out.push_back( '\\' );
+         _out.push_back( e );
+         if( e == 'u' )
+         {
+            _out.append( "00", 2 );
+            _out.push_back( hex[ uint8_t( *p ) >> 4 ] );
+            _out.push_back( hex[ uint8_t( *p ) & 0xf ] );
+         }
+      }
+      _out.append( run, end - run );
+      _out.push_back( '"' );
+   }
+
+   void json_writer::write( const variants& a, uint32_t max_depth )
+   {
+      begin_array();
+      for( auto itr = a.begin(); itr != a.end(); ++itr )
+      {
+         if( itr != a.begin() )
+            separator();
+         write( *itr, max_depth );
+      }
+      end_array();
+   }
+
+   void json_writer::write( const variant_object& o, uint32_t max_depth )
+   {
+      begin_object();
+      for( auto itr = o.begin(); itr != o.end(); ++itr )
+      {
+         if( itr != o.begin() )
+            separator();
+         key( itr->key() );
+         write( itr->value(), max_depth );
+      }
+      end_object();
+   }
+
+   void json_writer::write( const variant& v, uint32_t max_depth )
+   {
+      FC_ASSERT( max_depth > 0, "Too many nested objects!" );
+      switch( v.get_type() )
+      {
+         case variant::null_type:
+            write_null();
+            return;
+         case variant::int64_type:
+            write( v.as_int64() );
+            return;
+         case variant::uint64_type:
+            write( v.as_uint64() );
+            return;
+         case variant::double_type:
+            write( v.as_double() );
+            return;
+         case variant::bool_type:
+            write( v.as_bool() );
+            return;
+         case variant::string_type:
+            write( v.get_string() );
+            return;
+         case variant::blob_type:
+            write( v.as_string() );
+            return;
+         case variant::array_type:
+            write( v.get_array(), max_depth - 1 );
+            return;
+         case variant::object_type:
+            write( v.get_object(), max_depth - 1 );
+            return;
+         default:
+            FC_THROW_EXCEPTION( fc::invalid_arg_exception, "Unsupported variant type: ${type}", ( "type", v.get_type() ) );
+      }
+   }
+
+} // fc
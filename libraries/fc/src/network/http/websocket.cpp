@@ -11,6 +11,11 @@
 #include <fc/thread/thread.hpp>
 #include <fc/asio.hpp>
 
+#include <boost/scope_exit.hpp>
+
+#include <atomic>
+#include <mutex>
+
 #ifdef DEFAULT_LOGGER
 # undef DEFAULT_LOGGER
 #endif
@@ -163,6 +168,11 @@ namespace fc { namespace http {
                auto ec = _ws_connection->send( message );
                FC_ASSERT( !ec, "websocket send failed: ${msg}", ("msg",ec.message() ) );
             }
+            virtual void send_binary_message( const std::vector<char>& message )override
+            {
+               auto ec = _ws_connection->send( message.data(), message.size(), websocketpp::frame::opcode::binary );
+               FC_ASSERT( !ec, "websocket send failed: ${msg}", ("msg",ec.message() ) );
+            }
             virtual void close( int64_t code, const std::string& reason  )override
             {
                _ws_connection->close(code,reason);
@@ -178,235 +188,263 @@ namespace fc { namespace http {
 
       typedef websocketpp::lib::shared_ptr<boost::asio::ssl::context> context_ptr;
 
-      class websocket_server_impl
+      /**
+       * The io_service the sockets of a server are handled on, see websocket_server
+       */
+      class server_io_service
       {
          public:
-            websocket_server_impl()
-            :_server_thread( fc::thread::current() )
+            server_io_service( uint16_t io_threads, const std::string& name )
             {
-
-               _server.clear_access_channels( websocketpp::log::alevel::all );
-               _server.init_asio(&fc::asio::default_io_service());
-               _server.set_reuse_addr(true);
-               _server.set_open_handler( [&]( connection_hdl hdl ){
-                    _server_thread.async( [&](){
-                       auto new_con = std::make_shared<websocket_connection_impl<websocket_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl) );
-                       _on_connection( _connections[hdl] = new_con );
-                    }).wait();
-               });
-               _server.set_message_handler( [&]( connection_hdl hdl, websocket_server_type::message_ptr msg ){
-                    _server_thread.async( [&](){
-                       auto current_con = _connections.find(hdl);
-                       assert( current_con != _connections.end() );
-                       wdump(("server")(msg->get_payload()));
-                       //std::cerr<<"recv: "<<msg->get_payload()<<"\n";
-                       auto payload = msg->get_payload();
-                       std::shared_ptr<websocket_connection> con = current_con->second;
-                       ++_pending_messages;
-                       auto f = fc::async([this,con,payload](){ if( _pending_messages ) --_pending_messages; con->on_message( payload ); });
-                       if( _pending_messages > 100 ) 
-                         f.wait();
-                    }).wait();
-               });
-
-               _server.set_socket_init_handler( [&](websocketpp::connection_hdl hdl, boost::asio::ip::tcp::socket& s ) {
-                      boost::asio::ip::tcp::no_delay option(true);
-                      s.lowest_layer().set_option(option);
-               } );
-
-               _server.set_http_handler( [&]( connection_hdl hdl ){
-                    _server_thread.async( [&](){
-                       auto current_con = std::make_shared<websocket_connection_impl<websocket_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl) );
-                       _on_connection( current_con );
-
-                       auto con = _server.get_con_from_hdl(hdl);
-                       con->defer_http_response();
-                       std::string request_body = con->get_request_body();
-                       wdump(("server")(request_body));
-
-                       fc::async([current_con, request_body, con] {
-                          std::string response = current_con->on_http(request_body);
-                          idump((response));
-                          con->set_body( response );
-                          con->set_status( websocketpp::http::status_code::ok );
-                          con->send_http_response();
-                          current_con->closed();
-                       }, "call on_http");
-                    }).wait();
-               });
-
-               _server.set_close_handler( [&]( connection_hdl hdl ){
-                    _server_thread.async( [&](){
-                       if( _connections.find(hdl) != _connections.end() )
-                       {
-                          _connections[hdl]->closed();
-                          _connections.erase( hdl );
-                       }
-                       else
-                       {
-                            wlog( "unknown connection closed" );
-                       }
-                       if( _connections.empty() && _closed )
-                          _closed->set_value();
-                    }).wait();
-               });
-
-               _server.set_fail_handler( [&]( connection_hdl hdl ){
-                    if( _server.is_listening() )
-                    {
-                       _server_thread.async( [&](){
-                          if( _connections.find(hdl) != _connections.end() )
-                          {
-                             _connections[hdl]->closed();
-                             _connections.erase( hdl );
-                          }
-                          else
-                          {
-                            wlog( "unknown connection failed" );
-                          }
-                          if( _connections.empty() && _closed )
-                             _closed->set_value();
-                       }).wait();
-                    }
-               });
+               if( io_threads == 0 )
+                  return;
+               _io.reset( new boost::asio::io_service() );
+               _work.reset( new boost::asio::io_service::work( *_io ) );
+               for( uint16_t i = 0; i < io_threads; ++i )
+               {
+                  _threads.emplace_back( [this, i, name]()
+                  {
+                     fc::thread::current().set_name( name + " #" + fc::to_string(i) );
+
+                     BOOST_SCOPE_EXIT(void)
+                     {
+                        fc::thread::cleanup();
+                     }
+                     BOOST_SCOPE_EXIT_END
+
+                     while( !_io->stopped() )
+                     {
+                        try
+                        {
+                           _io->run();
+                        }
+                        catch( const fc::exception& e )
+                        {
+                           elog( "Caught unhandled exception in ${name} I/O thread: ${e}", ("name",name)("e",e) );
+                        }
+                        catch( const std::exception& e )
+                        {
+                           elog( "Caught unhandled exception in ${name} I/O thread: ${e}", ("name",name)("e",e.what()) );
+                        }
+                        catch( ... )
+                        {
+                           elog( "Caught unhandled exception in ${name} I/O thread", ("name",name) );
+                        }
+                     }
+                  } );
+               }
             }
-            ~websocket_server_impl()
-            {
-               if( _server.is_listening() )
-                  _server.stop_listening();
 
-               if( _connections.size() )
-                  _closed = new fc::promise<void>();
+            ~server_io_service() { stop(); }
 
-               auto cpy_con = _connections;
-               for( auto item : cpy_con )
-                  _server.close( item.first, 0, "server exit" );
+            boost::asio::io_service& get() { return _io ? *_io : fc::asio::default_io_service(); }
 
-               if( _closed ) _closed->wait();
+            /// Stops and joins the threads of a server that has its own, handlers that are still queued don't run
+            void stop()
+            {
+               if( !_io )
+                  return;
+               _work.reset();
+               _io->stop();
+               for( auto& t : _threads )
+                  t.join();
+               _threads.clear();
             }
 
-            typedef std::map<connection_hdl, websocket_connection_ptr,std::owner_less<connection_hdl> > con_map;
-
-            con_map                  _connections;
-            fc::thread&              _server_thread;
-            websocket_server_type    _server;
-            on_connection_handler    _on_connection;
-            fc::promise<void>::ptr   _closed;
-            uint32_t                 _pending_messages = 0;
+         private:
+            std::unique_ptr<boost::asio::io_service>        _io;
+            std::unique_ptr<boost::asio::io_service::work>  _work;
+            std::vector<boost::thread>                      _threads;
       };
 
-      class websocket_tls_server_impl
+      /**
+       * What websocket_server_impl and websocket_tls_server_impl have in common.  The websocketpp handlers run on
+       * the I/O threads; they only wait for the server thread when a connection is opened, so that the
+       * connection handler has set up the connection before its first message is parsed.
+       */
+      template<typename server_type>
+      class basic_websocket_server_impl
       {
          public:
-            websocket_tls_server_impl( const string& server_pem, const string& ssl_password )
-            :_server_thread( fc::thread::current() )
-            {
-               //if( server_pem.size() )
-               {
-                  _server.set_tls_init_handler( [=]( websocketpp::connection_hdl hdl ) -> context_ptr {
-                        context_ptr ctx = websocketpp::lib::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::tlsv1);
-                        try {
-                           ctx->set_options(boost::asio::ssl::context::default_workarounds |
-                           boost::asio::ssl::context::no_sslv2 |
-                           boost::asio::ssl::context::no_sslv3 |
-                           boost::asio::ssl::context::single_dh_use);
-                           ctx->set_password_callback([=](std::size_t max_length, boost::asio::ssl::context::password_purpose){ return ssl_password;});
-                           ctx->use_certificate_chain_file(server_pem);
-                           ctx->use_private_key_file(server_pem, boost::asio::ssl::context::pem);
-                        } catch (std::exception& e) {
-                           std::cout << e.what() << std::endl;
-                        }
-                        return ctx;
-                  });
-               }
+            typedef websocket_connection_impl<typename server_type::connection_ptr> connection_type;
+
+            /// Messages handed to the server thread but not yet handled beyond which an I/O thread waits for it
+            static const uint32_t max_pending_messages = 100;
 
+            basic_websocket_server_impl( uint16_t io_threads, const std::string& name )
+            :_server_thread( fc::thread::current() ), _io( io_threads, name )
+            {
                _server.clear_access_channels( websocketpp::log::alevel::all );
-               _server.init_asio(&fc::asio::default_io_service());
+               _server.init_asio( &_io.get() );
                _server.set_reuse_addr(true);
-               _server.set_open_handler( [&]( connection_hdl hdl ){
-                    _server_thread.async( [&](){
-                       auto new_con = std::make_shared<websocket_connection_impl<websocket_tls_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl) );
-                       _on_connection( _connections[hdl] = new_con );
-                    }).wait();
+               _server.set_open_handler( [this]( connection_hdl hdl ){
+                    auto new_con = std::make_shared<connection_type>( _server.get_con_from_hdl(hdl) );
+                    {
+                       std::lock_guard<std::mutex> lock( _connections_mutex );
+                       _connections[hdl] = new_con;
+                    }
+                    _server_thread.async( [&](){ _on_connection( new_con ); } ).wait();
                });
-               _server.set_message_handler( [&]( connection_hdl hdl, websocket_server_type::message_ptr msg ){
-                    _server_thread.async( [&](){
-                       auto current_con = _connections.find(hdl);
-                       assert( current_con != _connections.end() );
-                       auto received = msg->get_payload();
-                       std::shared_ptr<websocket_connection> con = current_con->second;
-                       fc::async([con,received](){ con->on_message( received ); });
-                    }).wait();
+
+               _server.set_message_handler( [this]( connection_hdl hdl, typename server_type::message_ptr msg ){
+                    websocket_connection_ptr con = find_connection( hdl );
+                    if( !con )
+                    {
+                       wlog( "message for unknown connection" );
+                       return;
+                    }
+                    std::string payload = msg->get_payload();
+                    wdump(("server")(payload));
+                    fc::optional<fc::variant> parsed = con->parse_message( payload );
+                    ++_pending_messages;
+                    auto f = _server_thread.async( [this,con,payload,parsed](){
+                       --_pending_messages;
+                       con->on_message( payload, parsed );
+                    }, "websocket message" );
+                    if( _pending_messages > max_pending_messages )
+                       f.wait();
                });
 
-               _server.set_http_handler( [&]( connection_hdl hdl ){
-                    _server_thread.async( [&](){
+               _server.set_http_handler( [this]( connection_hdl hdl ){
+                    auto con = _server.get_con_from_hdl(hdl);
+                    auto current_con = std::make_shared<connection_type>( con );
+                    _server_thread.async( [&](){ _on_connection( current_con ); } ).wait();
 
-                       auto current_con = std::make_shared<websocket_connection_impl<websocket_tls_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl) );
-                       try{
-                          _on_connection( current_con );
+                    con->defer_http_response();
+                    std::string request_body = con->get_request_body();
+                    wdump(("server")(request_body));
+                    fc::optional<fc::variant> parsed = current_con->parse_message( request_body );
 
-                          auto con = _server.get_con_from_hdl(hdl);
-                          wdump(("server")(con->get_request_body()));
-                          auto response = current_con->on_http( con->get_request_body() );
+                    _server_thread.async( [current_con, request_body, parsed, con](){
+                       try
+                       {
+                          std::string response = current_con->on_http( request_body, parsed );
                           idump((response));
                           con->set_body( response );
                           con->set_status( websocketpp::http::status_code::ok );
-                       } catch ( const fc::exception& e )
+                       }
+                       catch( const fc::exception& e )
                        {
-                         edump((e.to_detail_string()));
+                          edump((e.to_detail_string()));
+                          con->set_status( websocketpp::http::status_code::internal_server_error );
                        }
+                       con->send_http_response();
                        current_con->closed();
-
-                    }).wait();
+                    }, "call on_http" );
                });
 
-               _server.set_close_handler( [&]( connection_hdl hdl ){
-                    _server_thread.async( [&](){
-                       _connections[hdl]->closed();
-                       _connections.erase( hdl );
-                    }).wait();
+               _server.set_close_handler( [this]( connection_hdl hdl ){
+                    remove_connection( hdl );
                });
 
-               _server.set_fail_handler( [&]( connection_hdl hdl ){
+               _server.set_fail_handler( [this]( connection_hdl hdl ){
                     if( _server.is_listening() )
-                    {
-                       _server_thread.async( [&](){
-                          if( _connections.find(hdl) != _connections.end() )
-                          {
-                             _connections[hdl]->closed();
-                             _connections.erase( hdl );
-                          }
-                       }).wait();
-                    }
+                       remove_connection( hdl );
                });
             }
-            ~websocket_tls_server_impl()
+
+            ~basic_websocket_server_impl()
             {
                if( _server.is_listening() )
                   _server.stop_listening();
-               auto cpy_con = _connections;
-               for( auto item : cpy_con )
-                  _server.close( item.first, 0, "server exit" );
+
+               std::vector<connection_hdl> open_connections;
+               {
+                  std::lock_guard<std::mutex> lock( _connections_mutex );
+                  for( const auto& item : _connections )
+                     open_connections.push_back( item.first );
+                  if( !open_connections.empty() )
+                     _closed = new fc::promise<void>();
+               }
+
+               for( const auto& hdl : open_connections )
+               {
+                  websocketpp::lib::error_code ec;
+                  _server.close( hdl, 0, "server exit", ec );
+               }
+
+               if( _closed ) _closed->wait();
+               _io.stop();
+            }
+
+            websocket_connection_ptr find_connection( connection_hdl hdl )
+            {
+               std::lock_guard<std::mutex> lock( _connections_mutex );
+               auto itr = _connections.find( hdl );
+               return itr != _connections.end() ? itr->second : websocket_connection_ptr();
+            }
+
+            /// Called on an I/O thread, the connection's closed signal is raised on the server thread
+            void remove_connection( connection_hdl hdl )
+            {
+               websocket_connection_ptr con;
+               {
+                  std::lock_guard<std::mutex> lock( _connections_mutex );
+                  auto itr = _connections.find( hdl );
+                  if( itr == _connections.end() )
+                  {
+                     wlog( "unknown connection closed" );
+                     return;
+                  }
+                  con = itr->second;
+                  _connections.erase( itr );
+               }
+               _server_thread.async( [this,con](){
+                  con->closed();
+                  std::lock_guard<std::mutex> lock( _connections_mutex );
+                  if( _connections.empty() && _closed && !_closed->ready() )
+                     _closed->set_value();
+               }, "websocket connection closed" );
             }
 
             typedef std::map<connection_hdl, websocket_connection_ptr,std::owner_less<connection_hdl> > con_map;
 
-            con_map                     _connections;
             fc::thread&                 _server_thread;
-            websocket_tls_server_type   _server;
+            server_io_service           _io;
+            server_type                 _server;
+            std::mutex                  _connections_mutex;
+            con_map                     _connections;
             on_connection_handler       _on_connection;
             fc::promise<void>::ptr      _closed;
+            std::atomic<uint32_t>       _pending_messages{0};
       };
 
+      class websocket_server_impl : public basic_websocket_server_impl<websocket_server_type>
+      {
+         public:
+            explicit websocket_server_impl( uint16_t io_threads )
+            :basic_websocket_server_impl<websocket_server_type>( io_threads, "websocket server" )
+            {
+               _server.set_socket_init_handler( []( websocketpp::connection_hdl hdl, boost::asio::ip::tcp::socket& s ) {
+                      boost::asio::ip::tcp::no_delay option(true);
+                      s.lowest_layer().set_option(option);
+               } );
+            }
+      };
 
-
-
-
-
-
-
-
+      class websocket_tls_server_impl : public basic_websocket_server_impl<websocket_tls_server_type>
+      {
+         public:
+            websocket_tls_server_impl( const string& server_pem, const string& ssl_password, uint16_t io_threads )
+            :basic_websocket_server_impl<websocket_tls_server_type>( io_threads, "websocket tls server" )
+            {
+               _server.set_tls_init_handler( [=]( websocketpp::connection_hdl hdl ) -> context_ptr {
+                     context_ptr ctx = websocketpp::lib::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::tlsv1);
+                     try {
+                        ctx->set_options(boost::asio::ssl::context::default_workarounds |
+                        boost::asio::ssl::context::no_sslv2 |
+                        boost::asio::ssl::context::no_sslv3 |
+                        boost::asio::ssl::context::single_dh_use);
+                        ctx->set_password_callback([=](std::size_t max_length, boost::asio::ssl::context::password_purpose){ return ssl_password;});
+                        ctx->use_certificate_chain_file(server_pem);
+                        ctx->use_private_key_file(server_pem, boost::asio::ssl::context::pem);
+                     } catch (std::exception& e) {
+                        std::cout << e.what() << std::endl;
+                     }
+                     return ctx;
+               });
+            }
+      };
 
 
 
@@ -596,7 +634,7 @@ namespace fc { namespace http {
 
    } // namespace detail
 
-   websocket_server::websocket_server():my( new detail::websocket_server_impl() ) {}
+   websocket_server::websocket_server( uint16_t io_threads ):my( new detail::websocket_server_impl( io_threads ) ) {}
    websocket_server::~websocket_server(){}
 
    void websocket_server::on_connection( const on_connection_handler& handler )
@@ -620,7 +658,8 @@ namespace fc { namespace http {
 
 
 
-   websocket_tls_server::websocket_tls_server( const string& server_pem, const string& ssl_password ):my( new detail::websocket_tls_server_impl(server_pem, ssl_password) ) {}
+   websocket_tls_server::websocket_tls_server( const string& server_pem, const string& ssl_password, uint16_t io_threads )
+   :my( new detail::websocket_tls_server_impl( server_pem, ssl_password, io_threads ) ) {}
    websocket_tls_server::~websocket_tls_server(){}
 
    void websocket_tls_server::on_connection( const on_connection_handler& handler )
@@ -0,0 +1,109 @@
+#include <fc/rpc/binary_api_connection.hpp>
+
+namespace fc { namespace rpc {
+
+binary_api_connection::~binary_api_connection()
+{
+}
+
+binary_api_connection::binary_api_connection( fc::http::websocket_connection& c, uint32_t max_depth )
+   : api_connection(max_depth),_connection(c)
+{
+   _rpc_state.add_method( "call", [this]( const params_type& params ) -> result_type
+   {
+      fc::datastream<const char*> args( params.data(), params.size() );
+      api_id_type api_id;
+      std::string method_name;
+      fc::raw::unpack( args, api_id, _max_conversion_depth );
+      fc::raw::unpack( args, method_name, _max_conversion_depth );
+
+      result_type result;
+      this->receive_call( api_id, method_name, args, result );
+      return result;
+   } );
+
+   _connection.on_message_handler( [this]( const std::string& msg ){ on_message(msg); } );
+   _connection.on_http_handler( []( const std::string& ) -> std::string {
+      FC_THROW( "the binary protocol is only served over websocket" );
+   } );
+   _connection.closed.connect( [this](){
+      _rpc_state.close();
+      closed();
+   } );
+}
+
+std::vector<char> binary_api_connection::send_call( api_id_type api_id, const string& method_name,
+                                                    const std::vector<char>& args )
+{
+   fc::datastream<size_t> size;
+   fc::raw::pack( size, api_id );
+   fc::raw::pack( size, method_name );
+   params_type params( size.tellp() + args.size() );
+   fc::datastream<char*> out( params.data(), params.size() );
+   fc::raw::pack( out, api_id );
+   fc::raw::pack( out, method_name );
+   if( args.size() )
+      out.write( args.data(), args.size() );
+
+   auto request = _rpc_state.start_remote_call( "call", std::move(params) );
+   _connection.send_binary_message( fc::raw::pack_to_vector( bmessage( request ), _max_conversion_depth ) );
+   return _rpc_state.wait_for_response( *request.id );
+}
+
+variant binary_api_connection::send_call( api_id_type api_id, string method_name, variants args )
+{
+   FC_THROW( "binary_api_connection can't call ${method} with variant arguments, bind the API with "
+             "binary_api_connection::get_remote_api()", ("method",method_name) );
+}
+
+variant binary_api_connection::send_call( string api_name, string method_name, variants args )
+{
+   FC_THROW( "calls by API name are not supported by the binary protocol" );
+}
+
+variant binary_api_connection::send_callback( uint64_t callback_id, variants args )
+{
+   FC_THROW( "callbacks are not supported by the binary protocol" );
+}
+
+void binary_api_connection::send_notice( uint64_t callback_id, variants args )
+{
+   FC_THROW( "callbacks are not supported by the binary protocol" );
+}
+
+void binary_api_connection::on_message( const std::string& message )
+{
+   try
+   {
+      bmessage msg;
+      fc::datastream<const char*> ds( message.data(), message.size() );
+      fc::raw::unpack( ds, msg, _max_conversion_depth );
+
+      if( msg.which() == bmessage::tag< bresponse >::value )
+      {
+         _rpc_state.handle_reply( msg.get< bresponse >() );
+         return;
+      }
+
+      const brequest& call = msg.get< brequest >();
+      bresponse reply;
+      try
+      {
+         reply = bresponse( call.id ? *call.id : 0, _rpc_state.local_call( call.method, call.params ) );
+      }
+      catch ( const fc::exception& e )
+      {
+         // without data, which would take more than the depth the message may be packed with; bstate only
+         // reads the message
+         reply = bresponse( call.id ? *call.id : 0, error_object{ 1, e.to_detail_string(), fc::optional<fc::variant>() } );
+      }
+      if( call.id )
+         _connection.send_binary_message( fc::raw::pack_to_vector( bmessage( reply ), _max_conversion_depth ) );
+   }
+   catch ( const fc::exception& e )
+   {
+      wdump((e.to_detail_string()));
+   }
+}
+
+} } // namespace fc::rpc
@@ -10,7 +10,7 @@ http_api_connection::~http_api_connection()
 http_api_connection::http_api_connection(uint32_t max_depth)
 :api_connection(max_depth)
 {
-   _rpc_state.add_method( "call", [this]( const variants& args ) -> variant
+   _rpc_state.add_json_method( "call", [this]( const variants& args, json_writer& result )
    {
       // TODO: This logic is duplicated between http_api_connection and websocket_api_connection
       // it should be consolidated into one place instead of copy-pasted
@@ -26,10 +26,11 @@ http_api_connection::http_api_connection(uint32_t max_depth)
       else
          api_id = args[0].as_uint64();
 
-      return this->receive_call(
+      this->receive_call(
          api_id,
          args[1].as_string(),
-         args[2].get_array() );
+         args[2].get_array(),
+         result );
    } );
 
    _rpc_state.add_method( "notice", [this]( const variants& args ) -> variant
@@ -50,9 +51,9 @@ http_api_connection::http_api_connection(uint32_t max_depth)
       return variant();
    } );
 
-   _rpc_state.on_unhandled( [&]( const std::string& method_name, const variants& args )
+   _rpc_state.on_unhandled_json( [&]( const std::string& method_name, const variants& args, json_writer& result )
    {
-      return this->receive_call( 0, method_name, args );
+      this->receive_call( 0, method_name, args, result );
    } );
 }
 
@@ -110,9 +111,15 @@ void http_api_connection::on_request( const fc::http::request& req, const fc::ht
          {
             try
             {
-               fc::variant result( _rpc_state.local_call( call.method, call.params ), _max_conversion_depth );
-               resp_body = fc::json::to_string( fc::variant( fc::rpc::response( *call.id, result ), _max_conversion_depth),
-                                                fc::json::stringify_large_ints_and_doubles, _max_conversion_depth );
+               // the result is written straight into the body, see fc::json_writer
+               json_writer writer( resp_body, fc::json::stringify_large_ints_and_doubles );
+               writer.begin_object();
+               writer.key( "id" );
+               writer.write( int64_t( *call.id ) );
+               writer.separator();
+               writer.key( "result" );
+               _rpc_state.local_call( call.method, call.params, writer, _max_conversion_depth );
+               writer.end_object();
                resp_status = http::reply::OK;
             }
             FC_CAPTURE_AND_RETHROW( (call.method)(call.params) );
@@ -13,9 +13,15 @@ void state::add_method( const fc::string& name, method m )
    _methods.emplace(std::pair<std::string,method>(name,fc::move(m)));
 }
 
+void state::add_json_method( const fc::string& name, json_method m )
+{
+   _json_methods.emplace(std::pair<std::string,json_method>(name,fc::move(m)));
+}
+
 void state::remove_method( const fc::string& name )
 {
    _methods.erase(name);
+   _json_methods.erase(name);
 }
 
 variant state::local_call( const string& method_name, const variants& args )
@@ -27,6 +33,21 @@ variant state::local_call( const string& method_name, const variants& args )
    return method_itr->second(args);
 }
 
+void state::local_call( const string& method_name, const variants& args, json_writer& result, uint32_t max_depth )
+{
+   auto json_itr = _json_methods.find(method_name);
+   if( json_itr != _json_methods.end() )
+      return json_itr->second( args, result );
+   auto method_itr = _methods.find(method_name);
+   if( method_itr != _methods.end() )
+      return result.write( method_itr->second(args), max_depth );
+   if( _unhandled_json )
+      return _unhandled_json( method_name, args, result );
+   if( _unhandled )
+      return result.write( _unhandled( method_name, args ), max_depth );
+   FC_ASSERT( false, "Unknown Method: ${name}", ("name",method_name) );
+}
+
 void  state::handle_reply( const response& response )
 {
    auto await = _awaiting.find( response.id );
@@ -65,5 +86,9 @@ void state::on_unhandled( const std::function<variant(const string&, const varia
 {
    _unhandled = unhandled;
 }
+void state::on_unhandled_json( const std::function<void(const string&, const variants&, json_writer&)>& unhandled )
+{
+   _unhandled_json = unhandled;
+}
 
 } }  // namespace fc::rpc
@@ -10,7 +10,7 @@ websocket_api_connection::~websocket_api_connection()
 websocket_api_connection::websocket_api_connection( fc::http::websocket_connection& c, uint32_t max_depth )
    : api_connection(max_depth),_connection(c)
 {
-   _rpc_state.add_method( "call", [this]( const variants& args ) -> variant
+   _rpc_state.add_json_method( "call", [this]( const variants& args, json_writer& result )
    {
       FC_ASSERT( args.size() == 3 && args[2].is_array() );
       api_id_type api_id;
@@ -26,10 +26,11 @@ websocket_api_connection::websocket_api_connection( fc::http::websocket_connecti
 
       idump( (args) );
 
-      return this->receive_call(
+      this->receive_call(
          api_id,
          args[1].as_string(),
-         args[2].get_array() );
+         args[2].get_array(),
+         result );
    } );
 
    _rpc_state.add_method( "notice", [this]( const variants& args ) -> variant
@@ -46,13 +47,19 @@ websocket_api_connection::websocket_api_connection( fc::http::websocket_connecti
       return variant();
    } );
 
-   _rpc_state.on_unhandled( [&]( const std::string& method_name, const variants& args )
+   _rpc_state.on_unhandled_json( [&]( const std::string& method_name, const variants& args, json_writer& result )
    {
-      return this->receive_call( 0, method_name, args );
+      this->receive_call( 0, method_name, args, result );
    } );
 
    _connection.on_message_handler( [&]( const std::string& msg ){ on_message(msg,true); } );
    _connection.on_http_handler( [&]( const std::string& msg ){ return on_message(msg,false); } );
+   // runs on the server's I/O threads
+   _connection.on_parse_handler( [this]( const std::string& msg ){
+      return fc::json::from_string(msg, fc::json::legacy_parser, _max_conversion_depth);
+   } );
+   _connection.on_parsed_message_handler( [&]( const std::string& msg, const variant& var ){ on_message(msg,var,true); } );
+   _connection.on_parsed_http_handler( [&]( const std::string& msg, const variant& var ){ return on_message(msg,var,false); } );
    _connection.closed.connect( [this](){ closed(); } );
 }
 
@@ -106,7 +113,22 @@ std::string websocket_api_connection::on_message(
    wdump((message));
    try
    {
-      auto var = fc::json::from_string(message, fc::json::legacy_parser, _max_conversion_depth);
+      return on_message( message, fc::json::from_string(message, fc::json::legacy_parser, _max_conversion_depth), send_message );
+   }
+   catch ( const fc::exception& e )
+   {
+      wdump((e.to_detail_string()));
+      return e.to_detail_string();
+   }
+}
+
+std::string websocket_api_connection::on_message(
+   const std::string& message,
+   const variant& var,
+   bool send_message /* = true */ )
+{
+   try
+   {
       const auto& var_obj = var.get_object();
 
       if( var_obj.contains( "method" ) )
@@ -121,7 +143,19 @@ std::string websocket_api_connection::on_message(
                auto start = time_point::now();
 #endif
 
-               auto result = _rpc_state.local_call( call.method, call.params );
+               // the result is written straight into the reply, see fc::json_writer
+               std::string reply;
+               json_writer writer( reply, fc::json::stringify_large_ints_and_doubles );
+               writer.begin_object();
+               writer.key( "id" );
+               writer.write( int64_t( call.id ? *call.id : 0 ) );
+               writer.separator();
+               writer.key( "jsonrpc" );
+               writer.write( std::string( "2.0" ) );
+               writer.separator();
+               writer.key( "result" );
+               _rpc_state.local_call( call.method, call.params, writer, _max_conversion_depth );
+               writer.end_object();
 
 #ifdef LOG_LONG_API
                auto end = time_point::now();
@@ -134,7 +168,6 @@ std::string websocket_api_connection::on_message(
 
                if( call.id )
                {
-                  auto reply = fc::json::to_string( response( *call.id, result, "2.0" ), fc::json::stringify_large_ints_and_doubles, _max_conversion_depth );
                   if( send_message )
                      _connection.send_message( reply );
                   return reply;
@@ -1,4 +1,5 @@
 #include <fc/api.hpp>
+#include <fc/io/raw.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/rpc/api_connection.hpp>
 #include <fc/rpc/websocket_api.hpp>
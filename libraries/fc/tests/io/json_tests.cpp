@@ -8,10 +8,44 @@
 #include <fc/io/fstream.hpp>
 #include <fc/io/iostream.hpp>
 #include <fc/io/json.hpp>
+#include <fc/io/json_writer.hpp>
 #include <fc/io/sstream.hpp>
+#include <fc/time.hpp>
 
 #include <fstream>
 
+namespace json_writer_test {
+   enum color { red, green };
+
+   struct inner
+   {
+      color                          c = green;
+      fc::optional<std::string>      note;
+      std::vector<char>              data;
+   };
+
+   struct outer
+   {
+      std::string                    name;
+      uint64_t                       big = 0;
+      int32_t                        small = 0;
+      double                         ratio = 0;
+      bool                           flag = false;
+      fc::time_point_sec             when;
+      fc::optional<uint16_t>         missing;
+      fc::optional<inner>            present;
+      std::vector<inner>             items;
+      std::map<std::string,int64_t>  by_name;
+      std::map<uint32_t,inner>       by_id;
+      std::pair<int8_t,std::string>  tagged;
+      fc::variant                    extra;
+   };
+}
+
+FC_REFLECT_ENUM( json_writer_test::color, (red)(green) )
+FC_REFLECT( json_writer_test::inner, (c)(note)(data) )
+FC_REFLECT( json_writer_test::outer, (name)(big)(small)(ratio)(flag)(when)(missing)(present)(items)(by_name)(by_id)(tagged)(extra) )
+
 BOOST_AUTO_TEST_SUITE(json_tests)
 
 static void replace_some( std::string& str )
@@ -332,6 +366,75 @@ BOOST_AUTO_TEST_CASE(recursion_test)
    BOOST_CHECK_THROW( fc::json::to_string( nested, fc::json::stringify_large_ints_and_doubles, 9 ), fc::assert_exception );
 }
 
+BOOST_AUTO_TEST_CASE(string_reader_test)
+{
+   const std::string long_text = "a string that is long enough to be scanned in more than one chunk";
+   std::vector<std::string> tests
+   { // ' is used instead of " as above
+      "{'jsonrpc':'2.0','id':1,'method':'call','params':[0,'get_block',[12345]]}",
+      "  \t\r\n  {  'a' : [ 1 , -2 , 3.5 , -0.25 , 18446744073709551615 , -9223372036854775808 ] ,\n  'b' : null }",
+      "['" + long_text + "','" + long_text + "\\\\" + long_text + "\\'','\\t\\n\\r\\x\\u00e9']",
+      "['\xc3\xa9\xe2\x82\xac " + long_text + "']",
+      "[true,false,null,nul,fals]",
+      "[12abc,-3x,1.5e3,7]",
+      "{'a':1,'a':2}",
+      "[,,1,,2,]",
+      "17",
+      "'" + long_text + "'",
+      "tru",
+   };
+
+   for( std::string str : tests )
+   {
+      replace_some( str );
+      fc::istream_ptr in( new fc::stringstream( str ) );
+      fc::buffered_istream bin( in );
+      BOOST_CHECK_EQUAL( fc::json::to_string( fc::json::from_stream( bin ) ), fc::json::to_string( fc::json::from_string( str ) ) );
+   }
+
+   BOOST_CHECK( fc::json::is_valid( "{\"a\":\"" + long_text + "\"}" ) );
+   BOOST_CHECK( !fc::json::is_valid( "{\"a\":\"" + long_text + "\"} " ) );
+   BOOST_CHECK( !fc::json::is_valid( "[1]]" ) );
+
+   test_fail_string( "['" + long_text + "\x04']" );
+   test_fail_string( "['" + long_text );
+   test_fail_string( "[1,2" + std::string( 40, ' ' ) );
+   test_fail_string( "[1.2.3]" );
+}
+
+BOOST_AUTO_TEST_CASE(json_writer_test)
+{
+   using namespace json_writer_test;
+   outer o;
+   o.name = "quote\" backslash\\ tab\t bell\a \x1f utf8 \xc3\xa9";
+   o.big = 0x100000001ULL;
+   o.small = -7;
+   o.ratio = 0.25;
+   o.flag = true;
+   o.when = fc::time_point_sec( 1500000000 );
+   o.present = inner();
+   o.present->note = "set";
+   o.present->data = { 'a', '\0', char(0xff) };
+   o.items.resize( 2 );
+   o.items[1].c = red;
+   o.by_name["b"] = -0x100000000LL;
+   o.by_name["a"] = 1;
+   o.by_id[3] = inner();
+   o.tagged = std::make_pair( int8_t(-1), std::string( "x" ) );
+   o.extra = fc::mutable_variant_object( "k", fc::variants{ 1, "two", fc::variant() } );
+
+   for( auto format : { fc::json::stringify_large_ints_and_doubles, fc::json::legacy_generator } )
+   {
+      BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( o, 20 ), format ), fc::to_json_string( o, format, 20 ) );
+      BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( o.items, 20 ), format ), fc::to_json_string( o.items, format, 20 ) );
+      BOOST_CHECK_EQUAL( fc::json::to_string( o.extra, format ), fc::to_json_string( o.extra, format ) );
+   }
+
+   std::vector<std::vector<std::vector<int>>> nested( 1, std::vector<std::vector<int>>( 1 ) );
+   BOOST_CHECK_EQUAL( "[[[]]]", fc::to_json_string( nested ) );
+   BOOST_CHECK_THROW( fc::to_json_string( nested, fc::json::stringify_large_ints_and_doubles, 2 ), fc::assert_exception );
+}
+
 BOOST_AUTO_TEST_CASE(rethrow_test)
 {
    fc::variants biggie;
@@ -1,7 +1,9 @@
 #include <boost/test/unit_test.hpp>
 
 #include <fc/network/http/websocket.hpp>
+#include <fc/io/json.hpp>
 
+#include <atomic>
 #include <iostream>
 
 BOOST_AUTO_TEST_SUITE(fc_network)
@@ -84,4 +86,63 @@ BOOST_AUTO_TEST_CASE(websocket_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(websocket_io_threads_test)
+{
+    std::vector<std::unique_ptr<fc::http::websocket_client>> clients;
+    std::vector<fc::http::websocket_connection_ptr> c_conns;
+    std::vector<std::string> echoes( 4 );
+    std::atomic<uint32_t> parsed_on_server_thread( 0 );
+    fc::thread* server_thread = &fc::thread::current();
+    {
+        fc::http::websocket_server server( 2 );
+        server.on_connection([&]( const fc::http::websocket_connection_ptr& c ){
+                c->on_parse_handler([&]( const std::string& s ){
+                    if( &fc::thread::current() == server_thread )
+                        ++parsed_on_server_thread;
+                    return fc::json::from_string( s );
+                });
+                c->on_message_handler([c]( const std::string& s ){
+                    c->send_message( "unparsed: " + s );
+                });
+                c->on_parsed_message_handler([c]( const std::string& s, const fc::variant& v ){
+                    c->send_message( "echo: " + fc::to_string( v.as_int64() ) );
+                });
+            });
+
+        int port = 0;
+        for( int i = 0; !port && i < 5; ++i )
+        {
+           int candidate = std::rand() % 50000 + 10000;
+           try
+           {
+              server.listen( candidate );
+              port = candidate;
+           }
+           catch( std::exception& ignore )
+           {
+              // if the port is busy, listen() will throw a std::exception, do nothing here.
+           }
+        }
+        BOOST_REQUIRE( port );
+        server.start_accept();
+
+        for( size_t i = 0; i < echoes.size(); ++i )
+        {
+            clients.emplace_back( new fc::http::websocket_client() );
+            c_conns.push_back( clients.back()->connect( "ws://localhost:" + fc::to_string(port) ) );
+            c_conns.back()->on_message_handler([&echoes, i](const std::string& s){
+                        echoes[i] = s;
+                    });
+        }
+        for( size_t i = 0; i < c_conns.size(); ++i )
+            c_conns[i]->send_message( fc::to_string( uint64_t( i ) ) );
+        c_conns[0]->send_message( "[1," );
+        fc::usleep( fc::seconds(1) );
+        for( size_t i = 1; i < echoes.size(); ++i )
+            BOOST_CHECK_EQUAL( "echo: " + fc::to_string( uint64_t( i ) ), echoes[i] );
+        BOOST_CHECK_EQUAL( "unparsed: [1,", echoes[0] );
+        BOOST_CHECK_EQUAL( 0u, parsed_on_server_thread.load() );
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
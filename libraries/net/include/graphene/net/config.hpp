@@ -81,6 +81,21 @@
 
 #define GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING      200
 
+/**
+ * While syncing, we try to keep every peer busy for this long beyond a round
+ * trip, see sync_fetch_scheduler.  Blocks among the next this many blocks we
+ * need that take too long to arrive are requested from a faster peer as well.
+ */
+#define GRAPHENE_NET_SYNC_PIPELINE_TIME_MS                   1000
+#define GRAPHENE_NET_SYNC_STRAGGLER_LOOKAHEAD                20
+
+/**
+ * How many blocks the client told us it keeps until their ancestors arrive
+ * we remember, so that we don't fetch them again while we sync.  Matches the
+ * number of unlinked blocks the fork database caches.
+ */
+#define GRAPHENE_NET_MAX_BUFFERED_BLOCKS                     1024
+
 /**
  * During normal operation, how many items will be fetched from each
  * peer at a time.  This will only come into play when the network
@@ -0,0 +1,122 @@
+#pragma once
+#include <graphene/net/config.hpp>
+#include <graphene/net/core_messages.hpp>
+
+#include <fc/time.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace graphene { namespace net {
+
+  /**
+   * What the sync_fetch_scheduler has measured about a peer
+   */
+  struct sync_peer_statistics
+  {
+    fc::microseconds round_trip_time;        ///< smoothed time from a request sent to an idle peer to the block, zero until measured
+    fc::microseconds round_trip_variation;
+    double           bytes_per_second = 0;   ///< smoothed rate at which the peer delivers back to back blocks, zero until measured
+    uint32_t         congestion_window = 0;  ///< grows with every block delivered, halved when a request straggles
+    uint32_t         blocks_received = 0;
+    uint32_t         requests_straggled = 0; ///< requests that took so long that we asked another peer for the block
+  };
+
+  /**
+   * Decides how many sync blocks we keep requested from each peer, and which requests take so long that
+   * the block should be requested from another peer as well.
+   *
+   * For every peer the scheduler measures the round trip time of a request sent while the peer had nothing
+   * else to do, and the bandwidth at which the peer delivers blocks that were requested together.  The
+   * window of a peer is the number of blocks it can deliver in one round trip plus the pipeline time, and
+   * never more than its congestion window, which starts small, grows by one with every block the peer
+   * delivers and is halved whenever one of its requests straggles.
+   *
+   * A request straggles when it is outstanding longer than its deadline: the smoothed round trip time
+   * plus four times its variation, plus twice the time the peer needs to deliver the blocks requested
+   * before it and the block itself.
+   *
+   * The scheduler only keeps the books, node_impl sends the requests.  It never reads the clock, so
+   * that it can be driven by simulated peers.
+   */
+  class sync_fetch_scheduler
+  {
+    public:
+      typedef const void* peer_handle;
+
+      explicit sync_fetch_scheduler( uint32_t max_window = GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING,
+                                     fc::microseconds pipeline_time = fc::milliseconds(GRAPHENE_NET_SYNC_PIPELINE_TIME_MS) );
+
+      void     set_max_window( uint32_t max_window );
+      uint32_t get_max_window()const { return _max_window; }
+
+      void requested( peer_handle peer, const item_hash_t& block_id, fc::time_point now );
+      void received( peer_handle peer, const item_hash_t& block_id, uint32_t bytes, fc::time_point now );
+      /// The peer told us it doesn't have the block after all
+      void not_available( peer_handle peer, const item_hash_t& block_id );
+      void remove_peer( peer_handle peer );
+
+      /// Number of blocks we may keep requested from @p peer
+      uint32_t window( peer_handle peer )const;
+      uint32_t outstanding( peer_handle peer )const;
+      uint32_t free_slots( peer_handle peer )const;
+      bool     is_outstanding( peer_handle peer, const item_hash_t& block_id )const;
+
+      /// When a block requested from @p peer right now would be expected to arrive
+      fc::time_point expected_arrival( peer_handle peer, fc::time_point now )const;
+
+      /**
+       * @return the blocks whose request has passed its deadline, with the peer they were requested from,
+       *         leaving out those already requested from a second peer
+       */
+      std::vector< std::pair< item_hash_t, peer_handle > > straggling_requests( fc::time_point now )const;
+
+      /**
+       * Picks the peer among @p candidates that is expected to deliver a straggling block first, leaving out
+       * peers without free slots and peers it is already requested from.
+       * @return nullptr if there is none
+       */
+      peer_handle pick_peer_for_straggler( const item_hash_t& block_id, const std::vector< peer_handle >& candidates,
+                                           fc::time_point now )const;
+
+      /// The earliest deadline of an outstanding request after @p now, or fc::time_point::maximum() if there is none
+      fc::time_point next_deadline( fc::time_point now )const;
+
+      const sync_peer_statistics* get_statistics( peer_handle peer )const;
+
+      static const uint32_t initial_window = 16;
+      static const uint32_t min_window = 2;
+
+    private:
+      struct request
+      {
+        item_hash_t    block_id;
+        fc::time_point requested_at;
+        uint32_t       queued_ahead; ///< requests outstanding at the peer when this one was sent
+      };
+
+      struct peer_state
+      {
+        sync_peer_statistics  statistics;
+        std::vector< request > requests; ///< outstanding, in the order they were sent
+        fc::time_point        last_arrival;
+      };
+
+      fc::microseconds block_delivery_time( const peer_state& state )const;
+      fc::time_point   deadline( const peer_state& state, const request& r )const;
+      void             forget_request( const item_hash_t& block_id );
+
+      uint32_t                          _max_window;
+      fc::microseconds                  _pipeline_time;
+      double                            _average_block_size = 0;
+      std::map< peer_handle, peer_state > _peers;
+      std::unordered_set< item_hash_t > _straggling; ///< blocks that are requested from more than one peer
+  };
+
+} } // graphene::net
+
+FC_REFLECT( graphene::net::sync_peer_statistics,
+            (round_trip_time)(round_trip_variation)(bytes_per_second)(congestion_window)(blocks_received)(requests_straggled) )
@@ -75,6 +75,7 @@
 #include <graphene/net/peer_database.hpp>
 #include <graphene/net/peer_connection.hpp>
 #include <graphene/net/stcp_socket.hpp>
+#include <graphene/net/sync_fetch_scheduler.hpp>
 #include <graphene/net/config.hpp>
 #include <graphene/net/exceptions.hpp>
 
@@ -444,6 +445,7 @@ namespace graphene { namespace net { namespace detail {
       typedef std::unordered_map<graphene::net::block_id_type, fc::time_point> active_sync_requests_map;
 
       active_sync_requests_map              _active_sync_requests; /// list of sync blocks we've asked for from peers but have not yet received
+      sync_fetch_scheduler                  _sync_scheduler; /// how many sync blocks we keep requested from each peer, and which requests straggle
       std::list<graphene::net::block_message> _new_received_sync_items; /// list of sync blocks we've just received but haven't yet tried to process
       std::list<graphene::net::block_message> _received_sync_items; /// list of sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain
       // @}
@@ -518,6 +520,11 @@ namespace graphene { namespace net { namespace detail {
       std::unordered_set<peer_connection_ptr>                     _terminating_connections;
 
       boost::circular_buffer<item_hash_t> _most_recent_blocks_accepted; // the /n/ most recent blocks we've accepted (currently tuned to the max number of connections)
+      /// blocks the client keeps until their ancestors arrive, which we don't fetch again while syncing
+      // @{
+      std::unordered_set<item_hash_t>     _buffered_blocks;
+      boost::circular_buffer<item_hash_t> _buffered_blocks_by_age;
+      // @}
 
       uint32_t _sync_item_type;
       uint32_t _total_number_of_unfetched_items; /// the number of items we still need to fetch while syncing
@@ -583,6 +590,8 @@ namespace graphene { namespace net { namespace detail {
       void trigger_p2p_network_connect_loop();
 
       bool have_already_received_sync_item( const item_hash_t& item_hash );
+      void remember_buffered_block( const item_hash_t& block_id );
+      void skip_buffered_sync_items();
       void request_sync_item_from_peer( const peer_connection_ptr& peer, const item_hash_t& item_to_request );
       void request_sync_items_from_peer( const peer_connection_ptr& peer, const std::vector<item_hash_t>& items_to_request );
       void fetch_sync_items_loop();
@@ -805,6 +814,7 @@ namespace graphene { namespace net { namespace detail {
       _peer_connection_retry_timeout(GRAPHENE_NET_DEFAULT_PEER_CONNECTION_RETRY_TIME),
       _peer_inactivity_timeout(GRAPHENE_NET_PEER_HANDSHAKE_INACTIVITY_TIMEOUT),
       _most_recent_blocks_accepted(_maximum_number_of_connections),
+      _buffered_blocks_by_age(GRAPHENE_NET_MAX_BUFFERED_BLOCKS),
       _total_number_of_unfetched_items(0),
       _rate_limiter(0, 0),
       _last_reported_number_of_connections(0),
@@ -995,12 +1005,68 @@ namespace graphene { namespace net { namespace detail {
                           [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _new_received_sync_items.end();                          ;
     }
 
+    void node_impl::remember_buffered_block( const item_hash_t& block_id )
+    {
+      VERIFY_CORRECT_THREAD();
+      if( !_buffered_blocks.insert( block_id ).second )
+        return;
+      if( _buffered_blocks_by_age.full() )
+        _buffered_blocks.erase( _buffered_blocks_by_age.front() );
+      _buffered_blocks_by_age.push_back( block_id );
+    }
+
+    /**
+     * Pops the blocks the client has buffered from the front of our peers' lists of sync items.  The client
+     * links a buffered block as soon as the block before it is pushed, so there is no need to fetch it again.
+     */
+    void node_impl::skip_buffered_sync_items()
+    {
+      VERIFY_CORRECT_THREAD();
+      if( _buffered_blocks.empty() )
+        return;
+
+      std::vector<peer_connection_ptr> peers_needing_next_batch;
+      // has_item() may yield, so work on a copy of our connections
+      std::vector<peer_connection_ptr> peers( _active_connections.begin(), _active_connections.end() );
+      for( const peer_connection_ptr& peer : peers )
+      {
+        while( !peer->ids_of_items_to_get.empty() &&
+               _buffered_blocks.find( peer->ids_of_items_to_get.front() ) != _buffered_blocks.end() )
+        {
+          const item_hash_t block_id = peer->ids_of_items_to_get.front();
+          if( !_delegate->has_item( item_id( graphene::net::block_message_type, block_id ) ) )
+          {
+            // the client dropped it after all, fetch it as usual
+            _buffered_blocks.erase( block_id );
+            break;
+          }
+          const fc::time_point_sec block_time = _delegate->get_block_time( block_id );
+          if( peer->ids_of_items_to_get.empty() || peer->ids_of_items_to_get.front() != block_id )
+            continue; // the list changed while we were waiting on the client
+
+          dlog( "Skipping sync item ${id} from peer ${endpoint}, the client already has it buffered",
+                ("id", block_id)("endpoint", peer->get_remote_endpoint()) );
+          peer->ids_of_items_to_get.pop_front();
+          peer->last_block_delegate_has_seen = block_id;
+          peer->last_block_time_delegate_has_seen = block_time;
+          _received_sync_items.remove_if( [&block_id]( const graphene::net::block_message& message ) { return message.block_id == block_id; } );
+          if( peer->ids_of_items_to_get.empty() &&
+              peer->number_of_unfetched_item_ids == 0 &&
+              peer->ids_of_items_being_processed.empty() )
+            peers_needing_next_batch.push_back( peer );
+        }
+      }
+      for( const peer_connection_ptr& peer : peers_needing_next_batch )
+        fetch_next_batch_of_item_ids_from_peer( peer.get() );
+    }
+
     void node_impl::request_sync_item_from_peer( const peer_connection_ptr& peer, const item_hash_t& item_to_request )
     {
       VERIFY_CORRECT_THREAD();
       dlog( "requesting item ${item_hash} from peer ${endpoint}", ("item_hash", item_to_request )("endpoint", peer->get_remote_endpoint() ) );
       item_id item_id_to_request( graphene::net::block_message_type, item_to_request );
       _active_sync_requests.insert( active_sync_requests_map::value_type(item_to_request, fc::time_point::now() ) );
+      _sync_scheduler.requested( peer.get(), item_to_request, fc::time_point::now() );
       peer->last_sync_item_received_time = fc::time_point::now();
       peer->sync_items_requested_from_peer.insert(item_to_request);
       peer->send_message( fetch_items_message(item_id_to_request.item_type, std::vector<item_hash_t>{item_id_to_request.item_hash} ) );
@@ -1014,6 +1080,7 @@ namespace graphene { namespace net { namespace detail {
       for (const item_hash_t& item_to_request : items_to_request)
       {
         _active_sync_requests.insert( active_sync_requests_map::value_type(item_to_request, fc::time_point::now() ) );
+        _sync_scheduler.requested( peer.get(), item_to_request, fc::time_point::now() );
         peer->last_sync_item_received_time = fc::time_point::now();
         peer->sync_items_requested_from_peer.insert(item_to_request);
       }
@@ -1035,31 +1102,74 @@ namespace graphene { namespace net { namespace detail {
           {
             ASSERT_TASK_NOT_PREEMPTED();
             std::set<item_hash_t> sync_items_to_request;
+            const fc::time_point now = fc::time_point::now();
 
-            // for each idle peer that we're syncing with
+            // peers we can send sync item requests to, with the number of blocks each of them can take
+            std::map<peer_connection_ptr, uint32_t> free_slots;
             for( const peer_connection_ptr& peer : _active_connections )
-            {
               if( peer->we_need_sync_items_from_peer &&
-                  sync_item_requests_to_send.find(peer) == sync_item_requests_to_send.end() && // if we've already scheduled a request for this peer, don't consider scheduling another
-                  peer->idle() )
+                  !peer->inhibit_fetching_sync_blocks &&
+                  peer->items_requested_from_peer.empty() &&
+                  !peer->item_ids_requested_from_peer )
               {
-                if (!peer->inhibit_fetching_sync_blocks)
+                uint32_t slots = _sync_scheduler.free_slots( peer.get() );
+                if( slots > 0 )
+                  free_slots[peer] = slots;
+              }
+
+            // ask a second peer for the blocks we need next whose requests straggle, before anything else,
+            // because the blocks after them can't be pushed until they arrive
+            std::set<item_hash_t> items_needed_next;
+            for( const peer_connection_ptr& peer : _active_connections )
+              if( peer->we_need_sync_items_from_peer )
+                for( unsigned i = 0; i < peer->ids_of_items_to_get.size() && i < GRAPHENE_NET_SYNC_STRAGGLER_LOOKAHEAD; ++i )
+                  items_needed_next.insert( peer->ids_of_items_to_get[i] );
+            for( const auto& straggler : _sync_scheduler.straggling_requests( now ) )
+            {
+              if( items_needed_next.find( straggler.first ) == items_needed_next.end() ||
+                  have_already_received_sync_item( straggler.first ) )
+                continue;
+              std::vector<sync_fetch_scheduler::peer_handle> candidates;
+              for( const auto& peer_and_slots : free_slots )
+                if( sync_item_requests_to_send[peer_and_slots.first].size() < peer_and_slots.second &&
+                    std::find( peer_and_slots.first->ids_of_items_to_get.begin(), peer_and_slots.first->ids_of_items_to_get.end(),
+                               straggler.first ) != peer_and_slots.first->ids_of_items_to_get.end() )
+                  candidates.push_back( peer_and_slots.first.get() );
+              sync_fetch_scheduler::peer_handle chosen = _sync_scheduler.pick_peer_for_straggler( straggler.first, candidates, now );
+              if( !chosen )
+                continue;
+              for( const auto& peer_and_slots : free_slots )
+                if( peer_and_slots.first.get() == chosen )
                 {
-                  // loop through the items it has that we don't yet have on our blockchain
-                  for( unsigned i = 0; i < peer->ids_of_items_to_get.size(); ++i )
+                  dlog( "request for sync item ${item_hash} straggles, requesting it from ${endpoint} as well",
+                        ("item_hash", straggler.first)("endpoint", peer_and_slots.first->get_remote_endpoint()) );
+                  sync_item_requests_to_send[peer_and_slots.first].push_back( straggler.first );
+                  sync_items_to_request.insert( straggler.first );
+                }
+            }
+
+            // for each peer that we're syncing with that has room for more requests
+            for( const auto& peer_and_slots : free_slots )
+            {
+              const peer_connection_ptr& peer = peer_and_slots.first;
+              std::vector<item_hash_t>& requests_for_peer = sync_item_requests_to_send[peer];
+              if( requests_for_peer.size() < peer_and_slots.second )
+              {
+                // loop through the items it has that we don't yet have on our blockchain
+                for( unsigned i = 0; i < peer->ids_of_items_to_get.size(); ++i )
+                {
+                  item_hash_t item_to_potentially_request = peer->ids_of_items_to_get[i];
+                  // if we don't already have this item in our temporary storage and we haven't requested from another syncing peer
+                  if( !have_already_received_sync_item(item_to_potentially_request) && // already got it, but for some reson it's still in our list of items to fetch
+                      _buffered_blocks.find(item_to_potentially_request) == _buffered_blocks.end() && // the client keeps it until it links, see skip_buffered_sync_items()
+                      sync_items_to_request.find(item_to_potentially_request) == sync_items_to_request.end() &&  // we have already decided to request it from another peer during this iteration
+                      _active_sync_requests.find(item_to_potentially_request) == _active_sync_requests.end() ) // we've requested it in a previous iteration and we're still waiting for it to arrive
                   {
-                    item_hash_t item_to_potentially_request = peer->ids_of_items_to_get[i];
-                    // if we don't already have this item in our temporary storage and we haven't requested from another syncing peer
-                    if( !have_already_received_sync_item(item_to_potentially_request) && // already got it, but for some reson it's still in our list of items to fetch
-                        sync_items_to_request.find(item_to_potentially_request) == sync_items_to_request.end() &&  // we have already decided to request it from another peer during this iteration
-                        _active_sync_requests.find(item_to_potentially_request) == _active_sync_requests.end() ) // we've requested it in a previous iteration and we're still waiting for it to arrive
-                    {
-                      // then schedule a request from this peer
-                      sync_item_requests_to_send[peer].push_back(item_to_potentially_request);
-                      sync_items_to_request.insert( item_to_potentially_request );
-                      if (sync_item_requests_to_send[peer].size() >= _maximum_blocks_per_peer_during_syncing)
-                        break;
-                    }
+                    // then schedule a request from this peer
+                    requests_for_peer.push_back(item_to_potentially_request);
+                    sync_items_to_request.insert( item_to_potentially_request );
+                    if (requests_for_peer.size() >= peer_and_slots.second)
+                      break;
                   }
                 }
               }
@@ -1068,7 +1178,8 @@ namespace graphene { namespace net { namespace detail {
 
           // make all the requests we scheduled in the loop above
           for( auto sync_item_request : sync_item_requests_to_send )
-            request_sync_items_from_peer( sync_item_request.first, sync_item_request.second );
+            if( !sync_item_request.second.empty() )
+              request_sync_items_from_peer( sync_item_request.first, sync_item_request.second );
           sync_item_requests_to_send.clear();
         }
         else
@@ -1077,8 +1188,19 @@ namespace graphene { namespace net { namespace detail {
         if( !_sync_items_to_fetch_updated )
         {
           dlog( "no sync items to fetch right now, going to sleep" );
+          // wake up when the next outstanding request straggles, if nothing else happens before
+          const fc::time_point next_deadline = _sync_scheduler.next_deadline( fc::time_point::now() );
           _retrigger_fetch_sync_items_loop_promise = fc::promise<void>::ptr( new fc::promise<void>("graphene::net::retrigger_fetch_sync_items_loop") );
-          _retrigger_fetch_sync_items_loop_promise->wait();
+          try
+          {
+            if( next_deadline == fc::time_point::maximum() )
+              _retrigger_fetch_sync_items_loop_promise->wait();
+            else
+              _retrigger_fetch_sync_items_loop_promise->wait_until( next_deadline + fc::milliseconds(1) );
+          }
+          catch ( fc::timeout_exception& ) //intentionally not logged
+          {
+          }
           _retrigger_fetch_sync_items_loop_promise.reset();
         }
       } // while( !canceled )
@@ -2842,6 +2964,7 @@ namespace graphene { namespace net { namespace detail {
       if (sync_item_iter != originating_peer->sync_items_requested_from_peer.end())
       {
         originating_peer->sync_items_requested_from_peer.erase(sync_item_iter);
+        _sync_scheduler.not_available(originating_peer, requested_item.item_hash);
 
         if (originating_peer->peer_needs_sync_items_from_us)
           originating_peer->inhibit_fetching_sync_blocks = true;
@@ -3024,6 +3147,7 @@ namespace graphene { namespace net { namespace detail {
 
       // if we had requested any sync or regular items from this peer that we haven't
       // received yet, reschedule them to be fetched from another peer
+      _sync_scheduler.remove_peer(originating_peer);
       if (!originating_peer->sync_items_requested_from_peer.empty())
       {
         for (auto sync_item : originating_peer->sync_items_requested_from_peer)
@@ -3235,6 +3359,8 @@ namespace graphene { namespace net { namespace detail {
       }
       dlog("currently ${count} blocks in the process of being handled", ("count", _handle_message_calls_in_progress.size()));
 
+      skip_buffered_sync_items();
+
 
       if (_suspend_fetching_sync_blocks)
       {
@@ -3369,6 +3495,17 @@ namespace graphene { namespace net { namespace detail {
       VERIFY_CORRECT_THREAD();
       dlog( "received a sync block from peer ${endpoint}", ("endpoint", originating_peer->get_remote_endpoint() ) );
 
+      // a block whose request straggled arrives twice, the copy that comes second is no longer needed by anyone
+      bool still_needed = false;
+      for (const peer_connection_ptr& peer : _active_connections)
+        if (std::find(peer->ids_of_items_to_get.begin(), peer->ids_of_items_to_get.end(), block_message_to_process.block_id) != peer->ids_of_items_to_get.end())
+          still_needed = true;
+      if (!still_needed || have_already_received_sync_item(block_message_to_process.block_id))
+      {
+        dlog( "already received sync block ${id}, ignoring this copy", ("id", block_message_to_process.block_id) );
+        return;
+      }
+
       // add it to the front of _received_sync_items, then process _received_sync_items to try to
       // pass as many messages as possible to the client.
       _new_received_sync_items.push_front( block_message_to_process );
@@ -3486,6 +3623,12 @@ namespace graphene { namespace net { namespace detail {
       {
         throw;
       }
+      catch (const block_buffered_exception& e)
+      {
+        // the client keeps the block until the blocks before it arrive, sync with the peer to get those
+        remember_buffered_block(block_message_to_process.block_id);
+        restart_sync_exception = e;
+      }
       catch (const unlinkable_block_exception& e)
       {
         restart_sync_exception = e;
@@ -3554,6 +3697,8 @@ namespace graphene { namespace net { namespace detail {
           {
             originating_peer->last_sync_item_received_time = fc::time_point::now();
             _active_sync_requests.erase(block_message_to_process.block_id);
+            _sync_scheduler.received(originating_peer, block_message_to_process.block_id, message_to_process.size,
+                                     originating_peer->last_sync_item_received_time);
             process_block_during_sync(originating_peer, block_message_to_process, message_hash);
             if (originating_peer->idle())
             {
@@ -3565,6 +3710,8 @@ namespace graphene { namespace net { namespace detail {
               else
                 trigger_fetch_sync_items_loop();
             }
+            else if (_sync_scheduler.free_slots(originating_peer) > 0)
+              trigger_fetch_sync_items_loop(); // keep the peer's window full
             return;
           }
           catch (const fc::canceled_exception& e)
@@ -5004,7 +5151,10 @@ namespace graphene { namespace net { namespace detail {
       if (params.contains("maximum_number_of_sync_blocks_to_prefetch"))
         _maximum_number_of_sync_blocks_to_prefetch = params["maximum_number_of_sync_blocks_to_prefetch"].as<uint32_t>(1);
       if (params.contains("maximum_blocks_per_peer_during_syncing"))
+      {
         _maximum_blocks_per_peer_during_syncing = params["maximum_blocks_per_peer_during_syncing"].as<uint32_t>(1);
+        _sync_scheduler.set_max_window(_maximum_blocks_per_peer_during_syncing);
+      }
 
       _desired_number_of_connections = std::min(_desired_number_of_connections, _maximum_number_of_connections);
 
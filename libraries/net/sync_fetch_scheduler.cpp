@@ -0,0 +1,264 @@
+#include <graphene/net/sync_fetch_scheduler.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace graphene { namespace net {
+
+namespace {
+
+  // used until a peer has been measured
+  const fc::microseconds default_round_trip_time = fc::milliseconds(500);
+  const fc::microseconds default_block_delivery_time = fc::milliseconds(50);
+  // a request is never considered straggling before this much time has passed
+  const fc::microseconds min_straggler_timeout = fc::milliseconds(250);
+
+  fc::microseconds abs( fc::microseconds t ) { return fc::microseconds( std::abs( t.count() ) ); }
+
+  template< typename Requests >
+  auto find_request( Requests& requests, const item_hash_t& block_id ) -> decltype( requests.begin() )
+  {
+    return std::find_if( requests.begin(), requests.end(),
+                         [&block_id]( const typename Requests::value_type& r ) { return r.block_id == block_id; } );
+  }
+
+} // anonymous
+
+const uint32_t sync_fetch_scheduler::initial_window;
+const uint32_t sync_fetch_scheduler::min_window;
+
+sync_fetch_scheduler::sync_fetch_scheduler( uint32_t max_window, fc::microseconds pipeline_time )
+  : _max_window( std::max( max_window, 1u ) ), _pipeline_time( pipeline_time )
+{
+}
+
+void sync_fetch_scheduler::set_max_window( uint32_t max_window )
+{
+  _max_window = std::max( max_window, 1u );
+  for( auto& peer : _peers )
+    peer.second.statistics.congestion_window = std::min( peer.second.statistics.congestion_window, _max_window );
+}
+
+void sync_fetch_scheduler::requested( peer_handle peer, const item_hash_t& block_id, fc::time_point now )
+{
+  auto itr = _peers.find( peer );
+  if( itr == _peers.end() )
+  {
+    itr = _peers.emplace( peer, peer_state() ).first;
+    itr->second.statistics.congestion_window = std::min( initial_window, _max_window );
+  }
+  peer_state& state = itr->second;
+  if( is_outstanding( peer, block_id ) )
+    return;
+
+  // requested from another peer already: that request straggles
+  for( auto& other : _peers )
+    if( other.first != peer && is_outstanding( other.first, block_id ) )
+    {
+      _straggling.insert( block_id );
+      sync_peer_statistics& statistics = other.second.statistics;
+      statistics.congestion_window = std::max( statistics.congestion_window / 2, std::min( min_window, _max_window ) );
+      ++statistics.requests_straggled;
+    }
+
+  state.requests.push_back( request{ block_id, now, uint32_t( state.requests.size() ) } );
+}
+
+void sync_fetch_scheduler::received( peer_handle peer, const item_hash_t& block_id, uint32_t bytes, fc::time_point now )
+{
+  auto itr = _peers.find( peer );
+  if( itr == _peers.end() )
+    return;
+  peer_state& state = itr->second;
+  auto r = find_request( state.requests, block_id );
+  if( r == state.requests.end() )
+    return;
+  const request done = *r;
+  state.requests.erase( r );
+
+  sync_peer_statistics& statistics = state.statistics;
+  ++statistics.blocks_received;
+  _average_block_size = _average_block_size == 0 ? bytes : ( 7 * _average_block_size + bytes ) / 8;
+
+  if( done.queued_ahead == 0 && done.requested_at >= state.last_arrival )
+  {
+    // the peer had nothing else to send us before this block, so it took a full round trip (RFC 6298)
+    const fc::microseconds sample = now - done.requested_at;
+    if( statistics.round_trip_time.count() == 0 )
+    {
+      statistics.round_trip_time = sample;
+      statistics.round_trip_variation = fc::microseconds( sample.count() / 2 );
+    }
+    else
+    {
+      statistics.round_trip_variation = fc::microseconds( ( 3 * statistics.round_trip_variation.count()
+                                                            + abs( statistics.round_trip_time - sample ).count() ) / 4 );
+      statistics.round_trip_time = fc::microseconds( ( 7 * statistics.round_trip_time.count() + sample.count() ) / 8 );
+    }
+  }
+  else if( now > state.last_arrival )
+  {
+    // back to back with the previous block, the time in between was spent transferring this one
+    const double sample = bytes * 1000000.0 / ( now - state.last_arrival ).count();
+    statistics.bytes_per_second = statistics.bytes_per_second == 0 ? sample
+                                                                   : ( 7 * statistics.bytes_per_second + sample ) / 8;
+  }
+  state.last_arrival = now;
+
+  if( !_straggling.count( block_id ) )
+    statistics.congestion_window = std::min( statistics.congestion_window + 1, _max_window );
+  forget_request( block_id );
+}
+
+void sync_fetch_scheduler::not_available( peer_handle peer, const item_hash_t& block_id )
+{
+  auto itr = _peers.find( peer );
+  if( itr == _peers.end() )
+    return;
+  auto& requests = itr->second.requests;
+  auto r = find_request( requests, block_id );
+  if( r != requests.end() )
+    requests.erase( r );
+  forget_request( block_id );
+}
+
+void sync_fetch_scheduler::remove_peer( peer_handle peer )
+{
+  auto itr = _peers.find( peer );
+  if( itr == _peers.end() )
+    return;
+  const auto requests = std::move( itr->second.requests );
+  _peers.erase( itr );
+  for( const auto& r : requests )
+    forget_request( r.block_id );
+}
+
+void sync_fetch_scheduler::forget_request( const item_hash_t& block_id )
+{
+  if( !_straggling.count( block_id ) )
+    return;
+  for( const auto& peer : _peers )
+    if( is_outstanding( peer.first, block_id ) )
+      return;
+  _straggling.erase( block_id );
+}
+
+uint32_t sync_fetch_scheduler::window( peer_handle peer )const
+{
+  auto itr = _peers.find( peer );
+  if( itr == _peers.end() )
+    return std::min( initial_window, _max_window );
+
+  const peer_state& state = itr->second;
+  uint32_t result = state.statistics.congestion_window;
+  if( state.statistics.bytes_per_second > 0 )
+  {
+    // enough blocks to keep the peer busy for a round trip and the pipeline time
+    const fc::microseconds round_trip = state.statistics.round_trip_time.count() > 0 ? state.statistics.round_trip_time
+                                                                                      : default_round_trip_time;
+    const double blocks = double( ( round_trip + _pipeline_time ).count() ) / block_delivery_time( state ).count();
+    result = std::min< uint32_t >( result, std::max< double >( min_window, std::ceil( blocks ) ) );
+  }
+  return std::min( result, _max_window );
+}
+
+uint32_t sync_fetch_scheduler::outstanding( peer_handle peer )const
+{
+  auto itr = _peers.find( peer );
+  return itr == _peers.end() ? 0 : itr->second.requests.size();
+}
+
+uint32_t sync_fetch_scheduler::free_slots( peer_handle peer )const
+{
+  const uint32_t w = window( peer );
+  const uint32_t o = outstanding( peer );
+  return w > o ? w - o : 0;
+}
+
+bool sync_fetch_scheduler::is_outstanding( peer_handle peer, const item_hash_t& block_id )const
+{
+  auto itr = _peers.find( peer );
+  if( itr == _peers.end() )
+    return false;
+  return find_request( itr->second.requests, block_id ) != itr->second.requests.end();
+}
+
+fc::microseconds sync_fetch_scheduler::block_delivery_time( const peer_state& state )const
+{
+  if( state.statistics.bytes_per_second <= 0 || _average_block_size <= 0 )
+    return default_block_delivery_time;
+  return fc::microseconds( std::max< int64_t >( 1, _average_block_size * 1000000.0 / state.statistics.bytes_per_second ) );
+}
+
+fc::time_point sync_fetch_scheduler::deadline( const peer_state& state, const request& r )const
+{
+  const sync_peer_statistics& statistics = state.statistics;
+  const fc::microseconds round_trip = statistics.round_trip_time.count() > 0
+                                      ? statistics.round_trip_time + fc::microseconds( 4 * statistics.round_trip_variation.count() )
+                                      : default_round_trip_time;
+  const fc::microseconds delivery( 2 * int64_t( r.queued_ahead + 1 ) * block_delivery_time( state ).count() );
+  return r.requested_at + std::max( min_straggler_timeout, round_trip + delivery );
+}
+
+fc::time_point sync_fetch_scheduler::expected_arrival( peer_handle peer, fc::time_point now )const
+{
+  auto itr = _peers.find( peer );
+  if( itr == _peers.end() )
+    return now + default_round_trip_time + default_block_delivery_time;
+  const peer_state& state = itr->second;
+  const fc::microseconds round_trip = state.statistics.round_trip_time.count() > 0 ? state.statistics.round_trip_time
+                                                                                   : default_round_trip_time;
+  return now + round_trip + fc::microseconds( int64_t( state.requests.size() + 1 ) * block_delivery_time( state ).count() );
+}
+
+std::vector< std::pair< item_hash_t, sync_fetch_scheduler::peer_handle > >
+sync_fetch_scheduler::straggling_requests( fc::time_point now )const
+{
+  std::vector< std::pair< item_hash_t, peer_handle > > result;
+  for( const auto& peer : _peers )
+    for( const request& r : peer.second.requests )
+      if( !_straggling.count( r.block_id ) && deadline( peer.second, r ) < now )
+        result.emplace_back( r.block_id, peer.first );
+  return result;
+}
+
+sync_fetch_scheduler::peer_handle sync_fetch_scheduler::pick_peer_for_straggler( const item_hash_t& block_id,
+                                                                                 const std::vector< peer_handle >& candidates,
+                                                                                 fc::time_point now )const
+{
+  peer_handle best = nullptr;
+  fc::time_point best_arrival = fc::time_point::maximum();
+  for( peer_handle candidate : candidates )
+  {
+    if( free_slots( candidate ) == 0 || is_outstanding( candidate, block_id ) )
+      continue;
+    const fc::time_point arrival = expected_arrival( candidate, now );
+    if( arrival < best_arrival )
+    {
+      best = candidate;
+      best_arrival = arrival;
+    }
+  }
+  return best;
+}
+
+fc::time_point sync_fetch_scheduler::next_deadline( fc::time_point now )const
+{
+  fc::time_point result = fc::time_point::maximum();
+  for( const auto& peer : _peers )
+    for( const request& r : peer.second.requests )
+    {
+      const fc::time_point d = deadline( peer.second, r );
+      if( d > now && !_straggling.count( r.block_id ) )
+        result = std::min( result, d );
+    }
+  return result;
+}
+
+const sync_peer_statistics* sync_fetch_scheduler::get_statistics( peer_handle peer )const
+{
+  auto itr = _peers.find( peer );
+  return itr == _peers.end() ? nullptr : &itr->second.statistics;
+}
+
+} } // graphene::net
@@ -46,7 +46,7 @@ void block_info_plugin::on_applied_block( const chain::signed_block& b )
    const chain::dynamic_global_property_object& dgpo = db.get_dynamic_global_properties();
 
    info.block_id                    = b.id();
-   info.block_size                  = fc::raw::pack_size( b );
+   info.block_size                  = b.packed_size();
    info.average_block_size          = dgpo.average_block_size;
    info.aslot                       = dgpo.current_aslot;
    info.last_irreversible_block_num = dgpo.last_irreversible_block_num;
@@ -0,0 +1,67 @@
+
+#include <btcm/app/api_context.hpp>
+#include <btcm/app/application.hpp>
+
+#include <btcm/plugins/block_profiler/block_profiler_api.hpp>
+#include <btcm/plugins/block_profiler/block_profiler_plugin.hpp>
+
+namespace btcm { namespace plugin { namespace block_profiler {
+
+namespace detail {
+
+class block_profiler_api_impl
+{
+   public:
+      block_profiler_api_impl( btcm::app::application& _app );
+
+      std::shared_ptr< btcm::plugin::block_profiler::block_profiler_plugin > get_plugin();
+
+      block_profile get_block_profile();
+      std::vector< block_timing > get_recent_block_timings( uint32_t count );
+
+      btcm::app::application& app;
+};
+
+block_profiler_api_impl::block_profiler_api_impl( btcm::app::application& _app ) : app( _app )
+{}
+
+std::shared_ptr< btcm::plugin::block_profiler::block_profiler_plugin > block_profiler_api_impl::get_plugin()
+{
+   FC_ASSERT( app.get_plugin( "block_profiler" ), "The block_profiler plugin is not enabled" );
+   return app.get_plugin< block_profiler_plugin >( "block_profiler" );
+}
+
+block_profile block_profiler_api_impl::get_block_profile()
+{
+   return get_plugin()->get_block_profile();
+}
+
+std::vector< block_timing > block_profiler_api_impl::get_recent_block_timings( uint32_t count )
+{
+   const std::deque< block_timing >& recent = get_plugin()->recent_blocks();
+
+   FC_ASSERT( count <= 10000 );
+   count = std::min( uint32_t( recent.size() ), count );
+   return std::vector< block_timing >( recent.end() - count, recent.end() );
+}
+
+} // detail
+
+block_profiler_api::block_profiler_api( const btcm::app::api_context& ctx )
+{
+   my = std::make_shared< detail::block_profiler_api_impl >( ctx.app );
+}
+
+block_profile block_profiler_api::get_block_profile()
+{
+   return my->get_block_profile();
+}
+
+std::vector< block_timing > block_profiler_api::get_recent_block_timings( uint32_t count )
+{
+   return my->get_recent_block_timings( count );
+}
+
+void block_profiler_api::on_api_startup() { }
+
+} } } // btcm::plugin::block_profiler
@@ -0,0 +1,192 @@
+
+#include <btcm/chain/database.hpp>
+#include <btcm/chain/block_phase_timer.hpp>
+
+#include <btcm/plugins/block_profiler/block_profiler.hpp>
+#include <btcm/plugins/block_profiler/block_profiler_api.hpp>
+#include <btcm/plugins/block_profiler/block_profiler_plugin.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+namespace btcm { namespace plugin { namespace block_profiler {
+
+namespace {
+
+struct operation_name
+{
+   std::string& name;
+   operation_name( std::string& n ) : name( n ) {}
+
+   typedef void result_type;
+   template< typename T > void operator()( const T& )const
+   {
+      name = fc::get_typename< T >::name();
+      name = name.substr( name.find_last_of( ':' ) + 1 );
+      const auto suffix = name.rfind( "_operation" );
+      if( suffix != std::string::npos )
+         name.erase( suffix );
+   }
+};
+
+}
+
+void duration_histogram::add( uint64_t us )
+{
+   ++count;
+   total_us += us;
+   max_us = std::max( max_us, us );
+
+   size_t bucket = 0;
+   while( bucket + 1 < max_buckets && ( uint64_t( 1 ) << bucket ) <= us )
+      ++bucket;
+   if( buckets.size() <= bucket )
+      buckets.resize( bucket + 1 );
+   ++buckets[ bucket ];
+}
+
+block_profiler_plugin::block_profiler_plugin() {}
+block_profiler_plugin::~block_profiler_plugin() {}
+
+std::string block_profiler_plugin::plugin_name()const
+{
+   return "block_profiler";
+}
+
+void block_profiler_plugin::plugin_set_program_options(
+   boost::program_options::options_description& cli,
+   boost::program_options::options_description& cfg
+)
+{
+   cli.add_options()
+         ("block-profiler-log-interval", boost::program_options::value<uint32_t>()->default_value(1200),
+           "Log a summary of the block application times every N blocks, 0 to disable (default: 1200)")
+         ("block-profiler-recent-blocks", boost::program_options::value<uint32_t>()->default_value(100),
+           "Number of most recent blocks whose application times are kept for the API (default: 100)")
+         ;
+   cfg.add(cli);
+}
+
+void block_profiler_plugin::plugin_initialize( const boost::program_options::variables_map& options )
+{ try {
+   if( options.count( "block-profiler-log-interval" ) )
+      _log_interval = options["block-profiler-log-interval"].as< uint32_t >();
+   if( options.count( "block-profiler-recent-blocks" ) )
+      _recent_limit = options["block-profiler-recent-blocks"].as< uint32_t >();
+
+   for( int i = 0; i < chain::operation::count(); ++i )
+   {
+      chain::operation op;
+      op.set_which( i );
+      std::string name;
+      op.visit( operation_name( name ) );
+      _operation_names.push_back( name );
+   }
+
+   _applied_block_timings_conn = database().applied_block_timings.connect(
+      [this]( const chain::block_phase_timings& t ){ on_applied_block_timings( t ); } );
+} FC_CAPTURE_AND_RETHROW() }
+
+void block_profiler_plugin::plugin_startup()
+{
+   app().register_api_factory< block_profiler_api >( "block_profiler_api" );
+}
+
+void block_profiler_plugin::plugin_shutdown()
+{
+}
+
+void block_profiler_plugin::add_block( block_profile& profile, const chain::block_phase_timings& t )const
+{
+   if( profile.time.count == 0 )
+   {
+      profile.first_block = t.block_num;
+      profile.phases.resize( chain::BLOCK_PHASE_COUNT );
+      for( uint32_t p = 0; p < chain::BLOCK_PHASE_COUNT; ++p )
+         profile.phases[p].phase = chain::block_phase_name( chain::block_phase( p ) );
+      profile.operations.resize( _operation_names.size() );
+      for( size_t i = 0; i < _operation_names.size(); ++i )
+         profile.operations[i].operation = _operation_names[i];
+   }
+   profile.last_block = t.block_num;
+
+   profile.time.add( t.total().count() );
+   for( uint32_t p = 0; p < chain::BLOCK_PHASE_COUNT; ++p )
+      profile.phases[p].time.add( t.elapsed[p].count() );
+   for( size_t i = 0; i < t.operations.size() && i < profile.operations.size(); ++i )
+   {
+      const auto& timing = t.operations[i];
+      if( timing.count == 0 )
+         continue;
+      auto& op = profile.operations[i];
+      op.count += timing.count;
+      op.max_us = std::max( op.max_us, uint64_t( timing.max.count() ) );
+      op.time.add( timing.elapsed.count() );
+   }
+}
+
+void block_profiler_plugin::on_applied_block_timings( const chain::block_phase_timings& t )
+{
+   add_block( _profile, t );
+   add_block( _interval_profile, t );
+
+   if( _recent_limit > 0 )
+   {
+      block_timing timing;
+      timing.block_num = t.block_num;
+      timing.total_us = t.total().count();
+      for( uint32_t p = 0; p < chain::BLOCK_PHASE_COUNT; ++p )
+         timing.phases_us.emplace_back( chain::block_phase_name( chain::block_phase( p ) ), t.elapsed[p].count() );
+      for( size_t i = 0; i < t.operations.size() && i < _operation_names.size(); ++i )
+         if( t.operations[i].count > 0 )
+            timing.operations_us.emplace_back( _operation_names[i], t.operations[i].elapsed.count() );
+
+      _recent_blocks.push_back( std::move( timing ) );
+      while( _recent_blocks.size() > _recent_limit )
+         _recent_blocks.pop_front();
+   }
+
+   if( _log_interval > 0 && _interval_profile.time.count >= _log_interval )
+   {
+      log_summary();
+      _interval_profile = block_profile();
+   }
+}
+
+block_profile block_profiler_plugin::get_block_profile()const
+{
+   block_profile result = _profile;
+   result.operations.erase( std::remove_if( result.operations.begin(), result.operations.end(),
+                                            []( const operation_profile& op ){ return op.count == 0; } ),
+                            result.operations.end() );
+   return result;
+}
+
+void block_profiler_plugin::log_summary()const
+{
+   const block_profile& p = _interval_profile;
+
+   std::ostringstream phases;
+   for( const auto& phase : p.phases )
+      phases << " " << phase.phase << "=" << phase.time.total_us / p.time.count;
+
+   std::vector< const operation_profile* > ops;
+   for( const auto& op : p.operations )
+      if( op.count > 0 )
+         ops.push_back( &op );
+   std::sort( ops.begin(), ops.end(), []( const operation_profile* a, const operation_profile* b ){
+      return a->time.total_us > b->time.total_us;
+   });
+   std::ostringstream slowest;
+   for( size_t i = 0; i < ops.size() && i < 5; ++i )
+      slowest << " " << ops[i]->operation << "=" << ops[i]->time.total_us << "/" << ops[i]->count;
+
+   ilog( "Applied blocks ${first} to ${last} in ${mean}us on average, ${max}us at most. Mean us per phase:${phases}. Evaluator us/count:${ops}",
+         ("first",p.first_block)("last",p.last_block)("mean",p.time.total_us / p.time.count)("max",p.time.max_us)
+         ("phases",phases.str())("ops",slowest.str()) );
+}
+
+} } } // btcm::plugin::block_profiler
+
+BTCM_DEFINE_PLUGIN( block_profiler, btcm::plugin::block_profiler::block_profiler_plugin )
@@ -0,0 +1,96 @@
+
+#pragma once
+
+#include <fc/reflect/reflect.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace btcm { namespace plugin { namespace block_profiler {
+
+/**
+ * Distribution of durations in microseconds.  Bucket i counts the durations shorter than 2^i but not
+ * shorter than 2^(i-1) microseconds, the last bucket also counts all longer ones.
+ */
+struct duration_histogram
+{
+   static const size_t max_buckets = 32;
+
+   uint64_t                count    = 0;
+   uint64_t                total_us = 0;
+   uint64_t                max_us   = 0;
+   std::vector< uint64_t > buckets;
+
+   void add( uint64_t us );
+};
+
+struct phase_profile
+{
+   std::string               phase;
+   duration_histogram        time;                   ///< time spent in the phase per block
+};
+
+struct operation_profile
+{
+   std::string               operation;
+   uint64_t                  count          = 0;     ///< number of operations evaluated
+   uint64_t                  max_us         = 0;     ///< longest evaluation of a single operation
+   duration_histogram        time;                   ///< time spent evaluating these operations per block containing any
+};
+
+struct block_profile
+{
+   uint32_t                         first_block = 0;
+   uint32_t                         last_block  = 0;
+   duration_histogram               time;            ///< time spent applying each block
+   std::vector< phase_profile >     phases;
+   std::vector< operation_profile > operations;
+};
+
+/**
+ * Time spent applying a single block, by phase and by type of the operations it contains.
+ */
+struct block_timing
+{
+   uint32_t                                            block_num = 0;
+   uint64_t                                            total_us  = 0;
+   std::vector< std::pair< std::string, uint64_t > >   phases_us;
+   std::vector< std::pair< std::string, uint64_t > >   operations_us;
+};
+
+} } }
+
+FC_REFLECT( btcm::plugin::block_profiler::duration_histogram,
+   (count)
+   (total_us)
+   (max_us)
+   (buckets)
+   )
+
+FC_REFLECT( btcm::plugin::block_profiler::phase_profile,
+   (phase)
+   (time)
+   )
+
+FC_REFLECT( btcm::plugin::block_profiler::operation_profile,
+   (operation)
+   (count)
+   (max_us)
+   (time)
+   )
+
+FC_REFLECT( btcm::plugin::block_profiler::block_profile,
+   (first_block)
+   (last_block)
+   (time)
+   (phases)
+   (operations)
+   )
+
+FC_REFLECT( btcm::plugin::block_profiler::block_timing,
+   (block_num)
+   (total_us)
+   (phases_us)
+   (operations_us)
+   )
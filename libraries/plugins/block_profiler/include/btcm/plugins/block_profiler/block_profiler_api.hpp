@@ -0,0 +1,46 @@
+
+#pragma once
+
+#include <fc/api.hpp>
+
+#include <btcm/plugins/block_profiler/block_profiler.hpp>
+
+namespace btcm { namespace app {
+   struct api_context;
+} }
+
+namespace btcm { namespace plugin { namespace block_profiler {
+
+namespace detail {
+class block_profiler_api_impl;
+}
+
+class block_profiler_api
+{
+   public:
+      block_profiler_api( const btcm::app::api_context& ctx );
+
+      void on_api_startup();
+
+      /**
+       * @return histograms of the time spent applying the blocks since the node was started, by phase of
+       * block application and by operation type
+       */
+      block_profile get_block_profile();
+
+      /**
+       * @return the time spent applying each of the last @p count blocks, oldest first; at most as many
+       * blocks as configured with block-profiler-recent-blocks are kept
+       */
+      std::vector< block_timing > get_recent_block_timings( uint32_t count );
+
+   private:
+      std::shared_ptr< detail::block_profiler_api_impl > my;
+};
+
+} } }
+
+FC_API( btcm::plugin::block_profiler::block_profiler_api,
+   (get_block_profile)
+   (get_recent_block_timings)
+   )
@@ -0,0 +1,57 @@
+
+#pragma once
+
+#include <btcm/app/plugin.hpp>
+#include <btcm/plugins/block_profiler/block_profiler.hpp>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace btcm { namespace chain {
+struct block_phase_timings;
+} }
+
+namespace btcm { namespace plugin { namespace block_profiler {
+
+/**
+ * Aggregates the phase and evaluator timings the database reports for every applied block into
+ * histograms, keeps the timings of the most recent blocks and periodically logs a summary.
+ */
+class block_profiler_plugin : public btcm::app::plugin
+{
+   public:
+      block_profiler_plugin();
+      virtual ~block_profiler_plugin();
+
+      virtual std::string plugin_name()const override;
+      virtual void plugin_set_program_options(
+         boost::program_options::options_description& cli,
+         boost::program_options::options_description& cfg ) override;
+      virtual void plugin_initialize( const boost::program_options::variables_map& options ) override;
+      virtual void plugin_startup() override;
+      virtual void plugin_shutdown() override;
+
+      void on_applied_block_timings( const chain::block_phase_timings& t );
+
+      /// @return the profile of all blocks applied since startup, without unused operation types
+      block_profile get_block_profile()const;
+
+      /// @return the timings of the most recent blocks, oldest first
+      const std::deque< block_timing >& recent_blocks()const { return _recent_blocks; }
+
+   private:
+      void add_block( block_profile& profile, const chain::block_phase_timings& t )const;
+      void log_summary()const;
+
+      std::vector< std::string >         _operation_names;
+      block_profile                      _profile;
+      block_profile                      _interval_profile;
+      std::deque< block_timing >         _recent_blocks;
+      uint32_t                           _log_interval  = 1200;
+      uint32_t                           _recent_limit  = 100;
+
+      boost::signals2::scoped_connection _applied_block_timings_conn;
+};
+
+} } }
@@ -59,7 +59,7 @@ private:
 bool custom_tags_api_impl::is_tagged( const std::string& user, const std::string& tagged_by, const std::string& tag ) const
 {
    const auto& idx = app.chain_database()->get_index_type<custom_tags_index>().indices().get<by_tagger>();
-   return idx.find( boost::make_tuple( tagged_by, tag, user ) ) != idx.end();
+   return idx.find( boost::make_tuple( btcm::chain::account_name_type( tagged_by ), tag, btcm::chain::account_name_type( user ) ) ) != idx.end();
 }
 
 //static const fc::optional<std::set<std::string>> EMPTY;
@@ -80,12 +80,13 @@ std::vector<half_tagging> custom_tags_api_impl::list_tags_from( const std::strin
                                                                 const std::string& start_taggee )const
 {
    FC_ASSERT( filter_tag.empty() || start_tag.empty(), "Use either filter_tag or start_tag but not both!" );
+   const btcm::chain::account_name_type tagger_name( tagger );
 
    std::vector<half_tagging> result;
    result.reserve(100);
    const auto& idx = app.chain_database()->get_index_type<custom_tags_index>().indices().get<by_tagger>();
-   auto itr = idx.lower_bound( boost::make_tuple( tagger, filter_tag.empty() ? start_tag : filter_tag, start_taggee ) );
-   while( itr != idx.end() && itr->tagger == tagger && result.size() < 100 )
+   auto itr = idx.lower_bound( boost::make_tuple( tagger_name, filter_tag.empty() ? start_tag : filter_tag, btcm::chain::account_name_type( start_taggee ) ) );
+   while( itr != idx.end() && itr->tagger == tagger_name && result.size() < 100 )
    {
        if( !filter_tag.empty() && itr->tag != filter_tag ) break;
        result.push_back( half_tagging( *itr++, false ) );
@@ -99,12 +100,13 @@ std::vector<half_tagging> custom_tags_api_impl::list_tags_on( const std::string&
                                                               const std::string& start_tagger )const
 {
    FC_ASSERT( filter_tag.empty() || start_tag.empty(), "Use either filter_tag or start_tag but not both!" );
+   const btcm::chain::account_name_type taggee_name( taggee );
 
    std::vector<half_tagging> result;
    result.reserve(100);
    const auto& idx = app.chain_database()->get_index_type<custom_tags_index>().indices().get<by_taggee>();
-   auto itr = idx.lower_bound( boost::make_tuple( taggee, filter_tag.empty() ? start_tag : filter_tag, start_tagger ) );
-   while( itr != idx.end() && itr->taggee == taggee && result.size() < 100 )
+   auto itr = idx.lower_bound( boost::make_tuple( taggee_name, filter_tag.empty() ? start_tag : filter_tag, btcm::chain::account_name_type( start_tagger ) ) );
+   while( itr != idx.end() && itr->taggee == taggee_name && result.size() < 100 )
    {
        if( !filter_tag.empty() && itr->tag != filter_tag ) break;
        result.push_back( half_tagging( *itr++, true ) );
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <btcm/app/plugin.hpp>
+#include <btcm/chain/account_name.hpp>
 #include <btcm/chain/database.hpp>
 
 #include <graphene/db/generic_index.hpp>
@@ -74,9 +75,9 @@ struct tag_object : graphene::db::abstract_object< tag_object > {
    static const uint8_t space_id = CUSTOM_TAGS_SPACE_ID;
    static const uint8_t type_id = 1;
 
-   std::string tagger;
-   std::string tag;
-   std::string taggee;
+   btcm::chain::account_name_type tagger;
+   std::string                    tag;
+   btcm::chain::account_name_type taggee;
 };
 
 struct by_tagger;
@@ -88,14 +89,14 @@ typedef boost::multi_index_container<
          boost::multi_index::member< graphene::db::object, graphene::db::object_id_type, &graphene::db::object::id > >,
       boost::multi_index::ordered_unique< boost::multi_index::tag< by_tagger >,
          boost::multi_index::composite_key< tag_object,
-            boost::multi_index::member< tag_object, std::string, &tag_object::tagger >,
+            boost::multi_index::member< tag_object, btcm::chain::account_name_type, &tag_object::tagger >,
             boost::multi_index::member< tag_object, std::string, &tag_object::tag >,
-            boost::multi_index::member< tag_object, std::string, &tag_object::taggee > > >,
+            boost::multi_index::member< tag_object, btcm::chain::account_name_type, &tag_object::taggee > > >,
       boost::multi_index::ordered_unique< boost::multi_index::tag< by_taggee >,
          boost::multi_index::composite_key< tag_object,
-            boost::multi_index::member< tag_object, std::string, &tag_object::taggee >,
+            boost::multi_index::member< tag_object, btcm::chain::account_name_type, &tag_object::taggee >,
             boost::multi_index::member< tag_object, std::string, &tag_object::tag >,
-            boost::multi_index::member< tag_object, std::string, &tag_object::tagger > > >
+            boost::multi_index::member< tag_object, btcm::chain::account_name_type, &tag_object::tagger > > >
    >
 > custom_tags_multi_index_container;
 typedef graphene::db::generic_index<tag_object, custom_tags_multi_index_container> custom_tags_index;
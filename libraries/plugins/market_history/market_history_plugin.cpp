@@ -15,134 +15,192 @@ class market_history_plugin_impl
       virtual ~market_history_plugin_impl() {}
 
       /**
-       * This method is called as a callback after a block is applied
-       * and will process/index all operations that were applied in the block.
+       * This method is called as a callback for every applied operation.  Fills of a block are
+       * buffered and flushed once the block has been applied, fills of pending transactions are
+       * flushed right away.
        */
       void update_market_histories( const operation_object& b );
 
+      void on_pre_apply_block( const signed_block& b );
+      void on_applied_block( const signed_block& b );
+
       market_history_plugin& _self;
       flat_set<uint32_t>     _tracked_buckets = { 15, 60, 300, 3600, 86400 };
       int32_t                _maximum_history_per_bucket_size = 5760;
+
+   private:
+      struct fill
+      {
+         fc::time_point_sec   time;
+         fill_order_operation op;
+         share_type           btcm;
+         share_type           mbd;
+
+         price fill_price()const { return asset( mbd, XUSD_SYMBOL ) / asset( btcm, BTCM_SYMBOL ); }
+      };
+
+      void flush_fills();
+      void update_bucket( uint32_t seconds, vector< fill >::const_iterator first, vector< fill >::const_iterator last );
+
+      vector< fill >         _fills;
 };
 
 void market_history_plugin_impl::update_market_histories( const operation_object& o )
 {
    if( o.op.which() == operation::tag< fill_order_operation >::value )
    {
-      fill_order_operation op = o.op.get< fill_order_operation >();
+      const bool applying_block = _self.database().is_applying_block();
+      if( !applying_block )
+         _fills.clear(); // left over from a block that failed to apply
 
-      auto& db = _self.database();
-      const auto& bucket_idx = db.get_index_type< bucket_index >().indices().get< by_bucket >();
+      fill f;
+      f.op = o.op.get< fill_order_operation >();
+      f.time = _self.database().head_block_time();
+      if( f.op.open_pays.asset_id == BTCM_SYMBOL )
+      {
+         f.btcm = f.op.open_pays.amount;
+         f.mbd = f.op.current_pays.amount;
+      }
+      else
+      {
+         f.btcm = f.op.current_pays.amount;
+         f.mbd = f.op.open_pays.amount;
+      }
+      _fills.push_back( std::move( f ) );
+
+      if( !applying_block )
+         flush_fills();
+   }
+}
 
+void market_history_plugin_impl::on_pre_apply_block( const signed_block& b )
+{
+   // fills left over from a block that failed to apply
+   _fills.clear();
+}
+
+void market_history_plugin_impl::on_applied_block( const signed_block& b )
+{
+   flush_fills();
+}
+
+void market_history_plugin_impl::flush_fills()
+{
+   if( _fills.empty() )
+      return;
+
+   auto& db = _self.database();
+   for( const auto& f : _fills )
+   {
       db.create< order_history_object >( [&]( order_history_object& ho )
       {
-         ho.time = db.head_block_time();
-         ho.op = op;
+         ho.time = f.time;
+         ho.op = f.op;
       });
+   }
 
-      if( !_maximum_history_per_bucket_size ) return;
-      if( !_tracked_buckets.size() ) return;
-
-      for( auto bucket : _tracked_buckets )
+   if( _maximum_history_per_bucket_size && _tracked_buckets.size() )
+   {
+      // fills are ordered by time, each run of fills with the same time falls into one bucket per size
+      auto first = _fills.cbegin();
+      while( first != _fills.cend() )
       {
-         auto cutoff = db.head_block_time() - fc::seconds( bucket * _maximum_history_per_bucket_size );
+         auto last = first + 1;
+         while( last != _fills.cend() && last->time == first->time )
+            ++last;
 
-         auto open = fc::time_point_sec( ( db.head_block_time().sec_since_epoch() / bucket ) * bucket );
-         auto seconds = bucket;
+         for( auto bucket : _tracked_buckets )
+            update_bucket( bucket, first, last );
 
-         auto itr = bucket_idx.find( boost::make_tuple( seconds, open ) );
-         if( itr == bucket_idx.end() )
+         first = last;
+      }
+   }
+
+   _fills.clear();
+}
+
+void market_history_plugin_impl::update_bucket( uint32_t seconds, vector< fill >::const_iterator first, vector< fill >::const_iterator last )
+{
+   auto& db = _self.database();
+   const auto& bucket_idx = db.get_index_type< bucket_index >().indices().get< by_bucket >();
+
+   auto now = first->time;
+   auto cutoff = now - fc::seconds( seconds * _maximum_history_per_bucket_size );
+   auto open = fc::time_point_sec( ( now.sec_since_epoch() / seconds ) * seconds );
+
+   auto high = first;
+   auto low = first;
+   share_type btcm_volume;
+   share_type mbd_volume;
+   for( auto itr = first; itr != last; ++itr )
+   {
+      if( high->fill_price() < itr->fill_price() )
+         high = itr;
+      if( low->fill_price() > itr->fill_price() )
+         low = itr;
+      btcm_volume += itr->btcm;
+      mbd_volume += itr->mbd;
+   }
+   const auto& close = *( last - 1 );
+
+   auto itr = bucket_idx.find( boost::make_tuple( seconds, open ) );
+   if( itr != bucket_idx.end() )
+   {
+      db.modify( *itr, [&]( bucket_object& b )
+      {
+         b.btcm_volume += btcm_volume;
+         b.mbd_volume += mbd_volume;
+         b.close_btcm = close.btcm;
+         b.close_mbd = close.mbd;
+
+         if( b.high() < high->fill_price() )
          {
-            db.create< bucket_object >( [&]( bucket_object &b )
-            {
-               b.open = open;
-               b.seconds = bucket;
-
-               if( op.open_pays.asset_id == BTCM_SYMBOL )
-               {
-                  b.high_btcm = op.open_pays.amount;
-                  b.high_mbd = op.current_pays.amount;
-                  b.low_btcm = op.open_pays.amount;
-                  b.low_mbd = op.current_pays.amount;
-                  b.open_btcm = op.open_pays.amount;
-                  b.open_mbd = op.current_pays.amount;
-                  b.close_btcm = op.open_pays.amount;
-                  b.close_mbd = op.current_pays.amount;
-                  b.btcm_volume = op.open_pays.amount;
-                  b.mbd_volume = op.current_pays.amount;
-               }
-               else
-               {
-                  b.high_btcm = op.current_pays.amount;
-                  b.high_mbd = op.open_pays.amount;
-                  b.low_btcm = op.current_pays.amount;
-                  b.low_mbd = op.open_pays.amount;
-                  b.open_btcm = op.current_pays.amount;
-                  b.open_mbd = op.open_pays.amount;
-                  b.close_btcm = op.current_pays.amount;
-                  b.close_mbd = op.open_pays.amount;
-                  b.btcm_volume = op.current_pays.amount;
-                  b.mbd_volume = op.open_pays.amount;
-               }
-            });
+            b.high_btcm = high->btcm;
+            b.high_mbd = high->mbd;
          }
-         else
+
+         if( b.low() > low->fill_price() )
          {
-            db.modify( *itr, [&]( bucket_object& b )
-            {
-               if( op.open_pays.asset_id == BTCM_SYMBOL )
-               {
-                  b.btcm_volume += op.open_pays.amount;
-                  b.mbd_volume += op.current_pays.amount;
-                  b.close_btcm = op.open_pays.amount;
-                  b.close_mbd = op.current_pays.amount;
-
-                  if( b.high() < price( op.current_pays, op.open_pays ) )
-                  {
-                     b.high_btcm = op.open_pays.amount;
-                     b.high_mbd = op.current_pays.amount;
-                  }
-
-                  if( b.low() > price( op.current_pays, op.open_pays ) )
-                  {
-                     b.low_btcm = op.open_pays.amount;
-                     b.low_mbd = op.current_pays.amount;
-                  }
-               }
-               else
-               {
-                  b.btcm_volume += op.current_pays.amount;
-                  b.mbd_volume += op.open_pays.amount;
-                  b.close_btcm = op.current_pays.amount;
-                  b.close_mbd = op.open_pays.amount;
-
-                  if( b.high() < price( op.open_pays, op.current_pays ) )
-                  {
-                     b.high_btcm = op.current_pays.amount;
-                     b.high_mbd = op.open_pays.amount;
-                  }
-
-                  if( b.low() > price( op.open_pays, op.current_pays ) )
-                  {
-                     b.low_btcm = op.current_pays.amount;
-                     b.low_mbd = op.open_pays.amount;
-                  }
-               }
-            });
-
-            if( _maximum_history_per_bucket_size > 0 )
-            {
-               open = fc::time_point_sec();
-               itr = bucket_idx.lower_bound( boost::make_tuple( seconds, open ) );
-
-               while( itr->seconds == seconds && itr->open < cutoff )
-               {
-                  auto old_itr = itr;
-                  ++itr;
-                  db.remove( *old_itr );
-               }
-            }
+            b.low_btcm = low->btcm;
+            b.low_mbd = low->mbd;
          }
+      });
+   }
+   else
+   {
+      auto init_bucket = [&]( bucket_object& b )
+      {
+         b.open = open;
+         b.seconds = seconds;
+         b.high_btcm = high->btcm;
+         b.high_mbd = high->mbd;
+         b.low_btcm = low->btcm;
+         b.low_mbd = low->mbd;
+         b.open_btcm = first->btcm;
+         b.open_mbd = first->mbd;
+         b.close_btcm = close.btcm;
+         b.close_mbd = close.mbd;
+         b.btcm_volume = btcm_volume;
+         b.mbd_volume = mbd_volume;
+      };
+
+      // The buckets of each size form a ring, the oldest bucket is reused once it has expired
+      auto oldest = bucket_idx.lower_bound( boost::make_tuple( seconds, fc::time_point_sec() ) );
+      if( _maximum_history_per_bucket_size > 0 && oldest != bucket_idx.end()
+         && oldest->seconds == seconds && oldest->open < cutoff )
+         db.modify( *oldest, init_bucket );
+      else
+         db.create< bucket_object >( init_bucket );
+   }
+
+   if( _maximum_history_per_bucket_size > 0 )
+   {
+      auto oldest = bucket_idx.lower_bound( boost::make_tuple( seconds, fc::time_point_sec() ) );
+      while( oldest != bucket_idx.end() && oldest->seconds == seconds && oldest->open < cutoff )
+      {
+         auto old_itr = oldest;
+         ++oldest;
+         db.remove( *old_itr );
       }
    }
 }
@@ -172,6 +230,8 @@ void market_history_plugin::plugin_initialize( const boost::program_options::var
    try
    {
       database().pre_apply_operation.connect( [this]( const operation_object& o ){ _my->update_market_histories( o ); } );
+      database().pre_apply_block.connect( [this]( const signed_block& b ){ _my->on_pre_apply_block( b ); } );
+      database().applied_block.connect( [this]( const signed_block& b ){ _my->on_applied_block( b ); } );
       database().add_index< primary_index< bucket_index > >();
       database().add_index< primary_index< order_history_index > >();
 
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <btcm/app/plugin.hpp>
+#include <btcm/chain/account_name.hpp>
 #include <btcm/chain/database.hpp>
 
 #include <graphene/db/generic_index.hpp>
@@ -79,8 +80,8 @@ class  message_object : public abstract_object<message_object> {
       static const uint8_t space_id = PRIVATE_MESSAGE_SPACE_ID;
       static const uint8_t type_id  = message_object_type;
 
-      string             from;
-      string             to;
+      account_name_type  from;
+      account_name_type  to;
       public_key_type    from_memo_key;
       public_key_type    to_memo_key;
       uint64_t           sent_time; /// used as seed to secret generation
@@ -117,19 +118,19 @@ typedef multi_index_container<
       ordered_unique< tag< by_id >, member< object, object_id_type, &object::id > >,
       ordered_unique< tag< by_to_date >, 
             composite_key< message_object,
-               member< message_object, string, &message_object::to >,
+               member< message_object, account_name_type, &message_object::to >,
                member< message_object, time_point_sec, &message_object::receive_time >,
                member<object, object_id_type, &object::id >
             >,
-            composite_key_compare< std::less<string>, std::greater< time_point_sec >, std::less< object_id_type > >
+            composite_key_compare< std::less<account_name_type>, std::greater< time_point_sec >, std::less< object_id_type > >
       >,
       ordered_unique< tag< by_from_date >, 
             composite_key< message_object,
-               member< message_object, string, &message_object::from >,
+               member< message_object, account_name_type, &message_object::from >,
                member< message_object, time_point_sec, &message_object::receive_time >,
                member<object, object_id_type, &object::id >
             >,
-            composite_key_compare< std::less<string>, std::greater< time_point_sec >, std::less< object_id_type > >
+            composite_key_compare< std::less<account_name_type>, std::greater< time_point_sec >, std::less< object_id_type > >
       >
    >
 > message_multi_index_type;
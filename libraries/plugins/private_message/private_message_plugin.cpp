@@ -88,14 +88,17 @@ void private_message_plugin_impl::on_operation( const operation_object& op_obj )
          FC_ASSERT( pm.from_memo_key != pm.to_memo_key );
          FC_ASSERT( pm.sent_time != 0 );
          FC_ASSERT( pm.encrypted_message.size() >= 32 );
+         // the operation names accounts by string, a name that cannot be an account is rejected here
+         const account_name_type from( pm.from );
+         const account_name_type to( pm.to );
 
          if( !_tracked_accounts.size() ||
              (to_itr != _tracked_accounts.end() && pm.to >= to_itr->first && pm.to <= to_itr->second) ||
              (from_itr != _tracked_accounts.end() && pm.from >= from_itr->first && pm.from <= from_itr->second) )
          {
             db.create<message_object>( [&]( message_object& pmo ) {
-               pmo.from               = pm.from;
-               pmo.to                 = pm.to;
+               pmo.from               = from;
+               pmo.to                 = to;
                pmo.from_memo_key      = pm.from_memo_key;
                pmo.to_memo_key        = pm.to_memo_key;
                pmo.checksum           = pm.checksum;
@@ -154,8 +157,9 @@ vector<message_object> private_message_api::get_inbox( string to, time_point new
    FC_ASSERT( limit <= 100 );
    vector<message_object> result;
    const auto& idx = _app->chain_database()->get_index_type<private_message_index>().indices().get<by_to_date>();
-   auto itr = idx.lower_bound( std::make_tuple( to, newest ) );
-   while( itr != idx.end() && limit && itr->to == to ) {
+   const account_name_type to_name( to );
+   auto itr = idx.lower_bound( std::make_tuple( to_name, newest ) );
+   while( itr != idx.end() && limit && itr->to == to_name ) {
       result.push_back(*itr);
       ++itr;
       --limit;
@@ -169,8 +173,9 @@ vector<message_object> private_message_api::get_outbox( string from, time_point
    vector<message_object> result;
    const auto& idx = _app->chain_database()->get_index_type<private_message_index>().indices().get<by_from_date>();
 
-   auto itr = idx.lower_bound( std::make_tuple( from, newest ) );
-   while( itr != idx.end() && limit && itr->from == from ) {
+   const account_name_type from_name( from );
+   auto itr = idx.lower_bound( std::make_tuple( from_name, newest ) );
+   while( itr != idx.end() && limit && itr->from == from_name ) {
       result.push_back(*itr);
       ++itr;
       --limit;
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <btcm/app/api.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <functional>
+
+namespace btcm { namespace wallet {
+
+using btcm::chain::signed_transaction;
+using btcm::chain::streaming_platform_report_operation;
+using btcm::chain::transaction_id_type;
+
+struct streaming_report_result
+{
+   transaction_id_type  trx_id; ///< transaction that carried the report, if it was accepted
+   bool                 accepted = false;
+   std::string          error;
+};
+
+/**
+ * Submits streaming reports in as few transactions as possible, see wallet_api::post_streaming_reports().
+ *
+ * The reports are grouped by streaming platform, so that one set of keys signs each transaction, and packed into
+ * transactions no larger than max_trx_size once they carry the signatures of their platform.  The transactions
+ * are broadcast trxs_per_call at a time, and the next ones are signed on a separate thread while a call is in
+ * flight, so sign must not depend on anything that changes before the next start_round.  A rejected
+ * transaction is split in halves which are signed anew and retried in the next round, until every failing report
+ * is isolated and reported with its own error.
+ */
+class streaming_report_batcher
+{
+   public:
+      typedef btcm::app::network_broadcast_api::broadcast_result broadcast_result;
+
+      /// @return the number of signatures the transactions of the platform of @p first_report need
+      std::function< size_t( const streaming_platform_report_operation& first_report ) >   signature_count;
+      /// called before the transactions of each round are signed, e.g. to fetch the head block they refer to
+      std::function< void() >                                                             start_round;
+      /// @return @p trx with its reference block, expiration and the signatures of @p platform, called on the signing thread
+      std::function< signed_transaction( signed_transaction trx, const std::string& platform ) > sign;
+      /// @return one result per transaction, in the same order
+      std::function< std::vector< broadcast_result >( const std::vector< signed_transaction >& trxs ) > broadcast;
+
+      size_t max_trx_size  = 0;  ///< the largest packed size of a signed transaction
+      size_t trxs_per_call = 50;
+
+      /// @return one result per report, in the same order
+      std::vector< streaming_report_result > post( const std::vector< streaming_platform_report_operation >& reports );
+
+   private:
+      /// a range of the reports in the order they are packed in, that makes up one transaction
+      typedef std::pair< size_t, size_t > report_range;
+
+      void pack( const std::vector< streaming_platform_report_operation >& reports );
+      std::vector< signed_transaction > sign_ranges( const std::vector< streaming_platform_report_operation >& reports,
+                                                     const std::vector< report_range >& ranges )const;
+      void process( const std::vector< report_range >& ranges, const std::vector< broadcast_result >& call_results );
+
+      std::vector< size_t >                                       _order;
+      std::vector< report_range >                                 _pending;
+      std::vector< report_range >                                 _retry;
+      std::vector< streaming_report_result >                      _results;
+      fc::thread                                                  _signing_thread{ "streaming_report_signer" };
+};
+
+} } // btcm::wallet
+
+FC_REFLECT( btcm::wallet::streaming_report_result, (trx_id)(accepted)(error) )
@@ -3,6 +3,7 @@
 #include <btcm/app/api.hpp>
 #include <btcm/private_message/private_message_plugin.hpp>
 #include <btcm/chain/base_objects.hpp>
+#include <btcm/wallet/report_batcher.hpp>
 
 #include <graphene/utilities/key_conversion.hpp>
 
@@ -923,20 +924,20 @@ class wallet_api
        * Get content submitted by given account
        * @param account Account submitting the content
        */
-      vector<content_object> get_content_by_account(string account);
+      vector<extended_content> get_content_by_account(string account);
 
       /**
        * Get content with given URL
        * @param url identifier
        */
-      optional<content_object>    get_content_by_url(string url);
+      optional<extended_content>    get_content_by_url(string url);
 
       /**
        * Get content list, by name
        * @param start Starting name
        * @param limit Limit, less than 1000
        */
-      vector<content_object>  lookup_content(const string& start, uint32_t limit );
+      vector<extended_content>  lookup_content(const string& start, uint32_t limit );
       
       /**
        * Get content list, by approver, filtered by approver
@@ -953,6 +954,19 @@ class wallet_api
       vector <extended_balance> get_assets(string account);
       annotated_signed_transaction      send_private_message( string from, string to, string subject, string body, bool broadcast );
       annotated_signed_transaction      post_streaming_report( string streaming_platform, string consumer, string content, string playlist_creator, uint64_t playtime, bool broadcast );
+
+      /**
+       * Post a batch of streaming reports
+       *
+       * The reports are grouped by streaming platform and packed into as few transactions as the maximum
+       * block size allows.  The transactions are signed locally and broadcast with a single call.  When a
+       * transaction is rejected its reports are split in halves and resubmitted until the failing reports
+       * are isolated, so one invalid report does not reject the rest of the batch.
+       *
+       * @param reports The reports to post
+       * @returns One result per report, in the same order
+       */
+      vector<streaming_report_result>   post_streaming_reports( vector<streaming_platform_report_operation> reports );
       
       vector<extended_message_object>   get_inbox( string account, fc::time_point newest, uint32_t limit );
       vector<extended_message_object>   get_outbox( string account, fc::time_point newest, uint32_t limit );
@@ -1204,6 +1218,7 @@ FC_API( btcm::wallet::wallet_api,
         (lookup_content)
         //(lookup_content_by_approver)
         (post_streaming_report)
+        (post_streaming_reports)
         (get_reports)
         (vote)
         (set_transaction_expiration)
@@ -0,0 +1,152 @@
+#include <btcm/wallet/report_batcher.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+namespace btcm { namespace wallet {
+
+std::vector< streaming_report_result > streaming_report_batcher::post( const std::vector< streaming_platform_report_operation >& reports )
+{
+   FC_ASSERT( trxs_per_call > 0 );
+   _results.assign( reports.size(), streaming_report_result() );
+   if( reports.empty() )
+      return std::move( _results );
+
+   pack( reports );
+
+   while( !_pending.empty() )
+   {
+      start_round();
+      _retry.clear();
+
+      std::vector< std::vector< report_range > > calls;
+      for( size_t first = 0; first < _pending.size(); first += trxs_per_call )
+         calls.emplace_back( _pending.begin() + first,
+                             _pending.begin() + std::min( first + trxs_per_call, _pending.size() ) );
+
+      // the transactions of the next call are signed on the signing thread while this one is in flight
+      auto sign_call = [this,&reports]( const std::vector< report_range >& ranges )
+      {
+         return _signing_thread.async( [this,&reports,&ranges]() { return sign_ranges( reports, ranges ); },
+                                       "streaming_report_sign" );
+      };
+      fc::future< std::vector< signed_transaction > > signing = sign_call( calls.front() );
+      try
+      {
+         for( size_t c = 0; c < calls.size(); ++c )
+         {
+            auto trxs = signing.wait();
+            if( c + 1 < calls.size() )
+               signing = sign_call( calls[ c + 1 ] );
+            process( calls[c], broadcast( trxs ) );
+         }
+      }
+      catch( ... )
+      {
+         // the signing in flight refers to the reports, let it finish before unwinding
+         if( signing.valid() && !signing.ready() )
+         {
+            try { signing.wait(); } catch( ... ) {}
+         }
+         throw;
+      }
+
+      _pending.swap( _retry );
+   }
+
+   return std::move( _results );
+}
+
+std::vector< signed_transaction > streaming_report_batcher::sign_ranges( const std::vector< streaming_platform_report_operation >& reports,
+                                                                         const std::vector< report_range >& ranges )const
+{
+   std::vector< signed_transaction > trxs;
+   trxs.reserve( ranges.size() );
+   for( const auto& range : ranges )
+   {
+      signed_transaction trx;
+      for( size_t i = range.first; i < range.second; ++i )
+         trx.operations.push_back( reports[ _order[i] ] );
+      trxs.push_back( sign( std::move( trx ), reports[ _order[ range.first ] ].streaming_platform ) );
+   }
+   return trxs;
+}
+
+void streaming_report_batcher::pack( const std::vector< streaming_platform_report_operation >& reports )
+{
+   _order.resize( reports.size() );
+   std::iota( _order.begin(), _order.end(), 0 );
+   std::stable_sort( _order.begin(), _order.end(), [&reports]( size_t a, size_t b )
+   {
+      return reports[a].streaming_platform < reports[b].streaming_platform;
+   } );
+
+   // the packed sizes of the operation and signature counts grow with their values
+   const auto& count_growth = []( size_t count ) -> size_t
+   {
+      return fc::raw::pack_size( fc::unsigned_int( count ) ) - fc::raw::pack_size( fc::unsigned_int( 0 ) );
+   };
+   const size_t empty_trx_size = fc::raw::pack_size( signed_transaction() );
+   const size_t signature_size = fc::raw::pack_size( btcm::chain::signature_type() );
+
+   _pending.clear();
+   size_t ops_size = 0;
+   size_t signatures_size = 0;
+   for( size_t i = 0; i < _order.size(); ++i )
+   {
+      const auto& report = reports[ _order[i] ];
+      const size_t op_size = fc::raw::pack_size( btcm::chain::operation( report ) );
+      const bool same_platform = !_pending.empty()
+         && reports[ _order[ _pending.back().first ] ].streaming_platform == report.streaming_platform;
+      if( !same_platform )
+      {
+         const size_t signatures = signature_count( report );
+         signatures_size = signatures * signature_size + count_growth( signatures );
+      }
+
+      const size_t op_count = same_platform ? i + 1 - _pending.back().first : 1;
+      const size_t trx_size = empty_trx_size + signatures_size + count_growth( op_count ) + op_size
+                              + ( same_platform ? ops_size : 0 );
+      if( same_platform && trx_size <= max_trx_size )
+      {
+         _pending.back().second = i + 1;
+         ops_size += op_size;
+      }
+      else
+      {
+         _pending.emplace_back( i, i + 1 );
+         ops_size = op_size;
+      }
+   }
+}
+
+void streaming_report_batcher::process( const std::vector< report_range >& ranges,
+                                        const std::vector< broadcast_result >& call_results )
+{
+   FC_ASSERT( call_results.size() == ranges.size(), "Expected one result per transaction" );
+   for( size_t t = 0; t < ranges.size(); ++t )
+   {
+      const auto& range = ranges[t];
+      const auto& result = call_results[t];
+      if( result.accepted )
+      {
+         for( size_t i = range.first; i < range.second; ++i )
+         {
+            _results[ _order[i] ].trx_id = result.id;
+            _results[ _order[i] ].accepted = true;
+         }
+      }
+      else if( range.second - range.first == 1 )
+      {
+         _results[ _order[ range.first ] ].error = result.error;
+      }
+      else
+      {
+         const size_t middle = range.first + ( range.second - range.first ) / 2;
+         _retry.emplace_back( range.first, middle );
+         _retry.emplace_back( middle, range.second );
+      }
+   }
+}
+
+} } // btcm::wallet
@@ -565,9 +565,9 @@ public:
       trx.operations[operation_index] = new_op;
    }
 
-   vector<content_object> get_content_by_account(string account);
-   optional<content_object>    get_content_by_url(string url);
-   vector<content_object>  lookup_content(const string& start, uint32_t limit );
+   vector<extended_content> get_content_by_account(string account);
+   optional<extended_content>    get_content_by_url(string url);
+   vector<extended_content>  lookup_content(const string& start, uint32_t limit );
    annotated_signed_transaction  import_balance( string name_or_id, const vector<string>& wif_keys, bool broadcast );
   
    transaction preview_builder_transaction(transaction_handle_type handle)
@@ -678,14 +678,14 @@ public:
 
       for( const string& con : req_content_approvals )
       {
-         optional<content_object> content = *_remote_db->get_content_by_url ( con );
+         optional<extended_content> content = *_remote_db->get_content_by_url ( con );
          for( const auto& a : content->manage_master.account_auths )
             req_active_approvals.insert(a.first);
       }
 
       for( const string& con : req_comp_content_approvals )
       {
-         optional<content_object> content = *_remote_db->get_content_by_url ( con );
+         optional<extended_content> content = *_remote_db->get_content_by_url ( con );
          for( const auto& a : content->manage_comp.account_auths )
             req_active_approvals.insert(a.first);
       }
@@ -802,7 +802,7 @@ public:
          {
             if( content_by_url.find( content_url ) == content_by_url.end() )
             {
-               optional<content_object> content = *_remote_db->get_content_by_url ( content_url );
+               optional<extended_content> content = *_remote_db->get_content_by_url ( content_url );
                FC_ASSERT( content, "Unknown content {u}", ("u",content_url) );
                content_by_url[content_url] = *content;
             }
@@ -812,7 +812,7 @@ public:
          {
             if( content_by_url.find( content_url ) == content_by_url.end() )
             {
-               optional<content_object> content = *_remote_db->get_content_by_url ( content_url );
+               optional<extended_content> content = *_remote_db->get_content_by_url ( content_url );
                FC_ASSERT( content, "Unknown content {u}", ("u",content_url) );
                content_by_url[content_url] = *content;
             }
@@ -845,6 +845,60 @@ public:
       return tx;
    }
 
+   vector< streaming_report_result > post_streaming_reports( const vector< streaming_platform_report_operation >& reports )
+   {
+      FC_ASSERT( !is_locked() );
+      for( const auto& report : reports )
+         report.validate();
+
+      auto dyn_props = _remote_db->get_dynamic_global_properties();
+      flat_map< string, vector< fc::ecc::private_key > > platform_keys;
+
+      streaming_report_batcher batcher;
+      // database::push_transaction() rejects anything larger than maximum_block_size - 256
+      batcher.max_trx_size = dyn_props.maximum_block_size - 256;
+
+      // The first report of a platform goes through the regular signing path, the keys it used are
+      // then reused for all transactions of the platform without further lookups
+      batcher.signature_count = [&]( const streaming_platform_report_operation& first_report ) -> size_t
+      {
+         signed_transaction tx;
+         tx.operations.push_back( first_report );
+         tx = sign_transaction( tx, false );
+         vector< fc::ecc::private_key > signing_keys;
+         for( const auto& key : tx.get_signature_keys( BTCM_CHAIN_ID ) )
+            signing_keys.push_back( get_private_key( key ) );
+         auto& keys = platform_keys[ first_report.streaming_platform ];
+         keys = std::move( signing_keys );
+         return keys.size();
+      };
+
+      // Retried transactions refer to the head block of their own round, signing only reads it in between
+      bool first_round = true;
+      batcher.start_round = [&]()
+      {
+         if( !first_round )
+            dyn_props = _remote_db->get_dynamic_global_properties();
+         first_round = false;
+      };
+
+      batcher.sign = [&]( signed_transaction tx, const string& platform ) -> signed_transaction
+      {
+         tx.set_reference_block( dyn_props.head_block_id );
+         tx.set_expiration( dyn_props.time + fc::seconds( _tx_expiration_seconds ) );
+         for( const auto& key : platform_keys.at( platform ) )
+            tx.sign( key, BTCM_CHAIN_ID );
+         return tx;
+      };
+
+      batcher.broadcast = [&]( const vector< signed_transaction >& trxs )
+      {
+         return _remote_net_broadcast->broadcast_transaction_batch( trxs );
+      };
+
+      return batcher.post( reports );
+   }
+
 
 
 
@@ -2198,32 +2252,32 @@ annotated_signed_transaction wallet_api::cancel_order( string owner, uint32_t or
 }
 
 
-vector<content_object> wallet_api::get_content_by_account(string account)
+vector<extended_content> wallet_api::get_content_by_account(string account)
 {
     return my->get_content_by_account(account);
 }
 
-vector<content_object> detail::wallet_api_impl::get_content_by_account(string account)
+vector<extended_content> detail::wallet_api_impl::get_content_by_account(string account)
 {
     return _remote_db->get_content_by_uploader(account);
 }
 
-optional<content_object>  wallet_api::get_content_by_url(string url)
+optional<extended_content>  wallet_api::get_content_by_url(string url)
 {   
     return my->get_content_by_url(url);
 }
 
-optional<content_object>  detail::wallet_api_impl::get_content_by_url(string url)
+optional<extended_content>  detail::wallet_api_impl::get_content_by_url(string url)
 {   
     return _remote_db->get_content_by_url(url);
 }
 
-vector<content_object>  wallet_api::lookup_content(const string& start, uint32_t limit )
+vector<extended_content>  wallet_api::lookup_content(const string& start, uint32_t limit )
 {
     return my->lookup_content(start, limit);
 }
 
-vector<content_object>  detail::wallet_api_impl::lookup_content(const string& start, uint32_t limit )
+vector<extended_content>  detail::wallet_api_impl::lookup_content(const string& start, uint32_t limit )
 {
     return _remote_db->lookup_content(start, limit);
 }
@@ -2525,6 +2579,11 @@ annotated_signed_transaction      wallet_api::post_streaming_report( string stre
 
 }
 
+vector< streaming_report_result > wallet_api::post_streaming_reports( vector< streaming_platform_report_operation > reports )
+{
+   return my->post_streaming_reports( reports );
+}
+
 annotated_signed_transaction      wallet_api::send_private_message( string from, string to, string subject, string body, bool broadcast ) {
    FC_ASSERT( !is_locked(), "wallet must be unlocked to send a private message" );
    auto from_account = get_account( from );
@@ -0,0 +1,33 @@
+#pragma once
+#include <fc/variant_object.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace btcm { namespace chain { namespace bench {
+
+   /// Number and total size of the heap allocations made by the process so far
+   struct allocation_counters
+   {
+      uint64_t count = 0;
+      uint64_t bytes = 0;
+   };
+
+   allocation_counters allocations();
+
+   /// Peak resident set size of the process so far, in kilobytes; 0 where unsupported
+   uint64_t peak_rss_kb();
+
+   /// Seed of the workload generators, BTCM_BENCH_SEED or 1
+   uint32_t seed();
+
+   /// Workload size multiplier, BTCM_BENCH_SCALE or 1
+   uint32_t scale();
+
+   /// File of recorded JSON-RPC requests, one per line, BTCM_BENCH_JSON_CORPUS or empty
+   std::string json_corpus();
+
+   /// Adds the result of a benchmark to the report written when the run ends
+   void report( const fc::variant_object& result );
+
+} } } // btcm::chain::bench
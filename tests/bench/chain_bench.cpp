@@ -0,0 +1,811 @@
+#include <boost/test/unit_test.hpp>
+
+#include <btcm/chain/protocol/ext.hpp>
+#include <btcm/chain/account_object.hpp>
+#include <btcm/chain/content_object.hpp>
+#include <btcm/chain/db_with.hpp>
+#include <btcm/chain/streaming_platform_objects.hpp>
+
+#include <fc/io/buffered_iostream.hpp>
+#include <fc/io/json.hpp>
+#include <fc/io/sstream.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+#include <fstream>
+#include <memory>
+
+#include <random>
+#include <set>
+
+#include "../common/database_fixture.hpp"
+#include "bench.hpp"
+
+using namespace btcm::chain;
+
+namespace {
+
+/**
+ * Builds reproducible synthetic workloads on top of a clean database and measures how fast the
+ * blocks carrying them are applied.
+ *
+ * Every measured block is produced by the fixture, popped and pushed again, so that only the block
+ * application path of a syncing node is timed and not the evaluation of the pending transactions
+ * while the block is produced.
+ */
+struct bench_fixture : public database_fixture
+{
+   static const uint32_t ops_per_trx = 50;
+   static const uint32_t apply_skip = database::skip_witness_signature
+                                    | database::skip_transaction_signatures
+                                    | database::skip_authority_check
+                                    | database::skip_undo_history_check;
+
+   bench_fixture() : rng( bench::seed() ), scale( bench::scale() )
+   {
+      initialize_clean( BTCM_NUM_HARDFORKS );
+      timings_connection = db.applied_block_timings.connect( [this]( const block_phase_timings& t ) {
+         if( !measuring )
+            return;
+         for( uint32_t p = 0; p < BLOCK_PHASE_COUNT; ++p )
+            phase_elapsed[p] += t.elapsed[p];
+         ++blocks;
+      });
+   }
+
+   uint32_t random( uint32_t n ) { return std::uniform_int_distribution< uint32_t >( 0, n - 1 )( rng ); }
+
+   /// Picks an index in [0,n) biased towards low indexes, which makes some accounts far more popular than others
+   uint32_t skewed_random( uint32_t n ) { return random( random( n ) + 1 ); }
+
+   const string& random_account() { return accounts[ random( accounts.size() ) ]; }
+
+   /// Pushes @p ops as pending transactions of at most ops_per_trx operations each
+   void push( const vector< operation >& ops )
+   {
+      for( size_t i = 0; i < ops.size(); i += ops_per_trx )
+      {
+         signed_transaction tx;
+         // distinct expirations keep otherwise identical transactions apart
+         tx.set_expiration( db.head_block_time() + BTCM_MAX_TIME_UNTIL_EXPIRATION - ( trx_count++ % 600 ) );
+         tx.operations.assign( ops.begin() + i, ops.begin() + std::min( ops.size(), i + ops_per_trx ) );
+         db.push_transaction( tx, database::skip_transaction_signatures );
+      }
+   }
+
+   /// Produces a block containing @p ops without measuring it
+   void setup_block( const vector< operation >& ops )
+   {
+      push( ops );
+      generate_block();
+   }
+
+   /// Produces a block containing @p ops and measures its application
+   void measure_block( const vector< operation >& ops = vector< operation >() )
+   {
+      push( ops );
+      signed_block block = generate_block();
+      uint64_t ops_in_block = 0;
+      for( const auto& tx : block.transactions )
+         ops_in_block += tx.operations.size();
+      BOOST_REQUIRE_EQUAL( ops.size(), ops_in_block );
+
+      db.pop_block();
+      db._popped_tx.clear();
+
+      measuring = true;
+      const auto allocs_before = bench::allocations();
+      const auto start = fc::time_point::now();
+      db.push_block( block, apply_skip );
+      elapsed += fc::time_point::now() - start;
+      const auto allocs_after = bench::allocations();
+      measuring = false;
+
+      allocations += allocs_after.count - allocs_before.count;
+      allocated_bytes += allocs_after.bytes - allocs_before.bytes;
+      operations += ops_in_block;
+   }
+
+   /// Adds the measurements of the blocks measured so far to the report
+   void report( const string& name )
+   {
+      fc::mutable_variant_object phases;
+      for( uint32_t p = 0; p < BLOCK_PHASE_COUNT; ++p )
+         phases( block_phase_name( block_phase( p ) ), phase_elapsed[p].count() );
+
+      const double seconds = elapsed.count() / 1000000.0;
+      fc::mutable_variant_object result;
+      result( "name", name )
+            ( "blocks", blocks )
+            ( "operations", operations )
+            ( "seconds", seconds )
+            ( "blocks_per_second", seconds > 0 ? blocks / seconds : 0.0 )
+            ( "operations_per_second", seconds > 0 ? operations / seconds : 0.0 )
+            ( "phase_us", phases )
+            ( "allocations", allocations )
+            ( "allocated_bytes", allocated_bytes )
+            ( "peak_rss_kb", bench::peak_rss_kb() );
+      bench::report( result );
+   }
+
+   void create_accounts( uint32_t count, bool measured = false )
+   {
+      vector< operation > ops;
+      for( uint32_t i = 0; i < count; ++i )
+      {
+         account_create_operation op;
+         op.new_account_name = "bench" + fc::to_string( accounts.size() );
+         op.creator = BTCM_INIT_MINER_NAME;
+         op.fee = asset( 100, BTCM_SYMBOL );
+         op.owner = authority( 1, init_account_pub_key, 1 );
+         op.active = op.owner;
+         op.basic = op.owner;
+         op.memo_key = init_account_pub_key;
+         ops.push_back( op );
+         accounts.push_back( op.new_account_name );
+
+         if( ops.size() == 200 || i + 1 == count )
+         {
+            measured ? measure_block( ops ) : setup_block( ops );
+            ops.clear();
+         }
+      }
+   }
+
+   /// Credits every account with @p amount of both BTCM and XUSD, outside of the pending state
+   void fund_accounts( share_type amount )
+   {
+      for( const auto& name : accounts )
+      {
+         const account_object& account = db.get_account( name );
+         db.adjust_balance( account, asset( amount, BTCM_SYMBOL ) );
+         db.adjust_supply( asset( amount, BTCM_SYMBOL ) );
+         db.adjust_balance( account, asset( amount, XUSD_SYMBOL ) );
+         db.adjust_supply( asset( amount, XUSD_SYMBOL ) );
+      }
+   }
+
+   /// Registers @p count streaming platforms, few enough to all be voted in
+   void create_platforms( uint32_t count )
+   {
+      for( uint32_t i = 0; i < count; ++i )
+      {
+         platforms.push_back( "benchsp" + fc::to_string( i ) );
+         account_create( platforms.back(), init_account_pub_key );
+      }
+      generate_block();
+
+      // the fee is credited outside of the pending state, which is discarded by block production
+      const asset fee = db.get_witness_schedule_object().median_props.streaming_platform_update_fee;
+      vector< operation > ops;
+      for( const auto& name : platforms )
+      {
+         db.adjust_balance( db.get_account( name ), fee );
+         db.adjust_supply( fee );
+
+         streaming_platform_update_operation op;
+         op.owner = name;
+         op.url = "http://" + name + ".bitcoinmusic.org";
+         op.fee = fee;
+         ops.push_back( op );
+      }
+      setup_block( ops );
+   }
+
+   content_operation make_content()
+   {
+      content_operation op;
+      op.uploader = random_account();
+      op.url = "bmfs://bench" + fc::to_string( contents.size() );
+      op.album_meta.album_title = "Bench album";
+      op.track_meta.track_title = "Bench track " + fc::to_string( contents.size() );
+      op.comp_meta.third_party_publishers = false;
+      distribution dist;
+      dist.payee = random_account();
+      dist.bp = BTCM_100_PERCENT;
+      op.distributions.push_back( dist );
+      management_vote mgmt;
+      mgmt.voter = op.uploader;
+      mgmt.percentage = 100;
+      op.management.push_back( mgmt );
+      op.management_threshold = 100;
+      op.playing_reward = 10;
+      op.publishers_share = 0;
+      contents.push_back( op.url );
+      return op;
+   }
+
+   void create_contents( uint32_t count, bool measured = false )
+   {
+      vector< operation > ops;
+      for( uint32_t i = 0; i < count; ++i )
+      {
+         ops.push_back( make_content() );
+         if( ops.size() == 100 || i + 1 == count )
+         {
+            measured ? measure_block( ops ) : setup_block( ops );
+            ops.clear();
+         }
+      }
+   }
+
+   /// Reports by known consumers, with one in four reports coming from anonymous platform users
+   operation make_report()
+   {
+      streaming_platform_report_operation op;
+      op.streaming_platform = platforms[ random( platforms.size() ) ];
+      op.content = contents[ skewed_random( contents.size() ) ];
+      op.play_time = 30 + random( 270 );
+      if( random( 4 ) == 0 )
+         op.ext.value.sp_user_id = random( 10000 );
+      else
+         op.consumer = random_account();
+      return op;
+   }
+
+   vector< operation > make_reports( uint32_t count )
+   {
+      vector< operation > ops;
+      for( uint32_t i = 0; i < count; ++i )
+         ops.push_back( make_report() );
+      return ops;
+   }
+
+   operation make_transfer()
+   {
+      transfer_operation op;
+      op.from = random_account();
+      do op.to = random_account(); while( op.to == op.from );
+      op.amount = asset( 1 + random( 1000 ), BTCM_SYMBOL );
+      return op;
+   }
+
+   /// Orders on both sides of the BTCM/XUSD market around a price of 1, so that some of them match
+   operation make_order()
+   {
+      limit_order_create_operation op;
+      op.owner = random_account();
+      op.orderid = order_count++;
+      const bool sell_btcm = random( 2 ) == 0;
+      op.amount_to_sell = asset( 1000, sell_btcm ? BTCM_SYMBOL : XUSD_SYMBOL );
+      op.min_to_receive = asset( 950 + random( 100 ), sell_btcm ? XUSD_SYMBOL : BTCM_SYMBOL );
+      op.expiration = db.head_block_time() + 86400;
+      return op;
+   }
+
+   /// Friendship requests between random accounts, each followed by the matching approval
+   void add_friendships( vector< operation >& ops, uint32_t count )
+   {
+      while( count-- > 0 )
+      {
+         uint32_t a, b;
+         do
+         {
+            a = skewed_random( accounts.size() );
+            b = random( accounts.size() );
+         } while( a == b || !friendships.insert( std::make_pair( std::min( a, b ), std::max( a, b ) ) ).second );
+
+         friendship_operation op;
+         op.who = accounts[a];
+         op.whom = accounts[b];
+         ops.push_back( op );
+         std::swap( op.who, op.whom );
+         ops.push_back( op );
+      }
+   }
+
+   /// Content votes by distinct voters, none of which has voted for the same content before
+   void add_votes( vector< operation >& ops, uint32_t count )
+   {
+      std::set< uint32_t > voters;
+      while( count-- > 0 )
+      {
+         uint32_t voter, content;
+         do
+         {
+            voter = random( accounts.size() );
+            content = skewed_random( contents.size() );
+         } while( voters.count( voter ) || !votes.insert( std::make_pair( voter, content ) ).second );
+         voters.insert( voter );
+
+         vote_operation op;
+         op.voter = accounts[voter];
+         op.url = contents[content];
+         op.weight = 1 + random( 100 );
+         ops.push_back( op );
+      }
+   }
+
+   std::mt19937                                      rng;
+   const uint32_t                                    scale;
+   vector< string >                                  accounts;
+   vector< string >                                  platforms;
+   vector< string >                                  contents;
+   std::set< std::pair< uint32_t, uint32_t > >       friendships;
+   std::set< std::pair< uint32_t, uint32_t > >       votes;
+   uint32_t                                          trx_count = 0;
+   uint32_t                                          order_count = 0;
+
+   boost::signals2::scoped_connection                timings_connection;
+   bool                                              measuring = false;
+   std::array< fc::microseconds, BLOCK_PHASE_COUNT > phase_elapsed;
+   uint64_t                                          blocks = 0;
+   fc::microseconds                                  elapsed;
+   uint64_t                                          operations = 0;
+   uint64_t                                          allocations = 0;
+   uint64_t                                          allocated_bytes = 0;
+};
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( chain_bench, bench_fixture )
+
+BOOST_AUTO_TEST_CASE( account_create )
+{ try {
+   create_accounts( 2000 * scale, true );
+   report( "account_create" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( content_upload )
+{ try {
+   create_accounts( 1000 * scale );
+   create_contents( 1000 * scale, true );
+   report( "content_upload" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( streaming_reports )
+{ try {
+   create_accounts( 2000 * scale );
+   create_platforms( 5 );
+   create_contents( 500 * scale );
+   for( uint32_t i = 0; i < 20 * scale; ++i )
+      measure_block( make_reports( 400 ) );
+   report( "streaming_reports" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( content_cashout )
+{ try {
+   create_accounts( 2000 * scale );
+   create_platforms( 5 );
+   create_contents( 500 * scale );
+   const fc::time_point_sec first_report = db.head_block_time() + BTCM_BLOCK_INTERVAL;
+   const uint32_t report_blocks = 20 * scale;
+   for( uint32_t i = 0; i < report_blocks; ++i )
+      setup_block( make_reports( 400 ) );
+
+   // reports are cashed out a day after they have been created, one block worth per block
+   generate_blocks( first_report + ( 86400 - BTCM_BLOCK_INTERVAL ) );
+   for( uint32_t i = 0; i < report_blocks; ++i )
+      measure_block();
+   report( "content_cashout" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( friendships )
+{ try {
+   create_accounts( 4000 * scale );
+   for( uint32_t i = 0; i < 20 * scale; ++i )
+   {
+      vector< operation > ops;
+      add_friendships( ops, 200 );
+      measure_block( ops );
+   }
+   report( "friendships" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( content_votes )
+{ try {
+   create_accounts( 2000 * scale );
+   create_contents( 500 * scale );
+   for( uint32_t i = 0; i < 20 * scale; ++i )
+   {
+      vector< operation > ops;
+      add_votes( ops, 400 );
+      measure_block( ops );
+   }
+   report( "content_votes" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( transfers )
+{ try {
+   create_accounts( 2000 * scale );
+   fund_accounts( 1000000 );
+   for( uint32_t i = 0; i < 20 * scale; ++i )
+   {
+      vector< operation > ops;
+      for( uint32_t j = 0; j < 400; ++j )
+         ops.push_back( make_transfer() );
+      measure_block( ops );
+   }
+   report( "transfers" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( limit_orders )
+{ try {
+   create_accounts( 2000 * scale );
+   fund_accounts( 1000000 );
+   for( uint32_t i = 0; i < 20 * scale; ++i )
+   {
+      vector< operation > ops;
+      for( uint32_t j = 0; j < 400; ++j )
+         ops.push_back( make_order() );
+      measure_block( ops );
+   }
+   report( "limit_orders" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( deep_book_sweeps )
+{ try {
+   create_accounts( 2000 * scale );
+   fund_accounts( 10000000 );
+   const uint32_t levels = 500;
+   const auto make_ask = [&]( uint32_t level ) {
+      limit_order_create_operation op;
+      op.owner = random_account();
+      op.orderid = order_count++;
+      op.amount_to_sell = asset( 1000, BTCM_SYMBOL );
+      op.min_to_receive = asset( 1000 + level, XUSD_SYMBOL );
+      op.expiration = db.head_block_time() + 86400;
+      return operation( op );
+   };
+   // every sweep may cross the whole book and fills a couple of hundred orders
+   const auto make_sweep = [&]() {
+      limit_order_create_operation op;
+      op.owner = random_account();
+      op.orderid = order_count++;
+      op.amount_to_sell = asset( 250000, XUSD_SYMBOL );
+      op.min_to_receive = asset( 250000 * 1000 / ( 1000 + levels ), BTCM_SYMBOL );
+      op.expiration = db.head_block_time() + 86400;
+      return operation( op );
+   };
+
+   for( uint32_t i = 0; i < 10; ++i )
+   {
+      vector< operation > asks;
+      for( uint32_t j = 0; j < 2000; ++j )
+         asks.push_back( make_ask( random( levels ) ) );
+      setup_block( asks );
+   }
+   for( uint32_t i = 0; i < 20 * scale; ++i )
+   {
+      vector< operation > asks;
+      for( uint32_t j = 0; j < 2000; ++j )
+         asks.push_back( make_ask( random( levels ) ) );
+      setup_block( asks );
+
+      vector< operation > sweeps;
+      for( uint32_t j = 0; j < 8; ++j )
+         sweeps.push_back( make_sweep() );
+      measure_block( sweeps );
+   }
+   report( "deep_book_sweeps" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( power_downs )
+{ try {
+   create_accounts( 4000 * scale );
+   fund_accounts( 10000000 );
+
+   vector< operation > ops;
+   for( const auto& name : accounts )
+   {
+      transfer_to_vesting_operation op;
+      op.from = name;
+      op.to = name;
+      op.amount = asset( 5000000, BTCM_SYMBOL );
+      ops.push_back( op );
+   }
+   setup_block( ops );
+
+   // half of the accounts route half of their payouts to another account, as shares or as BTCM
+   ops.clear();
+   for( size_t i = 0; i < accounts.size(); i += 2 )
+   {
+      set_withdraw_vesting_route_operation op;
+      op.from_account = accounts[i];
+      do op.to_account = random_account(); while( op.to_account == op.from_account );
+      op.percent = BTCM_100_PERCENT / 2;
+      op.auto_vest = random( 2 ) == 0;
+      ops.push_back( op );
+   }
+   setup_block( ops );
+
+   // every account powers down, a few hundred in every block, so that they are paid out as many a block
+   const uint32_t per_block = 400;
+   const fc::time_point_sec first_payout = db.head_block_time() + BTCM_BLOCK_INTERVAL + BTCM_VESTING_WITHDRAW_INTERVAL_SECONDS;
+   ops.clear();
+   for( const auto& name : accounts )
+   {
+      withdraw_vesting_operation op;
+      op.account = name;
+      op.vesting_shares = asset( db.get_account( name ).vesting_shares.amount / 2, VESTS_SYMBOL );
+      ops.push_back( op );
+      if( ops.size() == per_block )
+      {
+         setup_block( ops );
+         ops.clear();
+      }
+   }
+   if( !ops.empty() )
+      setup_block( ops );
+
+   generate_blocks( first_payout - BTCM_BLOCK_INTERVAL );
+   for( size_t i = 0; i < accounts.size(); i += per_block )
+      measure_block();
+   report( "power_downs" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( mixed )
+{ try {
+   create_accounts( 4000 * scale );
+   fund_accounts( 1000000 );
+   create_platforms( 5 );
+   create_contents( 500 * scale );
+   for( uint32_t i = 0; i < 20 * scale; ++i )
+   {
+      vector< operation > ops = make_reports( 200 );
+      add_friendships( ops, 25 );
+      add_votes( ops, 50 );
+      for( uint32_t j = 0; j < 50; ++j )
+      {
+         ops.push_back( make_transfer() );
+         ops.push_back( make_order() );
+      }
+      measure_block( ops );
+   }
+   report( "mixed" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( object_lookup )
+{ try {
+   create_accounts( 2000 * scale );
+   vector< account_id_type > ids;
+   for( const auto& name : accounts )
+      ids.push_back( db.get_account( name ).id );
+   const uint32_t rounds = 200;
+   const auto& by_id = db.get_index_type< account_index >().indices().get< graphene::db::by_id >();
+
+   uint64_t checksum = 0;
+   auto start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+      for( const auto id : ids )
+         checksum += db.get< account_object >( id ).id.instance();
+   const fc::microseconds dense = fc::time_point::now() - start;
+
+   start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+      for( const auto id : ids )
+         checksum += by_id.find( id )->id.instance();
+   const fc::microseconds ordered = fc::time_point::now() - start;
+
+   start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+      for( const auto& name : accounts )
+         checksum += db.get_account( name ).id.instance();
+   const fc::microseconds by_name = fc::time_point::now() - start;
+   BOOST_CHECK( checksum > 0 );
+
+   const double lookups = double( rounds ) * ids.size();
+   fc::mutable_variant_object result;
+   result( "name", "object_lookup" )
+         ( "lookups", uint64_t( lookups ) )
+         ( "dense_ns", dense.count() * 1000.0 / lookups )
+         ( "ordered_by_id_ns", ordered.count() * 1000.0 / lookups )
+         ( "by_name_ns", by_name.count() * 1000.0 / lookups );
+   bench::report( result );
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Modifies the dynamic global properties once per operation of a block of transfers, with every modification
+ * going to object_database::modify() as before singleton_write_buffer, and with the modifications of each
+ * block and each transaction coalesced as _apply_block and _apply_transaction do
+ */
+BOOST_AUTO_TEST_CASE( global_property_buffer )
+{ try {
+   const uint32_t rounds = 200 * scale;
+   const uint32_t trxs_per_block = 400 / ops_per_trx;
+   const auto& dgp = db.get_dynamic_global_properties();
+   const share_type initial_delta = dgp.supply_delta.amount;
+
+   // one block applied in an undo session, which is rolled back, @return the supply delta it left
+   auto apply = [&]( bool buffered ) -> share_type {
+      auto session = db._undo_db.start_undo_session();
+      std::unique_ptr< btcm::chain::detail::global_property_buffer_scope > block_scope;
+      if( buffered )
+         block_scope.reset( new btcm::chain::detail::global_property_buffer_scope( db ) );
+      for( uint32_t t = 0; t < trxs_per_block; ++t )
+      {
+         std::unique_ptr< btcm::chain::detail::global_property_buffer_scope > trx_scope;
+         if( buffered )
+            trx_scope.reset( new btcm::chain::detail::global_property_buffer_scope( db ) );
+         for( uint32_t o = 0; o < ops_per_trx; ++o )
+            db.modify( dgp, []( dynamic_global_property_object& p ) { p.supply_delta.amount += 1; } );
+         if( buffered )
+            trx_scope->flush();
+      }
+      if( buffered )
+         block_scope->flush();
+      return dgp.supply_delta.amount - initial_delta;
+   };
+
+   auto measure = [&]( bool buffered, uint64_t& allocs ) -> fc::microseconds {
+      const auto allocs_before = bench::allocations();
+      const auto start = fc::time_point::now();
+      for( uint32_t r = 0; r < rounds; ++r )
+         BOOST_REQUIRE_EQUAL( apply( buffered ).value, int64_t( trxs_per_block * ops_per_trx ) );
+      const fc::microseconds elapsed = fc::time_point::now() - start;
+      allocs = bench::allocations().count - allocs_before.count;
+      return elapsed;
+   };
+
+   uint64_t unbuffered_allocations = 0, buffered_allocations = 0;
+   const fc::microseconds unbuffered = measure( false, unbuffered_allocations );
+   const fc::microseconds buffered = measure( true, buffered_allocations );
+   BOOST_CHECK_EQUAL( dgp.supply_delta.amount.value, initial_delta.value );
+
+   const double modifications = double( rounds ) * trxs_per_block * ops_per_trx;
+   fc::mutable_variant_object result;
+   result( "name", "global_property_buffer" )
+         ( "modifications", uint64_t( modifications ) )
+         ( "unbuffered_ns", unbuffered.count() * 1000.0 / modifications )
+         ( "buffered_ns", buffered.count() * 1000.0 / modifications )
+         ( "unbuffered_allocations_per_block", unbuffered_allocations / double( rounds ) )
+         ( "buffered_allocations_per_block", buffered_allocations / double( rounds ) );
+   bench::report( result );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( block_serialization )
+{ try {
+   create_accounts( 2000 * scale );
+   create_platforms( 5 );
+   create_contents( 500 * scale );
+   push( make_reports( 1000 ) );
+   const signed_block block = generate_block();
+   const uint32_t rounds = 100 * scale;
+
+   // the walks done for one block while it is pushed and applied
+   auto walk = [&block]() {
+      size_t size = 0;
+      for( int i = 0; i < 3; ++i )
+      {
+         size += block.packed_size();
+         size += block.id()._hash[0];
+         size += block.digest()._hash[0];
+      }
+      return size;
+   };
+
+   size_t checksum = 0;
+   auto start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+      checksum += walk();
+   const fc::microseconds uncached = fc::time_point::now() - start;
+
+   start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+   {
+      scoped_serialization_cache< signed_block > cached( block );
+      checksum -= walk();
+   }
+   const fc::microseconds cached = fc::time_point::now() - start;
+   BOOST_CHECK_EQUAL( 0u, checksum );
+
+   fc::mutable_variant_object result;
+   result( "name", "block_serialization" )
+         ( "block_size", block.packed_size() )
+         ( "rounds", rounds )
+         ( "uncached_us", uncached.count() / double( rounds ) )
+         ( "cached_us", cached.count() / double( rounds ) );
+   bench::report( result );
+} FC_LOG_AND_RETHROW() }
+
+/// Parses every request of @p corpus with both JSON readers and adds their throughput to the report
+static void report_json_parse( const string& name, const vector< string >& corpus )
+{
+   const uint32_t rounds = 20 * bench::scale();
+   uint64_t bytes = 0;
+   for( const auto& request : corpus )
+   {
+      bytes += request.size();
+      fc::istream_ptr in( new fc::stringstream( request ) );
+      fc::buffered_istream bin( in );
+      BOOST_CHECK_EQUAL( fc::json::to_string( fc::json::from_stream( bin ) ),
+                         fc::json::to_string( fc::json::from_string( request ) ) );
+   }
+
+   auto allocs_before = bench::allocations();
+   auto start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+      for( const auto& request : corpus )
+      {
+         fc::istream_ptr in( new fc::stringstream( request ) );
+         fc::buffered_istream bin( in );
+         fc::json::from_stream( bin );
+      }
+   const fc::microseconds stream = fc::time_point::now() - start;
+   const uint64_t stream_allocations = bench::allocations().count - allocs_before.count;
+
+   allocs_before = bench::allocations();
+   start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+      for( const auto& request : corpus )
+         fc::json::from_string( request );
+   const fc::microseconds string_reader = fc::time_point::now() - start;
+   const uint64_t string_allocations = bench::allocations().count - allocs_before.count;
+
+   const double requests = double( rounds ) * corpus.size();
+   const double megabytes = double( rounds ) * bytes / ( 1024 * 1024 );
+   fc::mutable_variant_object result;
+   result( "name", name )
+         ( "requests", corpus.size() )
+         ( "bytes", bytes )
+         ( "rounds", rounds )
+         ( "stream_us_per_request", stream.count() / requests )
+         ( "stream_mb_per_second", stream.count() > 0 ? megabytes * 1000000 / stream.count() : 0.0 )
+         ( "stream_allocations_per_request", stream_allocations / requests )
+         ( "string_us_per_request", string_reader.count() / requests )
+         ( "string_mb_per_second", string_reader.count() > 0 ? megabytes * 1000000 / string_reader.count() : 0.0 )
+         ( "string_allocations_per_request", string_allocations / requests );
+   bench::report( result );
+}
+
+BOOST_AUTO_TEST_CASE( json_request_parse )
+{ try {
+   // the requests only name accounts and content, none of it has to exist on chain
+   for( uint32_t i = 0; i < 200; ++i )
+      accounts.push_back( "bench" + fc::to_string( i ) );
+   for( uint32_t i = 0; i < 5; ++i )
+      platforms.push_back( "benchsp" + fc::to_string( i ) );
+   for( uint32_t i = 0; i < 100; ++i )
+      make_content();
+
+   // mostly broadcast_transaction bodies, interleaved with the small queries of wallets and front-ends
+   vector< string > corpus;
+   for( uint32_t i = 0; i < 1000; ++i )
+   {
+      fc::mutable_variant_object request;
+      request( "jsonrpc", "2.0" )( "id", i );
+      switch( random( 8 ) )
+      {
+         case 0:
+            request( "method", "call" )( "params", fc::variants{ "database_api", "get_accounts",
+                                                                 fc::variants{ fc::variants{ random_account(), random_account() } } } );
+            break;
+         case 1:
+            request( "method", "get_block" )( "params", fc::variants{ random( 1000000 ) } );
+            break;
+         case 2:
+            request( "method", "call" )( "params", fc::variants{ "database_api", "lookup_content",
+                                                                 fc::variants{ contents[ random( contents.size() ) ], 100 } } );
+            break;
+         default:
+         {
+            signed_transaction tx;
+            tx.set_expiration( db.head_block_time() + BTCM_MAX_TIME_UNTIL_EXPIRATION );
+            tx.set_reference_block( db.head_block_id() );
+            const uint32_t ops = 1 + random( 3 );
+            for( uint32_t j = 0; j < ops; ++j )
+               tx.operations.push_back( random( 4 ) == 0 ? operation( make_content() )
+                                                         : random( 2 ) ? make_report() : make_transfer() );
+            sign( tx, init_account_priv_key );
+            request( "method", "call" )( "params", fc::variants{ "network_broadcast_api", "broadcast_transaction",
+                                                                 fc::variants{ fc::variant( tx, GRAPHENE_MAX_NESTED_OBJECTS ) } } );
+         }
+      }
+      corpus.push_back( fc::json::to_string( fc::variant( request ) ) );
+   }
+   report_json_parse( "json_request_parse", corpus );
+
+   const string recorded = bench::json_corpus();
+   if( !recorded.empty() )
+   {
+      corpus.clear();
+      std::ifstream in( recorded );
+      string line;
+      while( std::getline( in, line ) )
+         if( !line.empty() )
+            corpus.push_back( line );
+      BOOST_REQUIRE( !corpus.empty() );
+      report_json_parse( "json_request_parse_recorded", corpus );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,134 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <boost/test/included/unit_test.hpp>
+
+#include <btcm/chain/protocol/version.hpp>
+#include <btcm/chain/config.hpp>
+#include <graphene/utilities/git_revision.hpp>
+
+#include <fc/io/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "bench.hpp"
+
+extern uint32_t BTCM_TESTING_GENESIS_TIMESTAMP;
+
+namespace {
+   std::atomic< uint64_t > allocation_count( 0 );
+   std::atomic< uint64_t > allocated_bytes( 0 );
+
+   uint32_t env_or_default( const char* name, uint32_t def )
+   {
+      const char* value = getenv( name );
+      return value != nullptr ? std::stoul( value ) : def;
+   }
+
+   fc::variants& results()
+   {
+      static fc::variants r;
+      return r;
+   }
+}
+
+// Every allocation made through the global operator new is counted, so that the benchmarks can report
+// how many allocations a workload costs.
+void* operator new( std::size_t size )
+{
+   allocation_count.fetch_add( 1, std::memory_order_relaxed );
+   allocated_bytes.fetch_add( size, std::memory_order_relaxed );
+   if( void* p = std::malloc( size ? size : 1 ) )
+      return p;
+   throw std::bad_alloc();
+}
+void* operator new[]( std::size_t size ) { return operator new( size ); }
+void operator delete( void* p ) noexcept { std::free( p ); }
+void operator delete[]( void* p ) noexcept { std::free( p ); }
+void operator delete( void* p, std::size_t ) noexcept { std::free( p ); }
+void operator delete[]( void* p, std::size_t ) noexcept { std::free( p ); }
+
+namespace btcm { namespace chain { namespace bench {
+
+allocation_counters allocations()
+{
+   allocation_counters result;
+   result.count = allocation_count.load( std::memory_order_relaxed );
+   result.bytes = allocated_bytes.load( std::memory_order_relaxed );
+   return result;
+}
+
+uint64_t peak_rss_kb()
+{
+#if defined(__unix__) || defined(__APPLE__)
+   struct rusage usage;
+   if( getrusage( RUSAGE_SELF, &usage ) != 0 )
+      return 0;
+#ifdef __APPLE__
+   return usage.ru_maxrss / 1024;
+#else
+   return usage.ru_maxrss;
+#endif
+#else
+   return 0;
+#endif
+}
+
+uint32_t seed() { return env_or_default( "BTCM_BENCH_SEED", 1 ); }
+uint32_t scale() { return std::max< uint32_t >( env_or_default( "BTCM_BENCH_SCALE", 1 ), 1 ); }
+
+std::string json_corpus()
+{
+   const char* value = getenv( "BTCM_BENCH_JSON_CORPUS" );
+   return value != nullptr ? value : "";
+}
+
+void report( const fc::variant_object& result )
+{
+   results().emplace_back( result );
+}
+
+} } } // btcm::chain::bench
+
+/**
+ * Writes the collected results as a single JSON document to stdout, and to the file named by
+ * BTCM_BENCH_OUTPUT if it is set.
+ */
+struct bench_report_writer
+{
+   ~bench_report_writer()
+   {
+      using namespace btcm::chain;
+      fc::mutable_variant_object report;
+      report( "revision", graphene::utilities::git_revision_sha )
+            ( "revision_description", graphene::utilities::git_revision_description )
+            ( "blockchain_version", std::string( BTCM_BLOCKCHAIN_VERSION ) )
+            ( "seed", bench::seed() )
+            ( "scale", bench::scale() )
+            ( "peak_rss_kb", bench::peak_rss_kb() )
+            ( "results", results() );
+      const std::string json = fc::json::to_pretty_string( fc::variant( report ), fc::json::legacy_generator );
+      std::cout << json << std::endl;
+      const char* output = getenv( "BTCM_BENCH_OUTPUT" );
+      if( output != nullptr )
+         std::ofstream( output ) << json << std::endl;
+   }
+};
+
+BOOST_GLOBAL_FIXTURE( bench_report_writer );
+
+boost::unit_test::test_suite* init_unit_test_suite(int argc, char* argv[]) {
+   const char* genesis_timestamp_str = getenv("BTCM_TESTING_GENESIS_TIMESTAMP");
+   if( genesis_timestamp_str != nullptr )
+   {
+      BTCM_TESTING_GENESIS_TIMESTAMP = std::stoul( genesis_timestamp_str );
+   }
+   std::cerr << "BTCM_TESTING_GENESIS_TIMESTAMP is " << BTCM_TESTING_GENESIS_TIMESTAMP << std::endl;
+   return nullptr;
+}
@@ -0,0 +1,344 @@
+#include <boost/test/unit_test.hpp>
+
+#include <btcm/chain/protocol/block.hpp>
+
+#include <fc/api.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/network/http/websocket.hpp>
+#include <fc/rpc/binary_api_connection.hpp>
+#include <fc/rpc/websocket_api.hpp>
+#include <fc/smart_ref_impl.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <thread>
+
+#include "bench.hpp"
+
+/// What the load clients call, small enough that the server's time goes into socket I/O and parsing
+class rpc_bench_api
+{
+   public:
+      uint64_t sum( const std::vector< uint64_t >& values )const
+      {
+         return std::accumulate( values.begin(), values.end(), uint64_t( 0 ) );
+      }
+};
+FC_API( rpc_bench_api, (sum) )
+
+using namespace btcm::chain;
+
+/// Serves the payloads of database_api::get_block and network_broadcast_api::broadcast_transaction
+class rpc_payload_api
+{
+   public:
+      explicit rpc_payload_api( signed_block b ) : block( std::move( b ) ) {}
+
+      optional< signed_block > get_block( uint32_t block_num )const { return block; }
+      void broadcast_transaction( const signed_transaction& trx ) { FC_ASSERT( !trx.operations.empty() ); }
+
+      const signed_block block;
+};
+FC_API( rpc_payload_api, (get_block)(broadcast_transaction) )
+
+namespace {
+
+const uint32_t max_depth = 10;
+
+/// Starts @p server on a free port and returns the port
+uint16_t listen_on_free_port( fc::http::websocket_server& server )
+{
+   uint16_t port = 0;
+   for( uint32_t i = 0; port == 0 && i < 5; ++i )
+   {
+      const uint16_t candidate = std::rand() % 50000 + 10000;
+      try
+      {
+         server.listen( candidate );
+         port = candidate;
+      }
+      catch( const std::exception& )
+      {
+         // the port is busy, try another one
+      }
+   }
+   BOOST_REQUIRE( port != 0 );
+   server.start_accept();
+   return port;
+}
+
+/**
+ * A websocket RPC server on the calling thread, with rpc_bench_api as API 0 of every connection
+ */
+struct rpc_bench_server
+{
+   explicit rpc_bench_server( uint16_t io_threads )
+      : server( io_threads ), api( std::make_shared< rpc_bench_api >() )
+   {
+      server.on_connection( [this]( const fc::http::websocket_connection_ptr& c ) {
+         auto wsc = std::make_shared< fc::rpc::websocket_api_connection >( *c, max_depth );
+         wsc->register_api( api );
+         c->set_session_data( wsc );
+      });
+      port = listen_on_free_port( server );
+   }
+
+   fc::http::websocket_server server;
+   fc::api< rpc_bench_api >   api;
+   uint16_t                   port = 0;
+};
+
+/**
+ * Opens @p connections connections to the server on the calling thread and keeps one request outstanding on
+ * every one of them from @p begin until @p end.
+ * @return the latency of every request, in microseconds
+ */
+std::vector< int64_t > run_load_clients( uint16_t port, uint32_t connections, fc::time_point begin, fc::time_point end )
+{
+   // the clients close their connections when they are destroyed, which the api connections are told about
+   std::vector< std::shared_ptr< fc::rpc::websocket_api_connection > > apis;
+   std::vector< std::unique_ptr< fc::http::websocket_client > > clients;
+   std::vector< fc::http::websocket_connection_ptr > sockets;
+   std::vector< fc::future< std::vector< int64_t > > > loops;
+
+   for( uint32_t i = 0; i < connections; ++i )
+   {
+      clients.emplace_back( new fc::http::websocket_client() );
+      sockets.push_back( clients.back()->connect( "ws://localhost:" + fc::to_string( port ) ) );
+      apis.push_back( std::make_shared< fc::rpc::websocket_api_connection >( *sockets.back(), max_depth ) );
+   }
+
+   for( uint32_t i = 0; i < connections; ++i )
+   {
+      auto remote = apis[i]->get_remote_api< rpc_bench_api >( 0 );
+      loops.push_back( fc::async( [remote, begin, end, i]() {
+         if( fc::time_point::now() < begin )
+            fc::usleep( begin - fc::time_point::now() );
+         std::vector< int64_t > latencies;
+         std::vector< uint64_t > values( 64 );
+         std::iota( values.begin(), values.end(), uint64_t( i ) );
+         const uint64_t expected = std::accumulate( values.begin(), values.end(), uint64_t( 0 ) );
+         while( fc::time_point::now() < end )
+         {
+            const fc::time_point start = fc::time_point::now();
+            FC_ASSERT( remote->sum( values ) == expected );
+            latencies.push_back( ( fc::time_point::now() - start ).count() );
+         }
+         return latencies;
+      }, "rpc_bench client" ) );
+   }
+
+   std::vector< int64_t > result;
+   for( auto& loop : loops )
+   {
+      const auto latencies = loop.wait();
+      result.insert( result.end(), latencies.begin(), latencies.end() );
+   }
+   return result;
+}
+
+int64_t percentile( const std::vector< int64_t >& sorted, double p )
+{
+   return sorted.empty() ? 0 : sorted[ std::min< size_t >( sorted.size() - 1, size_t( sorted.size() * p ) ) ];
+}
+
+/// A block of @p transactions signed transactions with a few transfers each
+signed_block make_payload_block( uint32_t transactions )
+{
+   const fc::ecc::private_key key = fc::ecc::private_key::regenerate( fc::sha256::hash( std::string( "rpc_bench" ) ) );
+   signed_block block;
+   block.timestamp = fc::time_point_sec( 1500000000 );
+   block.witness = "bench-witness";
+   for( uint32_t t = 0; t < transactions; ++t )
+   {
+      signed_transaction trx;
+      trx.set_expiration( block.timestamp + 60 );
+      for( uint32_t o = 0; o < 3; ++o )
+      {
+         transfer_operation op;
+         op.from = "bench" + fc::to_string( ( t + o ) % 100 );
+         op.to = "bench" + fc::to_string( ( t * 7 + o ) % 100 );
+         op.amount = asset( t * 1000 + o + 1, BTCM_SYMBOL );
+         op.memo = "payment " + fc::to_string( t );
+         trx.operations.push_back( op );
+      }
+      trx.sign( key, chain_id_type() );
+      block.transactions.push_back( trx );
+   }
+   block.transaction_merkle_root = block.calculate_merkle_root();
+   block.sign( key );
+   return block;
+}
+
+/**
+ * A websocket RPC server on the calling thread serving rpc_payload_api as API 0, over JSON with
+ * websocket_api_connection or fc::raw with binary_api_connection
+ */
+template< typename Connection >
+struct rpc_payload_server
+{
+   explicit rpc_payload_server( const fc::api< rpc_payload_api >& a ) : api( a )
+   {
+      server.on_connection( [this]( const fc::http::websocket_connection_ptr& c ) {
+         auto con = std::make_shared< Connection >( *c, GRAPHENE_MAX_NESTED_OBJECTS );
+         con->register_api( api );
+         c->set_session_data( con );
+      });
+      port = listen_on_free_port( server );
+   }
+
+   fc::http::websocket_server server;
+   fc::api< rpc_payload_api > api;
+   uint16_t                   port = 0;
+};
+
+/// Calls the methods of the payload API on @p port @p rounds times each, on the calling thread
+template< typename Connection >
+std::pair< fc::microseconds, fc::microseconds > run_payload_calls( uint16_t port, const signed_transaction& trx, uint32_t rounds )
+{
+   // declared before the client, so that it outlives the socket the client closes on destruction
+   std::shared_ptr< Connection > con;
+   fc::http::websocket_client client;
+   auto socket = client.connect( "ws://localhost:" + fc::to_string( port ) );
+   con = std::make_shared< Connection >( *socket, GRAPHENE_MAX_NESTED_OBJECTS );
+   auto remote = con->template get_remote_api< rpc_payload_api >( 0 );
+
+   auto start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+      FC_ASSERT( remote->get_block( r )->transactions.size() > 0 );
+   const fc::microseconds get_block = fc::time_point::now() - start;
+
+   start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+      remote->broadcast_transaction( trx );
+   const fc::microseconds broadcast_transaction = fc::time_point::now() - start;
+   return std::make_pair( get_block, broadcast_transaction );
+}
+
+} // anonymous
+
+BOOST_AUTO_TEST_SUITE( rpc_bench )
+
+/**
+ * Measures requests per second and latency of the websocket RPC server at increasing numbers of connections,
+ * with the server sharing fc's I/O threads and with I/O threads of its own.  The clients run on threads of
+ * their own, so that the server thread only runs the calls.
+ */
+BOOST_AUTO_TEST_CASE( websocket_rpc_load )
+{ try {
+   const uint32_t hardware_threads = std::max( std::thread::hardware_concurrency(), 2u );
+   const uint32_t client_threads = std::min( hardware_threads / 2, 4u );
+   const fc::microseconds duration = fc::seconds( 2 * bench::scale() );
+
+   std::vector< std::unique_ptr< fc::thread > > clients;
+   for( uint32_t t = 0; t < client_threads; ++t )
+      clients.emplace_back( new fc::thread( "rpc_bench clients #" + fc::to_string( t ) ) );
+
+   for( uint16_t io_threads : { uint16_t( 0 ), uint16_t( std::max( hardware_threads / 2, 1u ) ) } )
+   {
+      rpc_bench_server server( io_threads );
+      for( uint32_t connections : { 1u, 16u, 64u, 256u } )
+      {
+         // connecting takes a while with many connections, the measurement starts after all are open
+         const fc::time_point begin = fc::time_point::now() + fc::seconds( 1 );
+         const fc::time_point end = begin + duration;
+         std::vector< fc::future< std::vector< int64_t > > > runs;
+         for( uint32_t t = 0; t < client_threads; ++t )
+         {
+            const uint32_t share = connections / client_threads + ( t < connections % client_threads ? 1 : 0 );
+            if( share > 0 )
+               runs.push_back( clients[t]->async( [&server, share, begin, end]() {
+                  return run_load_clients( server.port, share, begin, end );
+               }, "rpc_bench clients" ) );
+         }
+
+         std::vector< int64_t > latencies;
+         for( auto& run : runs )
+         {
+            const auto l = run.wait();
+            latencies.insert( latencies.end(), l.begin(), l.end() );
+         }
+         const double seconds = duration.count() / 1000000.0;
+         std::sort( latencies.begin(), latencies.end() );
+         BOOST_CHECK( !latencies.empty() );
+
+         fc::mutable_variant_object result;
+         result( "name", "websocket_rpc_load" )
+               ( "io_threads", io_threads )
+               ( "connections", connections )
+               ( "requests", latencies.size() )
+               ( "requests_per_second", latencies.size() / seconds )
+               ( "p50_us", percentile( latencies, 0.50 ) )
+               ( "p99_us", percentile( latencies, 0.99 ) )
+               ( "max_us", latencies.empty() ? 0 : latencies.back() );
+         bench::report( result );
+      }
+   }
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Compares the JSON endpoint with the fc::raw endpoint (--rpc-binary-endpoint) for the payloads of get_block
+ * and broadcast_transaction: the time the client waits for a call, on one connection, and what encoding and
+ * decoding the payload costs on its own.
+ */
+BOOST_AUTO_TEST_CASE( binary_vs_json_rpc )
+{ try {
+   const uint32_t rounds = 50 * bench::scale();
+   const signed_block block = make_payload_block( 1000 );
+   const signed_transaction& trx = block.transactions.front();
+   const fc::api< rpc_payload_api > api( std::make_shared< rpc_payload_api >( block ) );
+
+   rpc_payload_server< fc::rpc::websocket_api_connection > json_server( api );
+   rpc_payload_server< fc::rpc::binary_api_connection > binary_server( api );
+   fc::thread client_thread( "rpc_bench payload client" );
+   const auto json = client_thread.async( [&]() {
+      return run_payload_calls< fc::rpc::websocket_api_connection >( json_server.port, trx, rounds );
+   } ).wait();
+   const auto binary = client_thread.async( [&]() {
+      return run_payload_calls< fc::rpc::binary_api_connection >( binary_server.port, trx, rounds );
+   } ).wait();
+
+   // encoding and decoding alone, as both ends of a call do it
+   auto start = fc::time_point::now();
+   size_t json_size = 0;
+   for( uint32_t r = 0; r < rounds; ++r )
+   {
+      const std::string s = fc::json::to_string( fc::variant( block, GRAPHENE_MAX_NESTED_OBJECTS ) );
+      json_size = s.size();
+      FC_ASSERT( fc::json::from_string( s ).as< signed_block >( GRAPHENE_MAX_NESTED_OBJECTS ).transactions.size() == block.transactions.size() );
+   }
+   const fc::microseconds json_codec = fc::time_point::now() - start;
+
+   start = fc::time_point::now();
+   size_t binary_size = 0;
+   for( uint32_t r = 0; r < rounds; ++r )
+   {
+      const std::vector< char > packed = fc::raw::pack_to_vector( block, GRAPHENE_MAX_NESTED_OBJECTS );
+      binary_size = packed.size();
+      FC_ASSERT( fc::raw::unpack_from_vector< signed_block >( packed, GRAPHENE_MAX_NESTED_OBJECTS ).transactions.size() == block.transactions.size() );
+   }
+   const fc::microseconds binary_codec = fc::time_point::now() - start;
+
+   auto per_call = []( fc::microseconds t, uint32_t calls ) { return t.count() / double( calls ); };
+   fc::mutable_variant_object result;
+   result( "name", "binary_vs_json_rpc" )
+         ( "block_transactions", block.transactions.size() )
+         ( "rounds", rounds )
+         ( "get_block_json_bytes", json_size )
+         ( "get_block_binary_bytes", binary_size )
+         ( "get_block_json_us", per_call( json.first, rounds ) )
+         ( "get_block_binary_us", per_call( binary.first, rounds ) )
+         ( "broadcast_transaction_json_us", per_call( json.second, rounds ) )
+         ( "broadcast_transaction_binary_us", per_call( binary.second, rounds ) )
+         ( "block_json_codec_us", per_call( json_codec, rounds ) )
+         ( "block_binary_codec_us", per_call( binary_codec, rounds ) );
+   bench::report( result );
+   BOOST_CHECK_LT( binary_size, json_size );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
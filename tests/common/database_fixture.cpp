@@ -505,8 +505,8 @@ void database_fixture::validate_database( void )
 
       auto gpo = db.get_dynamic_global_properties();
 
-      const auto& content_idx = db.get_index_type< content_index >().indices().get< by_id >();
-      for( auto itr = content_idx.begin(); itr != content_idx.end(); itr++ )
+      const auto& content_stats_idx = db.get_index_type< content_stats_index >().indices().get< by_id >();
+      for( auto itr = content_stats_idx.begin(); itr != content_stats_idx.end(); itr++ )
       {
          total_supply += itr->accumulated_balance_master;
          total_supply += itr->accumulated_balance_comp;
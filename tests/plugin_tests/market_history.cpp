@@ -329,4 +329,70 @@ BOOST_AUTO_TEST_CASE( mh_test )
    FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( mh_failed_block_test )
+{
+   using namespace btcm::market_history;
+
+   try
+   {
+      auto mh_plugin = app.register_plugin< market_history_plugin >();
+      boost::program_options::variables_map options;
+      mh_plugin->plugin_set_app( &app );
+      mh_plugin->plugin_initialize( options );
+
+      ACTORS( (alice)(bob) );
+      fund( "alice", 1000000 );
+      fund( "bob", 1000000 );
+      set_price_feed( price( ASSET( "1.000 2.28.0" ), ASSET( "1.000 2.28.2" ) ) );
+      convert( "bob", asset( 10000, BTCM_SYMBOL ) );
+      generate_block();
+
+      const auto& order_hist_idx = db.get_index_type< order_history_index >().indices();
+
+      limit_order_create_operation op;
+      op.owner = "alice";
+      op.orderid = 1;
+      op.amount_to_sell = asset( 1000, BTCM_SYMBOL );
+      op.min_to_receive = asset( 1000, XUSD_SYMBOL );
+      trx.clear();
+      trx.set_expiration( db.head_block_time() + BTCM_MAX_TIME_UNTIL_EXPIRATION );
+      trx.operations.push_back( op );
+      sign( trx, alice_private_key );
+      PUSH_TX( db, trx );
+
+      op.owner = "bob";
+      op.amount_to_sell = asset( 1000, XUSD_SYMBOL );
+      op.min_to_receive = asset( 1000, BTCM_SYMBOL );
+      trx.clear();
+      trx.set_expiration( db.head_block_time() + BTCM_MAX_TIME_UNTIL_EXPIRATION );
+      trx.operations.push_back( op );
+      sign( trx, bob_private_key );
+      PUSH_TX( db, trx );
+      BOOST_REQUIRE_EQUAL( order_hist_idx.size(), 1u );
+
+      BOOST_TEST_MESSAGE( "Pushing a block that fills the orders and then fails to apply" );
+      auto bad_block = generate_block();
+      BOOST_REQUIRE_EQUAL( bad_block.transactions.size(), 2u );
+      BOOST_REQUIRE_EQUAL( order_hist_idx.size(), 1u );
+      db.pop_block();
+
+      bad_block.transactions.emplace_back();
+      bad_block.transactions.back().operations.emplace_back( transfer_operation() );
+      bad_block.transaction_merkle_root = bad_block.calculate_merkle_root();
+      bad_block.sign( init_account_priv_key );
+      BTCM_REQUIRE_THROW( PUSH_BLOCK( db, bad_block ), fc::exception );
+      BOOST_REQUIRE( !db.is_applying_block() );
+
+      // the orders of the failed block are pending again, their fill is recorded right away and only once
+      BOOST_REQUIRE_EQUAL( order_hist_idx.size(), 1u );
+      BOOST_REQUIRE( order_hist_idx.begin()->op.open_owner == "alice" );
+      BOOST_REQUIRE( order_hist_idx.begin()->op.current_owner == "bob" );
+
+      generate_block();
+      BOOST_REQUIRE_EQUAL( order_hist_idx.size(), 1u );
+      validate_database();
+   }
+   FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_SUITE_END()
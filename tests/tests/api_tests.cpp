@@ -25,6 +25,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <btcm/chain/protocol/ext.hpp>
+#include <btcm/app/confirmation_tracker.hpp>
 #include <btcm/app/database_api.hpp>
 #include <btcm/chain/protocol/operations.hpp>
 
@@ -462,7 +463,7 @@ BOOST_AUTO_TEST_CASE( list_content )
 
    // _by_latest
    BOOST_CHECK_THROW( db_api.list_content_by_latest( "", 1000 ), fc::assert_exception );
-   vector<content_object> songs = db_api.list_content_by_latest( "", 100 );
+   vector<btcm::app::extended_content> songs = db_api.list_content_by_latest( "", 100 );
    BOOST_CHECK( songs.empty() );
    BOOST_CHECK_THROW( db_api.list_content_by_latest( "1.9.0", 100 ), fc::assert_exception );
    BOOST_CHECK( songs.empty() );
@@ -735,6 +736,100 @@ BOOST_AUTO_TEST_CASE( list_content )
    BOOST_CHECK_EQUAL( 1, songs[0].id.instance() );
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( content_vote_totals_test )
+{ try {
+   btcm::app::database_api db_api( db );
+
+   ACTORS( (martha)(paula)(uhura)(veronica)(vici) );
+
+   signed_transaction tx;
+   tx.set_expiration( db.head_block_time() + BTCM_MAX_TIME_UNTIL_EXPIRATION );
+
+   content_operation cop;
+   cop.uploader = "uhura";
+   cop.url = "bmfs://abcdef1";
+   cop.album_meta.album_title = "First test album";
+   cop.track_meta.track_title = "First test song";
+   cop.comp_meta.third_party_publishers = false;
+   distribution dist;
+   dist.payee = "paula";
+   dist.bp = BTCM_100_PERCENT;
+   cop.distributions.push_back( dist );
+   management_vote mgmt;
+   mgmt.voter = "martha";
+   mgmt.percentage = 100;
+   cop.management.push_back( mgmt );
+   cop.management_threshold = 100;
+   cop.playing_reward = 10;
+   cop.publishers_share = 0;
+   tx.operations.push_back( cop );
+
+   vote_operation vop;
+   vop.voter = "veronica";
+   vop.url = "bmfs://abcdef1";
+   vop.weight = 5;
+   tx.operations.push_back( vop );
+   vop.voter = "vici";
+   vop.weight = -3;
+   tx.operations.push_back( vop );
+   db.push_transaction( tx, database::skip_transaction_signatures );
+
+   BOOST_CHECK( !db_api.get_content_vote_totals( "bmfs://abcdef2" ).valid() );
+   optional<content_vote_totals> totals = db_api.get_content_vote_totals( "bmfs://abcdef1" );
+   BOOST_REQUIRE( totals.valid() );
+   BOOST_CHECK_EQUAL( 2, totals->votes );
+   BOOST_CHECK_EQUAL( 1, totals->positive_votes );
+   BOOST_CHECK_EQUAL( 2, totals->vote_weight );
+   BOOST_CHECK_EQUAL( 5, totals->positive_vote_weight );
+
+   // settled votes move to the archive without changing the totals
+   const content_id_type song = db.get_content( "bmfs://abcdef1" ).id;
+   const auto& content_vote_idx = db.get_index_type< content_vote_index >().indices().get< by_content_voter >();
+   db.set_content_vote_archive_age( 60 );
+   generate_blocks( db.head_block_time() + 60, false );
+   BOOST_CHECK_EQUAL( 0, db.archive_settled_content_votes() );
+   generate_blocks( BTCM_MAX_MINERS + 1 );
+   BOOST_CHECK_EQUAL( 2, db.archive_settled_content_votes() );
+   BOOST_CHECK_EQUAL( 2, db.get_content_vote_archive().size() );
+   BOOST_CHECK( content_vote_idx.find( std::make_tuple( song, veronica_id ) ) == content_vote_idx.end() );
+   BOOST_CHECK( content_vote_idx.find( std::make_tuple( song, vici_id ) ) == content_vote_idx.end() );
+   BOOST_CHECK_EQUAL( 2, db_api.get_content_vote_totals( "bmfs://abcdef1" )->vote_weight );
+
+   // changing an archived vote brings it back
+   tx.set_expiration( db.head_block_time() + BTCM_MAX_TIME_UNTIL_EXPIRATION );
+   tx.operations.clear();
+   vop.voter = "veronica";
+   vop.weight = 7;
+   tx.operations.push_back( vop );
+   db.push_transaction( tx, database::skip_transaction_signatures );
+   auto voted = content_vote_idx.find( std::make_tuple( song, veronica_id ) );
+   BOOST_REQUIRE( voted != content_vote_idx.end() );
+   BOOST_CHECK_EQUAL( 7, voted->weight );
+   BOOST_CHECK_EQUAL( 1, voted->num_changes );
+   totals = db_api.get_content_vote_totals( "bmfs://abcdef1" );
+   BOOST_CHECK_EQUAL( 2, totals->votes );
+   BOOST_CHECK_EQUAL( 1, totals->positive_votes );
+   BOOST_CHECK_EQUAL( 4, totals->vote_weight );
+   BOOST_CHECK_EQUAL( 7, totals->positive_vote_weight );
+
+   // ...and the archived state is still checked
+   tx.operations.clear();
+   vop.voter = "vici";
+   vop.weight = -3;
+   tx.operations.push_back( vop );
+   BTCM_REQUIRE_THROW( db.push_transaction( tx, database::skip_transaction_signatures ), fc::assert_exception );
+   BOOST_CHECK( content_vote_idx.find( std::make_tuple( song, vici_id ) ) == content_vote_idx.end() );
+
+   vop.weight = 0;
+   tx.operations.clear();
+   tx.operations.push_back( vop );
+   db.push_transaction( tx, database::skip_transaction_signatures );
+   totals = db_api.get_content_vote_totals( "bmfs://abcdef1" );
+   BOOST_CHECK_EQUAL( 1, totals->votes );
+   BOOST_CHECK_EQUAL( 7, totals->vote_weight );
+   BOOST_CHECK_EQUAL( 1, content_vote_idx.find( std::make_tuple( song, vici_id ) )->num_changes );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( asset_holders )
 { try {
    btcm::app::database_api db_api( db );
@@ -818,4 +913,51 @@ BOOST_AUTO_TEST_CASE( asset_holders )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( confirmation_tracker_test )
+{ try {
+   ACTORS( (alice)(bob) )
+   fund( "alice", 10000 );
+
+   btcm::app::transaction_confirmation_tracker tracker( db );
+   vector< btcm::app::transaction_confirmation > confirmations;
+   auto record = [&confirmations]( const btcm::app::transaction_confirmation& c ){ confirmations.push_back( c ); };
+
+   transfer_operation op;
+   op.from = "alice";
+   op.to = "bob";
+   op.amount = asset( 1000, BTCM_SYMBOL );
+
+   signed_transaction tx;
+   tx.operations.push_back( op );
+   tx.set_expiration( db.head_block_time() + BTCM_MAX_TIME_UNTIL_EXPIRATION );
+   tx.sign( alice_private_key, db.get_chain_id() );
+
+   BOOST_TEST_MESSAGE( "Tracking the same transaction twice and one that never makes it into a block" );
+   tracker.track( tx.id(), tx.expiration, record );
+   tracker.track( tx.id(), tx.expiration, record );
+   transaction_id_type missing_id = fc::ripemd160::hash( "missing" );
+   tracker.track( missing_id, db.head_block_time() + 1, record );
+   BOOST_REQUIRE_EQUAL( tracker.size(), 3 );
+
+   db.push_transaction( tx, 0 );
+   generate_block();
+
+   BOOST_REQUIRE_EQUAL( tracker.size(), 0 );
+   BOOST_TEST_MESSAGE( "Confirmations are delivered asynchronously" );
+   BOOST_REQUIRE( confirmations.empty() );
+   fc::yield();
+
+   BOOST_REQUIRE_EQUAL( confirmations.size(), 3 );
+   for( size_t i = 0; i < 2; ++i )
+   {
+      BOOST_CHECK( confirmations[i].id == tx.id() );
+      BOOST_CHECK_EQUAL( confirmations[i].block_num, int32_t( db.head_block_num() ) );
+      BOOST_CHECK_EQUAL( confirmations[i].trx_num, 0 );
+      BOOST_CHECK( !confirmations[i].expired );
+   }
+   BOOST_CHECK( confirmations[2].id == missing_id );
+   BOOST_CHECK_EQUAL( confirmations[2].trx_num, -1 );
+   BOOST_CHECK( confirmations[2].expired );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2018 Peertracks, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <btcm/app/api_access.hpp>
+#include <btcm/app/application.hpp>
+#include <btcm/app/binary_api_client.hpp>
+#include <btcm/app/database_api.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/crypto/base64.hpp>
+#include <fc/smart_ref_impl.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <cstdlib>
+
+using namespace btcm::chain;
+using namespace btcm::app;
+namespace bpo = boost::program_options;
+
+BOOST_AUTO_TEST_SUITE( app_tests )
+
+/**
+ * Starts a node with its rpc-binary-endpoint and checks that a session gets database_api, which is not public,
+ * only once it logged in as a user allowed to call it, and that blocks come back as the node has them
+ */
+BOOST_AUTO_TEST_CASE( binary_endpoint_login )
+{ try {
+   fc::temp_directory app_dir( graphene::utilities::temp_directory_path() );
+
+   api_access_info user;
+   user.username = "reader";
+   user.password_salt_b64 = fc::base64_encode( "salt" );
+   const fc::sha256 password_hash = fc::sha256::hash( std::string( "secret" ) + "salt" );
+   user.password_hash_b64 = fc::base64_encode( (const unsigned char*)password_hash.data(), password_hash.data_size() );
+   user.allowed_apis.push_back( "database_api" );
+
+   const uint16_t port = std::rand() % 50000 + 10000;
+   bpo::variables_map options;
+   options.emplace( "rpc-binary-endpoint", bpo::variable_value( "127.0.0.1:" + fc::to_string( port ), false ) );
+   options.emplace( "p2p-endpoint", bpo::variable_value( std::string( "127.0.0.1:0" ), false ) );
+   options.emplace( "seed-node", bpo::variable_value( std::vector< std::string >(), false ) );
+   options.emplace( "public-api", bpo::variable_value( std::vector< std::string >{ "login_api" }, false ) );
+   options.emplace( "api-user", bpo::variable_value( std::vector< std::string >{
+                                   fc::json::to_string( fc::variant( user, 2 ) ) }, false ) );
+
+   application app;
+   app.initialize( app_dir.path(), options );
+   app.startup();
+
+   auto db = app.chain_database();
+   const auto init_key = fc::ecc::private_key::regenerate( fc::sha256::hash( std::string( "init_key" ) ) );
+   const signed_block block = db->generate_block( db->get_slot_time( 1 ), db->get_scheduled_witness( 1 ), init_key,
+                                                  database::skip_witness_signature );
+
+   // the client blocks the fc task that calls it, the node serves the call on this thread meanwhile
+   fc::thread client_thread( "app_tests binary client" );
+   client_thread.async( [&]() {
+      binary_api_client client( 0 );
+      client.connect( "ws://127.0.0.1:" + fc::to_string( port ) );
+
+      BOOST_CHECK( !client.get_login_api()->get_api_by_name( "database_api" ) );
+      BOOST_CHECK_THROW( client.get_api< database_api >( "database_api" ), fc::exception );
+
+      BOOST_CHECK( !client.login( "reader", "wrong" ) );
+      BOOST_CHECK( !client.login( "writer", "secret" ) );
+      BOOST_CHECK( !client.get_login_api()->get_api_by_name( "database_api" ) );
+
+      BOOST_REQUIRE( client.login( "reader", "secret" ) );
+      auto remote_db = client.get_api< database_api >( "database_api" );
+      const optional< signed_block > remote_block = remote_db->get_block( block.block_num() );
+      BOOST_REQUIRE( remote_block.valid() );
+      BOOST_CHECK( remote_block->id() == block.id() );
+      BOOST_CHECK( fc::raw::pack_to_vector( *remote_block ) == fc::raw::pack_to_vector( block ) );
+      BOOST_CHECK( !remote_db->get_block( block.block_num() + 1 ).valid() );
+   }, "binary_endpoint_login" ).wait();
+
+   app.shutdown();
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -28,6 +28,8 @@
 #include <btcm/chain/protocol/asset_ops.hpp>
 #include <btcm/app/database_api.hpp>
 
+#include <fc/io/json.hpp>
+
 #include "../common/database_fixture.hpp"
 
 using namespace btcm::chain;
@@ -377,6 +379,65 @@ BOOST_AUTO_TEST_CASE(trade_assets_test)
     BOOST_CHECK_EQUAL(3000000000, orderbook.asks[0].quote.value);
     BOOST_CHECK_EQUAL(20000, orderbook.asks[0].base.value);
 
+    orderbook = db_api.get_order_book_for_assets(btc.id, BTCM_SYMBOL, 1000);
+    auto depth = db_api.get_order_book_depth(btc.id, BTCM_SYMBOL, 1000);
+    BOOST_CHECK_EQUAL("BTC", depth.value().base);
+    BOOST_CHECK_EQUAL("BTCM", depth.value().quote);
+    BOOST_REQUIRE_EQUAL(orderbook.asks.size(), depth.value().asks.size());
+    BOOST_REQUIRE_EQUAL(orderbook.bids.size(), depth.value().bids.size());
+    for( size_t i = 0; i < orderbook.asks.size(); ++i )
+    {
+        BOOST_CHECK(orderbook.asks[i].order_price == depth.value().asks[i].order_price);
+        BOOST_CHECK_EQUAL(orderbook.asks[i].base.value, depth.value().asks[i].base.value);
+        BOOST_CHECK_EQUAL(orderbook.asks[i].quote.value, depth.value().asks[i].quote.value);
+        BOOST_CHECK_EQUAL(1u, depth.value().asks[i].orders);
+    }
+    for( size_t i = 0; i < orderbook.bids.size(); ++i )
+    {
+        BOOST_CHECK(orderbook.bids[i].order_price == depth.value().bids[i].order_price);
+        BOOST_CHECK_EQUAL(orderbook.bids[i].base.value, depth.value().bids[i].base.value);
+        BOOST_CHECK_EQUAL(orderbook.bids[i].quote.value, depth.value().bids[i].quote.value);
+        BOOST_CHECK_EQUAL(1u, depth.value().bids[i].orders);
+    }
+    // unchanged markets are served from the cache
+    BOOST_CHECK(&depth.json() == &db_api.get_order_book_depth(btc.id, BTCM_SYMBOL, 1000).json());
+    BOOST_CHECK_EQUAL(fc::json::to_string(fc::variant(depth.value(), 100)), depth.json());
+
+    auto top = db_api.get_top_of_book(btc.id, BTCM_SYMBOL);
+    BOOST_REQUIRE(top.ask.valid() && top.bid.valid());
+    BOOST_CHECK(top.ask->order_price == orderbook.asks[0].order_price);
+    BOOST_CHECK(top.bid->order_price == orderbook.bids[0].order_price);
+    BOOST_CHECK(!db_api.get_top_of_book(bts.id, btc.id).ask.valid());
+
+    generate_block();
+
+    {
+        // an order at the best bid joins its price level
+        limit_order_create_operation loc;
+        loc.owner = "bob";
+        loc.orderid = 100;
+        loc.amount_to_sell = BTCM_SYMBOL(db).amount(700000);
+        loc.min_to_receive = btc.amount(44);
+        trx.set_expiration( db.head_block_time() + BTCM_MAX_TIME_UNTIL_EXPIRATION );
+        trx.operations.emplace_back(std::move(loc));
+        sign(trx, bob_private_key);
+        PUSH_TX(db, trx);
+        trx.clear();
+    }
+
+    auto depth2 = db_api.get_order_book_depth(btc.id, BTCM_SYMBOL, 1000);
+    BOOST_CHECK(&depth.json() != &depth2.json());
+    BOOST_REQUIRE_EQUAL(orderbook.bids.size(), depth2.value().bids.size());
+    BOOST_CHECK_EQUAL(2u, depth2.value().bids[0].orders);
+    BOOST_CHECK_EQUAL(1050000, depth2.value().bids[0].quote.value);
+    BOOST_CHECK_EQUAL(66, depth2.value().bids[0].base.value);
+    BOOST_CHECK_EQUAL(2u, db_api.get_top_of_book(btc.id, BTCM_SYMBOL).bid->orders);
+
+    // undoing the order restores the level
+    db.clear_pending();
+    BOOST_CHECK_EQUAL(1u, db_api.get_order_book_depth(btc.id, BTCM_SYMBOL, 1000).value().bids[0].orders);
+    BOOST_CHECK_EQUAL(350000, db_api.get_top_of_book(btc.id, BTCM_SYMBOL).bid->quote.value);
+
 } FC_LOG_AND_RETHROW() }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -27,10 +27,12 @@
 #include <btcm/chain/exceptions.hpp>
 #include <btcm/chain/base_objects.hpp>
 #include <btcm/chain/history_object.hpp>
+#include <btcm/chain/transaction_object.hpp>
 #include <btcm/account_history/account_history_plugin.hpp>
 
 #include <graphene/utilities/tempdir.hpp>
 
+#include <fc/bitutil.hpp>
 #include <fc/crypto/digest.hpp>
 
 #include "../common/database_fixture.hpp"
@@ -100,6 +102,72 @@ BOOST_AUTO_TEST_CASE( block_database_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( block_database_async_write_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+
+      block_database::write_options options;
+      options.max_batch = 3;
+      options.max_queued = 4;
+      options.fsync = true;
+
+      block_database bdb;
+      bdb.set_write_options( options );
+      bdb.open( data_dir.path() );
+
+      vector< signed_block > blocks;
+      signed_block b;
+      for( uint32_t i = 0; i < 20; ++i )
+      {
+         if( i > 0 ) b.previous = b.id();
+         b.witness = witness_id_type(i+1);
+         bdb.store( b.id(), b );
+         blocks.push_back( b );
+
+         // readers see the block whether or not it has been written yet
+         BOOST_CHECK( bdb.contains( b.id() ) );
+         BOOST_CHECK( bdb.fetch_block_id( b.block_num() ) == b.id() );
+         BOOST_REQUIRE( bdb.fetch_by_number( b.block_num() ).valid() );
+         BOOST_CHECK( bdb.fetch_by_number( b.block_num() )->witness == b.witness );
+         BOOST_REQUIRE( bdb.last_id().valid() );
+         BOOST_CHECK( *bdb.last_id() == b.id() );
+      }
+
+      // switch to a fork at block 15, the later store of a block number wins
+      signed_block fork = blocks[13];
+      for( uint32_t i = 14; i < 20; ++i )
+      {
+         fork.previous = fork.id();
+         fork.witness = witness_id_type(100+i);
+         bdb.store( fork.id(), fork );
+         BOOST_CHECK( !bdb.contains( blocks[i].id() ) );
+         BOOST_CHECK( !bdb.fetch_optional( blocks[i].id() ).valid() );
+         BOOST_CHECK( bdb.fetch_optional( fork.id() ).valid() );
+      }
+
+      bdb.flush();
+      BOOST_CHECK( *bdb.last_id() == fork.id() );
+      bdb.close();
+
+      options.async = false;
+      bdb.set_write_options( options );
+      bdb.open( data_dir.path() );
+      BOOST_REQUIRE( bdb.last().valid() );
+      BOOST_CHECK( bdb.last()->id() == fork.id() );
+      for( uint32_t i = 0; i < 14; ++i )
+         BOOST_CHECK( bdb.fetch_block_id( i+1 ) == blocks[i].id() );
+      BOOST_CHECK( !bdb.contains( blocks[19].id() ) );
+
+      bdb.remove( fork.id() );
+      BOOST_CHECK( !bdb.contains( fork.id() ) );
+      BOOST_CHECK( *bdb.last_id() == fork.previous );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 static const fc::ecc::private_key& init_account_priv_key()
 {
    static const auto priv_key = fc::ecc::private_key::regenerate( fc::sha256::hash( string( "init_key" ) ) );
@@ -364,6 +432,67 @@ BOOST_AUTO_TEST_CASE( fork_blocks )
    }
 }
 
+BOOST_AUTO_TEST_CASE( out_of_order_blocks )
+{
+   try {
+      fc::temp_directory data_dir1( graphene::utilities::temp_directory_path() );
+      fc::temp_directory data_dir2( graphene::utilities::temp_directory_path() );
+
+      genesis_state_type genesis;
+      genesis.init_supply = INITIAL_TEST_SUPPLY;
+
+      database db1;
+      db1.open( data_dir1.path(), genesis, "TEST" );
+      init_witness_keys( db1 );
+      database db2;
+      db2.open( data_dir2.path(), genesis, "TEST" );
+      init_witness_keys( db2 );
+
+      vector< signed_block > blocks;
+      for( uint32_t i = 1; i <= 10; ++i )
+         blocks.push_back( db1.generate_block( db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key(), database::skip_nothing ) );
+      const auto block = [&]( uint32_t num ) -> const signed_block& { return blocks[num - 1]; };
+
+      for( uint32_t i = 1; i <= 3; ++i )
+         PUSH_BLOCK( db2, block(i) );
+
+      BOOST_TEST_MESSAGE( "Blocks that don't link yet are kept" );
+      BTCM_REQUIRE_THROW( PUSH_BLOCK( db2, block(5) ), block_buffered_exception );
+      BTCM_REQUIRE_THROW( PUSH_BLOCK( db2, block(7) ), block_buffered_exception );
+      BTCM_REQUIRE_THROW( PUSH_BLOCK( db2, block(6) ), block_buffered_exception );
+      BOOST_CHECK_EQUAL( db2.head_block_num(), 3u );
+      BOOST_CHECK( db2.is_known_block( block(5).id() ) );
+      BOOST_CHECK( db2.is_known_block( block(7).id() ) );
+
+      BOOST_TEST_MESSAGE( "The missing block links them" );
+      BOOST_CHECK( !PUSH_BLOCK( db2, block(4) ) );
+      BOOST_CHECK_EQUAL( db2.head_block_num(), 7u );
+      BOOST_CHECK_EQUAL( db2.head_block_id().str(), block(7).id().str() );
+      for( uint32_t i = 4; i <= 7; ++i )
+         BOOST_CHECK_EQUAL( db2.fetch_block_by_number(i)->id().str(), block(i).id().str() );
+
+      BOOST_TEST_MESSAGE( "A kept block that turns out to be invalid is dropped" );
+      signed_block bad_block = block(10);
+      bad_block.transactions.emplace_back( signed_transaction() );
+      bad_block.transactions.back().operations.emplace_back( transfer_operation() );
+      bad_block.sign( init_account_priv_key() );
+      BTCM_REQUIRE_THROW( PUSH_BLOCK( db2, bad_block ), block_buffered_exception );
+      BTCM_REQUIRE_THROW( PUSH_BLOCK( db2, block(9) ), block_buffered_exception );
+      BOOST_CHECK( !PUSH_BLOCK( db2, block(8) ) );
+      BOOST_CHECK_EQUAL( db2.head_block_id().str(), block(9).id().str() );
+      BOOST_CHECK( !db2.is_known_block( bad_block.id() ) );
+
+      PUSH_BLOCK( db2, block(10) );
+      BOOST_CHECK_EQUAL( db2.head_block_id().str(), db1.head_block_id().str() );
+
+      BOOST_TEST_MESSAGE( "Blocks too far ahead are not kept" );
+      signed_block far_block = block(10);
+      far_block.previous._hash[0] = fc::endian_reverse_u32( db2.head_block_num() + fork_database::MAX_BLOCK_REORDERING );
+      BTCM_REQUIRE_THROW( PUSH_BLOCK( db2, far_block ), unlinkable_block_exception );
+      BOOST_CHECK( !db2.is_known_block( far_block.id() ) );
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_CASE( switch_forks_undo_create )
 {
    try {
@@ -686,6 +815,57 @@ BOOST_FIXTURE_TEST_CASE( pop_block_twice, clean_database_fixture )
    }
 }
 
+/**
+ * Check that a transaction stays known until it expires, that its body is found while it is pending
+ * and once it is in a block, through the number of that block, and that popping the block that expired
+ * it makes it known again
+ */
+BOOST_FIXTURE_TEST_CASE( expired_transactions, clean_database_fixture )
+{ try {
+   const auto& blocks = db.get_index_type< primary_index< transaction_index > >().get_secondary_index< transaction_block_index >();
+   generate_block();
+
+   signed_transaction tx;
+   transfer_operation op;
+   op.from = BTCM_INIT_MINER_NAME;
+   op.to = BTCM_INIT_MINER_NAME;
+   op.amount = asset( 1, BTCM_SYMBOL );
+   tx.operations.push_back( op );
+   tx.set_expiration( db.head_block_time() + 5 * BTCM_BLOCK_INTERVAL );
+   tx.sign( init_account_priv_key, db.get_chain_id() );
+   db.push_transaction( tx, 0 );
+   const transaction_id_type id = tx.id();
+
+   BOOST_CHECK( db.is_known_transaction( id ) );
+   BOOST_CHECK( db.get_recent_transaction( id ).id() == id );
+   BOOST_CHECK_EQUAL( blocks.block_num( id ), 0u );
+
+   generate_block();
+   const uint32_t block_num = db.head_block_num();
+   BOOST_CHECK( db.is_known_transaction( id ) );
+   BOOST_CHECK( db.get_recent_transaction( id ).id() == id );
+   BOOST_CHECK_EQUAL( blocks.block_num( id ), block_num );
+
+   while( db.is_known_transaction( id ) )
+   {
+      BOOST_REQUIRE( db.head_block_time() <= tx.expiration );
+      BOOST_CHECK_EQUAL( blocks.block_num( id ), block_num );
+      generate_block();
+   }
+   BOOST_CHECK( db.head_block_time() > tx.expiration );
+   BOOST_CHECK_EQUAL( blocks.block_num( id ), 0u );
+   BTCM_CHECK_THROW( db.get_recent_transaction( id ), fc::exception );
+
+   // the transaction_object restored by the undo database has no block number, the block is searched for
+   db.pop_block();
+   BOOST_CHECK( db.is_known_transaction( id ) );
+   BOOST_CHECK_EQUAL( blocks.block_num( id ), 0u );
+   BOOST_CHECK( db.get_recent_transaction( id ).id() == id );
+
+   generate_block();
+   BOOST_CHECK( !db.is_known_transaction( id ) );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_FIXTURE_TEST_CASE( rsf_missed_blocks, clean_database_fixture )
 {
    try
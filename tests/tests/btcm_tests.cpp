@@ -1808,6 +1808,20 @@ BOOST_AUTO_TEST_CASE( friends_test )
    BOOST_CHECK_EQUAL(  9100 + (200 + 100 + 80) * BTCM_1ST_LEVEL_SCORING_PERCENTAGE + 300 * BTCM_2ST_LEVEL_SCORING_PERCENTAGE, dora.score );
    BOOST_CHECK_EQUAL(  8000 + (300 + 91) * BTCM_1ST_LEVEL_SCORING_PERCENTAGE + (200 + 100) * BTCM_2ST_LEVEL_SCORING_PERCENTAGE, eve.score );
 
+   const auto& path_idx = db.get_index_type< friend_path_index >().indices().get< by_account_second >();
+   const auto& friend_paths = [&]( account_id_type account, account_id_type second ) -> uint32_t
+   {
+      auto itr = path_idx.find( boost::make_tuple( account, second ) );
+      return itr == path_idx.end() ? 0 : itr->paths;
+   };
+
+   BOOST_CHECK_EQUAL( 2, friend_paths( alice_id, dora_id ) );
+   BOOST_CHECK_EQUAL( 2, friend_paths( dora_id, alice_id ) );
+   BOOST_CHECK_EQUAL( 1, friend_paths( charlene_id, brenda_id ) );
+   BOOST_CHECK_EQUAL( 2, friend_paths( brenda_id, eve_id ) );
+   BOOST_CHECK_EQUAL( 0, friend_paths( alice_id, charlene_id ) );
+   validate_database();
+
    // --------- Lose friends ------------
    {
       unfriend_operation ufo;
@@ -1871,6 +1885,13 @@ BOOST_AUTO_TEST_CASE( friends_test )
    BOOST_CHECK_EQUAL(  9100 + (100 + 80) * BTCM_1ST_LEVEL_SCORING_PERCENTAGE + 300 * BTCM_2ST_LEVEL_SCORING_PERCENTAGE, dora.score );
    BOOST_CHECK_EQUAL(  8000 + (300 + 91) * BTCM_1ST_LEVEL_SCORING_PERCENTAGE + (200 + 100) * BTCM_2ST_LEVEL_SCORING_PERCENTAGE, eve.score );
 
+   BOOST_CHECK_EQUAL( 1, friend_paths( alice_id, dora_id ) );
+   BOOST_CHECK_EQUAL( 1, friend_paths( dora_id, alice_id ) );
+   BOOST_CHECK_EQUAL( 0, friend_paths( charlene_id, brenda_id ) );
+   BOOST_CHECK_EQUAL( 0, friend_paths( brenda_id, charlene_id ) );
+   BOOST_CHECK_EQUAL( 1, friend_paths( brenda_id, eve_id ) );
+   validate_database();
+
    {
       withdraw_vesting_operation op;
       op.account = "alice";
@@ -1896,6 +1917,161 @@ BOOST_AUTO_TEST_CASE( friends_test )
    validate_database();
 } FC_LOG_AND_RETHROW() }
 
+/**
+ * Replays a pseudo random sequence of friendships, unfriendings and vesting changes, and checks that second levels
+ * and scores match those of the friendship and unfriend evaluators from before second levels were maintained
+ * incrementally, including the rounding that recursive_recalculate_score() leaves behind
+ */
+BOOST_AUTO_TEST_CASE( friends_score_replay_test )
+{ try {
+   initialize_clean( BTCM_NUM_HARDFORKS );
+
+   ACTORS( (alice)(brenda)(charlene)(dora)(eve)(fred)(gina)(hank) );
+   const vector< string > names{ "alice", "brenda", "charlene", "dora", "eve", "fred", "gina", "hank" };
+   for( const auto& name : names )
+      fund( name, 100000000 );
+
+   // the reference: the second levels and scores as the old evaluators maintained them
+   struct reference_account
+   {
+      set< string > friends;
+      set< string > second_level;
+      uint64_t      score = 0;
+   };
+   map< string, reference_account > ref;
+   for( const auto& name : names )
+      ref[ name ].score = db.get_account( name ).score;
+
+   const auto& isqrt_of = [&]( const string& name ) -> uint64_t
+   {
+      return btcm::chain::detail::isqrt( db.get_account( name ).get_scoring_vesting() );
+   };
+   const auto& recalculate = [&]( const string& name )
+   {
+      auto& r = ref[ name ];
+      uint64_t score = isqrt_of( name );
+      for( const auto& f : r.friends )
+         score += isqrt_of( f ) * BTCM_1ST_LEVEL_SCORING_PERCENTAGE / 100;
+      for( const auto& f : r.second_level )
+         score += isqrt_of( f ) * BTCM_2ST_LEVEL_SCORING_PERCENTAGE / 100;
+      r.score = score;
+   };
+   const auto& befriend = [&]( const string& a1, const string& a2 )
+   {
+      for( const auto& a3 : ref[ a2 ].friends )
+      {
+         ref[ a3 ].second_level.insert( a1 );
+         recalculate( a3 );
+      }
+      for( const auto& a3 : ref[ a1 ].friends )
+      {
+         ref[ a3 ].second_level.insert( a2 );
+         recalculate( a3 );
+      }
+      ref[ a1 ].friends.insert( a2 );
+      ref[ a1 ].second_level.insert( ref[ a2 ].friends.begin(), ref[ a2 ].friends.end() );
+      ref[ a1 ].second_level.erase( a1 );
+      recalculate( a1 );
+      ref[ a2 ].friends.insert( a1 );
+      ref[ a2 ].second_level.insert( ref[ a1 ].friends.begin(), ref[ a1 ].friends.end() );
+      ref[ a2 ].second_level.erase( a2 );
+      recalculate( a2 );
+   };
+   const auto& rebuild_second_level = [&]( const string& name )
+   {
+      set< string > second_level;
+      for( const auto& f : ref[ name ].friends )
+         second_level.insert( ref[ f ].friends.begin(), ref[ f ].friends.end() );
+      second_level.erase( name );
+      ref[ name ].second_level = second_level;
+   };
+   const auto& unfriend = [&]( const string& a1, const string& a2 )
+   {
+      ref[ a1 ].friends.erase( a2 );
+      ref[ a2 ].friends.erase( a1 );
+      rebuild_second_level( a1 );
+      rebuild_second_level( a2 );
+      recalculate( a1 );
+      recalculate( a2 );
+      for( const auto& a : { a1, a2 } )
+         for( const auto& f : ref[ a ].friends )
+         {
+            rebuild_second_level( f );
+            recalculate( f );
+         }
+   };
+   const auto& vested = [&]( const string& name, share_type old_vesting )
+   {
+      int64_t delta = int64_t( isqrt_of( name ) ) - btcm::chain::detail::isqrt( old_vesting.value );
+      ref[ name ].score += delta;
+      for( const auto& f : ref[ name ].friends )
+         ref[ f ].score += delta * BTCM_1ST_LEVEL_SCORING_PERCENTAGE / 100;
+      for( const auto& f : ref[ name ].second_level )
+         ref[ f ].score += delta * BTCM_2ST_LEVEL_SCORING_PERCENTAGE / 100;
+   };
+
+   signed_transaction tx;
+   const auto& push = [&]( const operation& op, uint32_t step )
+   {
+      tx.operations.clear();
+      tx.operations.push_back( op );
+      // vary the expiration so that repeated operations are not duplicate transactions
+      tx.set_expiration( db.head_block_time() + BTCM_MAX_TIME_UNTIL_EXPIRATION - step );
+      db.push_transaction( tx, database::skip_transaction_signatures );
+   };
+
+   uint64_t seed = 42;
+   const auto& next = [&]( uint32_t n ) -> uint32_t
+   {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      return ( seed >> 33 ) % n;
+   };
+
+   for( uint32_t step = 0; step < 300; ++step )
+   {
+      const string& a = names[ next( names.size() ) ];
+      const string& b = names[ next( names.size() ) ];
+      const uint32_t action = next( 3 );
+      if( action == 0 )
+      {
+         const share_type old_vesting = db.get_account( a ).vesting_shares.amount;
+         vest( a, 1000 + step * 7919 % 100000 );
+         vested( a, old_vesting );
+      }
+      else if( a != b && ref[ a ].friends.count( b ) == 0 )
+      {
+         friendship_operation fop;
+         fop.who = b;
+         fop.whom = a;
+         push( fop, step );
+         fop.who = a;
+         fop.whom = b;
+         push( fop, step );
+         befriend( a, b );
+      }
+      else if( a != b )
+      {
+         unfriend_operation ufo;
+         ufo.who = a;
+         ufo.whom = b;
+         push( ufo, step );
+         unfriend( a, b );
+      }
+
+      for( const auto& name : names )
+      {
+         const auto& acct = db.get_account( name );
+         set< string > second_level;
+         for( const auto& id : acct.second_level )
+            second_level.insert( string( id( db ).name ) );
+         BOOST_REQUIRE( second_level == ref[ name ].second_level );
+         BOOST_REQUIRE_EQUAL( acct.score, ref[ name ].score );
+      }
+   }
+
+   validate_database();
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( disable_test )
 { try {
    initialize_clean( BTCM_NUM_HARDFORKS );
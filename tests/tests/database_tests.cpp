@@ -25,8 +25,13 @@
 #include <boost/test/unit_test.hpp>
 
 #include <btcm/chain/database.hpp>
+#include <btcm/chain/db_with.hpp>
 #include <btcm/chain/content_object.hpp>
+#include <btcm/chain/content_vote_archive.hpp>
 #include <btcm/chain/streaming_platform_objects.hpp>
+#include <btcm/chain/transaction_object.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
 
 #include <fc/crypto/digest.hpp>
 
@@ -107,4 +112,248 @@ BOOST_AUTO_TEST_CASE( merge_test )
    }
 }
 
+/**
+ * Check that the dense lookup table follows creation, removal, undo and failed modification
+ */
+BOOST_AUTO_TEST_CASE( dense_lookup_test )
+{ try {
+   database db;
+   const auto& idx = db.get_index_type< primary_index< streaming_platform_index > >();
+   BOOST_REQUIRE( idx.has_dense_lookup() );
+
+   const auto& sp1 = db.create<streaming_platform_object>( []( streaming_platform_object& obj ){ obj.owner = "sp1"; } );
+   const auto& sp2 = db.create<streaming_platform_object>( []( streaming_platform_object& obj ){ obj.owner = "sp2"; } );
+   const streaming_platform_id_type id1 = sp1.id;
+   const streaming_platform_id_type id2 = sp2.id;
+   BOOST_CHECK( db.find( id1 ) == &sp1 );
+   BOOST_CHECK( &db.get( id2 ) == &sp2 );
+   BOOST_CHECK( db.find( streaming_platform_id_type( id2.instance.value + 1 ) ) == nullptr );
+   BOOST_CHECK_THROW( db.get( streaming_platform_id_type( id2.instance.value + 1 ) ), fc::exception );
+
+   {
+      auto session = db._undo_db.start_undo_session();
+      db.remove( sp1 );
+      BOOST_CHECK( db.find( id1 ) == nullptr );
+      const auto& sp3 = db.create<streaming_platform_object>( []( streaming_platform_object& obj ){ obj.owner = "sp3"; } );
+      const streaming_platform_id_type id3 = sp3.id;
+      BOOST_CHECK( db.find( id3 ) == &sp3 );
+      session.undo();
+      BOOST_CHECK( db.find( id3 ) == nullptr );
+   }
+   BOOST_REQUIRE( db.find( id1 ) != nullptr );
+   BOOST_CHECK( db.find( id1 ) == &db.get_streaming_platform( "sp1" ) );
+   BOOST_CHECK( db.find( id1 ) == db.find_object( id1 ) );
+
+   // violating the uniqueness of the owner erases the object from the derived index
+   BOOST_CHECK_THROW( db.modify( sp2, []( streaming_platform_object& obj ){ obj.owner = "sp1"; } ), fc::exception );
+   BOOST_CHECK( db.find_object( id2 ) == nullptr );
+   BOOST_CHECK( db.find( id2 ) == nullptr );
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Check that looking up a witness or streaming platform by a name longer than account names can be fails instead
+ * of matching the account whose name is its first BTCM_MAX_ACCOUNT_NAME_LENGTH characters
+ */
+BOOST_AUTO_TEST_CASE( long_name_lookup_test )
+{ try {
+   database db;
+   const string name = "abcdefghijklmnop";
+   const string long_name = name + "q";
+   BOOST_REQUIRE_EQUAL( name.size(), BTCM_MAX_ACCOUNT_NAME_LENGTH );
+
+   db.create<witness_object>( [&]( witness_object& w ){ w.owner = name; } );
+   db.create<streaming_platform_object>( [&]( streaming_platform_object& sp ){ sp.owner = name; } );
+
+   BOOST_CHECK( db.find_witness( name ) != nullptr );
+   BOOST_CHECK_THROW( db.find_witness( long_name ), fc::exception );
+   BOOST_CHECK_THROW( db.get_witness( long_name ), fc::exception );
+   BOOST_CHECK( db.find_streaming_platform( name ) != nullptr );
+   BOOST_CHECK_THROW( db.find_streaming_platform( long_name ), fc::exception );
+   BOOST_CHECK_THROW( db.get_streaming_platform( long_name ), fc::exception );
+   BOOST_CHECK( db.is_streaming_platform( name ) );
+   BOOST_CHECK_THROW( db.is_streaming_platform( long_name ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Check that the segments a merge replaces are kept until the object database has been saved past the merged
+ * segment, and removed then
+ */
+BOOST_AUTO_TEST_CASE( content_vote_archive_merge_test )
+{ try {
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   const fc::path dir = data_dir.path() / "content_vote_archive";
+   const auto& segment_files = [&dir]()
+   {
+      size_t count = 0;
+      for( fc::directory_iterator itr( dir ), end; itr != end; ++itr )
+         if( fc::path( *itr ).extension() == ".seg" )
+            ++count;
+      return count;
+   };
+
+   const uint32_t max_segments = content_vote_archive::max_segments;
+   content_vote_archive archive;
+   archive.open( dir, 0 );
+   archived_content_vote vote;
+   vote.content = content_id_type( 1 );
+   vote.voter = account_id_type( 2 );
+   for( uint32_t block_num = 1; block_num <= max_segments; ++block_num )
+   {
+      vote.weight = block_num;
+      archive.add( { vote }, block_num * 10 );
+   }
+   BOOST_CHECK_EQUAL( archive.size(), max_segments );
+   BOOST_CHECK_EQUAL( segment_files(), max_segments );
+
+   // the merge replaces all segments but keeps their files
+   vote.weight = 100;
+   archive.add( { vote }, 1000 );
+   BOOST_CHECK_EQUAL( archive.size(), 1u );
+   BOOST_CHECK_EQUAL( segment_files(), max_segments + 2 );
+
+   archive.remove_superseded( 999 );
+   BOOST_CHECK_EQUAL( segment_files(), max_segments + 2 );
+
+   archive.remove_superseded( 1000 );
+   BOOST_CHECK_EQUAL( segment_files(), 1u );
+   BOOST_REQUIRE( archive.find( vote.content, vote.voter ).valid() );
+   BOOST_CHECK_EQUAL( archive.find( vote.content, vote.voter )->weight, 100 );
+
+   archive.open( dir, 1000 );
+   BOOST_CHECK_EQUAL( archive.size(), 1u );
+   BOOST_CHECK_EQUAL( archive.find( vote.content, vote.voter )->weight, 100 );
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Check that the transaction id filter never misses a transaction_object, including ones restored by the
+ * undo database, and that rebuilding it drops the ids of removed ones
+ */
+BOOST_AUTO_TEST_CASE( transaction_id_filter_test )
+{ try {
+   database db;
+   const auto& idx = db.get_index_type< primary_index< transaction_index > >();
+   const auto& filter = idx.get_secondary_index< transaction_id_filter >();
+
+   vector< transaction_id_type > ids;
+   for( int i = 0; i < 100; ++i )
+      ids.push_back( transaction_id_type::hash( std::to_string( i ) ) );
+
+   for( int i = 0; i < 50; ++i )
+      db.create< transaction_object >( [&]( transaction_object& t ){ t.trx_id = ids[i]; } );
+   for( int i = 0; i < 50; ++i )
+      BOOST_CHECK( filter.may_contain( ids[i] ) && db.is_known_transaction( ids[i] ) );
+   int false_positives = 0;
+   for( int i = 50; i < 100; ++i )
+   {
+      BOOST_CHECK( !db.is_known_transaction( ids[i] ) );
+      false_positives += filter.may_contain( ids[i] );
+   }
+   BOOST_CHECK_LT( false_positives, 5 );
+
+   {
+      auto session = db._undo_db.start_undo_session();
+      for( int i = 0; i < 10; ++i )
+         db.remove( *idx.indices().get< by_trx_id >().find( ids[i] ) );
+      BOOST_CHECK( !db.is_known_transaction( ids[0] ) );
+      session.undo();
+   }
+   for( int i = 0; i < 50; ++i )
+      BOOST_CHECK( db.is_known_transaction( ids[i] ) );
+
+   for( int i = 0; i < 25; ++i )
+      db.remove( *idx.indices().get< by_trx_id >().find( ids[i] ) );
+   const_cast< transaction_id_filter& >( filter ).rebuild( idx );
+   false_positives = 0;
+   for( int i = 0; i < 25; ++i )
+      false_positives += filter.may_contain( ids[i] );
+   BOOST_CHECK_LT( false_positives, 5 );
+   for( int i = 25; i < 50; ++i )
+      BOOST_CHECK( db.is_known_transaction( ids[i] ) );
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Check that buffered modifications of the global properties are visible immediately and are
+ * rolled back correctly by nested undo sessions
+ */
+BOOST_FIXTURE_TEST_CASE( buffered_global_properties_test, clean_database_fixture )
+{ try {
+   const auto& dgpo = db.get_dynamic_global_properties();
+   const asset initial = dgpo.total_reward_fund_btcm;
+
+   auto outer = db._undo_db.start_undo_session();
+   {
+      btcm::chain::detail::global_property_buffer_scope buffered( db );
+      db.modify( dgpo, []( dynamic_global_property_object& p ) {
+         p.total_reward_fund_btcm += asset( 1, BTCM_SYMBOL );
+      });
+      BOOST_CHECK( db.get_dynamic_global_properties().total_reward_fund_btcm == initial + asset( 1, BTCM_SYMBOL ) );
+      {
+         auto inner = db._undo_db.start_undo_session();
+         db.modify( dgpo, []( dynamic_global_property_object& p ) {
+            p.total_reward_fund_btcm += asset( 10, BTCM_SYMBOL );
+         });
+         BOOST_CHECK( dgpo.total_reward_fund_btcm == initial + asset( 11, BTCM_SYMBOL ) );
+         inner.undo();
+      }
+      BOOST_CHECK( dgpo.total_reward_fund_btcm == initial + asset( 1, BTCM_SYMBOL ) );
+
+      // modifying a copy must still change the stored object
+      const dynamic_global_property_object copy = dgpo;
+      db.modify( copy, []( dynamic_global_property_object& p ) {
+         p.total_reward_fund_btcm += asset( 100, BTCM_SYMBOL );
+      });
+      buffered.flush();
+   }
+   BOOST_CHECK( dgpo.total_reward_fund_btcm == initial + asset( 101, BTCM_SYMBOL ) );
+
+   outer.undo();
+   BOOST_CHECK( dgpo.total_reward_fund_btcm == initial );
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Check that the block timings are reported once per applied block and account for the evaluated
+ * operations of the block only
+ */
+BOOST_FIXTURE_TEST_CASE( block_timings_test, clean_database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( "alice", 10000 );
+   generate_block();
+
+   vector< block_phase_timings > reported;
+   boost::signals2::scoped_connection conn = db.applied_block_timings.connect(
+      [&reported]( const block_phase_timings& t ){ reported.push_back( t ); } );
+
+   const int transfer_tag = operation::tag< transfer_operation >::value;
+   transfer_operation op;
+   op.from = "alice";
+   op.to = "bob";
+   op.amount = asset( 100, BTCM_SYMBOL );
+   trx.operations.push_back( op );
+   op.amount = asset( 200, BTCM_SYMBOL );
+   trx.operations.push_back( op );
+   trx.set_expiration( db.head_block_time() + BTCM_MAX_TIME_UNTIL_EXPIRATION );
+   db.push_transaction( trx, database::skip_transaction_signatures );
+   trx.clear();
+
+   generate_block();
+   BOOST_REQUIRE_EQUAL( 1u, reported.size() );
+   BOOST_CHECK_EQUAL( db.head_block_num(), reported[0].block_num );
+   BOOST_REQUIRE( reported[0].operations.size() > size_t( transfer_tag ) );
+   BOOST_CHECK_EQUAL( 2u, reported[0].operations[ transfer_tag ].count );
+   BOOST_CHECK( reported[0].operations[ transfer_tag ].max <= reported[0].operations[ transfer_tag ].elapsed );
+   BOOST_CHECK( reported[0].elapsed[ transactions_phase ] >= reported[0].operations[ transfer_tag ].elapsed );
+
+   fc::microseconds sum;
+   for( const auto& e : reported[0].elapsed )
+      sum += e;
+   BOOST_CHECK( sum == reported[0].total() );
+
+   generate_block();
+   BOOST_REQUIRE_EQUAL( 2u, reported.size() );
+   BOOST_CHECK_EQUAL( reported[0].block_num + 1, reported[1].block_num );
+   BOOST_CHECK_EQUAL( 0u, reported[1].operations[ transfer_tag ].count );
+   BOOST_CHECK( db.get_last_block_timings().block_num == reported[1].block_num );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -5,6 +5,7 @@
 #include <btcm/chain/hardfork.hpp>
 
 #include <btcm/chain/base_objects.hpp>
+#include <btcm/chain/history_object.hpp>
 
 #include <fc/crypto/digest.hpp>
 
@@ -2630,6 +2631,101 @@ BOOST_AUTO_TEST_CASE( limit_order_create_apply )
    FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( limit_order_sweep_matches_sequential )
+{
+   try
+   {
+      BOOST_TEST_MESSAGE( "Testing: matching an order against a sweep of resting orders is identical to matching one at a time" );
+
+      set_price_feed( price( ASSET( "1.000 2.28.0" ), ASSET( "1.000 2.28.2" ) ) );
+
+      ACTORS( (alice)(bob)(sam)(dave)(eve) )
+      fund( "alice", 1000000000 );
+      fund( "bob", 1000000000 );
+      fund( "sam", 1000000000 );
+
+      auto create_order = [&]( const string& seller, uint32_t orderid, const asset& sell, const asset& receive ) -> const limit_order_object&
+      {
+         return db.create< limit_order_object >( [&]( limit_order_object& o )
+         {
+            o.created = db.head_block_time();
+            o.expiration = db.head_block_time() + fc::days( 1 );
+            o.seller = seller;
+            o.orderid = orderid;
+            o.for_sale = sell.amount;
+            o.sell_price = sell / receive;
+         } );
+      };
+
+      // resting orders buying BTCM, several at the same price and one buyer with several orders
+      create_order( "bob",  1, ASSET( "10.0000 2.28.2" ), ASSET( "10.000 2.28.0" ) );
+      create_order( "sam",  1, ASSET( "5.0000 2.28.2" ),  ASSET( "5.000 2.28.0" ) );
+      create_order( "bob",  2, ASSET( "10.0000 2.28.2" ), ASSET( "11.000 2.28.0" ) );
+      create_order( "dave", 1, ASSET( "3.0000 2.28.2" ),  ASSET( "4.000 2.28.0" ) );
+      create_order( "eve",  1, ASSET( "0.0007 2.28.2" ),  ASSET( "0.001 2.28.0" ) );
+      create_order( "bob",  3, ASSET( "2.0000 2.28.2" ),  ASSET( "3.000 2.28.0" ) );
+      create_order( "sam",  2, ASSET( "0.0001 2.28.2" ),  ASSET( "1.000 2.28.0" ) );
+
+      // the old matching loop, see database::match()
+      auto match_sequentially = [&]( const limit_order_object& new_order )
+      {
+         const auto& limit_price_idx = db.get_index_type< limit_order_index >().indices().get< by_price >();
+         auto max_price = ~new_order.sell_price;
+         auto limit_itr = limit_price_idx.lower_bound( max_price.max() );
+         auto limit_end = limit_price_idx.upper_bound( max_price );
+         bool finished = false;
+         while( !finished && limit_itr != limit_end )
+         {
+            auto old_limit_itr = limit_itr;
+            ++limit_itr;
+            finished = ( db.match( new_order, *old_limit_itr, old_limit_itr->sell_price ) & 0x1 );
+         }
+      };
+
+      auto sweep = [&]( const asset& sell, const asset& receive, bool batched ) -> string
+      {
+         auto session = db._undo_db.start_undo_session();
+         vector< operation_object > ops;
+         boost::signals2::scoped_connection c = db.pre_apply_operation.connect( [&ops]( const operation_object& o ) { ops.push_back( o ); } );
+
+         const auto& new_order = create_order( "alice", 100, sell, receive );
+         if( batched )
+            db.apply_order( new_order );
+         else
+            match_sequentially( new_order );
+
+         fc::mutable_variant_object state;
+         vector< limit_order_object > orders;
+         for( const auto& o : db.get_index_type< limit_order_index >().indices() )
+            orders.push_back( o );
+         vector< account_object > accounts;
+         for( const char* name : { "alice", "bob", "sam", "dave", "eve" } )
+            accounts.push_back( db.get_account( name ) );
+         state( "orders", orders, 10 )
+              ( "accounts", accounts, 10 )
+              ( "props", db.get_dynamic_global_properties(), 10 )
+              ( "ops", ops, 10 );
+         return fc::json::to_string( state );
+      };
+
+      BOOST_TEST_MESSAGE( "--- Sweep that fills the new order with a resting order left partially filled" );
+      BOOST_CHECK_EQUAL( sweep( ASSET( "25.000 2.28.0" ), ASSET( "20.0000 2.28.2" ), false ),
+                         sweep( ASSET( "25.000 2.28.0" ), ASSET( "20.0000 2.28.2" ), true ) );
+
+      BOOST_TEST_MESSAGE( "--- Sweep of every resting order that leaves the new order on the book" );
+      BOOST_CHECK_EQUAL( sweep( ASSET( "100.000 2.28.0" ), ASSET( "1.0000 2.28.2" ), false ),
+                         sweep( ASSET( "100.000 2.28.0" ), ASSET( "1.0000 2.28.2" ), true ) );
+
+      BOOST_TEST_MESSAGE( "--- Order that does not cross" );
+      BOOST_CHECK_EQUAL( sweep( ASSET( "1.000 2.28.0" ), ASSET( "2.0000 2.28.2" ), false ),
+                         sweep( ASSET( "1.000 2.28.0" ), ASSET( "2.0000 2.28.2" ), true ) );
+
+      BOOST_CHECK_NE( sweep( ASSET( "25.000 2.28.0" ), ASSET( "20.0000 2.28.2" ), true ),
+                      sweep( ASSET( "1.000 2.28.0" ), ASSET( "2.0000 2.28.2" ), true ) );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_CASE( limit_order_create2_authorities )
 {
    try
@@ -137,6 +137,68 @@ BOOST_AUTO_TEST_CASE( vesting_withdrawals )
    FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( vesting_withdrawal_schedule )
+{
+   try
+   {
+      ACTORS( (alice)(bob) )
+      fund( "alice", 100000 );
+      vest( "alice", 100000 );
+      fund( "bob", 100000 );
+      vest( "bob", 100000 );
+
+      const auto& schedule = db.get_index_type< vesting_withdrawal_index >().indices().get< by_account >();
+      BOOST_REQUIRE( schedule.empty() );
+
+      BOOST_TEST_MESSAGE( "Powering down two accounts in the same block" );
+
+      signed_transaction tx;
+      withdraw_vesting_operation op;
+      op.account = "alice";
+      op.vesting_shares = asset( db.get_account( "alice" ).vesting_shares.amount / 2, VESTS_SYMBOL );
+      tx.operations.push_back( op );
+      op.account = "bob";
+      op.vesting_shares = asset( db.get_account( "bob" ).vesting_shares.amount / 2, VESTS_SYMBOL );
+      tx.operations.push_back( op );
+      tx.set_expiration( db.head_block_time() + BTCM_MAX_TIME_UNTIL_EXPIRATION );
+      tx.sign( alice_private_key, db.get_chain_id() );
+      tx.sign( bob_private_key, db.get_chain_id() );
+      db.push_transaction( tx, 0 );
+
+      const auto next_withdrawal = db.head_block_time() + BTCM_VESTING_WITHDRAW_INTERVAL_SECONDS;
+      BOOST_REQUIRE_EQUAL( schedule.size(), 2 );
+      BOOST_REQUIRE( schedule.find( alice_id )->next_vesting_withdrawal == next_withdrawal );
+      BOOST_REQUIRE( schedule.find( bob_id )->next_vesting_withdrawal == next_withdrawal );
+
+      BOOST_TEST_MESSAGE( "Paying out both in one batch" );
+
+      const auto alice_vesting = db.get_account( "alice" ).vesting_shares;
+      const auto bob_vesting = db.get_account( "bob" ).vesting_shares;
+      generate_blocks( next_withdrawal, true );
+
+      BOOST_REQUIRE( db.get_account( "alice" ).vesting_shares == alice_vesting - db.get_account( "alice" ).vesting_withdraw_rate );
+      BOOST_REQUIRE( db.get_account( "bob" ).vesting_shares == bob_vesting - db.get_account( "bob" ).vesting_withdraw_rate );
+      BOOST_REQUIRE( schedule.find( alice_id )->next_vesting_withdrawal == next_withdrawal + BTCM_VESTING_WITHDRAW_INTERVAL_SECONDS );
+      BOOST_REQUIRE( schedule.find( bob_id )->next_vesting_withdrawal == next_withdrawal + BTCM_VESTING_WITHDRAW_INTERVAL_SECONDS );
+      validate_database();
+
+      BOOST_TEST_MESSAGE( "Cancelling a power down removes it from the schedule" );
+
+      tx.operations.clear();
+      tx.signatures.clear();
+      op.account = "alice";
+      op.vesting_shares = asset( 0, VESTS_SYMBOL );
+      tx.operations.push_back( op );
+      tx.sign( alice_private_key, db.get_chain_id() );
+      db.push_transaction( tx, 0 );
+
+      BOOST_REQUIRE_EQUAL( schedule.size(), 1 );
+      BOOST_REQUIRE( schedule.find( alice_id ) == schedule.end() );
+      validate_database();
+   }
+   FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_CASE( vesting_withdraw_route )
 {
    try
@@ -0,0 +1,202 @@
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/net/sync_fetch_scheduler.hpp>
+
+#include <fc/crypto/ripemd160.hpp>
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+using namespace graphene::net;
+
+namespace {
+
+/**
+ * Syncs a chain of blocks from in-process peers with the given round trip times and bandwidths, requesting
+ * blocks the way node_impl::fetch_sync_items_loop() does, on a simulated clock.
+ */
+struct sync_simulation
+{
+   struct peer
+   {
+      fc::microseconds          round_trip;
+      double                    bytes_per_second;
+      std::map< uint32_t, fc::microseconds > extra_delay; ///< blocks the peer is slow to send
+      fc::time_point            busy_until;
+      uint32_t                  delivered = 0;
+   };
+
+   static const uint32_t block_size = 10000;
+
+   sync_simulation( uint32_t block_count, uint32_t max_window = GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING )
+      : scheduler( max_window ), blocks( block_count ), now( fc::time_point() + fc::seconds( 1000 ) ), start( now )
+   {
+      for( uint32_t i = 0; i < block_count; ++i )
+         ids.push_back( fc::ripemd160::hash( (const char*)&i, sizeof(i) ) );
+   }
+
+   sync_fetch_scheduler::peer_handle handle( size_t p )const { return &peers[p]; }
+
+   void request( size_t p, uint32_t block )
+   {
+      peer& from = peers[p];
+      scheduler.requested( handle( p ), ids[block], now );
+      const fc::time_point arrival = std::max( now + fc::microseconds( from.round_trip.count() / 2 ), from.busy_until )
+                                   + fc::microseconds( int64_t( block_size * 1000000.0 / from.bytes_per_second ) );
+      from.busy_until = arrival;
+      auto delay = from.extra_delay.find( block );
+      arrivals.emplace( arrival + fc::microseconds( from.round_trip.count() / 2 )
+                        + ( delay == from.extra_delay.end() ? fc::microseconds() : delay->second ),
+                        std::make_pair( p, block ) );
+      requested.insert( block );
+   }
+
+   void schedule()
+   {
+      for( size_t p = 0; p < peers.size(); ++p )
+         for( uint32_t slots = scheduler.free_slots( handle( p ) ); slots > 0 && next_block < blocks; --slots )
+            request( p, next_block++ );
+
+      std::set< uint32_t > needed;
+      for( uint32_t block = first_missing; block < blocks && needed.size() < GRAPHENE_NET_SYNC_STRAGGLER_LOOKAHEAD; ++block )
+         if( !received.count( block ) )
+            needed.insert( block );
+      for( const auto& straggler : scheduler.straggling_requests( now ) )
+      {
+         const uint32_t block = std::find( ids.begin(), ids.end(), straggler.first ) - ids.begin();
+         if( !needed.count( block ) )
+            continue;
+         std::vector< sync_fetch_scheduler::peer_handle > candidates;
+         for( size_t p = 0; p < peers.size(); ++p )
+            candidates.push_back( handle( p ) );
+         auto chosen = scheduler.pick_peer_for_straggler( straggler.first, candidates, now );
+         if( chosen )
+         {
+            request( (const peer*)chosen - &peers[0], block );
+            ++rerequests;
+         }
+      }
+   }
+
+   /// @return the time it took to receive all blocks
+   fc::microseconds run()
+   {
+      schedule();
+      while( first_missing < blocks )
+      {
+         BOOST_REQUIRE( !arrivals.empty() );
+         const fc::time_point next_arrival = arrivals.begin()->first;
+         const fc::time_point deadline = scheduler.next_deadline( now );
+         if( deadline < next_arrival )
+            now = deadline + fc::microseconds( 1 );
+         else
+         {
+            now = next_arrival;
+            const size_t p = arrivals.begin()->second.first;
+            const uint32_t block = arrivals.begin()->second.second;
+            arrivals.erase( arrivals.begin() );
+            scheduler.received( handle( p ), ids[block], block_size, now );
+            if( received.insert( block ).second )
+               ++peers[p].delivered;
+            while( received.count( first_missing ) )
+               ++first_missing;
+         }
+         schedule();
+      }
+      return now - start;
+   }
+
+   sync_fetch_scheduler                                        scheduler;
+   std::vector< peer >                                         peers;
+   std::vector< item_hash_t >                                  ids;
+   uint32_t                                                    blocks;
+   uint32_t                                                    next_block = 0;
+   uint32_t                                                    first_missing = 0;
+   uint32_t                                                    rerequests = 0;
+   std::set< uint32_t >                                        requested;
+   std::set< uint32_t >                                        received;
+   std::multimap< fc::time_point, std::pair< size_t, uint32_t > > arrivals;
+   fc::time_point                                              now;
+   fc::time_point                                              start;
+};
+
+sync_simulation::peer make_peer( int64_t round_trip_ms, double bytes_per_second )
+{
+   sync_simulation::peer p;
+   p.round_trip = fc::milliseconds( round_trip_ms );
+   p.bytes_per_second = bytes_per_second;
+   return p;
+}
+
+} // anonymous
+
+BOOST_AUTO_TEST_SUITE( p2p_sync_tests )
+
+BOOST_AUTO_TEST_CASE( sync_windows_follow_peer_speed )
+{
+   sync_simulation sim( 3000 );
+   sim.peers.push_back( make_peer( 20, 10000000 ) );
+   sim.peers.push_back( make_peer( 400, 200000 ) );
+   sim.run();
+
+   const auto& fast = *sim.scheduler.get_statistics( sim.handle( 0 ) );
+   const auto& slow = *sim.scheduler.get_statistics( sim.handle( 1 ) );
+   BOOST_CHECK_GT( slow.round_trip_time.count(), 10 * fast.round_trip_time.count() );
+   BOOST_CHECK_GT( fast.bytes_per_second, 10 * slow.bytes_per_second );
+   BOOST_CHECK_GT( sim.peers[0].delivered, 10 * sim.peers[1].delivered );
+   // the slow peer gets about as many blocks as it sends in a round trip and the pipeline time
+   BOOST_CHECK_LE( sim.scheduler.window( sim.handle( 1 ) ), 2 * ( 1.4 * 200000 / sync_simulation::block_size ) + 1 );
+   BOOST_CHECK_GT( sim.scheduler.window( sim.handle( 0 ) ), sim.scheduler.window( sim.handle( 1 ) ) );
+}
+
+BOOST_AUTO_TEST_CASE( sync_rerequests_stragglers )
+{
+   // the second peer holds back one block for a minute
+   sync_simulation sim( 2000 );
+   sim.peers.push_back( make_peer( 50, 2000000 ) );
+   sim.peers.push_back( make_peer( 50, 2000000 ) );
+   for( uint32_t block = 0; block < 2000; block += 97 )
+      sim.peers[1].extra_delay[block] = fc::seconds( 60 );
+
+   const fc::microseconds elapsed = sim.run();
+   BOOST_CHECK_LT( elapsed.count(), fc::seconds( 30 ).count() );
+   BOOST_CHECK_GT( sim.rerequests, 0u );
+   BOOST_CHECK_GT( sim.scheduler.get_statistics( sim.handle( 1 ) )->requests_straggled, 0u );
+   BOOST_CHECK_EQUAL( sim.scheduler.get_statistics( sim.handle( 0 ) )->requests_straggled, 0u );
+}
+
+BOOST_AUTO_TEST_CASE( sync_scheduler_bookkeeping )
+{
+   sync_fetch_scheduler scheduler( 4 );
+   int a, b;
+   const item_hash_t block = fc::ripemd160::hash( std::string( "block" ) );
+   const fc::time_point now = fc::time_point() + fc::seconds( 1000 );
+
+   BOOST_CHECK_EQUAL( scheduler.window( &a ), 4u );
+   scheduler.requested( &a, block, now );
+   BOOST_CHECK( scheduler.is_outstanding( &a, block ) );
+   BOOST_CHECK_EQUAL( scheduler.free_slots( &a ), 3u );
+   BOOST_CHECK( scheduler.straggling_requests( now ).empty() );
+   BOOST_REQUIRE_EQUAL( scheduler.straggling_requests( now + fc::seconds( 5 ) ).size(), 1u );
+
+   BOOST_CHECK( scheduler.pick_peer_for_straggler( block, { &a }, now ) == nullptr );
+   BOOST_CHECK( scheduler.pick_peer_for_straggler( block, { &a, &b }, now ) == &b );
+   scheduler.requested( &b, block, now + fc::seconds( 5 ) );
+   BOOST_CHECK_EQUAL( scheduler.get_statistics( &a )->requests_straggled, 1u );
+   BOOST_CHECK_EQUAL( scheduler.get_statistics( &a )->congestion_window, 2u );
+   // requested from a second peer, so it is not reported again
+   BOOST_CHECK( scheduler.straggling_requests( now + fc::seconds( 60 ) ).empty() );
+
+   scheduler.received( &b, block, 1000, now + fc::seconds( 6 ) );
+   BOOST_CHECK_EQUAL( scheduler.get_statistics( &b )->round_trip_time.count(), fc::seconds( 1 ).count() );
+   BOOST_CHECK( !scheduler.is_outstanding( &b, block ) );
+   BOOST_CHECK( scheduler.is_outstanding( &a, block ) );
+
+   scheduler.remove_peer( &a );
+   BOOST_CHECK( scheduler.get_statistics( &a ) == nullptr );
+   BOOST_CHECK_EQUAL( scheduler.outstanding( &a ), 0u );
+   BOOST_CHECK( scheduler.next_deadline( now ) == fc::time_point::maximum() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -305,4 +305,89 @@ BOOST_AUTO_TEST_CASE( hardfork_version_test )
    FC_LOG_AND_RETHROW();
 }
 
+BOOST_AUTO_TEST_CASE( serialization_cache_test )
+{
+   try
+   {
+      ACTORS( (alice)(bob) )
+      transfer_operation op;
+      op.from = "alice";
+      op.to = "bob";
+      op.amount = asset(100,BTCM_SYMBOL);
+
+      signed_block b;
+      b.witness = "alice";
+      trx.operations.push_back( op );
+      b.transactions.push_back( trx );
+
+      const auto& cached_trx = b.transactions[0];
+      auto trx_id = cached_trx.transaction::id();
+      auto block_id = b.signed_block_header::id();
+
+      {
+         scoped_serialization_cache< signed_block > cached_block( b );
+         BOOST_CHECK( cached_trx.id() == trx_id );
+         BOOST_CHECK( cached_trx.packed_size() == fc::raw::pack_size( cached_trx ) );
+         BOOST_CHECK( b.id() == block_id );
+         BOOST_CHECK( b.packed_size() == fc::raw::pack_size( b ) );
+
+         BOOST_TEST_MESSAGE( "Copies do not share the cache of the original" );
+         signed_transaction copy = cached_trx;
+         copy.operations.push_back( op );
+         BOOST_CHECK( copy.id() != trx_id );
+         BOOST_CHECK( copy.packed_size() > cached_trx.packed_size() );
+      }
+
+      BOOST_TEST_MESSAGE( "Closing the scope discards the cached values" );
+      b.transactions[0].operations.push_back( op );
+      b.witness = "bob";
+      BOOST_CHECK( b.transactions[0].id() != trx_id );
+      BOOST_CHECK( b.transactions[0].packed_size() == fc::raw::pack_size( b.transactions[0] ) );
+      BOOST_CHECK( b.id() != block_id );
+      BOOST_CHECK( b.packed_size() == fc::raw::pack_size( b ) );
+   }
+   FC_LOG_AND_RETHROW();
+}
+
+BOOST_AUTO_TEST_CASE( account_name_type_test )
+{
+   try
+   {
+      const std::vector< std::string > names = { "", "a", "ab", "abc", "alice", "alice.x", "b", "bob-1",
+                                                 "zzzzzzzzzzzzzzzz", "abcdefghijklmnop" };
+      for( const auto& n : names )
+      {
+         const account_name_type name( n );
+         BOOST_CHECK_EQUAL( std::string( name ), n );
+         BOOST_CHECK_EQUAL( name.size(), n.size() );
+         BOOST_CHECK( fc::raw::pack_to_vector( name ) == fc::raw::pack_to_vector( n ) );
+         BOOST_CHECK( fc::raw::unpack_from_vector< account_name_type >( fc::raw::pack_to_vector( n ) ) == name );
+         BOOST_CHECK_EQUAL( fc::json::to_string( name ), fc::json::to_string( n ) );
+
+         for( const auto& m : names )
+         {
+            BOOST_CHECK_EQUAL( name < account_name_type( m ), n < m );
+            BOOST_CHECK_EQUAL( name == account_name_type( m ), n == m );
+         }
+      }
+
+      BOOST_TEST_MESSAGE( "Unpacking a shorter name clears the previous one" );
+      account_name_type name( "abcdefgh" );
+      auto packed = fc::raw::pack_to_vector( std::string( "ab" ) );
+      fc::datastream< const char* > ds( packed.data(), packed.size() );
+      fc::raw::unpack( ds, name );
+      BOOST_CHECK( name == account_name_type( "ab" ) );
+
+      BOOST_TEST_MESSAGE( "Names that do not fit are rejected instead of truncated" );
+      const std::string long_name = "abcdefghijklmnopq";
+      BOOST_CHECK_THROW( (void)account_name_type( long_name ), fc::assert_exception );
+      BOOST_CHECK_THROW( (void)account_name_type( long_name.c_str() ), fc::assert_exception );
+      BOOST_CHECK_THROW( name = long_name, fc::assert_exception );
+      BOOST_CHECK( name == account_name_type( "ab" ) );
+      BOOST_CHECK_THROW( fc::raw::unpack_from_vector< account_name_type >( fc::raw::pack_to_vector( long_name ) ),
+                         fc::assert_exception );
+   }
+   FC_LOG_AND_RETHROW();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2018 Peertracks, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <btcm/wallet/report_batcher.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+
+using namespace btcm::chain;
+using btcm::wallet::streaming_report_batcher;
+
+namespace {
+
+struct report_batcher_fixture
+{
+   report_batcher_fixture()
+   {
+      for( int i = 0; i < 40; ++i )
+      {
+         streaming_platform_report_operation report;
+         report.streaming_platform = i % 3 ? "platform-a" : "platform-b";
+         report.consumer = "consumer" + std::to_string( i );
+         report.content = "ipfs://content/" + std::string( 40, 'x' ) + std::to_string( i );
+         report.play_time = 30 + i;
+         reports.push_back( report );
+      }
+
+      batcher.max_trx_size = 600;
+      batcher.trxs_per_call = 3;
+      batcher.signature_count = [this]( const streaming_platform_report_operation& first_report ) -> size_t
+      {
+         return signatures.at( first_report.streaming_platform );
+      };
+      batcher.start_round = [this]()
+      {
+         ++round;
+      };
+      // runs on the signing thread, the checks are made by the test cases
+      batcher.sign = [this]( signed_transaction trx, const std::string& platform ) -> signed_transaction
+      {
+         trx.set_reference_block( block_id_type() );
+         trx.set_expiration( fc::time_point_sec( round ) );
+         signature_type signature;
+         memset( signature.data, 0xff, sizeof( signature.data ) );
+         trx.signatures.assign( signatures.at( platform ), signature );
+
+         std::lock_guard< std::mutex > lock( sign_mutex );
+         for( const auto& op : trx.operations )
+            if( op.get< streaming_platform_report_operation >().streaming_platform != platform )
+               ++mixed_platforms;
+         max_signed_size = std::max( max_signed_size, fc::raw::pack_size( trx ) );
+         ++signed_count;
+         signed_cv.notify_all();
+         return trx;
+      };
+      batcher.broadcast = [this]( const std::vector< signed_transaction >& trxs )
+      {
+         BOOST_CHECK_LE( trxs.size(), batcher.trxs_per_call );
+         std::vector< streaming_report_batcher::broadcast_result > results;
+         for( const auto& trx : trxs )
+         {
+            BOOST_CHECK( trx.expiration == fc::time_point_sec( round ) );
+            streaming_report_batcher::broadcast_result result;
+            result.id = trx.id();
+            result.accepted = true;
+            for( const auto& op : trx.operations )
+               if( bad_consumers.count( op.get< streaming_platform_report_operation >().consumer ) )
+               {
+                  result.accepted = false;
+                  result.error = "bad report";
+               }
+            if( result.accepted )
+               for( const auto& op : trx.operations )
+                  carried_by[ op.get< streaming_platform_report_operation >().consumer ] = result.id;
+            results.push_back( result );
+         }
+
+         // the first call stands in for a round trip to the node that lasts until the next call is signed
+         if( calls++ == 0 )
+         {
+            std::unique_lock< std::mutex > lock( sign_mutex );
+            signed_during_first_call = signed_cv.wait_for( lock, std::chrono::seconds( 10 ),
+                                                           [&]() { return signed_count > trxs.size(); } );
+         }
+         return results;
+      };
+   }
+
+   std::vector< streaming_platform_report_operation >  reports;
+   std::map< std::string, size_t >                      signatures = { { "platform-a", 3 }, { "platform-b", 1 } };
+   std::set< std::string >                              bad_consumers;
+   std::map< std::string, transaction_id_type >         carried_by;
+   uint32_t                                             round = 0;
+   size_t                                               calls = 0;
+   bool                                                 signed_during_first_call = false;
+   streaming_report_batcher                             batcher;
+
+   std::mutex                                           sign_mutex;
+   std::condition_variable                              signed_cv;
+   size_t                                               signed_count = 0;
+   size_t                                               max_signed_size = 0;
+   size_t                                               mixed_platforms = 0;
+};
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( wallet_tests, report_batcher_fixture )
+
+BOOST_AUTO_TEST_CASE( streaming_report_batching )
+{ try {
+   auto results = batcher.post( reports );
+
+   BOOST_REQUIRE_EQUAL( results.size(), reports.size() );
+   for( size_t i = 0; i < reports.size(); ++i )
+   {
+      BOOST_CHECK( results[i].accepted );
+      BOOST_CHECK( results[i].error.empty() );
+      BOOST_CHECK( results[i].trx_id == carried_by.at( reports[i].consumer ) );
+   }
+   BOOST_CHECK_EQUAL( round, 1u );
+   // several reports of one platform share each transaction, but no transaction outgrows max_trx_size
+   BOOST_CHECK_EQUAL( mixed_platforms, 0u );
+   BOOST_CHECK_LE( max_signed_size, batcher.max_trx_size );
+   BOOST_CHECK_GT( max_signed_size, batcher.max_trx_size - 150 );
+   BOOST_CHECK_LT( signed_count, reports.size() / 2 );
+   BOOST_CHECK_EQUAL( calls, ( signed_count + batcher.trxs_per_call - 1 ) / batcher.trxs_per_call );
+
+   // the transactions of the next call are signed while the previous one is in flight
+   BOOST_CHECK( signed_during_first_call );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( streaming_report_partial_failure )
+{ try {
+   bad_consumers = { "consumer7", "consumer20" };
+
+   auto results = batcher.post( reports );
+
+   BOOST_REQUIRE_EQUAL( results.size(), reports.size() );
+   for( size_t i = 0; i < reports.size(); ++i )
+   {
+      if( bad_consumers.count( reports[i].consumer ) )
+      {
+         BOOST_CHECK( !results[i].accepted );
+         BOOST_CHECK_EQUAL( results[i].error, "bad report" );
+      }
+      else
+      {
+         BOOST_CHECK( results[i].accepted );
+         BOOST_CHECK( results[i].trx_id == carried_by.at( reports[i].consumer ) );
+      }
+   }
+   // the failing transactions were split and signed anew for each retry
+   BOOST_CHECK_GT( round, 1u );
+   BOOST_CHECK_EQUAL( mixed_platforms, 0u );
+   BOOST_CHECK_LE( max_signed_size, batcher.max_trx_size );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( streaming_report_broadcast_failure )
+{ try {
+   batcher.broadcast = []( const std::vector< signed_transaction >& ) -> std::vector< streaming_report_batcher::broadcast_result >
+   {
+      FC_THROW( "connection lost" );
+   };
+   BOOST_CHECK_THROW( batcher.post( reports ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()